@@ -26,6 +26,12 @@ ChannelStats::ChannelStats(channel_id_t cid)
       total_bytes_(0),
       prev_total_bytes_(0),
       bytes_per_second_(0),
+      total_buffers_(0),
+      key_frames_(0),
+      discont_buffers_(0),
+      gap_buffers_(0),
+      last_pts_(0),
+      last_dts_(0),
       desire_bytes_per_second_() {}
 
 channel_id_t ChannelStats::GetID() const {
@@ -56,6 +62,54 @@ size_t ChannelStats::GetDiffTotalBytes() const {
   return total_bytes_ - prev_total_bytes_;
 }
 
+size_t ChannelStats::GetTotalBuffers() const {
+  return total_buffers_;
+}
+
+void ChannelStats::SetTotalBuffers(size_t buffers) {
+  total_buffers_ = buffers;
+}
+
+size_t ChannelStats::GetKeyFrames() const {
+  return key_frames_;
+}
+
+void ChannelStats::SetKeyFrames(size_t frames) {
+  key_frames_ = frames;
+}
+
+size_t ChannelStats::GetDiscontBuffers() const {
+  return discont_buffers_;
+}
+
+void ChannelStats::SetDiscontBuffers(size_t buffers) {
+  discont_buffers_ = buffers;
+}
+
+size_t ChannelStats::GetGapBuffers() const {
+  return gap_buffers_;
+}
+
+void ChannelStats::SetGapBuffers(size_t buffers) {
+  gap_buffers_ = buffers;
+}
+
+uint64_t ChannelStats::GetLastPts() const {
+  return last_pts_;
+}
+
+void ChannelStats::SetLastPts(uint64_t pts) {
+  last_pts_ = pts;
+}
+
+uint64_t ChannelStats::GetLastDts() const {
+  return last_dts_;
+}
+
+void ChannelStats::SetLastDts(uint64_t dts) {
+  last_dts_ = dts;
+}
+
 void ChannelStats::UpdateBps(size_t sec) {
   if (!sec) {
     return;
@@ -38,6 +38,24 @@ class ChannelStats {  // only compile time size fields
 
   size_t GetDiffTotalBytes() const;
 
+  size_t GetTotalBuffers() const;
+  void SetTotalBuffers(size_t buffers);
+
+  size_t GetKeyFrames() const;
+  void SetKeyFrames(size_t frames);
+
+  size_t GetDiscontBuffers() const;
+  void SetDiscontBuffers(size_t buffers);
+
+  size_t GetGapBuffers() const;
+  void SetGapBuffers(size_t buffers);
+
+  uint64_t GetLastPts() const;
+  void SetLastPts(uint64_t pts);
+
+  uint64_t GetLastDts() const;
+  void SetLastDts(uint64_t dts);
+
   void UpdateBps(size_t sec);
   size_t GetBps() const;
   void SetBps(size_t bps);
@@ -54,6 +72,12 @@ class ChannelStats {  // only compile time size fields
   size_t total_bytes_;                     // received bytes
   size_t prev_total_bytes_;                // checkpoint received bytes
   size_t bytes_per_second_;                // bps
+  size_t total_buffers_;                   // received buffers
+  size_t key_frames_;                      // received buffers without delta unit flag
+  size_t discont_buffers_;                 // received buffers with discont flag
+  size_t gap_buffers_;                     // received buffers with gap flag
+  uint64_t last_pts_;                      // nanoseconds, 0 if unknown
+  uint64_t last_dts_;                      // nanoseconds, 0 if unknown
 
   common::media::DesireBytesPerSec desire_bytes_per_second_;
 };
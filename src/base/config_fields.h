@@ -20,6 +20,9 @@
 #define TYPE_FIELD "type"  // required
 #define STREAM_LINK_PATH "stream_link_path"
 #define AUTO_EXIT_TIME_FIELD "auto_exit_time"
+#define STALL_TIMEOUT_FIELD "stall_timeout"
+#define STARTUP_TRACE_FIELD "startup_trace"  // chrome trace of stream start in feedback directory
+#define TRACE_ELEMENTS_FIELD "trace_elements"  // per element rates and processing time in statistic
 
 #define INPUT_FIELD "input"  // required
 #define OUTPUT_FIELD "output"
@@ -39,6 +42,9 @@
 #define TIMESHIFT_DELAY_FIELD "timeshift_delay"
 #define TIMESHIFT_CHUNK_DURATION_FIELD "timeshift_chunk_duration"
 #define CLEANUP_TS_FIELD "cleanup_ts"
+#define VOD_WORKERS_FIELD "vod_workers"
+#define VOD_RANGE_FIELD "vod_range"  // inner, set by service for workers of splitted vod
+#define VOD_JIT_FIELD "vod_jit"      // segments are encoded on request
 #define LOGO_FIELD "logo"
 #define LOOP_FIELD "loop"
 #define AVFORMAT_FIELD "avformat"
@@ -52,6 +58,9 @@
 #define ASPECT_RATIO_FIELD "aspect_ratio"
 #define RELAY_AUDIO_FIELD "relay_audio"
 #define RELAY_VIDEO_FIELD "relay_video"
+#define RENDITIONS_FIELD "renditions"
+#define HOT_SWAP_FIELD "hot_swap"
+#define INPUT_REDUNDANCY_FIELD "input_redundancy"
 
 #define DECKLINK_VIDEO_MODE_FIELD "decklink_video_mode"
 
@@ -0,0 +1,80 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/element_stats.h"
+
+#include <string.h>
+
+namespace fastocloud {
+
+ElementStats::ElementStats() : ElementStats(std::string()) {}
+
+ElementStats::ElementStats(const std::string& name)
+    : name_(),
+      input_rate_(0),
+      output_rate_(0),
+      proctime_p50_(0),
+      proctime_p95_(0),
+      proctime_p99_(0),
+      queue_fill_(no_queue) {
+  strncpy(name_, name.c_str(), max_name_length - 1);
+}
+
+std::string ElementStats::GetName() const {
+  return name_;
+}
+
+double ElementStats::GetInputRate() const {
+  return input_rate_;
+}
+
+void ElementStats::SetInputRate(double rate) {
+  input_rate_ = rate;
+}
+
+double ElementStats::GetOutputRate() const {
+  return output_rate_;
+}
+
+void ElementStats::SetOutputRate(double rate) {
+  output_rate_ = rate;
+}
+
+ElementStats::proctime_t ElementStats::GetProcTimeP50() const {
+  return proctime_p50_;
+}
+
+ElementStats::proctime_t ElementStats::GetProcTimeP95() const {
+  return proctime_p95_;
+}
+
+ElementStats::proctime_t ElementStats::GetProcTimeP99() const {
+  return proctime_p99_;
+}
+
+void ElementStats::SetProcTime(proctime_t p50, proctime_t p95, proctime_t p99) {
+  proctime_p50_ = p50;
+  proctime_p95_ = p95;
+  proctime_p99_ = p99;
+}
+
+int ElementStats::GetQueueFill() const {
+  return queue_fill_;
+}
+
+void ElementStats::SetQueueFill(int percent) {
+  queue_fill_ = percent;
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,61 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace fastocloud {
+
+class ElementStats {  // only compile time size fields
+ public:
+  typedef uint64_t proctime_t;  // usec
+  enum { max_name_length = 64, no_queue = -1 };
+
+  ElementStats();
+  explicit ElementStats(const std::string& name);  // truncated to max_name_length - 1
+
+  std::string GetName() const;
+
+  double GetInputRate() const;  // buffers per second received on sink pads
+  void SetInputRate(double rate);
+
+  double GetOutputRate() const;  // buffers per second pushed from src pads
+  void SetOutputRate(double rate);
+
+  proctime_t GetProcTimeP50() const;
+  proctime_t GetProcTimeP95() const;
+  proctime_t GetProcTimeP99() const;
+  void SetProcTime(proctime_t p50, proctime_t p95, proctime_t p99);
+
+  int GetQueueFill() const;  // percent of the nearest limit, no_queue if element isn't a queue
+  void SetQueueFill(int percent);
+
+ private:
+  char name_[max_name_length];
+
+  double input_rate_;
+  double output_rate_;
+  proctime_t proctime_p50_;  // time from sink pad to src pad of the same buffer
+  proctime_t proctime_p95_;
+  proctime_t proctime_p99_;
+  int queue_fill_;
+};
+
+typedef std::vector<ElementStats> elements_stats_t;
+
+}  // namespace fastocloud
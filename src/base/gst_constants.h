@@ -179,6 +179,11 @@
 #define TS_PARSE "tsparse"
 #define AVDEC_H264 "avdec_h264"
 #define TS_DEMUX "tsdemux"
+#define INTER_VIDEO_SINK "intervideosink"
+#define INTER_VIDEO_SRC "intervideosrc"
+#define INTER_AUDIO_SINK "interaudiosink"
+#define INTER_AUDIO_SRC "interaudiosrc"
+#define INPUT_SELECTOR "input-selector"
 
 #define AVDEC_AC3 "avdec_ac3"
 #define AVDEC_AC3_FIXED "avdec_ac3_fixed"
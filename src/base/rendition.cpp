@@ -0,0 +1,134 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/rendition.h"
+
+#include <string>
+
+#include <json-c/json_object.h>
+#include <json-c/json_tokener.h>
+
+#include "base/config_fields.h"
+
+namespace fastocloud {
+
+Rendition::Rendition() : Rendition(common::draw::Size(), bit_rate_t()) {}
+
+Rendition::Rendition(const common::draw::Size& size, bit_rate_t video_bitrate)
+    : size_(size), video_bitrate_(video_bitrate), frame_rate_() {}
+
+bool Rendition::IsValid() const {
+  return size_.IsValid() && video_bitrate_;
+}
+
+bool Rendition::Equals(const Rendition& rend) const {
+  return size_ == rend.size_ && video_bitrate_ == rend.video_bitrate_ && frame_rate_ == rend.frame_rate_;
+}
+
+common::draw::Size Rendition::GetSize() const {
+  return size_;
+}
+
+void Rendition::SetSize(const common::draw::Size& size) {
+  size_ = size;
+}
+
+bit_rate_t Rendition::GetVideoBitrate() const {
+  return video_bitrate_;
+}
+
+void Rendition::SetVideoBitrate(bit_rate_t bitrate) {
+  video_bitrate_ = bitrate;
+}
+
+Rendition::frame_rate_t Rendition::GetFramerate() const {
+  return frame_rate_;
+}
+
+void Rendition::SetFramerate(frame_rate_t rate) {
+  frame_rate_ = rate;
+}
+
+common::Optional<Rendition> Rendition::MakeRendition(common::HashValue* hash) {
+  if (!hash) {
+    return common::Optional<Rendition>();
+  }
+
+  Rendition res;
+  common::Value* size_field = hash->Find(SIZE_FIELD);
+  std::string size_str;
+  common::draw::Size size;
+  if (size_field && size_field->GetAsBasicString(&size_str) && common::ConvertFromString(size_str, &size)) {
+    res.SetSize(size);
+  }
+
+  common::Value* video_bitrate_field = hash->Find(VIDEO_BIT_RATE_FIELD);
+  int video_bitrate;
+  if (video_bitrate_field && video_bitrate_field->GetAsInteger(&video_bitrate)) {
+    res.SetVideoBitrate(video_bitrate);
+  }
+
+  common::Value* frame_rate_field = hash->Find(FRAME_RATE_FIELD);
+  int frame_rate;
+  if (frame_rate_field && frame_rate_field->GetAsInteger(&frame_rate)) {
+    res.SetFramerate(frame_rate);
+  }
+
+  if (!res.IsValid()) {
+    return common::Optional<Rendition>();
+  }
+  return res;
+}
+
+common::Error Rendition::DoDeSerialize(json_object* serialized) {
+  Rendition res;
+  json_object* jsize = nullptr;
+  json_bool jsize_exists = json_object_object_get_ex(serialized, SIZE_FIELD, &jsize);
+  if (jsize_exists) {
+    common::draw::Size size;
+    if (common::ConvertFromString(json_object_get_string(jsize), &size)) {
+      res.SetSize(size);
+    }
+  }
+
+  json_object* jvideo_bitrate = nullptr;
+  json_bool jvideo_bitrate_exists = json_object_object_get_ex(serialized, VIDEO_BIT_RATE_FIELD, &jvideo_bitrate);
+  if (jvideo_bitrate_exists) {
+    res.SetVideoBitrate(json_object_get_int(jvideo_bitrate));
+  }
+
+  json_object* jframe_rate = nullptr;
+  json_bool jframe_rate_exists = json_object_object_get_ex(serialized, FRAME_RATE_FIELD, &jframe_rate);
+  if (jframe_rate_exists) {
+    res.SetFramerate(json_object_get_int(jframe_rate));
+  }
+
+  *this = res;
+  return common::Error();
+}
+
+common::Error Rendition::SerializeFields(json_object* out) const {
+  const std::string size_str = common::ConvertToString(size_);
+  json_object_object_add(out, SIZE_FIELD, json_object_new_string(size_str.c_str()));
+  if (video_bitrate_) {
+    json_object_object_add(out, VIDEO_BIT_RATE_FIELD, json_object_new_int(*video_bitrate_));
+  }
+  if (frame_rate_) {
+    json_object_object_add(out, FRAME_RATE_FIELD, json_object_new_int(*frame_rate_));
+  }
+
+  return common::Error();
+}
+
+}  // namespace fastocloud
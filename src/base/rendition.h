@@ -0,0 +1,62 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/draw/types.h>
+#include <common/serializer/json_serializer.h>
+#include <common/value.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+
+// one step of adaptive bitrate ladder, all renditions are encoded from the same decoded picture
+class Rendition : public common::serializer::JsonSerializer<Rendition> {
+ public:
+  typedef common::Optional<int> frame_rate_t;
+
+  Rendition();
+  Rendition(const common::draw::Size& size, bit_rate_t video_bitrate);
+
+  bool IsValid() const;
+  bool Equals(const Rendition& rend) const;
+
+  common::draw::Size GetSize() const;
+  void SetSize(const common::draw::Size& size);
+
+  bit_rate_t GetVideoBitrate() const;
+  void SetVideoBitrate(bit_rate_t bitrate);
+
+  frame_rate_t GetFramerate() const;
+  void SetFramerate(frame_rate_t rate);
+
+  static common::Optional<Rendition> MakeRendition(common::HashValue* hash);
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  common::draw::Size size_;
+  bit_rate_t video_bitrate_;
+  frame_rate_t frame_rate_;
+};
+
+typedef std::vector<Rendition> renditions_t;
+
+}  // namespace fastocloud
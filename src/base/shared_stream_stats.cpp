@@ -0,0 +1,201 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/shared_stream_stats.h"
+
+#if defined(OS_POSIX)
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <new>
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory seqlock requires lock free atomics");
+
+namespace fastocloud {
+
+SharedStreamStats* SharedStreamStats::Create() {
+#if defined(OS_POSIX)
+  void* mem = mmap(nullptr, sizeof(SharedStreamStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  return new (mem) SharedStreamStats;
+#else
+  return nullptr;
+#endif
+}
+
+SharedStreamStats* SharedStreamStats::CreateShared(int* fd) {
+  if (!fd) {
+    return nullptr;
+  }
+
+#if defined(OS_LINUX)
+  int lfd = memfd_create("stream_stats", MFD_CLOEXEC);
+  if (lfd == -1) {
+    return nullptr;
+  }
+
+  if (ftruncate(lfd, sizeof(SharedStreamStats)) == -1) {
+    close(lfd);
+    return nullptr;
+  }
+
+  void* mem = mmap(nullptr, sizeof(SharedStreamStats), PROT_READ | PROT_WRITE, MAP_SHARED, lfd, 0);
+  if (mem == MAP_FAILED) {
+    close(lfd);
+    return nullptr;
+  }
+
+  *fd = lfd;
+  return new (mem) SharedStreamStats;
+#else
+  return nullptr;
+#endif
+}
+
+SharedStreamStats* SharedStreamStats::Attach(int fd) {
+#if defined(OS_POSIX)
+  void* mem = mmap(nullptr, sizeof(SharedStreamStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  return static_cast<SharedStreamStats*>(mem);
+#else
+  UNUSED(fd);
+  return nullptr;
+#endif
+}
+
+void SharedStreamStats::Destroy(SharedStreamStats** mem) {
+  if (!mem || !*mem) {
+    return;
+  }
+
+#if defined(OS_POSIX)
+  (*mem)->~SharedStreamStats();
+  munmap(*mem, sizeof(SharedStreamStats));
+#endif
+  *mem = nullptr;
+}
+
+SharedStreamStats::SharedStreamStats()
+    : sequence_(0),
+      type_(PROXY),
+      status_(NEW),
+      start_time_(0),
+      loop_start_time_(0),
+      idle_time_(0),
+      restarts_(0),
+      cpu_load_(0),
+      rss_bytes_(0),
+      timestamp_(0),
+      input_count_(0),
+      input_(),
+      output_count_(0),
+      output_(),
+      elements_count_(0),
+      elements_() {}
+
+SharedStreamStats::~SharedStreamStats() {}
+
+void SharedStreamStats::Publish(const StreamStruct& stats,
+                                double cpu_load,
+                                size_t rss_bytes,
+                                fastotv::timestamp_t timestamp) {
+  // several threads of stream process can publish, take writer slot
+  sequence_t seq = sequence_.load(std::memory_order_relaxed);
+  while ((seq & 1) || !sequence_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) {
+    seq = sequence_.load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  type_ = stats.type;
+  status_ = stats.status;
+  start_time_ = stats.start_time;
+  loop_start_time_ = stats.loop_start_time;
+  idle_time_ = stats.idle_time;
+  restarts_ = stats.restarts;
+  cpu_load_ = cpu_load;
+  rss_bytes_ = rss_bytes;
+  timestamp_ = timestamp;
+  input_count_ = std::min(stats.input.size(), static_cast<size_t>(max_channels));
+  std::copy(stats.input.begin(), stats.input.begin() + input_count_, input_);
+  output_count_ = std::min(stats.output.size(), static_cast<size_t>(max_channels));
+  std::copy(stats.output.begin(), stats.output.begin() + output_count_, output_);
+  elements_count_ = std::min(stats.elements.size(), static_cast<size_t>(max_elements));
+  std::copy(stats.elements.begin(), stats.elements.begin() + elements_count_, elements_);
+
+  sequence_.store(seq + 2, std::memory_order_release);
+}
+
+bool SharedStreamStats::Read(StreamStruct* stats,
+                             double* cpu_load,
+                             size_t* rss_bytes,
+                             fastotv::timestamp_t* timestamp,
+                             sequence_t* sequence) const {
+  if (!stats || !cpu_load || !rss_bytes || !timestamp || !sequence) {
+    return false;
+  }
+
+  for (size_t i = 0; i < read_attempts; ++i) {
+    const sequence_t begin = sequence_.load(std::memory_order_acquire);
+    if (begin == 0) {
+      return false;
+    }
+
+    if (begin & 1) {
+#if defined(OS_POSIX)
+      sched_yield();
+#endif
+      continue;
+    }
+
+    StreamStruct copy = *stats;
+    copy.type = type_;
+    copy.status = status_;
+    copy.start_time = start_time_;
+    copy.loop_start_time = loop_start_time_;
+    copy.idle_time = idle_time_;
+    copy.restarts = restarts_;
+    const size_t input_count = std::min(input_count_, static_cast<size_t>(max_channels));
+    copy.input.assign(input_, input_ + input_count);
+    const size_t output_count = std::min(output_count_, static_cast<size_t>(max_channels));
+    copy.output.assign(output_, output_ + output_count);
+    const size_t elements_count = std::min(elements_count_, static_cast<size_t>(max_elements));
+    copy.elements.assign(elements_, elements_ + elements_count);
+    const double cpu_load_copy = cpu_load_;
+    const size_t rss_bytes_copy = rss_bytes_;
+    const fastotv::timestamp_t timestamp_copy = timestamp_;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != begin) {
+      continue;
+    }
+
+    *stats = copy;
+    *cpu_load = cpu_load_copy;
+    *rss_bytes = rss_bytes_copy;
+    *timestamp = timestamp_copy;
+    *sequence = begin;
+    return true;
+  }
+
+  return false;
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,71 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "base/stream_struct.h"
+
+namespace fastocloud {
+
+// Statistics of one stream shared between stream process (writer) and service (reader), mapped before fork
+// or passed to stream process as descriptor.
+// Fixed size layout, consistent snapshots guarded by seqlock.
+class SharedStreamStats {
+ public:
+  typedef uint32_t sequence_t;
+  enum { max_channels = 16, max_elements = 32, read_attempts = 100 };
+
+  static SharedStreamStats* Create();  // nullptr if platform not supported
+  // same as Create but backed by descriptor, so it can be passed to a process not forked from this one
+  static SharedStreamStats* CreateShared(int* fd);
+  static SharedStreamStats* Attach(int fd);  // maps memory made by CreateShared, descriptor can be closed after
+  static void Destroy(SharedStreamStats** mem);
+
+  void Publish(const StreamStruct& stats, double cpu_load, size_t rss_bytes, fastotv::timestamp_t timestamp);
+  // returns false if nothing published or writer busy, sequence changes on each publish
+  bool Read(StreamStruct* stats,
+            double* cpu_load,
+            size_t* rss_bytes,
+            fastotv::timestamp_t* timestamp,
+            sequence_t* sequence) const;
+
+ private:
+  SharedStreamStats();
+  ~SharedStreamStats();
+
+  std::atomic<sequence_t> sequence_;  // odd while writing
+
+  StreamType type_;
+  StreamStatus status_;
+  fastotv::timestamp_t start_time_;
+  fastotv::timestamp_t loop_start_time_;
+  fastotv::timestamp_t idle_time_;
+  size_t restarts_;
+  double cpu_load_;
+  size_t rss_bytes_;
+  fastotv::timestamp_t timestamp_;
+
+  size_t input_count_;
+  ChannelStats input_[max_channels];
+  size_t output_count_;
+  ChannelStats output_[max_channels];
+  size_t elements_count_;
+  ElementStats elements_[max_elements];
+
+  DISALLOW_COPY_AND_ASSIGN(SharedStreamStats);
+};
+
+}  // namespace fastocloud
@@ -0,0 +1,133 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/startup_timing.h"
+
+#include <chrono>
+
+namespace {
+// names of work which ends by phase
+const char* const kStartupPhases[] = {"requested", "fork", "load_core", "init", "starting", "generate_links",
+                                      "create_pipeline", "pause", "play", "first_input", "first_output",
+                                      "first_segment"};
+}  // namespace
+
+namespace common {
+
+std::string ConvertToString(fastocloud::StartupPhase phase) {
+  if (phase < 0 || phase >= fastocloud::STARTUP_PHASES_COUNT) {
+    return std::string();
+  }
+
+  return kStartupPhases[phase];
+}
+
+bool ConvertFromString(const std::string& from, fastocloud::StartupPhase* out) {
+  if (!out) {
+    return false;
+  }
+
+  for (int i = 0; i < fastocloud::STARTUP_PHASES_COUNT; ++i) {
+    if (from == kStartupPhases[i]) {
+      *out = static_cast<fastocloud::StartupPhase>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace common
+
+namespace fastocloud {
+
+StartupTiming::StartupTiming() : phases_() {}
+
+StartupTiming::mono_usec_t StartupTiming::Now() {
+  // steady clock is CLOCK_MONOTONIC on linux, it is the same in all processes
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+void StartupTiming::Mark(StartupPhase phase) {
+  if (!IsMarked(phase)) {
+    Set(phase, Now());
+  }
+}
+
+void StartupTiming::Set(StartupPhase phase, mono_usec_t time) {
+  if (phase < 0 || phase >= STARTUP_PHASES_COUNT) {
+    return;
+  }
+
+  phases_[phase] = time;
+}
+
+StartupTiming::mono_usec_t StartupTiming::Get(StartupPhase phase) const {
+  if (phase < 0 || phase >= STARTUP_PHASES_COUNT) {
+    return 0;
+  }
+
+  return phases_[phase];
+}
+
+bool StartupTiming::IsMarked(StartupPhase phase) const {
+  return Get(phase) != 0;
+}
+
+bool StartupTiming::IsEmpty() const {
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    if (phases_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StartupTiming::Merge(const StartupTiming& other) {
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    if (!phases_[i]) {
+      phases_[i] = other.phases_[i];
+    }
+  }
+}
+
+StartupTiming::mono_usec_t StartupTiming::GetDuration() const {
+  mono_usec_t first = 0;
+  mono_usec_t last = 0;
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    const mono_usec_t time = phases_[i];
+    if (!time) {
+      continue;
+    }
+
+    if (!first || time < first) {
+      first = time;
+    }
+    if (time > last) {
+      last = time;
+    }
+  }
+  return last - first;
+}
+
+bool StartupTiming::Equals(const StartupTiming& timing) const {
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    if (phases_[i] != timing.phases_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,81 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+namespace fastocloud {
+
+// Phases of stream start, each one is marked when it ends. Process phases are marked only for the first start,
+// restarts inside stream process are timed from STARTUP_STARTING.
+enum StartupPhase : int {
+  STARTUP_REQUESTED = 0,        // service creates stream process
+  STARTUP_FORKED = 1,           // stream process runs
+  STARTUP_CORE_LOADED = 2,      // stream core library loaded, at once if forked by zygote
+  STARTUP_INITED = 3,           // config parsed, gstreamer inited
+  STARTUP_STARTING = 4,         // pipeline (re)start begins
+  STARTUP_LINKS_GENERATED = 5,  // inputs resolved by stream link generator
+  STARTUP_PIPELINE_CREATED = 6,
+  STARTUP_PAUSED = 7,
+  STARTUP_PLAYING = 8,
+  STARTUP_FIRST_INPUT_BUFFER = 9,
+  STARTUP_FIRST_OUTPUT_BUFFER = 10,
+  STARTUP_FIRST_SEGMENT = 11,  // first hls chunk closed on disk
+  STARTUP_PHASES_COUNT = 12
+};
+
+// Monotonic timestamps of start phases, the clock is system wide so service and stream marks can be merged.
+// Plain values, passed to stream core library as is.
+class StartupTiming {
+ public:
+  typedef int64_t mono_usec_t;
+
+  StartupTiming();
+
+  static mono_usec_t Now();
+
+  void Mark(StartupPhase phase);  // first mark wins
+  void Set(StartupPhase phase, mono_usec_t time);
+  mono_usec_t Get(StartupPhase phase) const;  // 0 if phase not reached
+  bool IsMarked(StartupPhase phase) const;
+  bool IsEmpty() const;
+
+  // phases not marked here are taken from other
+  void Merge(const StartupTiming& other);
+  // time from first to last marked phase
+  mono_usec_t GetDuration() const;
+
+  bool Equals(const StartupTiming& timing) const;
+
+ private:
+  mono_usec_t phases_[STARTUP_PHASES_COUNT];
+};
+
+inline bool operator==(const StartupTiming& left, const StartupTiming& right) {
+  return left.Equals(right);
+}
+
+inline bool operator!=(const StartupTiming& left, const StartupTiming& right) {
+  return !operator==(left, right);
+}
+
+}  // namespace fastocloud
+
+namespace common {
+std::string ConvertToString(fastocloud::StartupPhase phase);
+bool ConvertFromString(const std::string& from, fastocloud::StartupPhase* out);
+}  // namespace common
@@ -78,7 +78,8 @@ StreamStruct::StreamStruct(stream_id_t sid,
       restarts(rest),
       status(status),
       input(input),
-      output(output) {}
+      output(output),
+      elements() {}
 
 bool StreamStruct::IsValid() const {
   return !id.empty();
@@ -20,6 +20,7 @@
 #include <common/macros.h>
 
 #include "base/channel_stats.h"
+#include "base/element_stats.h"
 #include "base/types.h"
 
 #include "base/stream_info.h"
@@ -58,6 +59,7 @@ struct StreamStruct {
 
   input_channels_info_t input;
   output_channels_info_t output;
+  elements_stats_t elements;  // filled only when elements tracing is on
 };
 
 }  // namespace fastocloud
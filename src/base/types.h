@@ -24,6 +24,7 @@
 #define CHUNK_EXT "." TS_EXTENSION
 
 #define DUMP_FILE_NAME "dump.html"
+#define STARTUP_TRACE_FILE_NAME "startup_trace.json"
 
 namespace fastocloud {
 
@@ -48,4 +49,10 @@ enum StreamType : int {
   SCREEN  // for inner use
 };
 
+enum StallReason : int {
+  STALL_NO_DATA = 0,      // no buffers arrived
+  STALL_NO_PROGRESS = 1,  // buffers arrive, timestamps stand still
+  STALL_LOW_BITRATE = 2   // data rate far below desired for stream caps
+};
+
 }  // namespace fastocloud
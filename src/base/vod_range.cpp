@@ -0,0 +1,211 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/vod_range.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include <common/convert2string.h>
+#include <common/sprintf.h>
+
+namespace fastocloud {
+
+VodRange::VodRange() : VodRange(0, 0, open_stop) {}
+
+VodRange::VodRange(size_t index, int64_t start_msec, int64_t stop_msec)
+    : index(index), start_msec(start_msec), stop_msec(stop_msec) {}
+
+bool VodRange::IsValid() const {
+  if (start_msec < 0) {
+    return false;
+  }
+  return stop_msec == open_stop || stop_msec > start_msec;
+}
+
+bool VodRange::Equals(const VodRange& range) const {
+  return index == range.index && start_msec == range.start_msec && stop_msec == range.stop_msec;
+}
+
+size_t CalcVodRangesCount(int64_t duration_msec, size_t workers) {
+  if (workers < 2 || duration_msec <= 0) {
+    return 1;
+  }
+
+  const size_t by_duration = duration_msec / VodRange::min_duration_msec;
+  const size_t count = std::min(workers * VodRange::ranges_per_worker, by_duration);
+  return count < 2 ? 1 : count;
+}
+
+size_t CalcVodSegmentsCount(int64_t duration_msec) {
+  if (duration_msec <= 0) {
+    return 1;
+  }
+
+  const size_t count = duration_msec / VodRange::jit_segment_msec;
+  return count ? count : 1;
+}
+
+vod_ranges_t MakeVodRanges(const std::vector<int64_t>& keyframes_msec, int64_t stop_msec) {
+  vod_ranges_t ranges;
+  int64_t start = 0;
+  for (int64_t keyframe : keyframes_msec) {
+    if (keyframe <= start) {  // several split points snapped to the same keyframe
+      continue;
+    }
+    if (stop_msec != VodRange::open_stop && keyframe >= stop_msec) {
+      break;
+    }
+    ranges.push_back(VodRange(ranges.size(), start, keyframe));
+    start = keyframe;
+  }
+  ranges.push_back(VodRange(ranges.size(), start, stop_msec));
+  return ranges;
+}
+
+std::string MakeVodRangePrefix(size_t index) {
+  return common::MemSPrintf("r%03lu_", index);
+}
+
+std::string MakeVodJitSegmentName(size_t index) {
+  return common::MemSPrintf("jit%05lu.ts", index);
+}
+
+bool ParseVodJitSegmentName(const std::string& name, size_t* index) {
+  if (!index) {
+    return false;
+  }
+
+  unsigned long lindex;
+  if (sscanf(name.c_str(), "jit%lu", &lindex) != 1 || name != MakeVodJitSegmentName(lindex)) {
+    return false;
+  }
+
+  *index = lindex;
+  return true;
+}
+
+common::file_system::ascii_file_string_path MakeVodRangesPath(
+    const common::file_system::ascii_directory_string_path& http_root) {
+  const auto path = http_root.MakeFileStringPath(VOD_RANGES_FILE_NAME);
+  return path ? *path : common::file_system::ascii_file_string_path();
+}
+
+common::file_system::ascii_file_string_path MakeVodJitIndexPath(
+    const common::file_system::ascii_directory_string_path& http_root) {
+  const auto path = http_root.MakeFileStringPath(VOD_JIT_INDEX_FILE_NAME);
+  return path ? *path : common::file_system::ascii_file_string_path();
+}
+
+common::ErrnoError WriteVodRanges(const common::file_system::ascii_file_string_path& path,
+                                  const vod_ranges_t& ranges) {
+  // ranges are read only after planner exit, but never half written if it crashed
+  const std::string tmp_path = path.GetPath() + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+      return common::make_errno_error(errno);
+    }
+
+    for (const VodRange& range : ranges) {
+      file << common::ConvertToString(range) << '\n';
+    }
+    if (!file.flush()) {
+      return common::make_errno_error("Can't write vod ranges", EIO);
+    }
+  }
+
+  if (rename(tmp_path.c_str(), path.GetPath().c_str()) != 0) {
+    return common::make_errno_error(errno);
+  }
+  return common::ErrnoError();
+}
+
+bool ReadVodRanges(const common::file_system::ascii_file_string_path& path, vod_ranges_t* ranges) {
+  if (!ranges) {
+    return false;
+  }
+
+  std::ifstream file(path.GetPath());
+  if (!file.is_open()) {
+    return false;
+  }
+
+  vod_ranges_t lranges;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    VodRange range;
+    if (!common::ConvertFromString(line, &range) || range.index != lranges.size()) {
+      return false;
+    }
+    lranges.push_back(range);
+  }
+
+  if (lranges.empty()) {
+    return false;
+  }
+
+  *ranges = lranges;
+  return true;
+}
+
+}  // namespace fastocloud
+
+namespace common {
+
+std::string ConvertToString(const fastocloud::VodRange& value) {
+  return MemSPrintf("%lu:%lld:%lld", value.index, static_cast<long long>(value.start_msec),
+                    static_cast<long long>(value.stop_msec));
+}
+
+bool ConvertFromString(const std::string& from, fastocloud::VodRange* out) {
+  if (!out) {
+    return false;
+  }
+
+  const size_t first = from.find(':');
+  if (first == std::string::npos) {
+    return false;
+  }
+  const size_t second = from.find(':', first + 1);
+  if (second == std::string::npos) {
+    return false;
+  }
+
+  uint64_t index;
+  int64_t start_msec;
+  int64_t stop_msec;
+  if (!ConvertFromString(from.substr(0, first), &index) ||
+      !ConvertFromString(from.substr(first + 1, second - first - 1), &start_msec) ||
+      !ConvertFromString(from.substr(second + 1), &stop_msec)) {
+    return false;
+  }
+
+  fastocloud::VodRange res(index, start_msec, stop_msec);
+  if (!res.IsValid()) {
+    return false;
+  }
+
+  *out = res;
+  return true;
+}
+
+}  // namespace common
@@ -0,0 +1,83 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/file_system/path.h>
+
+#define VOD_RANGES_FILE_NAME "vod_ranges.txt"
+#define VOD_JIT_INDEX_FILE_NAME "vod_index.txt"
+
+namespace fastocloud {
+
+// part of vod between two keyframes, splitted vod is encoded by pool of workers range by range,
+// just in time vod is indexed by segment sized ranges and every segment is encoded on request
+struct VodRange {
+  enum {
+    ranges_per_worker = 4,           // short ranges keep workers busy until the end of job
+    min_duration_msec = 20 * 1000,   // shorter ranges cost more in pipeline startup than they save
+    jit_segment_msec = 10 * 1000,    // segment of just in time vod
+    open_stop = -1                   // last range is encoded until end of input
+  };
+
+  VodRange();
+  VodRange(size_t index, int64_t start_msec, int64_t stop_msec);
+
+  bool IsValid() const;
+  bool Equals(const VodRange& range) const;
+
+  size_t index;
+  int64_t start_msec;
+  int64_t stop_msec;
+};
+
+inline bool operator==(const VodRange& left, const VodRange& right) {
+  return left.Equals(right);
+}
+
+inline bool operator!=(const VodRange& left, const VodRange& right) {
+  return !operator==(left, right);
+}
+
+typedef std::vector<VodRange> vod_ranges_t;
+
+// count of ranges for vod of given duration, 1 if it is not worth splitting
+size_t CalcVodRangesCount(int64_t duration_msec, size_t workers);
+size_t CalcVodSegmentsCount(int64_t duration_msec);
+// ranges starting at sorted split keyframes, first range starts at 0, last one stops at stop_msec
+vod_ranges_t MakeVodRanges(const std::vector<int64_t>& keyframes_msec, int64_t stop_msec = VodRange::open_stop);
+// range playlist and chunks are written with this prefix next to vod playlist
+std::string MakeVodRangePrefix(size_t index);
+// segment of just in time vod, listed in its playlist
+std::string MakeVodJitSegmentName(size_t index);
+bool ParseVodJitSegmentName(const std::string& name, size_t* index);
+
+common::file_system::ascii_file_string_path MakeVodRangesPath(
+    const common::file_system::ascii_directory_string_path& http_root);
+common::file_system::ascii_file_string_path MakeVodJitIndexPath(
+    const common::file_system::ascii_directory_string_path& http_root);
+common::ErrnoError WriteVodRanges(const common::file_system::ascii_file_string_path& path,
+                                  const vod_ranges_t& ranges) WARN_UNUSED_RESULT;
+bool ReadVodRanges(const common::file_system::ascii_file_string_path& path, vod_ranges_t* ranges);
+
+}  // namespace fastocloud
+
+namespace common {
+std::string ConvertToString(const fastocloud::VodRange& value);
+bool ConvertFromString(const std::string& from, fastocloud::VodRange* out);
+}  // namespace common
@@ -0,0 +1,283 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_file_response.h"
+
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include <common/sprintf.h>
+
+#define HTTP_DATE_FORMAT "%a, %d %b %Y %H:%M:%S GMT"
+#define BYTES_UNIT "bytes="
+#define BYTES_UNIT_LEN 6
+#define WEAK_ETAG_PREFIX "W/"
+
+namespace fastocloud {
+namespace server {
+namespace base {
+namespace {
+
+std::string MakeETag(const struct stat& sb) {
+  return common::MemSPrintf("\"%lx-%lx-%lx\"", static_cast<unsigned long>(sb.st_ino),
+                            static_cast<unsigned long>(sb.st_size), static_cast<unsigned long>(sb.st_mtime));
+}
+
+std::string TrimSpaces(const std::string& str) {
+  const size_t first = str.find_first_not_of(" \t");
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  const size_t last = str.find_last_not_of(" \t");
+  return str.substr(first, last - first + 1);
+}
+
+std::string FormatHttpDate(time_t date) {
+  struct tm tm_date;
+  char buff[64] = {0};
+  if (!gmtime_r(&date, &tm_date) || strftime(buff, sizeof(buff), HTTP_DATE_FORMAT, &tm_date) == 0) {
+    return std::string();
+  }
+  return buff;
+}
+
+bool ParseHttpDate(const std::string& str, time_t* date) {
+  struct tm tm_date;
+  memset(&tm_date, 0, sizeof(tm_date));
+  const char* end = strptime(str.c_str(), HTTP_DATE_FORMAT, &tm_date);
+  if (!end || *end != 0) {
+    return false;
+  }
+  *date = timegm(&tm_date);
+  return true;
+}
+
+bool ParseOffset(const std::string& str, off_t* offset) {
+  if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  *offset = strtoll(str.c_str(), nullptr, 10);
+  return true;
+}
+
+bool IsETagInList(const std::string& list, const std::string& etag) {
+  size_t pos = 0;
+  while (pos <= list.size()) {
+    size_t comma = list.find(',', pos);
+    if (comma == std::string::npos) {
+      comma = list.size();
+    }
+    std::string tag = TrimSpaces(list.substr(pos, comma - pos));
+    if (tag == "*") {
+      return true;
+    }
+    if (tag.compare(0, 2, WEAK_ETAG_PREFIX) == 0) {
+      tag = tag.substr(2);
+    }
+    if (tag == etag) {
+      return true;
+    }
+    pos = comma + 1;
+  }
+  return false;
+}
+
+const char* GetStatusTitle(HttpFileResponse::status_t status) {
+  switch (status) {
+    case HttpFileResponse::FILE_OK:
+      return "OK";
+    case HttpFileResponse::FILE_PARTIAL_CONTENT:
+      return "Partial Content";
+    case HttpFileResponse::FILE_NOT_MODIFIED:
+      return "Not Modified";
+    case HttpFileResponse::FILE_RANGE_NOT_SATISFIABLE:
+      return "Range Not Satisfiable";
+  }
+  return "OK";
+}
+
+}  // namespace
+
+HttpFileResponse::HttpFileResponse(const common::http::HttpRequest& request, const struct stat& sb)
+    : file_size_(sb.st_size),
+      mtime_(sb.st_mtime),
+      etag_(MakeETag(sb)),
+      status_(FILE_OK),
+      offset_(0),
+      length_(sb.st_size) {
+  if (IsNotModified(request)) {
+    status_ = FILE_NOT_MODIFIED;
+    length_ = 0;
+    return;
+  }
+
+  common::http::header_t range_field;
+  if (request.FindHeaderByKey("Range", false, &range_field) && IsRangeApplicable(request)) {
+    ApplyRange(TrimSpaces(range_field.value));
+  }
+}
+
+HttpFileResponse::status_t HttpFileResponse::GetStatus() const {
+  return status_;
+}
+
+bool HttpFileResponse::HasBody() const {
+  return status_ == FILE_OK || status_ == FILE_PARTIAL_CONTENT;
+}
+
+off_t HttpFileResponse::GetOffset() const {
+  return offset_;
+}
+
+off_t HttpFileResponse::GetLength() const {
+  return length_;
+}
+
+const std::string& HttpFileResponse::GetETag() const {
+  return etag_;
+}
+
+std::string HttpFileResponse::MakeHeaders(common::http::http_protocol protocol,
+                                          const char* mime,
+                                          bool is_keep_alive,
+                                          const char* server_name) const {
+  std::string headers = common::MemSPrintf("%s %d %s\r\n", protocol == common::http::HP_1_0 ? "HTTP/1.0" : "HTTP/1.1",
+                                           static_cast<int>(status_), GetStatusTitle(status_));
+  if (server_name) {
+    headers += common::MemSPrintf("Server: %s\r\n", server_name);
+  }
+  headers += "Date: " + FormatHttpDate(time(nullptr)) + "\r\n";
+  if (HasBody() && mime) {
+    headers += common::MemSPrintf("Content-Type: %s\r\n", mime);
+  }
+  if (status_ != FILE_NOT_MODIFIED) {
+    headers += common::MemSPrintf("Content-Length: %lld\r\n", static_cast<long long>(length_));
+  }
+  if (status_ == FILE_PARTIAL_CONTENT) {
+    headers += common::MemSPrintf("Content-Range: bytes %lld-%lld/%lld\r\n", static_cast<long long>(offset_),
+                                  static_cast<long long>(offset_ + length_ - 1), static_cast<long long>(file_size_));
+  } else if (status_ == FILE_RANGE_NOT_SATISFIABLE) {
+    headers += common::MemSPrintf("Content-Range: bytes */%lld\r\n", static_cast<long long>(file_size_));
+  }
+  headers += "Accept-Ranges: bytes\r\n";
+  headers += "ETag: " + etag_ + "\r\n";
+  headers += "Last-Modified: " + FormatHttpDate(mtime_) + "\r\n";
+  headers += is_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  headers += "\r\n";
+  return headers;
+}
+
+void HttpFileResponse::QueueHeaders(HttpOutput* output,
+                                    common::http::http_protocol protocol,
+                                    const char* mime,
+                                    bool is_keep_alive,
+                                    const char* server_name) const {
+  output->Push(MakeHeaders(protocol, mime, is_keep_alive, server_name));
+}
+
+void HttpFileResponse::QueueBody(HttpOutput* output, int file) const {
+  if (!HasBody()) {
+    ::close(file);
+    return;
+  }
+
+  output->PushFile(file, offset_, length_);
+}
+
+bool HttpFileResponse::IsNotModified(const common::http::HttpRequest& request) const {
+  common::http::header_t field;
+  if (request.FindHeaderByKey("If-None-Match", false, &field)) {
+    // If-Modified-Since ignored when If-None-Match present
+    return IsETagInList(field.value, etag_);
+  }
+
+  time_t since = 0;
+  if (request.FindHeaderByKey("If-Modified-Since", false, &field) && ParseHttpDate(TrimSpaces(field.value), &since)) {
+    return mtime_ <= since;
+  }
+  return false;
+}
+
+bool HttpFileResponse::IsRangeApplicable(const common::http::HttpRequest& request) const {
+  common::http::header_t field;
+  if (!request.FindHeaderByKey("If-Range", false, &field)) {
+    return true;
+  }
+
+  const std::string validator = TrimSpaces(field.value);
+  if (validator == etag_) {
+    return true;
+  }
+
+  time_t date = 0;
+  return ParseHttpDate(validator, &date) && date == mtime_;
+}
+
+void HttpFileResponse::ApplyRange(const std::string& range) {
+  if (range.size() <= BYTES_UNIT_LEN || strncasecmp(range.c_str(), BYTES_UNIT, BYTES_UNIT_LEN) != 0) {
+    return;  // unknown unit, full file
+  }
+
+  const std::string spec = TrimSpaces(range.substr(BYTES_UNIT_LEN));
+  const size_t dash = spec.find('-');
+  if (dash == std::string::npos || spec.find(',') != std::string::npos) {
+    return;  // invalid or multipart range, full file
+  }
+
+  const std::string first_str = TrimSpaces(spec.substr(0, dash));
+  const std::string last_str = TrimSpaces(spec.substr(dash + 1));
+  off_t first = 0;
+  off_t last = file_size_ - 1;
+  if (first_str.empty()) {
+    off_t suffix = 0;
+    if (!ParseOffset(last_str, &suffix)) {
+      return;
+    }
+    if (suffix == 0 || file_size_ == 0) {
+      status_ = FILE_RANGE_NOT_SATISFIABLE;
+      length_ = 0;
+      return;
+    }
+    first = suffix < file_size_ ? file_size_ - suffix : 0;
+  } else {
+    if (!ParseOffset(first_str, &first)) {
+      return;
+    }
+    if (!last_str.empty()) {
+      if (!ParseOffset(last_str, &last) || last < first) {
+        return;
+      }
+      if (last >= file_size_) {
+        last = file_size_ - 1;
+      }
+    }
+    if (first >= file_size_) {
+      status_ = FILE_RANGE_NOT_SATISFIABLE;
+      length_ = 0;
+      return;
+    }
+  }
+
+  status_ = FILE_PARTIAL_CONTENT;
+  offset_ = first;
+  length_ = last - first + 1;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
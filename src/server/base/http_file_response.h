@@ -0,0 +1,75 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/stat.h>
+
+#include <string>
+
+#include <common/http/http.h>
+
+#include "server/base/http_output.h"
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Static file answer for GET/HEAD according to If-None-Match, If-Modified-Since, Range and If-Range headers.
+class HttpFileResponse {
+ public:
+  enum status_t {
+    FILE_OK = 200,
+    FILE_PARTIAL_CONTENT = 206,
+    FILE_NOT_MODIFIED = 304,
+    FILE_RANGE_NOT_SATISFIABLE = 416
+  };
+
+  HttpFileResponse(const common::http::HttpRequest& request, const struct stat& sb);
+
+  status_t GetStatus() const;
+  bool HasBody() const;
+  off_t GetOffset() const;
+  off_t GetLength() const;
+  const std::string& GetETag() const;
+
+  std::string MakeHeaders(common::http::http_protocol protocol,
+                          const char* mime,
+                          bool is_keep_alive,
+                          const char* server_name) const;
+
+  void QueueHeaders(HttpOutput* output,
+                    common::http::http_protocol protocol,
+                    const char* mime,
+                    bool is_keep_alive,
+                    const char* server_name) const;
+  // queues [offset, offset + length) of opened file, takes ownership of file
+  void QueueBody(HttpOutput* output, int file) const;
+
+ private:
+  bool IsNotModified(const common::http::HttpRequest& request) const;
+  bool IsRangeApplicable(const common::http::HttpRequest& request) const;
+  void ApplyRange(const std::string& range);
+
+  const off_t file_size_;
+  const time_t mtime_;
+  const std::string etag_;
+  status_t status_;
+  off_t offset_;
+  off_t length_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
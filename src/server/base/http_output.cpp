@@ -0,0 +1,146 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_output.h"
+
+#if defined(OS_LINUX)
+#include <sys/sendfile.h>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <common/time.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+HttpOutput::HttpOutput() : chunks_(), last_progress_(0), close_on_empty_(false) {}
+
+HttpOutput::~HttpOutput() {
+  for (const Chunk& chunk : chunks_) {
+    if (chunk.file != INVALID_DESCRIPTOR) {
+      ::close(chunk.file);
+    }
+  }
+}
+
+bool HttpOutput::IsEmpty() const {
+  return chunks_.empty();
+}
+
+bool HttpOutput::IsCloseOnEmpty() const {
+  return close_on_empty_;
+}
+
+void HttpOutput::SetCloseOnEmpty() {
+  close_on_empty_ = true;
+}
+
+void HttpOutput::Push(const std::string& data) {
+  Push(std::make_shared<const std::string>(data), 0, data.size());
+}
+
+void HttpOutput::Push(const data_t& data, size_t offset, size_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  Chunk chunk;
+  chunk.data = data;
+  chunk.file = INVALID_DESCRIPTOR;
+  chunk.offset = offset;
+  chunk.length = size;
+  PushChunk(chunk);
+}
+
+void HttpOutput::PushFile(int file, off_t offset, off_t length) {
+  if (length == 0) {
+    ::close(file);
+    return;
+  }
+
+  Chunk chunk;
+  chunk.file = file;
+  chunk.offset = offset;
+  chunk.length = length;
+  PushChunk(chunk);
+}
+
+common::ErrnoError HttpOutput::Flush(int sock) {
+  while (!chunks_.empty()) {
+    Chunk* chunk = &chunks_.front();
+    const ssize_t sent = SendChunk(sock, chunk);
+    if (sent == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return common::ErrnoError();  // rest will be sent when client writable
+      }
+      return common::make_errno_error(errno);
+    }
+    if (sent == 0) {  // file was truncated
+      return common::make_errno_error(EIO);
+    }
+
+    last_progress_ = common::time::current_utc_mstime();
+    chunk->offset += sent;
+    chunk->length -= sent;
+    if (chunk->length == 0) {
+      if (chunk->file != INVALID_DESCRIPTOR) {
+        ::close(chunk->file);
+      }
+      chunks_.pop_front();
+    }
+  }
+
+  return common::ErrnoError();
+}
+
+bool HttpOutput::IsStalled(fastotv::timestamp_t current_time) const {
+  return !chunks_.empty() && current_time - last_progress_ > stall_timeout_msec;
+}
+
+void HttpOutput::PushChunk(const Chunk& chunk) {
+  if (chunks_.empty()) {
+    last_progress_ = common::time::current_utc_mstime();
+  }
+  chunks_.push_back(chunk);
+}
+
+ssize_t HttpOutput::SendChunk(int sock, Chunk* chunk) {
+  if (chunk->file == INVALID_DESCRIPTOR) {
+    return write(sock, chunk->data->data() + chunk->offset, chunk->length);
+  }
+
+#if defined(OS_LINUX)
+  off_t offset = chunk->offset;  // position of file isn't used nor changed
+  return sendfile(sock, chunk->file, &offset, chunk->length);
+#else
+  char buff[16 * 1024];
+  const ssize_t nread = pread(chunk->file, buff, std::min(static_cast<off_t>(sizeof(buff)), chunk->length),
+                              chunk->offset);
+  if (nread <= 0) {
+    return nread;
+  }
+  return write(sock, buff, nread);  // not sent part is read again on next flush
+#endif
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,79 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <common/error.h>
+
+#include <fastotv/types.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Per connection queue of response bytes, socket of client is non blocking so whatever it doesn't take
+// now stays queued and is flushed again when loop reports client writable, loop thread never waits.
+class HttpOutput {
+ public:
+  enum { stall_timeout_msec = 30 * 1000, stall_check_msec = 1000 };
+  typedef std::shared_ptr<const std::string> data_t;
+
+  HttpOutput();
+  ~HttpOutput();
+
+  bool IsEmpty() const;
+
+  // connection should be closed when everything queued is sent
+  bool IsCloseOnEmpty() const;
+  void SetCloseOnEmpty();
+
+  void Push(const std::string& data);
+  // [offset, offset + size) of shared data, data isn't copied
+  void Push(const data_t& data, size_t offset, size_t size);
+  // [offset, offset + length) of opened file, takes ownership of file
+  void PushFile(int file, off_t offset, off_t length);
+
+  // sends as much as socket takes, EAGAIN isn't error
+  common::ErrnoError Flush(int sock) WARN_UNUSED_RESULT;
+
+  // something queued but socket took nothing for stall_timeout_msec
+  bool IsStalled(fastotv::timestamp_t current_time) const;
+
+ private:
+  struct Chunk {
+    data_t data;
+    int file;  // INVALID_DESCRIPTOR for data
+    off_t offset;
+    off_t length;
+  };
+
+  DISALLOW_COPY_AND_ASSIGN(HttpOutput);
+
+  void PushChunk(const Chunk& chunk);
+  static ssize_t SendChunk(int sock, Chunk* chunk);
+
+  std::deque<Chunk> chunks_;
+  fastotv::timestamp_t last_progress_;
+  bool close_on_empty_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,139 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_request_reader.h"
+
+#include <string.h>
+#include <strings.h>
+
+#include <cstdlib>
+
+#define HEADERS_END "\r\n\r\n"
+#define HEADERS_END_LEN 4
+#define CONTENT_LENGTH_HEADER "Content-Length:"
+#define CONTENT_LENGTH_HEADER_LEN 15
+
+namespace fastocloud {
+namespace server {
+namespace base {
+namespace {
+
+// values above limit are cut to limit + 1, so adding header size can't overflow
+size_t ParseContentLength(const char* headers, size_t size, size_t limit) {
+  const char* end = headers + size;
+  const char* line = headers;
+  while (line < end) {
+    const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+    if (!eol) {
+      break;
+    }
+
+    const size_t line_len = eol - line;
+    if (line_len > CONTENT_LENGTH_HEADER_LEN &&
+        strncasecmp(line, CONTENT_LENGTH_HEADER, CONTENT_LENGTH_HEADER_LEN) == 0) {
+      const unsigned long long length = strtoull(line + CONTENT_LENGTH_HEADER_LEN, nullptr, 10);
+      return length > limit ? limit + 1 : static_cast<size_t>(length);
+    }
+    line = eol + 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+HttpRequestReader::HttpRequestReader()
+    : buffer_(), begin_(0), end_(0), scan_pos_(0), headers_size_(0), body_size_(0), request_() {}
+
+char* HttpRequestReader::PrepareRead(size_t* size) {
+  if (begin_ == end_) {
+    begin_ = end_ = scan_pos_ = 0;
+  } else if (begin_ != 0 && buffer_.size() - end_ < read_chunk_size) {
+    const size_t pending = GetPendingSize();
+    memmove(buffer_.data(), buffer_.data() + begin_, pending);
+    scan_pos_ -= begin_;
+    begin_ = 0;
+    end_ = pending;
+  }
+
+  if (buffer_.size() - end_ < read_chunk_size) {
+    buffer_.resize(end_ + read_chunk_size);
+  }
+
+  *size = buffer_.size() - end_;
+  return buffer_.data() + end_;
+}
+
+void HttpRequestReader::CommitRead(size_t size) {
+  end_ += size;
+}
+
+bool HttpRequestReader::NextRequest() {
+  if (!headers_size_) {
+    const size_t headers_end = FindHeadersEnd();
+    if (headers_end == std::string::npos) {
+      // keep tail, delimiter can be split between reads
+      scan_pos_ = end_ - begin_ >= HEADERS_END_LEN ? end_ - HEADERS_END_LEN + 1 : begin_;
+      return false;
+    }
+
+    headers_size_ = headers_end + HEADERS_END_LEN - begin_;
+    body_size_ = ParseContentLength(buffer_.data() + begin_, headers_size_, max_request_size);
+  }
+
+  const size_t request_size = headers_size_ + body_size_;
+  if (request_size > max_request_size || GetPendingSize() < request_size) {  // IsOverflow tells the first
+    return false;
+  }
+
+  request_.assign(buffer_.data() + begin_, request_size);
+  begin_ += request_size;
+  scan_pos_ = begin_;
+  headers_size_ = 0;
+  body_size_ = 0;
+  return true;
+}
+
+const std::string& HttpRequestReader::GetRequest() const {
+  return request_;
+}
+
+bool HttpRequestReader::IsOverflow() const {
+  if (headers_size_) {
+    return headers_size_ + body_size_ > max_request_size;
+  }
+  return GetPendingSize() > max_request_size;
+}
+
+size_t HttpRequestReader::GetPendingSize() const {
+  return end_ - begin_;
+}
+
+size_t HttpRequestReader::FindHeadersEnd() const {
+  const size_t from = scan_pos_ > begin_ ? scan_pos_ : begin_;
+  if (end_ < from + HEADERS_END_LEN) {
+    return std::string::npos;
+  }
+
+  const char* data = buffer_.data();
+  for (size_t i = from; i + HEADERS_END_LEN <= end_; ++i) {
+    if (data[i] == '\r' && memcmp(data + i, HEADERS_END, HEADERS_END_LEN) == 0) {
+      return i;
+    }
+  }
+  return std::string::npos;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,58 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Per connection incremental framing of http requests, handles requests split between reads
+// and several pipelined requests in one read, buffers are reused for whole connection life.
+class HttpRequestReader {
+ public:
+  enum { read_chunk_size = 4096, max_request_size = 64 * 1024 };
+
+  HttpRequestReader();
+
+  // free space for next read, size at least read_chunk_size
+  char* PrepareRead(size_t* size);
+  void CommitRead(size_t size);
+
+  // true if next full request available via GetRequest
+  bool NextRequest();
+  const std::string& GetRequest() const;
+
+  // incomplete request exceeds max_request_size
+  bool IsOverflow() const;
+
+ private:
+  size_t GetPendingSize() const;
+  size_t FindHeadersEnd() const;
+
+  std::vector<char> buffer_;
+  size_t begin_;  // first not consumed byte
+  size_t end_;    // end of received data
+  size_t scan_pos_;
+  size_t headers_size_;  // 0 while headers incomplete
+  size_t body_size_;
+  std::string request_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -26,6 +26,8 @@ class IHttpRequestsObserver {
   typedef common::file_system::ascii_file_string_path file_path_t;
 
   virtual void OnHttpRequest(common::libev::http::HttpClient* client, const file_path_t& file) = 0;
+  // missing file will be written soon, called from serving loops
+  virtual bool IsGeneratedOnDemand(const file_path_t& file) = 0;
   virtual ~IHttpRequestsObserver();
 };
 
@@ -14,32 +14,45 @@
 
 #include "server/base/iserver_handler.h"
 
+#include <common/libev/io_client.h>
+
+#include "server/base/workers_pool.h"
+
 namespace fastocloud {
 namespace server {
 namespace base {
 
-IServerHandler::IServerHandler() : online_clients_(0) {}
+IServerHandler::IServerHandler() : online_clients_(0), workers_(nullptr) {}
 
 size_t IServerHandler::GetOnlineClients() const {
   return online_clients_;
 }
 
+void IServerHandler::SetWorkersPool(WorkersPool* workers) {
+  workers_ = workers;
+}
+
 void IServerHandler::PreLooped(common::libev::IoLoop* server) {
   UNUSED(server);
 }
 
 void IServerHandler::Accepted(common::libev::IoClient* client) {
-  UNUSED(client);
   online_clients_++;
+  if (workers_) {
+    workers_->Dispatch(client);
+  }
 }
 
 void IServerHandler::Moved(common::libev::IoLoop* server, common::libev::IoClient* client) {
   UNUSED(server);
   UNUSED(client);
+  online_clients_--;
 }
 
 void IServerHandler::Closed(common::libev::IoClient* client) {
-  UNUSED(client);
+  if (workers_ && !workers_->IsWorkerLoop(client->GetServer())) {
+    workers_->Forget(client);
+  }
   online_clients_--;
 }
 
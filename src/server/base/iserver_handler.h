@@ -20,12 +20,15 @@ namespace fastocloud {
 namespace server {
 namespace base {
 
+class WorkersPool;
+
 class IServerHandler : public common::libev::IoLoopObserver {
  public:
   typedef std::atomic<size_t> online_clients_t;
   IServerHandler();
 
   size_t GetOnlineClients() const;
+  void SetWorkersPool(WorkersPool* workers);
 
   void PreLooped(common::libev::IoLoop* server) override;
 
@@ -44,6 +47,7 @@ class IServerHandler : public common::libev::IoLoopObserver {
 
  private:
   online_clients_t online_clients_;
+  WorkersPool* workers_;
 };
 
 }  // namespace base
@@ -0,0 +1,141 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/workers_pool.h"
+
+#include <common/libev/io_client.h>
+#include <common/sprintf.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+namespace {
+
+class WorkerLoop : public common::libev::IoLoop {
+ public:
+  typedef common::libev::IoLoop base_class;
+  explicit WorkerLoop(common::libev::IoLoopObserver* observer) : base_class(new common::libev::LibEvLoop, observer) {}
+
+  const char* ClassName() const override { return "WorkerLoop"; }
+
+  common::libev::IoChild* CreateChild() override {
+    NOTREACHED();
+    return nullptr;
+  }
+
+  common::libev::IoClient* CreateClient(const common::net::socket_info& info) override {
+    UNUSED(info);
+    NOTREACHED();
+    return nullptr;
+  }
+};
+
+}  // namespace
+
+WorkersPool::WorkersPool(size_t workers_count, common::libev::IoLoopObserver* observer, const std::string& name)
+    : workers_(), threads_(), next_(0), pending_() {
+  for (size_t i = 0; i < workers_count; ++i) {
+    common::libev::IoLoop* worker = new WorkerLoop(observer);
+    worker->SetName(common::MemSPrintf("%s_worker_%lu", name, i));
+    workers_.push_back(worker);
+  }
+}
+
+WorkersPool::~WorkersPool() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    delete workers_[i];
+  }
+  workers_.clear();
+}
+
+size_t WorkersPool::GetWorkersCount() const {
+  return workers_.size();
+}
+
+bool WorkersPool::IsWorkerLoop(const common::libev::IoLoop* loop) const {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i] == loop) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkersPool::Start() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    common::libev::IoLoop* worker = workers_[i];
+    threads_.push_back(std::thread([worker] {
+      int res = worker->Exec();
+      UNUSED(res);
+    }));
+  }
+}
+
+void WorkersPool::Stop() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Stop();
+  }
+}
+
+void WorkersPool::Join() {
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i].join();
+  }
+  threads_.clear();
+}
+
+bool WorkersPool::Dispatch(common::libev::IoClient* client) {
+  if (workers_.empty()) {
+    return false;
+  }
+
+  common::libev::IoLoop* listener = client->GetServer();
+  if (!listener || IsWorkerLoop(listener)) {
+    return false;
+  }
+
+  // slot 0 is listener itself
+  const size_t slot = next_++ % (workers_.size() + 1);
+  if (slot == 0) {
+    return false;
+  }
+
+  common::libev::IoLoop* worker = workers_[slot - 1];
+  pending_.insert(client);
+  // ExecInLoopThread of listener from its own thread runs at once, so post through the worker thread,
+  // then the move runs on listener after it finished registering the client
+  worker->ExecInLoopThread([this, listener, worker, client]() {
+    listener->ExecInLoopThread([this, listener, worker, client]() { Move(listener, worker, client); });
+  });
+  return true;
+}
+
+void WorkersPool::Forget(common::libev::IoClient* client) {
+  pending_.erase(client);
+}
+
+void WorkersPool::Move(common::libev::IoLoop* listener,
+                       common::libev::IoLoop* worker,
+                       common::libev::IoClient* client) {
+  if (pending_.erase(client) == 0) {  // closed meanwhile
+    return;
+  }
+
+  listener->UnRegisterClient(client);
+  worker->ExecInLoopThread([worker, client]() { worker->RegisterClient(client); });
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
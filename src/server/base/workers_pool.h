@@ -0,0 +1,59 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <common/libev/io_loop.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Extra serving loops for a listening http server, the listener keeps one share of clients
+// and hands the rest round-robin to the workers, every loop reports into the same observer.
+class WorkersPool {
+ public:
+  WorkersPool(size_t workers_count, common::libev::IoLoopObserver* observer, const std::string& name);
+  ~WorkersPool();
+
+  size_t GetWorkersCount() const;
+  bool IsWorkerLoop(const common::libev::IoLoop* loop) const;
+
+  void Start();
+  void Stop();
+  void Join();
+
+  // should be called from listener loop thread, returns true if client will be moved into a worker,
+  // move is posted and happens after listener finished handling accept of the client
+  bool Dispatch(common::libev::IoClient* client);
+  // listener loop thread, client closed before posted move happened
+  void Forget(common::libev::IoClient* client);
+
+ private:
+  void Move(common::libev::IoLoop* listener, common::libev::IoLoop* worker, common::libev::IoClient* client);
+
+  std::vector<common::libev::IoLoop*> workers_;
+  std::vector<std::thread> threads_;
+  size_t next_;
+  std::set<common::libev::IoClient*> pending_;  // listener loop thread only
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
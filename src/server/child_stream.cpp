@@ -14,14 +14,69 @@
 
 #include "server/child_stream.h"
 
+#include <common/time.h>
+
 namespace fastocloud {
 namespace server {
 
-ChildStream::ChildStream(common::libev::IoLoop* server, const stream_id_t& id) : base_class(server), id_(id) {}
+ChildStream::ChildStream(common::libev::IoLoop* server, const stream_id_t& id, SharedStreamStats* shared_stats)
+    : base_class(server),
+      id_(id),
+      shared_stats_(shared_stats),
+      last_sequence_(0),
+      spawn_time_(common::time::current_utc_mstime()),
+      playing_reported_(false),
+      startup_timing_(),
+      startup_trace_path_() {}
+
+ChildStream::~ChildStream() {
+  SharedStreamStats::Destroy(&shared_stats_);
+}
 
 stream_id_t ChildStream::GetStreamID() const {
   return id_;
 }
 
+bool ChildStream::ReadChangedStatistic(StatisticInfo* statistic) {
+  if (!shared_stats_ || !statistic) {
+    return false;
+  }
+
+  StreamStruct stats;
+  stats.id = id_;
+  StatisticInfo::cpu_load_t cpu_load = 0;
+  StatisticInfo::rss_t rss = 0;
+  fastotv::timestamp_t timestamp = 0;
+  SharedStreamStats::sequence_t sequence = 0;
+  if (!shared_stats_->Read(&stats, &cpu_load, &rss, &timestamp, &sequence) || sequence == last_sequence_) {
+    return false;
+  }
+
+  last_sequence_ = sequence;
+  if (!playing_reported_ && stats.status == PLAYING) {
+    playing_reported_ = true;
+    INFO_LOG() << "Stream id: " << id_ << " playing in " << common::time::current_utc_mstime() - spawn_time_
+               << " msec after fork";
+  }
+  *statistic = StatisticInfo(stats, cpu_load, rss, timestamp);
+  return true;
+}
+
+void ChildStream::SetStartupTiming(const StartupTiming& timing) {
+  startup_timing_ = timing;
+}
+
+StartupTiming ChildStream::GetStartupTiming() const {
+  return startup_timing_;
+}
+
+void ChildStream::SetStartupTracePath(const std::string& path) {
+  startup_trace_path_ = path;
+}
+
+std::string ChildStream::GetStartupTracePath() const {
+  return startup_trace_path_;
+}
+
 }  // namespace server
 }  // namespace fastocloud
@@ -14,20 +14,43 @@
 
 #pragma once
 
+#include <string>
+
+#include "base/shared_stream_stats.h"
+#include "base/startup_timing.h"
+
 #include "server/child.h"
 
+#include "stream_commands/commands_info/statistic_info.h"
+
 namespace fastocloud {
 namespace server {
 
 class ChildStream : public Child {
  public:
   typedef Child base_class;
-  ChildStream(common::libev::IoLoop* server, const stream_id_t& id);
+  ChildStream(common::libev::IoLoop* server, const stream_id_t& id, SharedStreamStats* shared_stats);
+  ~ChildStream() override;
 
   stream_id_t GetStreamID() const override;
 
+  // true if stream published statistic since previous call
+  bool ReadChangedStatistic(StatisticInfo* statistic);
+
+  // service side phases of first start, stream reports the rest
+  void SetStartupTiming(const StartupTiming& timing);
+  StartupTiming GetStartupTiming() const;
+  void SetStartupTracePath(const std::string& path);  // empty if trace export disabled
+  std::string GetStartupTracePath() const;
+
  private:
   const stream_id_t id_;
+  SharedStreamStats* shared_stats_;  // owned, nullptr if stream reports via pipe
+  SharedStreamStats::sequence_t last_sequence_;
+  const fastotv::timestamp_t spawn_time_;
+  bool playing_reported_;  // fork to PLAYING time logged
+  StartupTiming startup_timing_;
+  std::string startup_trace_path_;
   DISALLOW_COPY_AND_ASSIGN(ChildStream);
 };
 
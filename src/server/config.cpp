@@ -26,8 +26,17 @@
 #define SERVICE_HTTP_HOST_FIELD "http_host"
 #define SERVICE_VODS_HOST_FIELD "vods_host"
 #define SERVICE_CODS_HOST_FIELD "cods_host"
+#define SERVICE_HTTP_WORKERS_FIELD "http_workers"
+#define SERVICE_HTTP_CACHE_SIZE_FIELD "http_cache_size"
+#define SERVICE_HTTP_CACHE_SEGMENTS_FIELD "http_cache_segments"
 #define SERVICE_TTL_FILES_FIELD "ttl_files"
+#define SERVICE_CODS_WAIT_TIMEOUT_FIELD "cods_wait_timeout"
+#define SERVICE_VODS_JIT_PREFETCH_FIELD "vods_jit_prefetch"
+#define SERVICE_VODS_JIT_CACHE_SIZE_FIELD "vods_jit_cache_size"
+#define SERVICE_VODS_JIT_WAIT_TIMEOUT_FIELD "vods_jit_wait_timeout"
 #define SERVICE_STREAMLINK_PATH "streamlink_path"
+#define SERVICE_ZYGOTE_FIELD "zygote"
+#define SERVICE_CPU_PLACEMENT_FIELD "cpu_placement"
 
 #define DUMMY_LOG_FILE_PATH "/dev/null"
 
@@ -73,13 +82,43 @@ common::ErrnoError ReadConfigFile(const std::string& path, common::HashValue** a
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
     } else if (pair.first == SERVICE_CODS_HOST_FIELD) {
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
+    } else if (pair.first == SERVICE_HTTP_WORKERS_FIELD) {
+      int workers;
+      if (common::ConvertFromString(pair.second, &workers)) {
+        options->Insert(pair.first, common::Value::CreateIntegerValue(workers));
+      }
+    } else if (pair.first == SERVICE_HTTP_CACHE_SIZE_FIELD) {
+      int cache_size;
+      if (common::ConvertFromString(pair.second, &cache_size)) {
+        options->Insert(pair.first, common::Value::CreateIntegerValue(cache_size));
+      }
+    } else if (pair.first == SERVICE_HTTP_CACHE_SEGMENTS_FIELD) {
+      int cache_segments;
+      if (common::ConvertFromString(pair.second, &cache_segments)) {
+        options->Insert(pair.first, common::Value::CreateIntegerValue(cache_segments));
+      }
     } else if (pair.first == SERVICE_TTL_FILES_FIELD) {
       time_t ttl;
       if (common::ConvertFromString(pair.second, &ttl)) {
         options->Insert(pair.first, common::Value::CreateTimeValue(ttl));
       }
+    } else if (pair.first == SERVICE_CODS_WAIT_TIMEOUT_FIELD) {
+      time_t timeout;
+      if (common::ConvertFromString(pair.second, &timeout)) {
+        options->Insert(pair.first, common::Value::CreateTimeValue(timeout));
+      }
     } else if (pair.first == SERVICE_STREAMLINK_PATH) {
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
+    } else if (pair.first == SERVICE_ZYGOTE_FIELD) {
+      bool zygote;
+      if (common::ConvertFromString(pair.second, &zygote)) {
+        options->Insert(pair.first, common::Value::CreateBooleanValue(zygote));
+      }
+    } else if (pair.first == SERVICE_CPU_PLACEMENT_FIELD) {
+      bool cpu_placement;
+      if (common::ConvertFromString(pair.second, &cpu_placement)) {
+        options->Insert(pair.first, common::Value::CreateBooleanValue(cpu_placement));
+      }
     }
   }
 
@@ -96,8 +135,17 @@ Config::Config()
     : host(GetDefaultHost()),
       log_path(DUMMY_LOG_FILE_PATH),
       log_level(common::logging::LOG_LEVEL_INFO),
+      http_workers(HTTP_WORKERS),
+      http_cache_size(HTTP_CACHE_SIZE),
+      http_cache_segments(HTTP_CACHE_SEGMENTS),
       ttl_files(TTL_FILES),
-      streamlink_path(STREAMER_SERVICE_STREAMLINK_PATH) {}
+      cods_wait_timeout(CODS_WAIT_TIMEOUT),
+      vods_jit_prefetch(VODS_JIT_PREFETCH),
+      vods_jit_cache_size(VODS_JIT_CACHE_SIZE),
+      vods_jit_wait_timeout(VODS_JIT_WAIT_TIMEOUT),
+      streamlink_path(STREAMER_SERVICE_STREAMLINK_PATH),
+      zygote(false),
+      cpu_placement(false) {}
 
 common::net::HostAndPort Config::GetDefaultHost() {
   return common::net::HostAndPort::CreateLocalHost(CLIENT_PORT);
@@ -157,16 +205,78 @@ common::ErrnoError load_config_from_file(const std::string& config_absolute_path
     lconfig.cods_host = common::net::HostAndPort::CreateLocalHost(CODS_PORT);
   }
 
+  common::Value* http_workers_field = slave_config_args->Find(SERVICE_HTTP_WORKERS_FIELD);
+  int http_workers;
+  if (http_workers_field && http_workers_field->GetAsInteger(&http_workers) && http_workers > 0) {
+    lconfig.http_workers = http_workers;
+  } else {
+    lconfig.http_workers = HTTP_WORKERS;
+  }
+
+  common::Value* http_cache_size_field = slave_config_args->Find(SERVICE_HTTP_CACHE_SIZE_FIELD);
+  int http_cache_size;
+  if (http_cache_size_field && http_cache_size_field->GetAsInteger(&http_cache_size) && http_cache_size >= 0) {
+    lconfig.http_cache_size = http_cache_size;
+  } else {
+    lconfig.http_cache_size = HTTP_CACHE_SIZE;
+  }
+
+  common::Value* http_cache_segments_field = slave_config_args->Find(SERVICE_HTTP_CACHE_SEGMENTS_FIELD);
+  int http_cache_segments;
+  if (http_cache_segments_field && http_cache_segments_field->GetAsInteger(&http_cache_segments) &&
+      http_cache_segments > 0) {
+    lconfig.http_cache_segments = http_cache_segments;
+  } else {
+    lconfig.http_cache_segments = HTTP_CACHE_SEGMENTS;
+  }
+
   common::Value* ttl_field = slave_config_args->Find(SERVICE_TTL_FILES_FIELD);
   if (!ttl_field || !ttl_field->GetAsTime(&lconfig.ttl_files)) {
     lconfig.ttl_files = TTL_FILES;
   }
 
+  common::Value* cods_wait_timeout_field = slave_config_args->Find(SERVICE_CODS_WAIT_TIMEOUT_FIELD);
+  if (!cods_wait_timeout_field || !cods_wait_timeout_field->GetAsTime(&lconfig.cods_wait_timeout)) {
+    lconfig.cods_wait_timeout = CODS_WAIT_TIMEOUT;
+  }
+
+  common::Value* vods_jit_prefetch_field = slave_config_args->Find(SERVICE_VODS_JIT_PREFETCH_FIELD);
+  int vods_jit_prefetch;
+  if (vods_jit_prefetch_field && vods_jit_prefetch_field->GetAsInteger(&vods_jit_prefetch) && vods_jit_prefetch >= 0) {
+    lconfig.vods_jit_prefetch = vods_jit_prefetch;
+  } else {
+    lconfig.vods_jit_prefetch = VODS_JIT_PREFETCH;
+  }
+
+  common::Value* vods_jit_cache_size_field = slave_config_args->Find(SERVICE_VODS_JIT_CACHE_SIZE_FIELD);
+  int vods_jit_cache_size;
+  if (vods_jit_cache_size_field && vods_jit_cache_size_field->GetAsInteger(&vods_jit_cache_size) &&
+      vods_jit_cache_size > 0) {
+    lconfig.vods_jit_cache_size = vods_jit_cache_size;
+  } else {
+    lconfig.vods_jit_cache_size = VODS_JIT_CACHE_SIZE;
+  }
+
+  common::Value* vods_jit_wait_timeout_field = slave_config_args->Find(SERVICE_VODS_JIT_WAIT_TIMEOUT_FIELD);
+  if (!vods_jit_wait_timeout_field || !vods_jit_wait_timeout_field->GetAsTime(&lconfig.vods_jit_wait_timeout)) {
+    lconfig.vods_jit_wait_timeout = VODS_JIT_WAIT_TIMEOUT;
+  }
+
   common::Value* streamlink_field = slave_config_args->Find(SERVICE_STREAMLINK_PATH);
   if (!streamlink_field || !streamlink_field->GetAsBasicString(&lconfig.streamlink_path)) {
     lconfig.streamlink_path = STREAMER_SERVICE_STREAMLINK_PATH;
   }
 
+  common::Value* zygote_field = slave_config_args->Find(SERVICE_ZYGOTE_FIELD);
+  if (!zygote_field || !zygote_field->GetAsBoolean(&lconfig.zygote)) {
+    lconfig.zygote = false;
+  }
+
+  common::Value* cpu_placement_field = slave_config_args->Find(SERVICE_CPU_PLACEMENT_FIELD);
+  if (!cpu_placement_field || !cpu_placement_field->GetAsBoolean(&lconfig.cpu_placement)) {
+    lconfig.cpu_placement = false;
+  }
+
   *config = lconfig;
   delete slave_config_args;
   return common::ErrnoError();
@@ -33,8 +33,17 @@ struct Config {
   common::net::HostAndPort http_host;
   common::net::HostAndPort vods_host;
   common::net::HostAndPort cods_host;
-  time_t ttl_files;  // in seconds
+  size_t http_workers;           // serving loops per http/vods/cods server
+  size_t http_cache_size;        // in megabytes, 0 disables hls cache
+  size_t http_cache_segments;    // last segments of every channel kept in hls cache
+  time_t ttl_files;              // in seconds
+  time_t cods_wait_timeout;      // in seconds
+  size_t vods_jit_prefetch;      // segments of just in time vods encoded ahead of player
+  size_t vods_jit_cache_size;    // in megabytes, generated segments on disk
+  time_t vods_jit_wait_timeout;  // in seconds
   std::string streamlink_path;
+  bool zygote;         // fork streams from pre-initialized helper
+  bool cpu_placement;  // pin streams to cores/NUMA nodes and rebalance them
 };
 
 common::ErrnoError load_config_from_file(const std::string& config_absolute_path, Config* config) WARN_UNUSED_RESULT;
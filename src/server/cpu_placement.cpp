@@ -0,0 +1,525 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/cpu_placement.h"
+
+#if defined(OS_LINUX)
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include <common/sprintf.h>
+
+#define NODES_ONLINE_PATH "/sys/devices/system/node/online"
+#define NODE_CPULIST_PATH_1I "/sys/devices/system/node/node%d/cpulist"
+#define PROCESS_TASKS_PATH_1I "/proc/%d/task"
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+bool ReadFirstLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  return static_cast<bool>(std::getline(file, *line));
+}
+
+bool ParseCpuNumber(const std::string& str, int* number) {
+  if (str.empty()) {
+    return false;
+  }
+
+  char* end = nullptr;
+  const long value = strtol(str.c_str(), &end, 10);
+  if (*end != 0 || value < 0) {
+    return false;
+  }
+  *number = static_cast<int>(value);
+  return true;
+}
+
+std::string Trim(const std::string& str) {
+  const size_t first = str.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  const size_t last = str.find_last_not_of(" \t\r\n");
+  return str.substr(first, last - first + 1);
+}
+
+}  // namespace
+
+const double CpuPlacement::heavy_load_cores = 1.0;
+const double CpuPlacement::rebalance_threshold_cores = 0.5;
+
+CpuPlacement::CpuPlacement(const topology_t& topology) : topology_(topology), entries_() {}
+
+CpuPlacement::topology_t CpuPlacement::DetectTopology() {
+  cpus_t allowed;
+#if defined(OS_LINUX)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+      if (CPU_ISSET(i, &set)) {
+        allowed.push_back(i);
+      }
+    }
+  }
+#endif
+  if (allowed.empty()) {
+    return topology_t();
+  }
+
+  topology_t topology;
+  std::string online;
+  cpus_t nodes;
+  if (ReadFirstLine(NODES_ONLINE_PATH, &online) && ParseCpuList(online, &nodes)) {
+    for (int node : nodes) {
+      std::string cpulist;
+      cpus_t node_cpus;
+      if (!ReadFirstLine(common::MemSPrintf(NODE_CPULIST_PATH_1I, node), &cpulist) ||
+          !ParseCpuList(cpulist, &node_cpus)) {
+        continue;
+      }
+
+      Node usable = {node, cpus_t()};
+      for (int cpu : node_cpus) {
+        if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+          usable.cpus.push_back(cpu);
+        }
+      }
+      if (!usable.cpus.empty()) {
+        topology.push_back(usable);
+      }
+    }
+  }
+
+  if (topology.empty()) {
+    Node single = {0, allowed};
+    topology.push_back(single);
+  }
+  return topology;
+}
+
+bool CpuPlacement::ParseCpuList(const std::string& list, cpus_t* cpus) {
+  if (!cpus) {
+    return false;
+  }
+
+  cpus_t result;
+  const std::string trimmed = Trim(list);
+  size_t start = 0;
+  while (start <= trimmed.size()) {
+    size_t end = trimmed.find(',', start);
+    if (end == std::string::npos) {
+      end = trimmed.size();
+    }
+
+    const std::string range = Trim(trimmed.substr(start, end - start));
+    const size_t dash = range.find('-');
+    int first = 0;
+    int last = 0;
+    if (dash == std::string::npos) {
+      if (!ParseCpuNumber(range, &first)) {
+        return false;
+      }
+      last = first;
+    } else if (!ParseCpuNumber(range.substr(0, dash), &first) || !ParseCpuNumber(range.substr(dash + 1), &last) ||
+               last < first) {
+      return false;
+    }
+
+    for (int cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+    start = end + 1;
+  }
+
+  *cpus = result;
+  return !result.empty();
+}
+
+std::string CpuPlacement::MakeCpuList(const cpus_t& cpus) {
+  std::string list;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+
+    if (!list.empty()) {
+      list += ",";
+    }
+    list += j == i ? common::MemSPrintf("%d", cpus[i]) : common::MemSPrintf("%d-%d", cpus[i], cpus[j]);
+    i = j + 1;
+  }
+  return list;
+}
+
+bool CpuPlacement::Place(const stream_id_t& sid, pid_t pid, StreamType type) {
+  size_t total_cpus = 0;
+  for (const Node& node : topology_) {
+    total_cpus += node.cpus.size();
+  }
+  if (total_cpus < 2) {
+    return false;
+  }
+
+  entries_.erase(sid);
+  Entry entry = {pid, type, 0, cpus_t(), EstimateLoad(type)};
+  const size_t node = FindLeastLoadedNode();
+  auto it = entries_.insert(std::make_pair(sid, entry)).first;
+  Assign(sid, &it->second, node);
+
+  if (pid > 0) {
+    ApplyAffinity(pid, it->second.cpus);
+    MigrateMemory(pid, node);
+  }
+  INFO_LOG() << "Stream id: " << sid << " placed on node: " << topology_[node].id
+             << ", cpus: " << MakeCpuList(it->second.cpus);
+  return true;
+}
+
+void CpuPlacement::UpdateLoad(const stream_id_t& sid, double cores) {
+  auto it = entries_.find(sid);
+  if (it == entries_.end()) {
+    return;
+  }
+
+  it->second.load = cores;
+}
+
+void CpuPlacement::Remove(const stream_id_t& sid) {
+  entries_.erase(sid);
+}
+
+bool CpuPlacement::Rebalance() {
+  return RebalanceClasses() || RebalanceNodes() || RebalanceCpus();
+}
+
+bool CpuPlacement::GetStreamCpus(const stream_id_t& sid, cpus_t* cpus, int* node) const {
+  auto it = entries_.find(sid);
+  if (it == entries_.end() || !cpus || !node) {
+    return false;
+  }
+
+  *cpus = it->second.cpus;
+  *node = topology_[it->second.node].id;
+  return true;
+}
+
+service::PlacementInfo CpuPlacement::MakePlacementInfo() const {
+  service::PlacementInfo::nodes_t nodes;
+  for (size_t i = 0; i < topology_.size(); ++i) {
+    nodes.push_back(service::NodePlacement(topology_[i].id, MakeCpuList(topology_[i].cpus), GetNodeLoad(i)));
+  }
+
+  service::PlacementInfo::streams_t streams;
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    const Entry& entry = it->second;
+    streams.push_back(
+        service::StreamPlacement(it->first, topology_[entry.node].id, MakeCpuList(entry.cpus), entry.load));
+  }
+  return service::PlacementInfo(nodes, streams);
+}
+
+double CpuPlacement::EstimateLoad(StreamType type) {
+  if (type == ENCODE || type == VOD_ENCODE || type == COD_ENCODE) {
+    return 2.0;
+  }
+  if (type == TIMESHIFT_RECORDER || type == CATCHUP) {
+    return 0.2;
+  }
+  return 0.1;
+}
+
+bool CpuPlacement::IsHeavy(const Entry& entry) {
+  if (entry.type == ENCODE || entry.type == VOD_ENCODE || entry.type == COD_ENCODE) {
+    return true;
+  }
+  return entry.load >= heavy_load_cores;
+}
+
+double CpuPlacement::GetNodeLoad(size_t node) const {
+  double load = 0;
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->second.node == node) {
+      load += it->second.load;
+    }
+  }
+  return load;
+}
+
+double CpuPlacement::GetCpuLoad(size_t node, int cpu) const {
+  double load = 0;
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    const Entry& entry = it->second;
+    if (entry.node != node || entry.cpus.empty()) {
+      continue;
+    }
+
+    if (std::find(entry.cpus.begin(), entry.cpus.end(), cpu) != entry.cpus.end()) {
+      load += entry.load / entry.cpus.size();  // node wide streams spread over all node cpus
+    }
+  }
+  return load;
+}
+
+size_t CpuPlacement::FindLeastLoadedNode() const {
+  size_t best = 0;
+  double best_load = 0;
+  for (size_t i = 0; i < topology_.size(); ++i) {
+    const double load = GetNodeLoad(i) / topology_[i].cpus.size();
+    if (i == 0 || load < best_load) {
+      best = i;
+      best_load = load;
+    }
+  }
+  return best;
+}
+
+int CpuPlacement::FindLeastLoadedCpu(size_t node, const stream_id_t& skip) const {
+  const cpus_t& cpus = topology_[node].cpus;
+  auto skipped = entries_.find(skip);
+  int best = cpus[0];
+  double best_load = 0;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    double load = GetCpuLoad(node, cpus[i]);
+    if (skipped != entries_.end() && skipped->second.node == node && skipped->second.cpus == cpus_t(1, cpus[i])) {
+      load -= skipped->second.load;  // own load does not count against current cpu
+    }
+    if (i == 0 || load < best_load) {
+      best = cpus[i];
+      best_load = load;
+    }
+  }
+  return best;
+}
+
+void CpuPlacement::Assign(const stream_id_t& sid, Entry* entry, size_t node) {
+  if (IsHeavy(*entry)) {
+    entry->node = node;
+    entry->cpus = topology_[node].cpus;
+    return;
+  }
+
+  const int cpu = FindLeastLoadedCpu(node, sid);
+  entry->node = node;
+  entry->cpus = cpus_t(1, cpu);
+}
+
+void CpuPlacement::Move(const stream_id_t& sid, Entry* entry, size_t node) {
+  const size_t prev_node = entry->node;
+  Assign(sid, entry, node);
+  if (entry->pid > 0) {
+    ApplyAffinity(entry->pid, entry->cpus);
+    if (prev_node != node) {
+      MigrateMemory(entry->pid, node);
+    }
+  }
+  INFO_LOG() << "Stream id: " << sid << " moved to node: " << topology_[node].id
+             << ", cpus: " << MakeCpuList(entry->cpus) << ", load: " << entry->load;
+}
+
+bool CpuPlacement::RebalanceClasses() {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    Entry* entry = &it->second;
+    const cpus_t& node_cpus = topology_[entry->node].cpus;
+    if (node_cpus.size() < 2) {
+      continue;
+    }
+
+    const bool node_wide = entry->cpus == node_cpus;
+    if (IsHeavy(*entry) != node_wide) {
+      Move(it->first, entry, entry->node);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CpuPlacement::RebalanceNodes() {
+  if (topology_.size() < 2) {
+    return false;
+  }
+
+  size_t busiest = 0;
+  size_t idlest = 0;
+  for (size_t i = 1; i < topology_.size(); ++i) {
+    if (GetNodeLoad(i) / topology_[i].cpus.size() > GetNodeLoad(busiest) / topology_[busiest].cpus.size()) {
+      busiest = i;
+    }
+    if (GetNodeLoad(i) / topology_[i].cpus.size() < GetNodeLoad(idlest) / topology_[idlest].cpus.size()) {
+      idlest = i;
+    }
+  }
+
+  const double busiest_load = GetNodeLoad(busiest);
+  const double idlest_load = GetNodeLoad(idlest);
+  if (busiest == idlest || busiest_load - idlest_load < rebalance_threshold_cores) {
+    return false;
+  }
+
+  const double busiest_cpus = topology_[busiest].cpus.size();
+  const double idlest_cpus = topology_[idlest].cpus.size();
+  double best_imbalance = std::fabs(busiest_load / busiest_cpus - idlest_load / idlest_cpus);
+  auto best = entries_.end();
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    const Entry& entry = it->second;
+    if (entry.node != busiest) {
+      continue;
+    }
+
+    const double imbalance =
+        std::fabs((busiest_load - entry.load) / busiest_cpus - (idlest_load + entry.load) / idlest_cpus);
+    if (imbalance < best_imbalance) {
+      best_imbalance = imbalance;
+      best = it;
+    }
+  }
+
+  if (best == entries_.end()) {
+    return false;
+  }
+
+  Move(best->first, &best->second, idlest);
+  return true;
+}
+
+bool CpuPlacement::RebalanceCpus() {
+  for (size_t node = 0; node < topology_.size(); ++node) {
+    const cpus_t& cpus = topology_[node].cpus;
+    if (cpus.size() < 2) {
+      continue;
+    }
+
+    int busiest = cpus[0];
+    int idlest = cpus[0];
+    for (int cpu : cpus) {
+      if (GetCpuLoad(node, cpu) > GetCpuLoad(node, busiest)) {
+        busiest = cpu;
+      }
+      if (GetCpuLoad(node, cpu) < GetCpuLoad(node, idlest)) {
+        idlest = cpu;
+      }
+    }
+
+    const double busiest_load = GetCpuLoad(node, busiest);
+    const double idlest_load = GetCpuLoad(node, idlest);
+    if (busiest_load - idlest_load < rebalance_threshold_cores) {
+      continue;
+    }
+
+    double best_imbalance = busiest_load - idlest_load;
+    auto best = entries_.end();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      const Entry& entry = it->second;
+      if (entry.node != node || entry.cpus.size() != 1 || entry.cpus[0] != busiest) {
+        continue;
+      }
+
+      const double imbalance = std::fabs((busiest_load - entry.load) - (idlest_load + entry.load));
+      if (imbalance < best_imbalance) {
+        best_imbalance = imbalance;
+        best = it;
+      }
+    }
+
+    if (best != entries_.end()) {
+      Move(best->first, &best->second, node);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CpuPlacement::ApplyAffinity(pid_t pid, const cpus_t& cpus) {
+#if defined(OS_LINUX)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+
+  // affinity is per thread, threads started later inherit it from their creator
+  DIR* tasks = opendir(common::MemSPrintf(PROCESS_TASKS_PATH_1I, pid).c_str());
+  if (!tasks) {
+    if (sched_setaffinity(pid, sizeof(set), &set) != 0) {
+      WARNING_LOG() << "Can't set affinity of pid: " << pid << ", errno: " << errno;
+    }
+    return;
+  }
+
+  while (struct dirent* task = readdir(tasks)) {
+    int tid = 0;
+    if (!ParseCpuNumber(task->d_name, &tid)) {
+      continue;
+    }
+    if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+      WARNING_LOG() << "Can't set affinity of thread: " << tid << ", pid: " << pid << ", errno: " << errno;
+    }
+  }
+  closedir(tasks);
+#else
+  UNUSED(pid);
+  UNUSED(cpus);
+#endif
+}
+
+void CpuPlacement::MigrateMemory(pid_t pid, size_t to_node) const {
+#if defined(OS_LINUX) && defined(SYS_migrate_pages)
+  if (topology_.size() < 2) {
+    return;
+  }
+
+  const size_t bits = sizeof(unsigned long) * 8;
+  int max_node = 0;
+  for (const Node& node : topology_) {
+    max_node = std::max(max_node, node.id);
+  }
+
+  std::vector<unsigned long> from_mask(max_node / bits + 1, 0);
+  std::vector<unsigned long> to_mask(max_node / bits + 1, 0);
+  for (size_t i = 0; i < topology_.size(); ++i) {
+    const int id = topology_[i].id;
+    std::vector<unsigned long>& mask = i == to_node ? to_mask : from_mask;
+    mask[id / bits] |= 1UL << (id % bits);
+  }
+
+  // kernel treats maxnode as bits count plus one
+  const unsigned long maxnode = from_mask.size() * bits + 1;
+  if (syscall(SYS_migrate_pages, pid, maxnode, from_mask.data(), to_mask.data()) < 0) {
+    WARNING_LOG() << "Can't migrate memory of pid: " << pid << " to node: " << topology_[to_node].id
+                  << ", errno: " << errno;
+  }
+#else
+  UNUSED(pid);
+  UNUSED(to_node);
+#endif
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,98 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "base/types.h"
+
+#include "server/daemon/commands_info/service/placement_info.h"
+
+namespace fastocloud {
+namespace server {
+
+// Placement map of streams to cores and NUMA nodes. Encoding streams (or any stream measured above
+// heavy_load_cores) get all cpus of one node, light streams are packed on the least loaded single core.
+// Memory follows the node: allocations are local by first touch, pages are migrated when stream moves.
+// Loads are in cores (100% cpu usage of StatisticInfo is one core).
+class CpuPlacement {
+ public:
+  typedef std::vector<int> cpus_t;
+  struct Node {
+    int id;
+    cpus_t cpus;
+  };
+  typedef std::vector<Node> topology_t;
+
+  static const double heavy_load_cores;
+  static const double rebalance_threshold_cores;
+
+  explicit CpuPlacement(const topology_t& topology);
+
+  // online nodes from sysfs restricted to cpus the service may run on, one node if no NUMA info
+  static topology_t DetectTopology();
+  static bool ParseCpuList(const std::string& list, cpus_t* cpus);
+  static std::string MakeCpuList(const cpus_t& cpus);
+
+  // false if nothing to choose from (single cpu), pid <= 0 only records placement
+  bool Place(const stream_id_t& sid, pid_t pid, StreamType type);
+  void UpdateLoad(const stream_id_t& sid, double cores);
+  void Remove(const stream_id_t& sid);
+  // moves at most one stream, true if something moved
+  bool Rebalance();
+
+  bool GetStreamCpus(const stream_id_t& sid, cpus_t* cpus, int* node) const;
+  service::PlacementInfo MakePlacementInfo() const;
+
+ private:
+  struct Entry {
+    pid_t pid;
+    StreamType type;
+    size_t node;  // index in topology_
+    cpus_t cpus;
+    double load;
+  };
+  typedef std::map<stream_id_t, Entry> entries_t;
+
+  static double EstimateLoad(StreamType type);
+  static bool IsHeavy(const Entry& entry);
+
+  double GetNodeLoad(size_t node) const;
+  double GetCpuLoad(size_t node, int cpu) const;
+  size_t FindLeastLoadedNode() const;
+  int FindLeastLoadedCpu(size_t node, const stream_id_t& skip) const;
+  void Assign(const stream_id_t& sid, Entry* entry, size_t node);
+  void Move(const stream_id_t& sid, Entry* entry, size_t node);
+  bool RebalanceClasses();
+  bool RebalanceNodes();
+  bool RebalanceCpus();
+
+  static void ApplyAffinity(pid_t pid, const cpus_t& cpus);
+  void MigrateMemory(pid_t pid, size_t to_node) const;
+
+  const topology_t topology_;
+  entries_t entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CpuPlacement);
+};
+
+}  // namespace server
+}  // namespace fastocloud
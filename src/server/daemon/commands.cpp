@@ -47,6 +47,16 @@ common::Error StatisitcStreamBroadcast(const StatisticInfo& params, fastotv::pro
   return common::Error();
 }
 
+common::Error StatisitcStreamsBroadcast(fastotv::protocol::serializet_params_t params,
+                                        fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(STREAM_STATISTIC_STREAMS, params);
+  return common::Error();
+}
+
 common::Error StatisitcServiceBroadcast(fastotv::protocol::serializet_params_t params,
                                         fastotv::protocol::request_t* req) {
   if (!req) {
@@ -72,5 +82,35 @@ common::Error QuitStatusStreamBroadcast(const stream::QuitStatusInfo& params, fa
   return common::Error();
 }
 
+common::Error InputStallStreamBroadcast(const InputStallInfo& params, fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  std::string stall_json;
+  common::Error err_ser = params.SerializeToString(&stall_json);
+  if (err_ser) {
+    return err_ser;
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(STREAM_INPUT_STALL_STREAM, stall_json);
+  return common::Error();
+}
+
+common::Error StartupStreamBroadcast(const StartupInfo& params, fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  std::string startup_json;
+  common::Error err_ser = params.SerializeToString(&startup_json);
+  if (err_ser) {
+    return err_ser;
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(STREAM_STARTUP_STREAM, startup_json);
+  return common::Error();
+}
+
 }  // namespace server
 }  // namespace fastocloud
@@ -20,6 +20,8 @@
 
 #include "server/daemon/commands_info/stream/quit_status_info.h"
 #include "stream_commands/commands_info/changed_sources_info.h"
+#include "stream_commands/commands_info/input_stall_info.h"
+#include "stream_commands/commands_info/startup_info.h"
 #include "stream_commands/commands_info/statistic_info.h"
 
 // daemon
@@ -45,7 +47,10 @@
 // Broadcast
 #define STREAM_CHANGED_SOURCES_STREAM "changed_source_stream"
 #define STREAM_STATISTIC_STREAM "statistic_stream"
+#define STREAM_STATISTIC_STREAMS "statistic_streams"  // {"full": true, "streams": [{statistic_stream}, ...]}
 #define STREAM_QUIT_STATUS_STREAM "quit_status_stream"
+#define STREAM_INPUT_STALL_STREAM "input_stall_stream"
+#define STREAM_STARTUP_STREAM "startup_stream"  // per start and restart, phases in monotonic usec
 #define STREAM_STATISTIC_SERVICE "statistic_service"
 
 namespace fastocloud {
@@ -54,9 +59,13 @@ namespace server {
 // Broadcast
 common::Error ChangedSourcesStreamBroadcast(const ChangedSouresInfo& params, fastotv::protocol::request_t* req);
 common::Error StatisitcStreamBroadcast(const StatisticInfo& params, fastotv::protocol::request_t* req);
+common::Error StatisitcStreamsBroadcast(fastotv::protocol::serializet_params_t params,
+                                        fastotv::protocol::request_t* req);
 common::Error StatisitcServiceBroadcast(fastotv::protocol::serializet_params_t params,
                                         fastotv::protocol::request_t* req);
 common::Error QuitStatusStreamBroadcast(const stream::QuitStatusInfo& params, fastotv::protocol::request_t* req);
+common::Error InputStallStreamBroadcast(const InputStallInfo& params, fastotv::protocol::request_t* req);
+common::Error StartupStreamBroadcast(const StartupInfo& params, fastotv::protocol::request_t* req);
 
 }  // namespace server
 }  // namespace fastocloud
@@ -0,0 +1,128 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/daemon/commands_info/service/placement_info.h"
+
+#define PLACEMENT_INFO_NODES_FIELD "nodes"
+#define PLACEMENT_INFO_STREAMS_FIELD "streams"
+
+#define PLACEMENT_INFO_ID_FIELD "id"
+#define PLACEMENT_INFO_NODE_FIELD "node"
+#define PLACEMENT_INFO_CPUS_FIELD "cpus"
+#define PLACEMENT_INFO_LOAD_FIELD "load"
+
+namespace fastocloud {
+namespace server {
+namespace service {
+
+NodePlacement::NodePlacement() : NodePlacement(0, std::string(), 0) {}
+
+NodePlacement::NodePlacement(int id, const std::string& cpus, double load) : id(id), cpus(cpus), load(load) {}
+
+StreamPlacement::StreamPlacement() : StreamPlacement(stream_id_t(), 0, std::string(), 0) {}
+
+StreamPlacement::StreamPlacement(const stream_id_t& id, int node, const std::string& cpus, double load)
+    : id(id), node(node), cpus(cpus), load(load) {}
+
+PlacementInfo::PlacementInfo() : PlacementInfo(nodes_t(), streams_t()) {}
+
+PlacementInfo::PlacementInfo(const nodes_t& nodes, const streams_t& streams) : nodes_(nodes), streams_(streams) {}
+
+PlacementInfo::nodes_t PlacementInfo::GetNodes() const {
+  return nodes_;
+}
+
+PlacementInfo::streams_t PlacementInfo::GetStreams() const {
+  return streams_;
+}
+
+common::Error PlacementInfo::DoDeSerialize(json_object* serialized) {
+  PlacementInfo inf;
+  json_object* jnodes = nullptr;
+  json_bool jnodes_exists = json_object_object_get_ex(serialized, PLACEMENT_INFO_NODES_FIELD, &jnodes);
+  if (jnodes_exists) {
+    const size_t len = json_object_array_length(jnodes);
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jnode = json_object_array_get_idx(jnodes, i);
+      NodePlacement node;
+      json_object* jfield = nullptr;
+      if (json_object_object_get_ex(jnode, PLACEMENT_INFO_ID_FIELD, &jfield)) {
+        node.id = json_object_get_int(jfield);
+      }
+      if (json_object_object_get_ex(jnode, PLACEMENT_INFO_CPUS_FIELD, &jfield)) {
+        node.cpus = json_object_get_string(jfield);
+      }
+      if (json_object_object_get_ex(jnode, PLACEMENT_INFO_LOAD_FIELD, &jfield)) {
+        node.load = json_object_get_double(jfield);
+      }
+      inf.nodes_.push_back(node);
+    }
+  }
+
+  json_object* jstreams = nullptr;
+  json_bool jstreams_exists = json_object_object_get_ex(serialized, PLACEMENT_INFO_STREAMS_FIELD, &jstreams);
+  if (jstreams_exists) {
+    const size_t len = json_object_array_length(jstreams);
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jstream = json_object_array_get_idx(jstreams, i);
+      StreamPlacement stream;
+      json_object* jfield = nullptr;
+      if (json_object_object_get_ex(jstream, PLACEMENT_INFO_ID_FIELD, &jfield)) {
+        stream.id = json_object_get_string(jfield);
+      }
+      if (json_object_object_get_ex(jstream, PLACEMENT_INFO_NODE_FIELD, &jfield)) {
+        stream.node = json_object_get_int(jfield);
+      }
+      if (json_object_object_get_ex(jstream, PLACEMENT_INFO_CPUS_FIELD, &jfield)) {
+        stream.cpus = json_object_get_string(jfield);
+      }
+      if (json_object_object_get_ex(jstream, PLACEMENT_INFO_LOAD_FIELD, &jfield)) {
+        stream.load = json_object_get_double(jfield);
+      }
+      inf.streams_.push_back(stream);
+    }
+  }
+
+  *this = inf;
+  return common::Error();
+}
+
+common::Error PlacementInfo::SerializeFields(json_object* out) const {
+  json_object* jnodes = json_object_new_array();
+  for (const NodePlacement& node : nodes_) {
+    json_object* jnode = json_object_new_object();
+    json_object_object_add(jnode, PLACEMENT_INFO_ID_FIELD, json_object_new_int(node.id));
+    json_object_object_add(jnode, PLACEMENT_INFO_CPUS_FIELD, json_object_new_string(node.cpus.c_str()));
+    json_object_object_add(jnode, PLACEMENT_INFO_LOAD_FIELD, json_object_new_double(node.load));
+    json_object_array_add(jnodes, jnode);
+  }
+
+  json_object* jstreams = json_object_new_array();
+  for (const StreamPlacement& stream : streams_) {
+    json_object* jstream = json_object_new_object();
+    json_object_object_add(jstream, PLACEMENT_INFO_ID_FIELD, json_object_new_string(stream.id.c_str()));
+    json_object_object_add(jstream, PLACEMENT_INFO_NODE_FIELD, json_object_new_int(stream.node));
+    json_object_object_add(jstream, PLACEMENT_INFO_CPUS_FIELD, json_object_new_string(stream.cpus.c_str()));
+    json_object_object_add(jstream, PLACEMENT_INFO_LOAD_FIELD, json_object_new_double(stream.load));
+    json_object_array_add(jstreams, jstream);
+  }
+
+  json_object_object_add(out, PLACEMENT_INFO_NODES_FIELD, jnodes);
+  json_object_object_add(out, PLACEMENT_INFO_STREAMS_FIELD, jstreams);
+  return common::Error();
+}
+
+}  // namespace service
+}  // namespace server
+}  // namespace fastocloud
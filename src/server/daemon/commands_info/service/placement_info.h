@@ -0,0 +1,70 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/serializer/json_serializer.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+namespace server {
+namespace service {
+
+// cpus in kernel cpulist format ("0-3,8"), load in cores
+struct NodePlacement {
+  NodePlacement();
+  NodePlacement(int id, const std::string& cpus, double load);
+
+  int id;
+  std::string cpus;
+  double load;
+};
+
+struct StreamPlacement {
+  StreamPlacement();
+  StreamPlacement(const stream_id_t& id, int node, const std::string& cpus, double load);
+
+  stream_id_t id;
+  int node;
+  std::string cpus;
+  double load;
+};
+
+class PlacementInfo : public common::serializer::JsonSerializer<PlacementInfo> {
+ public:
+  typedef JsonSerializer<PlacementInfo> base_class;
+  typedef std::vector<NodePlacement> nodes_t;
+  typedef std::vector<StreamPlacement> streams_t;
+  PlacementInfo();
+  PlacementInfo(const nodes_t& nodes, const streams_t& streams);
+
+  nodes_t GetNodes() const;
+  streams_t GetStreams() const;
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  nodes_t nodes_;
+  streams_t streams_;
+};
+
+}  // namespace service
+}  // namespace server
+}  // namespace fastocloud
@@ -30,18 +30,24 @@
 #define STATISTIC_SERVICE_INFO_BANDWIDTH_OUT_FIELD "bandwidth_out"
 
 #define STATISTIC_SERVICE_INFO_ONLINE_USERS_FIELD "online_users"
+#define STATISTIC_SERVICE_INFO_HTTP_CACHE_FIELD "http_cache"
 
 #define FULL_SERVICE_INFO_OS_FIELD "os"
 #define FULL_SERVICE_INFO_VERSION_FIELD "version"
 #define FULL_SERVICE_INFO_HTTP_HOST_FIELD "http_host"
 #define FULL_SERVICE_INFO_VODS_HOST_FIELD "vods_host"
 #define FULL_SERVICE_INFO_CODS_HOST_FIELD "cods_host"
+#define FULL_SERVICE_INFO_PLACEMENT_FIELD "placement"
 
 #define ONLINE_USERS_DAEMON_FIELD "daemon"
 #define ONLINE_USERS_HTTP_FIELD "http"
 #define ONLINE_USERS_VODS_FIELD "vods"
 #define ONLINE_USERS_CODS_FIELD "cods"
 
+#define HTTP_CACHE_HITS_FIELD "hits"
+#define HTTP_CACHE_MISSES_FIELD "misses"
+#define HTTP_CACHE_BYTES_FIELD "bytes"
+
 namespace fastocloud {
 namespace server {
 namespace service {
@@ -89,6 +95,41 @@ common::Error OnlineUsers::SerializeFields(json_object* out) const {
   return common::Error();
 }
 
+HttpCacheInfo::HttpCacheInfo() : HttpCacheInfo(0, 0, 0) {}
+
+HttpCacheInfo::HttpCacheInfo(size_t hits, size_t misses, size_t bytes) : hits_(hits), misses_(misses), bytes_(bytes) {}
+
+common::Error HttpCacheInfo::DoDeSerialize(json_object* serialized) {
+  HttpCacheInfo inf;
+  json_object* jhits = nullptr;
+  json_bool jhits_exists = json_object_object_get_ex(serialized, HTTP_CACHE_HITS_FIELD, &jhits);
+  if (jhits_exists) {
+    inf.hits_ = json_object_get_int64(jhits);
+  }
+
+  json_object* jmisses = nullptr;
+  json_bool jmisses_exists = json_object_object_get_ex(serialized, HTTP_CACHE_MISSES_FIELD, &jmisses);
+  if (jmisses_exists) {
+    inf.misses_ = json_object_get_int64(jmisses);
+  }
+
+  json_object* jbytes = nullptr;
+  json_bool jbytes_exists = json_object_object_get_ex(serialized, HTTP_CACHE_BYTES_FIELD, &jbytes);
+  if (jbytes_exists) {
+    inf.bytes_ = json_object_get_int64(jbytes);
+  }
+
+  *this = inf;
+  return common::Error();
+}
+
+common::Error HttpCacheInfo::SerializeFields(json_object* out) const {
+  json_object_object_add(out, HTTP_CACHE_HITS_FIELD, json_object_new_int64(hits_));
+  json_object_object_add(out, HTTP_CACHE_MISSES_FIELD, json_object_new_int64(misses_));
+  json_object_object_add(out, HTTP_CACHE_BYTES_FIELD, json_object_new_int64(bytes_));
+  return common::Error();
+}
+
 ServerInfo::ServerInfo()
     : base_class(),
       cpu_load_(),
@@ -100,7 +141,8 @@ ServerInfo::ServerInfo()
       net_bytes_send_(),
       current_ts_(),
       sys_shot_(),
-      online_users_() {}
+      online_users_(),
+      http_cache_() {}
 
 ServerInfo::ServerInfo(cpu_load_t cpu_load,
                        gpu_load_t gpu_load,
@@ -111,7 +153,8 @@ ServerInfo::ServerInfo(cpu_load_t cpu_load,
                        fastotv::bandwidth_t net_bytes_send,
                        const SysinfoShot& sys,
                        fastotv::timestamp_t timestamp,
-                       const OnlineUsers& online_users)
+                       const OnlineUsers& online_users,
+                       const HttpCacheInfo& http_cache)
     : base_class(),
       cpu_load_(cpu_load),
       gpu_load_(gpu_load),
@@ -122,7 +165,8 @@ ServerInfo::ServerInfo(cpu_load_t cpu_load,
       net_bytes_send_(net_bytes_send),
       current_ts_(timestamp),
       sys_shot_(sys),
-      online_users_(online_users) {}
+      online_users_(online_users),
+      http_cache_(http_cache) {}
 
 common::Error ServerInfo::SerializeFields(json_object* out) const {
   json_object* obj = nullptr;
@@ -131,6 +175,13 @@ common::Error ServerInfo::SerializeFields(json_object* out) const {
     return err;
   }
 
+  json_object* jcache = nullptr;
+  err = http_cache_.Serialize(&jcache);
+  if (err) {
+    json_object_put(obj);
+    return err;
+  }
+
   json_object_object_add(out, STATISTIC_SERVICE_INFO_CPU_FIELD, json_object_new_double(cpu_load_));
   json_object_object_add(out, STATISTIC_SERVICE_INFO_GPU_FIELD, json_object_new_double(gpu_load_));
   json_object_object_add(out, STATISTIC_SERVICE_INFO_LOAD_AVERAGE_FIELD, json_object_new_string(uptime_.c_str()));
@@ -145,6 +196,7 @@ common::Error ServerInfo::SerializeFields(json_object* out) const {
   json_object_object_add(out, STATISTIC_SERVICE_INFO_UPTIME_FIELD, json_object_new_int64(sys_shot_.uptime));
   json_object_object_add(out, STATISTIC_SERVICE_INFO_TIMESTAMP_FIELD, json_object_new_int64(current_ts_));
   json_object_object_add(out, STATISTIC_SERVICE_INFO_ONLINE_USERS_FIELD, obj);
+  json_object_object_add(out, STATISTIC_SERVICE_INFO_HTTP_CACHE_FIELD, jcache);
   return common::Error();
 }
 
@@ -160,6 +212,15 @@ common::Error ServerInfo::DoDeSerialize(json_object* serialized) {
     }
   }
 
+  json_object* jcache = nullptr;
+  json_bool jcache_exists = json_object_object_get_ex(serialized, STATISTIC_SERVICE_INFO_HTTP_CACHE_FIELD, &jcache);
+  if (jcache_exists) {
+    common::Error err = inf.http_cache_.DeSerialize(jcache);
+    if (err) {
+      return err;
+    }
+  }
+
   json_object* jcpu_load = nullptr;
   json_bool jcpu_load_exists = json_object_object_get_ex(serialized, STATISTIC_SERVICE_INFO_CPU_FIELD, &jcpu_load);
   if (jcpu_load_exists) {
@@ -271,22 +332,29 @@ OnlineUsers ServerInfo::GetOnlineUsers() const {
   return online_users_;
 }
 
+HttpCacheInfo ServerInfo::GetHttpCache() const {
+  return http_cache_;
+}
+
 FullServiceInfo::FullServiceInfo()
     : base_class(),
       http_host_(),
       proj_ver_(PROJECT_VERSION_HUMAN),
-      os_(fastotv::commands_info::OperationSystemInfo::MakeOSSnapshot()) {}
+      os_(fastotv::commands_info::OperationSystemInfo::MakeOSSnapshot()),
+      placement_() {}
 
 FullServiceInfo::FullServiceInfo(const common::net::HostAndPort& http_host,
                                  const common::net::HostAndPort& vods_host,
                                  const common::net::HostAndPort& cods_host,
-                                 const base_class& base)
+                                 const base_class& base,
+                                 const PlacementInfo& placement)
     : base_class(base),
       http_host_(http_host),
       vods_host_(vods_host),
       cods_host_(cods_host),
       proj_ver_(PROJECT_VERSION_HUMAN),
-      os_(fastotv::commands_info::OperationSystemInfo::MakeOSSnapshot()) {}
+      os_(fastotv::commands_info::OperationSystemInfo::MakeOSSnapshot()),
+      placement_(placement) {}
 
 common::net::HostAndPort FullServiceInfo::GetHttpHost() const {
   return http_host_;
@@ -304,6 +372,10 @@ std::string FullServiceInfo::GetProjectVersion() const {
   return proj_ver_;
 }
 
+PlacementInfo FullServiceInfo::GetPlacement() const {
+  return placement_;
+}
+
 common::Error FullServiceInfo::DoDeSerialize(json_object* serialized) {
   FullServiceInfo inf;
   common::Error err = inf.base_class::DoDeSerialize(serialized);
@@ -353,6 +425,15 @@ common::Error FullServiceInfo::DoDeSerialize(json_object* serialized) {
     inf.proj_ver_ = json_object_get_string(jproj_ver);
   }
 
+  json_object* jplacement = nullptr;
+  json_bool jplacement_exists = json_object_object_get_ex(serialized, FULL_SERVICE_INFO_PLACEMENT_FIELD, &jplacement);
+  if (jplacement_exists) {
+    common::Error err = inf.placement_.DeSerialize(jplacement);
+    if (err) {
+      return err;
+    }
+  }
+
   *this = inf;
   return common::Error();
 }
@@ -364,6 +445,13 @@ common::Error FullServiceInfo::SerializeFields(json_object* out) const {
     return err;
   }
 
+  json_object* jplacement = nullptr;
+  err = placement_.Serialize(&jplacement);
+  if (err) {
+    json_object_put(jos);
+    return err;
+  }
+
   std::string http_host_str = common::ConvertToString(http_host_);
   std::string vods_host_str = common::ConvertToString(vods_host_);
   std::string cods_host_str = common::ConvertToString(cods_host_);
@@ -372,6 +460,7 @@ common::Error FullServiceInfo::SerializeFields(json_object* out) const {
   json_object_object_add(out, FULL_SERVICE_INFO_CODS_HOST_FIELD, json_object_new_string(cods_host_str.c_str()));
   json_object_object_add(out, FULL_SERVICE_INFO_VERSION_FIELD, json_object_new_string(proj_ver_.c_str()));
   json_object_object_add(out, FULL_SERVICE_INFO_OS_FIELD, jos);
+  json_object_object_add(out, FULL_SERVICE_INFO_PLACEMENT_FIELD, jplacement);
   return base_class::SerializeFields(out);
 }
 
@@ -23,6 +23,7 @@
 #include <fastotv/types.h>
 
 #include "server/daemon/commands_info/service/details/shots.h"
+#include "server/daemon/commands_info/service/placement_info.h"
 
 namespace fastocloud {
 namespace server {
@@ -45,6 +46,22 @@ class OnlineUsers : public common::serializer::JsonSerializer<OnlineUsers> {
   size_t cods_;
 };
 
+class HttpCacheInfo : public common::serializer::JsonSerializer<HttpCacheInfo> {
+ public:
+  typedef JsonSerializer<HttpCacheInfo> base_class;
+  HttpCacheInfo();
+  explicit HttpCacheInfo(size_t hits, size_t misses, size_t bytes);
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  size_t hits_;
+  size_t misses_;
+  size_t bytes_;
+};
+
 class ServerInfo : public common::serializer::JsonSerializer<ServerInfo> {
  public:
   typedef JsonSerializer<ServerInfo> base_class;
@@ -60,7 +77,8 @@ class ServerInfo : public common::serializer::JsonSerializer<ServerInfo> {
              fastotv::bandwidth_t net_bytes_send,
              const SysinfoShot& sys,
              fastotv::timestamp_t timestamp,
-             const OnlineUsers& online_users);
+             const OnlineUsers& online_users,
+             const HttpCacheInfo& http_cache);
 
   cpu_load_t GetCpuLoad() const;
   gpu_load_t GetGpuLoad() const;
@@ -71,6 +89,7 @@ class ServerInfo : public common::serializer::JsonSerializer<ServerInfo> {
   fastotv::bandwidth_t GetNetBytesSend() const;
   fastotv::timestamp_t GetTimestamp() const;
   OnlineUsers GetOnlineUsers() const;
+  HttpCacheInfo GetHttpCache() const;
 
  protected:
   common::Error DoDeSerialize(json_object* serialized) override;
@@ -87,6 +106,7 @@ class ServerInfo : public common::serializer::JsonSerializer<ServerInfo> {
   fastotv::timestamp_t current_ts_;
   SysinfoShot sys_shot_;
   OnlineUsers online_users_;
+  HttpCacheInfo http_cache_;
 };
 
 class FullServiceInfo : public ServerInfo {
@@ -96,12 +116,14 @@ class FullServiceInfo : public ServerInfo {
   explicit FullServiceInfo(const common::net::HostAndPort& http_host,
                            const common::net::HostAndPort& vods_host,
                            const common::net::HostAndPort& cods_host,
-                           const base_class& base);
+                           const base_class& base,
+                           const PlacementInfo& placement);
 
   common::net::HostAndPort GetHttpHost() const;
   common::net::HostAndPort GetVodsHost() const;
   common::net::HostAndPort GetCodsHost() const;
   std::string GetProjectVersion() const;
+  PlacementInfo GetPlacement() const;
 
  protected:
   common::Error DoDeSerialize(json_object* serialized) override;
@@ -114,6 +136,7 @@ class FullServiceInfo : public ServerInfo {
   common::net::HostAndPort bandwidth_host_;
   std::string proj_ver_;
   fastotv::commands_info::OperationSystemInfo os_;
+  PlacementInfo placement_;
 };
 
 }  // namespace service
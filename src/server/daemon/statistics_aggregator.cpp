@@ -0,0 +1,242 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/daemon/statistics_aggregator.h"
+
+#include <string.h>
+
+#include <json-c/json_object.h>
+
+#define STATISTICS_FULL_FIELD "full"
+#define STATISTICS_STREAMS_FIELD "streams"
+#define STATISTICS_ID_FIELD "id"
+#define STATISTICS_REMOVED_FIELD "removed"
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+bool IsEqualJson(json_object* left, json_object* right) {
+  return strcmp(json_object_to_json_string(left), json_object_to_json_string(right)) == 0;
+}
+
+json_object* MakeObjectDelta(json_object* prev, json_object* cur);
+
+json_object* FindById(json_object* array, json_object* jid) {
+  const size_t len = json_object_array_length(array);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* item = json_object_array_get_idx(array, i);
+    json_object* item_id = nullptr;
+    if (json_object_object_get_ex(item, STATISTICS_ID_FIELD, &item_id) && IsEqualJson(item_id, jid)) {
+      return item;
+    }
+  }
+  return nullptr;
+}
+
+bool IsArrayOfObjectsWithId(json_object* array) {
+  const size_t len = json_object_array_length(array);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* item = json_object_array_get_idx(array, i);
+    if (!json_object_is_type(item, json_type_object)) {
+      return false;
+    }
+    if (!json_object_object_get_ex(item, STATISTICS_ID_FIELD, nullptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// elements with id are matched by id: changed fields of changed elements, new elements whole,
+// removed elements as {"id": x, "removed": true}; other arrays are sent whole if changed
+json_object* MakeArrayDelta(json_object* prev, json_object* cur) {
+  if (!IsArrayOfObjectsWithId(prev) || !IsArrayOfObjectsWithId(cur)) {
+    return IsEqualJson(prev, cur) ? nullptr : json_object_get(cur);
+  }
+
+  json_object* delta = json_object_new_array();
+  const size_t len = json_object_array_length(cur);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* cur_item = json_object_array_get_idx(cur, i);
+    json_object* jid = nullptr;
+    json_object_object_get_ex(cur_item, STATISTICS_ID_FIELD, &jid);
+    json_object* prev_item = FindById(prev, jid);
+    if (!prev_item) {
+      json_object_array_add(delta, json_object_get(cur_item));
+      continue;
+    }
+
+    json_object* item_delta = MakeObjectDelta(prev_item, cur_item);
+    if (item_delta) {
+      json_object_array_add(delta, item_delta);
+    }
+  }
+
+  const size_t prev_len = json_object_array_length(prev);
+  for (size_t i = 0; i < prev_len; ++i) {
+    json_object* prev_item = json_object_array_get_idx(prev, i);
+    json_object* jid = nullptr;
+    json_object_object_get_ex(prev_item, STATISTICS_ID_FIELD, &jid);
+    if (!FindById(cur, jid)) {
+      json_object* removed = json_object_new_object();
+      json_object_object_add(removed, STATISTICS_ID_FIELD, json_object_get(jid));
+      json_object_object_add(removed, STATISTICS_REMOVED_FIELD, json_object_new_boolean(true));
+      json_object_array_add(delta, removed);
+    }
+  }
+
+  if (json_object_array_length(delta) == 0) {
+    json_object_put(delta);
+    return nullptr;
+  }
+  return delta;
+}
+
+// changed fields plus id, nullptr if nothing changed
+json_object* MakeObjectDelta(json_object* prev, json_object* cur) {
+  json_object* delta = json_object_new_object();
+  bool changed = false;
+  json_object_object_foreach(cur, key, val) {
+    if (strcmp(key, STATISTICS_ID_FIELD) == 0) {
+      json_object_object_add(delta, key, json_object_get(val));
+      continue;
+    }
+
+    json_object* prev_val = nullptr;
+    if (!json_object_object_get_ex(prev, key, &prev_val)) {
+      json_object_object_add(delta, key, json_object_get(val));
+      changed = true;
+    } else if (json_object_is_type(val, json_type_array) && json_object_is_type(prev_val, json_type_array)) {
+      json_object* array_delta = MakeArrayDelta(prev_val, val);
+      if (array_delta) {
+        json_object_object_add(delta, key, array_delta);
+        changed = true;
+      }
+    } else if (!IsEqualJson(prev_val, val)) {
+      json_object_object_add(delta, key, json_object_get(val));
+      changed = true;
+    }
+  }
+
+  if (!changed) {
+    json_object_put(delta);
+    return nullptr;
+  }
+  return delta;
+}
+
+std::string MakeParams(bool full, json_object* jstreams) {
+  json_object* jparams = json_object_new_object();
+  json_object_object_add(jparams, STATISTICS_FULL_FIELD, json_object_new_boolean(full));
+  json_object_object_add(jparams, STATISTICS_STREAMS_FIELD, jstreams);
+  const std::string params = json_object_to_json_string(jparams);
+  json_object_put(jparams);
+  return params;
+}
+
+}  // namespace
+
+StatisticsAggregator::StatisticsAggregator() : sent_(), pending_(), ticks_(0) {}
+
+StatisticsAggregator::~StatisticsAggregator() {
+  for (auto it = sent_.begin(); it != sent_.end(); ++it) {
+    json_object_put(it->second);
+  }
+}
+
+void StatisticsAggregator::Update(const StatisticInfo& statistic) {
+  const stream_id_t sid = statistic.GetStreamStruct().id;
+  auto it = pending_.find(sid);
+  if (it == pending_.end()) {
+    pending_.insert(std::make_pair(sid, statistic));
+    return;
+  }
+  it->second = statistic;
+}
+
+void StatisticsAggregator::Remove(const stream_id_t& sid) {
+  pending_.erase(sid);
+  auto it = sent_.find(sid);
+  if (it != sent_.end()) {
+    json_object_put(it->second);
+    sent_.erase(it);
+  }
+}
+
+bool StatisticsAggregator::MakeTickBroadcast(std::string* params) {
+  if (!params) {
+    return false;
+  }
+
+  const bool full = ++ticks_ % full_snapshot_ticks == 0;
+  json_object* jstreams = json_object_new_array();
+  for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+    json_object* jstat = nullptr;
+    common::Error err = it->second.Serialize(&jstat);
+    if (err) {
+      continue;
+    }
+
+    auto sent = sent_.find(it->first);
+    if (sent == sent_.end()) {
+      sent_.insert(std::make_pair(it->first, jstat));
+      if (!full) {
+        json_object_array_add(jstreams, json_object_get(jstat));
+      }
+      continue;
+    }
+
+    if (!full) {
+      json_object* delta = MakeObjectDelta(sent->second, jstat);
+      if (delta) {
+        json_object_array_add(jstreams, delta);
+      }
+    }
+    json_object_put(sent->second);
+    sent->second = jstat;
+  }
+  pending_.clear();
+
+  if (full) {
+    for (auto it = sent_.begin(); it != sent_.end(); ++it) {
+      json_object_array_add(jstreams, json_object_get(it->second));
+    }
+  }
+
+  if (json_object_array_length(jstreams) == 0) {
+    json_object_put(jstreams);
+    return false;
+  }
+
+  *params = MakeParams(full, jstreams);
+  return true;
+}
+
+bool StatisticsAggregator::MakeSnapshot(std::string* params) const {
+  if (!params || sent_.empty()) {
+    return false;
+  }
+
+  json_object* jstreams = json_object_new_array();
+  for (auto it = sent_.begin(); it != sent_.end(); ++it) {
+    json_object_array_add(jstreams, json_object_get(it->second));
+  }
+
+  *params = MakeParams(true, jstreams);
+  return true;
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,56 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "stream_commands/commands_info/statistic_info.h"
+
+struct json_object;
+
+namespace fastocloud {
+namespace server {
+
+// Coalesces streams statistics received during tick into one broadcast,
+// entries carry only fields changed since previous broadcast (channels matched by id),
+// full snapshot sent every full_snapshot_ticks.
+class StatisticsAggregator {
+ public:
+  enum { full_snapshot_ticks = 60 };
+
+  StatisticsAggregator();
+  ~StatisticsAggregator();
+
+  void Update(const StatisticInfo& statistic);  // latest statistic of stream wins
+  void Remove(const stream_id_t& sid);
+
+  // params of tick broadcast, false if nothing changed
+  bool MakeTickBroadcast(std::string* params);
+  // last sent state of all streams, for new clients
+  bool MakeSnapshot(std::string* params) const;
+
+ private:
+  typedef std::map<stream_id_t, json_object*> snapshots_t;
+
+  snapshots_t sent_;  // owned
+  std::map<stream_id_t, StatisticInfo> pending_;
+  size_t ticks_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatisticsAggregator);
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -18,7 +18,7 @@ namespace fastocloud {
 namespace server {
 
 HttpClient::HttpClient(common::libev::IoLoop* server, const common::net::socket_info& info)
-    : base_class(server, info), is_verified_(false) {}
+    : base_class(server, info), is_verified_(false), reader_(), output_() {}
 
 bool HttpClient::IsVerified() const {
   return is_verified_;
@@ -28,6 +28,14 @@ void HttpClient::SetVerified(bool verified) {
   is_verified_ = verified;
 }
 
+base::HttpRequestReader* HttpClient::GetRequestReader() {
+  return &reader_;
+}
+
+base::HttpOutput* HttpClient::GetOutput() {
+  return &output_;
+}
+
 const char* HttpClient::ClassName() const {
   return "HttpClient";
 }
@@ -16,6 +16,9 @@
 
 #include <common/libev/http/http_client.h>
 
+#include "server/base/http_output.h"
+#include "server/base/http_request_reader.h"
+
 namespace fastocloud {
 namespace server {
 
@@ -28,10 +31,16 @@ class HttpClient : public common::libev::http::HttpClient {
   bool IsVerified() const;
   void SetVerified(bool verified);
 
+  base::HttpRequestReader* GetRequestReader();
+  // queued response bytes, requests aren't processed while output isn't empty
+  base::HttpOutput* GetOutput();
+
   const char* ClassName() const override;
 
  private:
   bool is_verified_;
+  base::HttpRequestReader reader_;
+  base::HttpOutput output_;
 };
 
 }  // namespace server
@@ -20,21 +20,60 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <common/sprintf.h>
+#include <common/time.h>
+
+#include "base/types.h"
+
+#include "server/base/http_file_response.h"
 #include "server/base/ihttp_requests_observer.h"
 #include "server/http/client.h"
+#include "server/http/timeshift_playlist.h"
+
+#define TIMESHIFT_HTTP_DIR "timeshift"
+#define M3U8_MIME "application/vnd.apple.mpegurl"
 
 namespace fastocloud {
 namespace server {
+namespace {
+
+std::string MakePlaylistHeaders(common::http::http_protocol protocol, size_t size, bool is_keep_alive) {
+  std::string headers =
+      common::MemSPrintf("%s 200 OK\r\n", protocol == common::http::HP_1_0 ? "HTTP/1.0" : "HTTP/1.1");
+  headers += common::MemSPrintf("Server: %s\r\n", PROJECT_NAME_TITLE);
+  headers += "Content-Type: " M3U8_MIME "\r\n";
+  headers += common::MemSPrintf("Content-Length: %zu\r\n", size);
+  headers += "Cache-Control: no-cache\r\n";  // generated for current time
+  headers += is_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  headers += "\r\n";
+  return headers;
+}
+
+}  // namespace
 
-HttpHandler::HttpHandler(base::IHttpRequestsObserver* observer)
-    : base_class(), http_root_(http_directory_path_t::MakeHomeDir()), observer_(observer) {}
+HttpHandler::HttpHandler(base::IHttpRequestsObserver* observer, size_t cache_size, size_t cache_segments)
+    : base_class(),
+      http_root_(http_directory_path_t::MakeHomeDir()),
+      timeshifts_root_(http_directory_path_t::MakeHomeDir()),
+      observer_(observer),
+      cache_(cache_size, cache_segments) {}
 
 void HttpHandler::SetHttpRoot(const http_directory_path_t& http_root) {
   http_root_ = http_root;
 }
 
+void HttpHandler::SetTimeshiftsRoot(const http_directory_path_t& timeshifts_root) {
+  timeshifts_root_ = timeshifts_root;
+}
+
+SegmentsCache::Stats HttpHandler::GetCacheStats() const {
+  return cache_.GetStats();
+}
+
 void HttpHandler::PreLooped(common::libev::IoLoop* server) {
+  ignore_result(server->CreateTimer(static_cast<double>(base::HttpOutput::stall_check_msec) / 1000, true));
   base_class::PreLooped(server);
 }
 
@@ -51,6 +90,7 @@ void HttpHandler::Closed(common::libev::IoClient* client) {
 }
 
 void HttpHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  CloseStalledClients(server);  // only stall check timer created
   base_class::TimerEmited(server, id);
 }
 
@@ -67,21 +107,28 @@ void HttpHandler::ChildStatusChanged(common::libev::IoChild* child, int status,
 }
 
 void HttpHandler::DataReceived(common::libev::IoClient* client) {
-  char buff[BUF_SIZE] = {0};
+  HttpClient* hclient = static_cast<server::HttpClient*>(client);
+  base::HttpRequestReader* reader = hclient->GetRequestReader();
+  size_t buff_size = 0;
+  char* buff = reader->PrepareRead(&buff_size);
   size_t nread = 0;
-  common::ErrnoError errn = client->SingleRead(buff, BUF_SIZE - 1, &nread);
+  common::ErrnoError errn = client->SingleRead(buff, buff_size, &nread);
   if ((errn && errn->GetErrorCode() != EAGAIN) || nread == 0) {
     ignore_result(client->Close());
     delete client;
     return base_class::DataReceived(client);
   }
 
-  HttpClient* hclient = static_cast<server::HttpClient*>(client);
-  ProcessReceived(hclient, buff, nread);
+  reader->CommitRead(nread);
+  ProcessRequests(hclient);
   base_class::DataReceived(client);
 }
 
 void HttpHandler::DataReadyToWrite(common::libev::IoClient* client) {
+  HttpClient* hclient = static_cast<server::HttpClient*>(client);
+  if (FlushOutput(hclient) && hclient->GetOutput()->IsEmpty()) {
+    ProcessRequests(hclient);  // pipelined behind sent response
+  }
   base_class::DataReadyToWrite(client);
 }
 
@@ -89,11 +136,31 @@ void HttpHandler::PostLooped(common::libev::IoLoop* server) {
   base_class::PostLooped(server);
 }
 
-void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size_t req_len) {
+void HttpHandler::ProcessRequests(HttpClient* hclient) {
+  base::HttpRequestReader* reader = hclient->GetRequestReader();
+  base::HttpOutput* output = hclient->GetOutput();
+  while (output->IsEmpty() && reader->NextRequest()) {
+    if (!ProcessReceived(hclient, reader->GetRequest())) {
+      return;  // client closed
+    }
+  }
+
+  if (output->IsEmpty() && reader->IsOverflow()) {
+    static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+    common::ErrnoError err = hclient->SendError(common::http::HP_1_1, common::http::HS_BAD_REQUEST, nullptr,
+                                                "Request too large.", false, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    ignore_result(hclient->Close());
+    delete hclient;
+  }
+}
+
+bool HttpHandler::ProcessReceived(HttpClient* hclient, const std::string& request) {
   static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
   common::http::HttpRequest hrequest;
-  std::string request_str(request, req_len);
-  std::pair<common::http::http_status, common::Error> result = common::http::parse_http_request(request_str, &hrequest);
+  std::pair<common::http::http_status, common::Error> result = common::http::parse_http_request(request, &hrequest);
   DEBUG_LOG() << "Http request:\n" << request;
 
   if (result.second) {
@@ -106,7 +173,7 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
     }
     ignore_result(hclient->Close());
     delete hclient;
-    return;
+    return false;
   }
 
   // keep alive
@@ -124,13 +191,22 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
     const std::string url_dirs = path.GetHpath();
-    auto dirs_path = http_root_.MakeDirectoryStringPath(url_dirs.substr(1));
+    std::string root_dirs = url_dirs.substr(1);
+    http_directory_path_t root = http_root_;
+    static const std::string timeshift_prefix = TIMESHIFT_HTTP_DIR "/";
+    const bool is_timeshift = root_dirs.compare(0, timeshift_prefix.size(), timeshift_prefix) == 0;
+    if (is_timeshift) {
+      root_dirs = root_dirs.substr(timeshift_prefix.size());
+      root = timeshifts_root_;
+    }
+
+    auto dirs_path = root.MakeDirectoryStringPath(root_dirs);
     if (!dirs_path) {
-      dirs_path = http_root_;
+      dirs_path = root;
     }
 
     auto file_path = dirs_path->MakeFileStringPath(path.GetFileName());
@@ -140,7 +216,11 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
+    }
+
+    if (is_timeshift && common::EqualsASCII(file_path->GetExtension(), M3U8_EXTENSION, false)) {
+      return SendTimeShiftPlaylist(hclient, hrequest, request, *dirs_path, IsKeepAlive);
     }
 
     if (observer_) {
@@ -157,7 +237,7 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
     if (S_ISDIR(sb.st_mode)) {
@@ -166,7 +246,33 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
+    }
+
+    const std::string mime = path.GetMime();
+    const base::HttpFileResponse response(hrequest, sb);
+    base::HttpOutput* output = hclient->GetOutput();
+    if (!response.HasBody()) {  // not modified or bad range
+      response.QueueHeaders(output, protocol, mime.c_str(), IsKeepAlive, PROJECT_NAME_TITLE);
+      if (!IsKeepAlive) {
+        output->SetCloseOnEmpty();
+      }
+      return FlushOutput(hclient);
+    }
+
+    const SegmentsCache::data_t cached = cache_.Get(file_path_str, sb);
+    if (cached) {
+      response.QueueHeaders(output, protocol, mime.c_str(), IsKeepAlive, PROJECT_NAME_TITLE);
+      if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
+        output->Push(cached, response.GetOffset(), response.GetLength());
+        DEBUG_LOG() << "Sending cached file path: " << file_path_str << ", offset: " << response.GetOffset()
+                    << ", size: " << response.GetLength();
+      }
+
+      if (!IsKeepAlive) {
+        output->SetCloseOnEmpty();
+      }
+      return FlushOutput(hclient);
     }
 
     int file = open(file_path_str.c_str(), open_flags);
@@ -176,34 +282,104 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
-    const std::string mime = path.GetMime();
-    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, extra_header, mime.c_str(),
-                                                  &sb.st_size, &sb.st_mtime, IsKeepAlive, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    response.QueueHeaders(output, protocol, mime.c_str(), IsKeepAlive, PROJECT_NAME_TITLE);
+    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
+      response.QueueBody(output, file);
+      DEBUG_LOG() << "Sending file path: " << file_path_str << ", offset: " << response.GetOffset()
+                  << ", size: " << response.GetLength();
+    } else {
       ::close(file);
-      return;
     }
+  }
 
-    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
-      common::ErrnoError err = hclient->SendFileByFd(protocol, file, sb.st_size);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        DEBUG_LOG() << "Sent file path: " << file_path_str << ", size: " << sb.st_size;
-      }
-    }
+  if (!IsKeepAlive) {
+    hclient->GetOutput()->SetCloseOnEmpty();
+  }
+  return FlushOutput(hclient);
+}
 
-    ::close(file);
+bool HttpHandler::FlushOutput(HttpClient* hclient) {
+  base::HttpOutput* output = hclient->GetOutput();
+  common::ErrnoError err = output->Flush(hclient->GetInfo().fd());
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    ignore_result(hclient->Close());
+    delete hclient;
+    return false;
   }
 
-  if (!IsKeepAlive) {
+  // loop wakes us up when client can take the rest
+  const common::libev::IoClient::flags_t flags = output->IsEmpty() ? EV_READ : EV_READ | EV_WRITE;
+  if (hclient->GetFlags() != flags) {
+    hclient->SetFlags(flags);
+  }
+
+  if (output->IsEmpty() && output->IsCloseOnEmpty()) {
     ignore_result(hclient->Close());
     delete hclient;
+    return false;
+  }
+  return true;
+}
+
+void HttpHandler::CloseStalledClients(common::libev::IoLoop* server) {
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  std::vector<common::libev::IoClient*> clients = server->GetClients();
+  for (size_t i = 0; i < clients.size(); ++i) {
+    HttpClient* hclient = static_cast<HttpClient*>(clients[i]);
+    if (!hclient->GetOutput()->IsStalled(current_time)) {
+      continue;
+    }
+
+    WARNING_LOG() << "Http client doesn't read response for " << base::HttpOutput::stall_timeout_msec
+                  << " msec, closing";
+    ignore_result(hclient->Close());
+    delete hclient;
+  }
+}
+
+bool HttpHandler::SendTimeShiftPlaylist(HttpClient* hclient,
+                                        const common::http::HttpRequest& hrequest,
+                                        const std::string& request,
+                                        const http_directory_path_t& archive_dir,
+                                        bool is_keep_alive) {
+  static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  TimeShiftPlaylistRequest playlist_request;
+  if (!TimeShiftPlaylist::ParseQuery(TimeShiftPlaylist::GetRequestQuery(request), &playlist_request)) {
+    common::ErrnoError err = hclient->SendError(protocol, common::http::HS_BAD_REQUEST, nullptr,
+                                                "Invalid timeshift query.", is_keep_alive, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    return true;
+  }
+
+  // playlist is cheap to build from index, so any delay or range costs no stream process
+  const stream::TimeShiftIndex index(archive_dir);
+  std::string playlist;
+  if (!index.IsExist() ||
+      !TimeShiftPlaylist::Make(index, playlist_request, common::time::current_utc_mstime(), &playlist)) {
+    common::ErrnoError err = hclient->SendError(protocol, common::http::HS_NOT_FOUND, nullptr,
+                                                "No recorded chunks for request.", is_keep_alive, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    return true;
+  }
+
+  base::HttpOutput* output = hclient->GetOutput();
+  output->Push(MakePlaylistHeaders(protocol, playlist.size(), is_keep_alive));
+  if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
+    output->Push(playlist);
+  }
+  if (!is_keep_alive) {
+    output->SetCloseOnEmpty();
   }
+  return FlushOutput(hclient);
 }
 
 }  // namespace server
@@ -14,9 +14,12 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/file_system/path.h>
 
 #include "server/base/iserver_handler.h"
+#include "server/http/segments_cache.h"
 
 namespace fastocloud {
 namespace server {
@@ -28,12 +31,15 @@ class IHttpRequestsObserver;
 
 class HttpHandler : public base::IServerHandler {
  public:
-  enum { BUF_SIZE = 4096 };
   typedef base::IServerHandler base_class;
   typedef common::file_system::ascii_directory_string_path http_directory_path_t;
-  explicit HttpHandler(base::IHttpRequestsObserver* observer);
+  // cache_segments is count of last segments of every channel kept in cache
+  HttpHandler(base::IHttpRequestsObserver* observer, size_t cache_size, size_t cache_segments);
 
   void SetHttpRoot(const http_directory_path_t& http_root);
+  // recorder archives are served under /TIMESHIFT_HTTP_DIR/ with generated playlists
+  void SetTimeshiftsRoot(const http_directory_path_t& timeshifts_root);
+  SegmentsCache::Stats GetCacheStats() const;
 
   void PreLooped(common::libev::IoLoop* server) override;
 
@@ -51,10 +57,23 @@ class HttpHandler : public base::IServerHandler {
   void PostLooped(common::libev::IoLoop* server) override;
 
  private:
-  void ProcessReceived(HttpClient* hclient, const char* request, size_t req_len);
+  void ProcessRequests(HttpClient* hclient);
+  // false if client closed
+  bool ProcessReceived(HttpClient* hclient, const std::string& request) WARN_UNUSED_RESULT;
+  // false if client closed
+  bool SendTimeShiftPlaylist(HttpClient* hclient,
+                             const common::http::HttpRequest& hrequest,
+                             const std::string& request,
+                             const http_directory_path_t& archive_dir,
+                             bool is_keep_alive) WARN_UNUSED_RESULT;
+  // sends queued output or waits writability, false if client closed
+  bool FlushOutput(HttpClient* hclient) WARN_UNUSED_RESULT;
+  void CloseStalledClients(common::libev::IoLoop* server);
 
   http_directory_path_t http_root_;
+  http_directory_path_t timeshifts_root_;
   base::IHttpRequestsObserver* observer_;
+  SegmentsCache cache_;
 };
 
 }  // namespace server
@@ -0,0 +1,302 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/http/segments_cache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iterator>
+#include <set>
+#include <utility>
+
+#include <common/string_util.h>
+
+#include "base/types.h"
+
+#if defined(OS_MACOSX)
+#define STAT_MTIME_NSEC(sb) (sb).st_mtimespec.tv_nsec
+#elif defined(OS_POSIX)
+#define STAT_MTIME_NSEC(sb) (sb).st_mtim.tv_nsec
+#else
+#define STAT_MTIME_NSEC(sb) 0
+#endif
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+bool HasExtension(const std::string& path, const char* ext) {
+  const size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos) {
+    return false;
+  }
+  return common::EqualsASCII(path.substr(dot + 1), ext, false);
+}
+
+std::string GetDirectory(const std::string& path) {
+  const size_t slash = path.find_last_of('/');
+  if (slash == std::string::npos) {
+    return std::string();
+  }
+  return path.substr(0, slash + 1);
+}
+
+bool ReadWholeFile(const std::string& path, size_t size, std::string* out) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  std::string data(size, 0);
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t res = read(fd, &data[offset], size - offset);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      break;
+    }
+    offset += res;
+  }
+  ::close(fd);
+
+  if (offset != size) {  // file was changed while reading
+    return false;
+  }
+
+  *out = data;
+  return true;
+}
+
+}  // namespace
+
+bool SegmentsCache::Entry::IsValid(const struct stat& sb) const {
+  return inode == sb.st_ino && mtime == sb.st_mtime && mtime_nsec == STAT_MTIME_NSEC(sb) && size == sb.st_size;
+}
+
+SegmentsCache::Stats::Stats() : hits(0), misses(0), bytes(0), entries(0) {}
+
+SegmentsCache::SegmentsCache(size_t max_bytes, size_t max_segments_per_channel)
+    : max_bytes_(max_bytes),
+      max_segments_per_channel_(max_segments_per_channel),
+      mutex_(),
+      entries_(),
+      index_(),
+      segments_per_dir_(),
+      bytes_(0),
+      hits_(0),
+      misses_(0),
+      pending_(),
+      pending_paths_(),
+      loading_(false),
+      stop_(false),
+      pending_cond_(),
+      loaded_cond_(),
+      loader_() {
+  if (IsEnabled()) {
+    loader_ = std::thread(&SegmentsCache::LoaderRoutine, this);
+  }
+}
+
+SegmentsCache::~SegmentsCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  pending_cond_.notify_all();
+  if (loader_.joinable()) {
+    loader_.join();
+  }
+}
+
+bool SegmentsCache::IsEnabled() const {
+  return max_bytes_ != 0;
+}
+
+SegmentsCache::data_t SegmentsCache::Get(const std::string& path, const struct stat& sb) {
+  if (!IsEnabled() || !S_ISREG(sb.st_mode)) {
+    return data_t();
+  }
+
+  const size_t size = sb.st_size;
+  if (size > max_file_size || size > max_bytes_) {
+    return data_t();
+  }
+
+  const bool is_playlist = HasExtension(path, M3U8_EXTENSION);
+  const bool is_segment = HasExtension(path, TS_EXTENSION);
+  if (!is_playlist && !is_segment) {
+    return data_t();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = index_.find(path);
+  if (it != index_.end()) {
+    entries_t::iterator entry = it->second;
+    if (entry->IsValid(sb)) {
+      entries_.splice(entries_.begin(), entries_, entry);
+      hits_++;
+      return entry->data;
+    }
+    EraseLocked(entry);
+  }
+  misses_++;
+
+  if (pending_.size() >= max_pending_loads || !pending_paths_.insert(path).second) {
+    return data_t();
+  }
+
+  Entry entry;
+  entry.path = path;
+  entry.dir = GetDirectory(path);
+  entry.is_segment = is_segment;
+  entry.inode = sb.st_ino;
+  entry.mtime = sb.st_mtime;
+  entry.mtime_nsec = STAT_MTIME_NSEC(sb);
+  entry.size = sb.st_size;
+  pending_.push_back(entry);
+  lock.unlock();
+  pending_cond_.notify_one();
+  return data_t();
+}
+
+void SegmentsCache::WaitLoaded() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  loaded_cond_.wait(lock, [this]() { return stop_ || (pending_.empty() && !loading_); });
+}
+
+SegmentsCache::Stats SegmentsCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.bytes = bytes_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+void SegmentsCache::LoaderRoutine() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    pending_cond_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+    if (stop_) {
+      break;
+    }
+
+    Entry entry = pending_.front();
+    pending_.pop_front();
+    loading_ = true;
+    lock.unlock();
+    Load(entry);
+    lock.lock();
+    pending_paths_.erase(entry.path);
+    loading_ = false;
+    if (pending_.empty()) {
+      loaded_cond_.notify_all();
+    }
+  }
+  loaded_cond_.notify_all();
+}
+
+void SegmentsCache::Load(Entry entry) {
+  std::string content;
+  if (!ReadWholeFile(entry.path, entry.size, &content)) {
+    return;
+  }
+
+  struct stat sb;
+  if (stat(entry.path.c_str(), &sb) < 0 || !entry.IsValid(sb)) {  // rewritten while reading
+    return;
+  }
+
+  entry.data = std::make_shared<const std::string>(std::move(content));
+  std::lock_guard<std::mutex> lock(mutex_);
+  InsertLocked(entry);
+  if (!entry.is_segment) {
+    EvictNotInPlaylistLocked(entry.dir, *entry.data);
+  } else if (segments_per_dir_[entry.dir] > max_segments_per_channel_) {
+    EvictOldestSegmentLocked(entry.dir);
+  }
+
+  while (bytes_ > max_bytes_ && !entries_.empty()) {
+    EraseLocked(std::prev(entries_.end()));
+  }
+}
+
+void SegmentsCache::InsertLocked(const Entry& entry) {
+  auto it = index_.find(entry.path);
+  if (it != index_.end()) {  // loaded by another loop meanwhile
+    EraseLocked(it->second);
+  }
+
+  entries_.push_front(entry);
+  index_[entry.path] = entries_.begin();
+  bytes_ += entry.data->size();
+  if (entry.is_segment) {
+    segments_per_dir_[entry.dir]++;
+  }
+}
+
+void SegmentsCache::EraseLocked(entries_t::iterator it) {
+  if (it->is_segment) {
+    auto dir = segments_per_dir_.find(it->dir);
+    if (dir != segments_per_dir_.end() && --dir->second == 0) {
+      segments_per_dir_.erase(dir);
+    }
+  }
+  bytes_ -= it->data->size();
+  index_.erase(it->path);
+  entries_.erase(it);
+}
+
+void SegmentsCache::EvictNotInPlaylistLocked(const std::string& dir, const std::string& playlist) {
+  // segments are relative to playlist directory
+  std::set<std::string> actual;
+  size_t start = 0;
+  while (start < playlist.size()) {
+    size_t end = playlist.find('\n', start);
+    if (end == std::string::npos) {
+      end = playlist.size();
+    }
+    std::string line = playlist.substr(start, end - start);
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty() && line[0] != '#') {
+      actual.insert(dir + line);
+    }
+    start = end + 1;
+  }
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto cur = it++;
+    if (cur->is_segment && cur->dir == dir && actual.find(cur->path) == actual.end()) {
+      EraseLocked(cur);
+    }
+  }
+}
+
+void SegmentsCache::EvictOldestSegmentLocked(const std::string& dir) {
+  for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+    if (it->is_segment && it->dir == dir) {
+      EraseLocked(std::next(it).base());
+      return;
+    }
+  }
+}
+
+}  // namespace server
+}  // namespace fastocloud
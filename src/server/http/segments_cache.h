@@ -0,0 +1,106 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fastocloud {
+namespace server {
+
+// Shared by all serving loops of http server, keeps playlists and last segments of every channel in memory.
+// Entries are validated against inode/mtime/size, so disk stays the source of truth.
+// Files are read by own loader thread, serving loops never wait for disk.
+class SegmentsCache {
+ public:
+  enum { max_file_size = 32 * 1024 * 1024, max_pending_loads = 256 };
+  typedef std::shared_ptr<const std::string> data_t;
+
+  struct Stats {
+    Stats();
+
+    size_t hits;
+    size_t misses;
+    size_t bytes;
+    size_t entries;
+  };
+
+  SegmentsCache(size_t max_bytes, size_t max_segments_per_channel);
+  ~SegmentsCache();
+
+  bool IsEnabled() const;
+
+  // file content from memory, empty on miss or if file can't be cached,
+  // missed file is queued to loader so next requests hit
+  data_t Get(const std::string& path, const struct stat& sb);
+
+  // waits until loader has read everything queued
+  void WaitLoaded();
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    bool IsValid(const struct stat& sb) const;
+
+    std::string path;
+    std::string dir;
+    bool is_segment;
+    ino_t inode;
+    time_t mtime;
+    long mtime_nsec;
+    off_t size;
+    data_t data;
+  };
+  typedef std::list<Entry> entries_t;
+
+  void LoaderRoutine();
+  void Load(Entry entry);
+  void InsertLocked(const Entry& entry);
+  void EraseLocked(entries_t::iterator it);
+  void EvictNotInPlaylistLocked(const std::string& dir, const std::string& playlist);
+  void EvictOldestSegmentLocked(const std::string& dir);
+
+  const size_t max_bytes_;
+  const size_t max_segments_per_channel_;
+
+  mutable std::mutex mutex_;
+  entries_t entries_;  // most recently used first
+  std::unordered_map<std::string, entries_t::iterator> index_;
+  std::unordered_map<std::string, size_t> segments_per_dir_;
+  size_t bytes_;
+  size_t hits_;
+  size_t misses_;
+
+  std::deque<Entry> pending_;  // without data
+  std::unordered_set<std::string> pending_paths_;
+  bool loading_;
+  bool stop_;
+  std::condition_variable pending_cond_;
+  std::condition_variable loaded_cond_;
+  std::thread loader_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
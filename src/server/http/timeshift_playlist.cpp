@@ -0,0 +1,193 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/http/timeshift_playlist.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#define TIMESHIFT_QUERY_DELAY "delay"
+#define TIMESHIFT_QUERY_START "start"
+#define TIMESHIFT_QUERY_END "end"
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+bool ParseSeconds(const std::string& str, time_t* seconds) {
+  if (str.empty()) {
+    return false;
+  }
+
+  char* end = nullptr;
+  const long long value = strtoll(str.c_str(), &end, 10);
+  if (*end != 0 || value < 0) {
+    return false;
+  }
+  *seconds = static_cast<time_t>(value);
+  return true;
+}
+
+std::string MakeProgramDateTime(int64_t utc_msec) {
+  const time_t seconds = utc_msec / 1000;
+  struct tm info;
+#if defined(OS_WIN)
+  gmtime_s(&info, &seconds);
+#else
+  gmtime_r(&seconds, &info);
+#endif
+  char buff[32];
+  strftime(buff, sizeof(buff), "%Y-%m-%dT%H:%M:%S", &info);
+  return common::MemSPrintf("%s.%03dZ", buff, static_cast<int>(utc_msec % 1000));
+}
+
+bool IsContinuous(const stream::TimeShiftChunk& prev, const stream::TimeShiftChunk& next) {
+  const int64_t gap = next.start_time - prev.GetEndTime();
+  return next.index == prev.index + 1 && gap <= TimeShiftPlaylist::discontinuity_gap_msec;
+}
+
+}  // namespace
+
+TimeShiftPlaylistRequest::TimeShiftPlaylistRequest() : delay(0), start(0), end(0) {}
+
+bool TimeShiftPlaylistRequest::IsRange() const {
+  return start != 0;
+}
+
+std::string TimeShiftPlaylist::GetRequestQuery(const std::string& request) {
+  const std::string line = request.substr(0, request.find("\r\n"));
+  const size_t target_start = line.find(' ');
+  if (target_start == std::string::npos) {
+    return std::string();
+  }
+
+  const size_t target_end = line.find(' ', target_start + 1);
+  const std::string target = line.substr(target_start + 1, target_end - target_start - 1);
+  const size_t query_start = target.find('?');
+  if (query_start == std::string::npos) {
+    return std::string();
+  }
+  return target.substr(query_start + 1);
+}
+
+bool TimeShiftPlaylist::ParseQuery(const std::string& query, TimeShiftPlaylistRequest* request) {
+  if (!request) {
+    return false;
+  }
+
+  TimeShiftPlaylistRequest result;
+  size_t pos = 0;
+  while (pos < query.size()) {
+    size_t next = query.find('&', pos);
+    if (next == std::string::npos) {
+      next = query.size();
+    }
+
+    const std::string param = query.substr(pos, next - pos);
+    const size_t eq = param.find('=');
+    const std::string key = param.substr(0, eq);
+    const std::string value = eq == std::string::npos ? std::string() : param.substr(eq + 1);
+    if (key == TIMESHIFT_QUERY_DELAY) {
+      if (!ParseSeconds(value, &result.delay)) {
+        return false;
+      }
+    } else if (key == TIMESHIFT_QUERY_START) {
+      if (!ParseSeconds(value, &result.start) || result.start == 0) {
+        return false;
+      }
+    } else if (key == TIMESHIFT_QUERY_END) {
+      if (!ParseSeconds(value, &result.end)) {
+        return false;
+      }
+    }
+    pos = next + 1;
+  }
+
+  if (result.end != 0 && result.end <= result.start) {
+    return false;
+  }
+
+  *request = result;
+  return true;
+}
+
+bool TimeShiftPlaylist::Make(const stream::TimeShiftIndex& index,
+                             const TimeShiftPlaylistRequest& request,
+                             int64_t now_msec,
+                             std::string* playlist) {
+  if (!playlist) {
+    return false;
+  }
+
+  std::vector<stream::TimeShiftChunk> chunks;
+  if (request.IsRange()) {
+    const int64_t from = static_cast<int64_t>(request.start) * 1000;
+    const int64_t to = request.end ? static_cast<int64_t>(request.end) * 1000 : std::numeric_limits<int64_t>::max();
+    if (!index.GetChunks(from, to, max_range_chunks, &chunks)) {
+      return false;
+    }
+  } else if (!index.GetChunksBefore(now_msec - static_cast<int64_t>(request.delay) * 1000, window_chunks, &chunks)) {
+    return false;
+  }
+
+  if (chunks.empty()) {
+    return false;
+  }
+
+  int64_t max_duration = 0;
+  for (const auto& chunk : chunks) {
+    max_duration = std::max(max_duration, chunk.duration);
+  }
+
+  std::string result = "#EXTM3U\n#EXT-X-VERSION:3\n";
+  result += common::MemSPrintf("#EXT-X-TARGETDURATION:%lld\n", static_cast<long long>((max_duration + 999) / 1000));
+  result += common::MemSPrintf("#EXT-X-MEDIA-SEQUENCE:%llu\n", static_cast<unsigned long long>(chunks[0].index));
+  bool closed = false;
+  if (request.IsRange()) {
+    const int64_t end = static_cast<int64_t>(request.end) * 1000;
+    closed = chunks.size() == static_cast<size_t>(max_range_chunks) ||
+             (request.end && (chunks.back().GetEndTime() >= end || now_msec - end > closed_range_lag_msec));
+    result += closed ? "#EXT-X-PLAYLIST-TYPE:VOD\n" : "#EXT-X-PLAYLIST-TYPE:EVENT\n";
+  }
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const stream::TimeShiftChunk& chunk = chunks[i];
+    if (i != 0 && !IsContinuous(chunks[i - 1], chunk)) {
+      result += "#EXT-X-DISCONTINUITY\n";
+    }
+    if (i == 0 || !IsContinuous(chunks[i - 1], chunk)) {
+      result += "#EXT-X-PROGRAM-DATE-TIME:" + MakeProgramDateTime(chunk.start_time) + "\n";
+    }
+    result += common::MemSPrintf(M3U8_CHUNK_MARKER ":%.3f,\n", chunk.duration / 1000.0);
+    result += common::MemSPrintf("%llu" CHUNK_EXT "\n", static_cast<unsigned long long>(chunk.index));
+  }
+
+  if (closed) {
+    result += "#EXT-X-ENDLIST\n";
+  }
+
+  *playlist = result;
+  return true;
+}
+
+}  // namespace server
+}  // namespace fastocloud
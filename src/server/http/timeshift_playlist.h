@@ -0,0 +1,57 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "stream/timeshift_index.h"
+
+namespace fastocloud {
+namespace server {
+
+// HLS playlist over the recorder archive, chunks are referenced as written by the recorder:
+// ?delay=<sec> - sliding window behind live edge, ?start=<utc sec>[&end=<utc sec>] - absolute range
+struct TimeShiftPlaylistRequest {
+  TimeShiftPlaylistRequest();
+
+  bool IsRange() const;
+
+  time_t delay;
+  time_t start;  // 0 for sliding window
+  time_t end;    // 0 if range is open
+};
+
+class TimeShiftPlaylist {
+ public:
+  enum {
+    window_chunks = 5,
+    max_range_chunks = 720,  // longer range is cut, cut range is closed once all its chunks are recorded
+    discontinuity_gap_msec = 1000,
+    closed_range_lag_msec = 60000  // range end this far in past gets ENDLIST even if archive has a hole
+  };
+
+  // query part of raw request line, empty if none
+  static std::string GetRequestQuery(const std::string& request);
+  static bool ParseQuery(const std::string& query, TimeShiftPlaylistRequest* request) WARN_UNUSED_RESULT;
+
+  // false if archive has no chunks for request
+  static bool Make(const stream::TimeShiftIndex& index,
+                   const TimeShiftPlaylistRequest& request,
+                   int64_t now_msec,
+                   std::string* playlist) WARN_UNUSED_RESULT;
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -26,6 +26,7 @@
 #include "base/config_fields.h"
 #include "base/gst_constants.h"
 #include "base/types.h"
+#include "base/vod_range.h"
 
 namespace fastocloud {
 
@@ -210,6 +211,28 @@ Validity validate_auto_exit_time(const common::Value* value) {
   return validate_is_positive(value, false);
 }
 
+Validity validate_stall_timeout(const common::Value* value) {
+  return validate_range(value, 0, 60 * 1000, false);  // msec, 0 disables stall detection
+}
+
+Validity validate_startup_trace(const common::Value* value) {
+  bool trace;
+  if (!value->GetAsBoolean(&trace)) {
+    return Validity::INVALID;
+  }
+
+  return Validity::VALID;
+}
+
+Validity validate_trace_elements(const common::Value* value) {
+  bool trace;
+  if (!value->GetAsBoolean(&trace)) {
+    return Validity::INVALID;
+  }
+
+  return Validity::VALID;
+}
+
 Validity validate_size(const common::Value* value) {
   std::string size_str;
   if (!value->GetAsBasicString(&size_str)) {
@@ -229,6 +252,29 @@ Validity validate_cleanupts(const common::Value* value) {
   return Validity::VALID;
 }
 
+Validity validate_vod_workers(const common::Value* value) {
+  return validate_range(value, 1, 64, false);
+}
+
+Validity validate_vod_range(const common::Value* value) {
+  std::string range_str;
+  if (!value->GetAsBasicString(&range_str)) {
+    return Validity::INVALID;
+  }
+
+  VodRange range;
+  return common::ConvertFromString(range_str, &range) ? Validity::VALID : Validity::INVALID;
+}
+
+Validity validate_vod_jit(const common::Value* value) {
+  bool jit;
+  if (!value->GetAsBoolean(&jit)) {
+    return Validity::INVALID;
+  }
+
+  return Validity::VALID;
+}
+
 Validity validate_framerate(const common::Value* value) {
   return validate_is_positive(value, false);
 }
@@ -251,6 +297,23 @@ Validity validate_video_bitrate(const common::Value* value) {
   return validate_is_positive(value, false);
 }
 
+Validity validate_renditions(const common::Value* value) {
+  const common::ArrayValue* renditions = nullptr;
+  if (!value->GetAsList(&renditions)) {
+    return Validity::INVALID;
+  }
+
+  for (size_t i = 0; i < renditions->GetSize(); ++i) {
+    const common::Value* rendition = nullptr;
+    const common::HashValue* rendition_hash = nullptr;
+    if (!renditions->Get(i, &rendition) || !rendition->GetAsHash(&rendition_hash)) {
+      return Validity::INVALID;
+    }
+  }
+
+  return Validity::VALID;
+}
+
 Validity validate_audio_bitrate(const common::Value* value) {
   return validate_is_positive(value, false);
 }
@@ -438,6 +501,9 @@ bool FindOption(const std::string& key, option_t* opt) {
     {OUTPUT_FIELD, validate_output},
     {RESTART_ATTEMPTS_FIELD, validate_restart_attempts},
     {AUTO_EXIT_TIME_FIELD, validate_auto_exit_time},
+    {STALL_TIMEOUT_FIELD, validate_stall_timeout},
+    {STARTUP_TRACE_FIELD, validate_startup_trace},
+    {TRACE_ELEMENTS_FIELD, validate_trace_elements},
     {TIMESHIFT_DIR_FIELD, validate_timeshift_dir},
     {TIMESHIFT_CHUNK_LIFE_TIME_FIELD, validate_timeshift_chunk_life_time},
     {TIMESHIFT_DELAY_FIELD, validate_timeshift_delay},
@@ -455,15 +521,21 @@ bool FindOption(const std::string& key, option_t* opt) {
     {DEINTERLACE_FIELD, dont_validate},
     {RELAY_AUDIO_FIELD, dont_validate},
     {RELAY_VIDEO_FIELD, dont_validate},
+    {HOT_SWAP_FIELD, dont_validate},
+    {INPUT_REDUNDANCY_FIELD, dont_validate},
     {LOOP_FIELD, dont_validate},
     {AVFORMAT_FIELD, dont_validate},
     {SIZE_FIELD, validate_size},
     {CLEANUP_TS_FIELD, validate_cleanupts},
+    {VOD_WORKERS_FIELD, validate_vod_workers},
+    {VOD_RANGE_FIELD, validate_vod_range},
+    {VOD_JIT_FIELD, validate_vod_jit},
     {LOGO_FIELD, dont_validate},
     {FRAME_RATE_FIELD, validate_framerate},
     {ASPECT_RATIO_FIELD, validate_aspect_ratio},
     {VIDEO_BIT_RATE_FIELD, validate_video_bitrate},
     {AUDIO_BIT_RATE_FIELD, validate_audio_bitrate},
+    {RENDITIONS_FIELD, validate_renditions},
     {AUDIO_CHANNELS_FIELD, validate_audio_channels},
     {AUDIO_SELECT_FIELD, validate_audio_select},
     {DECKLINK_VIDEO_MODE_FIELD, validate_decklink_video_mode},
@@ -14,6 +14,7 @@
 
 #include "server/process_slave_wrapper.h"
 
+#include <fstream>
 #include <string>
 #include <thread>
 #include <utility>
@@ -32,7 +33,9 @@
 
 #include "gpu_stats/perf_monitor.h"
 
+#include "server/base/workers_pool.h"
 #include "server/child_stream.h"
+#include "server/cpu_placement.h"
 #include "server/daemon/client.h"
 #include "server/daemon/commands.h"
 #include "server/daemon/commands_info/service/activate_info.h"
@@ -46,16 +49,19 @@
 #include "server/daemon/commands_info/stream/start_info.h"
 #include "server/daemon/commands_info/stream/stop_info.h"
 #include "server/daemon/server.h"
+#include "server/daemon/statistics_aggregator.h"
 #include "server/http/handler.h"
 #include "server/http/server.h"
 #include "server/options/options.h"
 #include "server/vods/handler.h"
 #include "server/vods/server.h"
+#include "server/vods/vod_jit.h"
+#include "server/vods/vod_jit_segments.h"
+#include "server/vods/vod_split_job.h"
+#include "server/vods/vods_completeness.h"
 
 #include "stream_commands/commands.h"
 
-#include "utils/m3u8_reader.h"
-
 #if defined(OS_WIN)
 #undef SetPort
 #endif
@@ -103,6 +109,12 @@ common::Optional<common::file_system::ascii_file_string_path> MakeStreamPipeline
   return dir.MakeFileStringPath(DUMP_FILE_NAME);
 }
 
+common::Optional<common::file_system::ascii_file_string_path> MakeStreamStartupTracePath(
+    const std::string& feedback_dir) {
+  common::file_system::ascii_directory_string_path dir(feedback_dir);
+  return dir.MakeFileStringPath(STARTUP_TRACE_FILE_NAME);
+}
+
 common::Error PostHttpFile(const common::file_system::ascii_file_string_path& file_path, const common::uri::Url& url) {
   common::net::HostAndPort http_server_address;
   if (!GetPostServerFromUrl(url, &http_server_address)) {
@@ -145,28 +157,6 @@ namespace server {
 namespace {
 typedef VodsHandler CodsHandler;
 typedef VodsServer CodsServer;
-
-bool CheckIsFullVod(const common::file_system::ascii_file_string_path& file) {
-  utils::M3u8Reader reader;
-  if (!reader.Parse(file)) {
-    return false;
-  }
-
-  common::file_system::ascii_directory_string_path dir(file.GetDirectory());
-  const auto chunks = reader.GetChunks();
-  for (const utils::ChunkInfo& chunk : chunks) {
-    const auto chunk_path = dir.MakeFileStringPath(chunk.path);
-    if (!chunk_path) {
-      return false;
-    }
-
-    if (!common::file_system::is_file_exist(chunk_path->GetPath())) {
-      return false;
-    }
-  }
-
-  return true;
-}
 }  // namespace
 
 struct ProcessSlaveWrapper::NodeStats {
@@ -184,33 +174,66 @@ ProcessSlaveWrapper::ProcessSlaveWrapper(const std::string& license_key, const C
       process_argc_(0),
       process_argv_(nullptr),
       loop_(nullptr),
+      zygote_(nullptr),
       http_server_(nullptr),
       http_handler_(nullptr),
+      http_workers_(nullptr),
       vods_server_(nullptr),
       vods_handler_(nullptr),
+      vods_workers_(nullptr),
       cods_server_(nullptr),
       cods_handler_(nullptr),
+      cods_workers_(nullptr),
       ping_client_timer_(INVALID_TIMER_ID),
       node_stats_timer_(INVALID_TIMER_ID),
+      stream_stats_timer_(INVALID_TIMER_ID),
       cleanup_files_timer_(INVALID_TIMER_ID),
       quit_cleanup_timer_(INVALID_TIMER_ID),
+      placement_timer_(INVALID_TIMER_ID),
       node_stats_(new NodeStats),
+      streams_stats_(new StatisticsAggregator),
+      vods_states_(new VodsCompleteness),
+      placement_(nullptr),
       vods_links_(),
-      cods_links_() {
+      cods_links_(),
+      vod_jobs_(),
+      vod_jits_(),
+      vod_jit_segments_(new VodJitSegments(config.vods_jit_cache_size * 1024 * 1024)),
+      jit_roots_mutex_(),
+      jit_roots_() {
   loop_ = new DaemonServer(config.host, this);
   loop_->SetName("client_server");
 
-  http_handler_ = new HttpHandler(this);
+  // listener loop serves too, so workers are extra loops
+  const size_t workers_count = config.http_workers ? config.http_workers - 1 : 0;
+
+  HttpHandler* http_handler =
+      new HttpHandler(this, config.http_cache_size * 1024 * 1024, config.http_cache_segments);
+  http_workers_ = new base::WorkersPool(workers_count, http_handler, "http_server");
+  http_handler->SetWorkersPool(http_workers_);
+  http_handler_ = http_handler;
   http_server_ = new HttpServer(config.http_host, http_handler_);
   http_server_->SetName("http_server");
 
-  vods_handler_ = new VodsHandler(this);
+  VodsHandler* vods_handler = new VodsHandler(this);
+  vods_workers_ = new base::WorkersPool(workers_count, vods_handler, "vods_server");
+  vods_handler->SetWorkersPool(vods_workers_);
+  vods_handler->SetWaitGeneratedFileTimeout(config.vods_jit_wait_timeout);
+  vods_handler_ = vods_handler;
   vods_server_ = new VodsServer(config.vods_host, vods_handler_);
   vods_server_->SetName("vods_server");
 
-  cods_handler_ = new CodsHandler(this);
+  CodsHandler* cods_handler = new CodsHandler(this);
+  cods_workers_ = new base::WorkersPool(workers_count, cods_handler, "cods_server");
+  cods_handler->SetWorkersPool(cods_workers_);
+  cods_handler->SetWaitFileTimeout(config.cods_wait_timeout);
+  cods_handler_ = cods_handler;
   cods_server_ = new CodsServer(config.cods_host, cods_handler_);
   cods_server_->SetName("cods_server");
+
+  if (config.cpu_placement) {
+    placement_ = new CpuPlacement(CpuPlacement::DetectTopology());
+  }
 }
 
 int ProcessSlaveWrapper::SendStopDaemonRequest(const std::string& license) {
@@ -236,19 +259,35 @@ int ProcessSlaveWrapper::SendStopDaemonRequest(const std::string& license) {
 }
 
 ProcessSlaveWrapper::~ProcessSlaveWrapper() {
+  for (auto it = vod_jobs_.begin(); it != vod_jobs_.end(); ++it) {
+    delete it->second;
+  }
+  vod_jobs_.clear();
+  for (auto it = vod_jits_.begin(); it != vod_jits_.end(); ++it) {
+    delete it->second;
+  }
+  vod_jits_.clear();
+  destroy(&vod_jit_segments_);
+  destroy(&cods_workers_);
   destroy(&cods_server_);
   destroy(&cods_handler_);
+  destroy(&vods_workers_);
   destroy(&vods_server_);
   destroy(&vods_handler_);
+  destroy(&http_workers_);
   destroy(&http_server_);
   destroy(&http_handler_);
   destroy(&loop_);
+  destroy(&placement_);
+  destroy(&vods_states_);
+  destroy(&streams_stats_);
   destroy(&node_stats_);
 }
 
 int ProcessSlaveWrapper::Exec(int argc, char** argv) {
   process_argc_ = argc;
   process_argv_ = argv;
+  StartZygote();  // before any thread started
 
   // gpu statistic monitor
   std::thread perf_thread;
@@ -257,6 +296,10 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
     perf_thread = std::thread([perf_monitor] { perf_monitor->Exec(); });
   }
 
+  http_workers_->Start();
+  vods_workers_->Start();
+  cods_workers_->Start();
+
   HttpServer* http_server = static_cast<HttpServer*>(http_server_);
   std::thread http_thread = std::thread([http_server] {
     common::ErrnoError err = http_server->Bind(true);
@@ -335,6 +378,9 @@ finished:
   vods_thread.join();
   cods_thread.join();
   http_thread.join();
+  cods_workers_->Join();
+  vods_workers_->Join();
+  http_workers_->Join();
   if (perf_monitor) {
     perf_monitor->Stop();
   }
@@ -342,13 +388,18 @@ finished:
     perf_thread.join();
   }
   delete perf_monitor;
+  StopZygote();
   return res;
 }
 
 void ProcessSlaveWrapper::PreLooped(common::libev::IoLoop* server) {
   ping_client_timer_ = server->CreateTimer(ping_timeout_clients_seconds, true);
   node_stats_timer_ = server->CreateTimer(node_stats_send_seconds, true);
+  stream_stats_timer_ = server->CreateTimer(stream_stats_send_seconds, true);
   cleanup_files_timer_ = server->CreateTimer(config_.ttl_files, true);
+  if (placement_) {
+    placement_timer_ = server->CreateTimer(placement_rebalance_seconds, true);
+  }
 }
 
 void ProcessSlaveWrapper::Accepted(common::libev::IoClient* client) {
@@ -391,13 +442,22 @@ void ProcessSlaveWrapper::TimerEmited(common::libev::IoLoop* server, common::lib
     }
 
     BroadcastClients(req);
+  } else if (stream_stats_timer_ == id) {
+    BroadcastStreamsStatistic();
+    KillStaleZygoteStreams();
   } else if (cleanup_files_timer_ == id) {
     for (auto it = vods_links_.begin(); it != vods_links_.end(); ++it) {
       RemoveFilesByExtension((*it).first, CHUNK_EXT);
+      vods_states_->OnChunksRemoved((*it).first);
     }
+  } else if (placement_timer_ == id) {
+    placement_->Rebalance();
   } else if (quit_cleanup_timer_ == id) {
+    vods_workers_->Stop();
     vods_server_->Stop();
+    cods_workers_->Stop();
     cods_server_->Stop();
+    http_workers_->Stop();
     http_server_->Stop();
     loop_->Stop();
   }
@@ -420,9 +480,22 @@ void ProcessSlaveWrapper::ChildStatusChanged(common::libev::IoChild* child, int
              << ", exit with status: " << (status ? "FAILURE" : "SUCCESS") << ", signal: " << signal;
 
   loop_->UnRegisterChild(child);
+  streams_stats_->Remove(sid);
+  vods_states_->OnStreamExited(sid);
+  if (placement_) {
+    placement_->Remove(sid);
+  }
 
   delete channel;
 
+  if (HandleVodSplitChildExited(sid, status, signal) || HandleVodJitChildExited(sid, status, signal)) {
+    return;
+  }
+
+  BroadcastQuitStatus(sid, status, signal);
+}
+
+void ProcessSlaveWrapper::BroadcastQuitStatus(stream_id_t sid, int status, int signal) {
   stream::QuitStatusInfo ch_status_info(sid, status, signal);
   fastotv::protocol::request_t req;
   common::Error err_ser = QuitStatusStreamBroadcast(ch_status_info, &req);
@@ -433,6 +506,248 @@ void ProcessSlaveWrapper::ChildStatusChanged(common::libev::IoChild* child, int
   BroadcastClients(req);
 }
 
+bool ProcessSlaveWrapper::HandleVodSplitChildExited(stream_id_t sid, int status, int signal) {
+  const bool success = status == EXIT_SUCCESS && !signal;
+  auto it = vod_jobs_.find(sid);
+  if (it != vod_jobs_.end()) {
+    // planner exited, ranges are ready if it succeeded
+    VodSplitJob* job = it->second;
+    if (success && !job->IsCancelled() && job->LoadRanges()) {
+      INFO_LOG() << "Vod " << sid << " splitted into " << job->GetRanges().size() << " ranges, workers: "
+                 << job->GetWorkersCount();
+      job->QueueAllRanges();
+      vods_states_->OnStreamStarted(sid);
+      RunVodSplitJob(job);
+      if (job->IsFinished()) {
+        FinishVodSplitJob(job);
+      }
+      return true;
+    }
+
+    // encoded by planner itself or failed
+    vod_jobs_.erase(it);
+    delete job;
+    return false;
+  }
+
+  for (auto jt = vod_jobs_.begin(); jt != vod_jobs_.end(); ++jt) {
+    VodSplitJob* job = jt->second;
+    if (job->OnWorkerExited(sid, success)) {
+      RunVodSplitJob(job);
+      if (job->IsFinished()) {
+        FinishVodSplitJob(job);
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+common::ErrnoError ProcessSlaveWrapper::StartVodSplitJob(const serialized_stream_t& config_args,
+                                                         stream_id_t sid,
+                                                         size_t workers) {
+  VodSplitJob* job = new VodSplitJob(sid, config_args, workers);
+  if (!job->LoadRanges()) {
+    // not splitted yet, stream process probes keyframes and exits
+    common::ErrnoError err = CreateChildStreamImpl(config_args, sid, VOD_ENCODE);
+    if (err) {
+      delete job;
+      return err;
+    }
+
+    vod_jobs_[sid] = job;
+    return common::ErrnoError();
+  }
+
+  // vod was splitted before, encode only ranges with missing chunks
+  vod_jobs_[sid] = job;
+  INFO_LOG() << "Vod " << sid << " ranges to encode: " << job->QueueMissingRanges();
+  vods_states_->OnStreamStarted(sid);
+  RunVodSplitJob(job);
+  if (job->IsFinished()) {
+    FinishVodSplitJob(job);
+  }
+  return common::ErrnoError();
+}
+
+void ProcessSlaveWrapper::RunVodSplitJob(VodSplitJob* job) {
+  if (quit_cleanup_timer_ != INVALID_TIMER_ID) {  // service is stopping, workers are not restarted
+    job->Cancel();
+    return;
+  }
+
+  stream_id_t wid;
+  serialized_stream_t wconfig;
+  while (job->TakeRange(&wid, &wconfig)) {
+    common::ErrnoError err = wconfig ? CreateChildStream(wconfig) : common::make_errno_error_inval();
+    if (err) {
+      WARNING_LOG() << "Can't start vod worker " << wid << ", error: " << err->GetDescription();
+      ignore_result(job->OnWorkerExited(wid, false));
+    }
+  }
+}
+
+void ProcessSlaveWrapper::FinishVodSplitJob(VodSplitJob* job) {
+  const stream_id_t sid = job->GetID();
+  int status = EXIT_SUCCESS;
+  if (job->IsCancelled() || job->IsFailed()) {
+    status = EXIT_FAILURE;
+  } else {
+    common::ErrnoError err = job->StitchPlaylists();
+    if (err) {
+      WARNING_LOG() << "Can't stitch playlists of vod " << sid << ", error: " << err->GetDescription();
+      status = EXIT_FAILURE;
+    }
+  }
+
+  vod_jobs_.erase(sid);
+  delete job;
+  vods_states_->OnStreamExited(sid);
+  BroadcastQuitStatus(sid, status, 0);
+}
+
+void ProcessSlaveWrapper::AddVodJit(const serialized_stream_t& config_args, stream_id_t sid) {
+  if (vod_jits_.find(sid) != vod_jits_.end()) {  // kept with running workers after sync
+    return;
+  }
+
+  VodJit* jit = new VodJit(sid, config_args, config_.vods_jit_prefetch);
+  if (jit->LoadIndex()) {
+    common::ErrnoError err = jit->WritePlaylists();
+    if (err) {
+      WARNING_LOG() << "Can't write playlist of vod " << sid << ", error: " << err->GetDescription();
+    }
+
+    for (const VodJit::Segment& segment : jit->GetReadySegments()) {
+      for (const std::string& evicted : vod_jit_segments_->Add(segment.path, segment.size)) {
+        ignore_result(common::file_system::remove_file(evicted));
+      }
+    }
+  }
+
+  vod_jits_[sid] = jit;
+  std::lock_guard<std::mutex> lock(jit_roots_mutex_);
+  for (const VodSplitJob::Output& output : VodSplitJob::GetOutputs(config_args)) {
+    jit_roots_.insert(output.http_root.GetPath());
+  }
+}
+
+void ProcessSlaveWrapper::RemoveVodJit(stream_id_t sid) {
+  auto it = vod_jits_.find(sid);
+  if (it == vod_jits_.end()) {
+    return;
+  }
+
+  VodJit* jit = it->second;
+  for (const stream_id_t& wid : jit->GetRunningWorkers()) {
+    Child* worker = FindChildByID(wid);
+    if (worker) {
+      ignore_result(worker->Stop());
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(jit_roots_mutex_);
+    for (const VodSplitJob::Output& output : VodSplitJob::GetOutputs(jit->GetConfig())) {
+      jit_roots_.erase(output.http_root.GetPath());
+    }
+  }
+  vod_jits_.erase(it);
+  delete jit;
+}
+
+VodJit* ProcessSlaveWrapper::FindVodJit(const common::file_system::ascii_directory_string_path& http_root) const {
+  for (auto it = vod_jits_.begin(); it != vod_jits_.end(); ++it) {
+    if (it->second->HasHttpRoot(http_root)) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+void ProcessSlaveWrapper::HandleVodJitRequest(const file_path_t& file) {
+  CHECK(loop_->IsLoopThread());
+  VodJit* jit = FindVodJit(common::file_system::ascii_directory_string_path(file.GetDirectory()));
+  if (!jit) {
+    return;
+  }
+
+  if (!jit->IsIndexed()) {
+    if (jit->IsIndexing()) {
+      return;
+    }
+
+    // first request, playlist is written from index after indexer exit
+    common::ErrnoError err = CreateChildStream(jit->GetConfig());
+    if (err) {
+      WARNING_LOG() << "Can't index vod " << jit->GetID() << ", error: " << err->GetDescription();
+      return;
+    }
+    jit->SetIndexing(true);
+    return;
+  }
+
+  size_t index;
+  if (!ParseVodJitSegmentName(file.GetFileName(), &index)) {
+    return;
+  }
+
+  vod_jit_segments_->Touch(file.GetPath());
+  if (jit->Request(index)) {
+    RunVodJit(jit);
+  }
+}
+
+void ProcessSlaveWrapper::RunVodJit(VodJit* jit) {
+  if (quit_cleanup_timer_ != INVALID_TIMER_ID) {  // service is stopping
+    return;
+  }
+
+  stream_id_t wid;
+  serialized_stream_t wconfig;
+  while (jit->TakeSegment(&wid, &wconfig)) {
+    common::ErrnoError err = wconfig ? CreateChildStream(wconfig) : common::make_errno_error_inval();
+    if (err) {
+      WARNING_LOG() << "Can't start vod worker " << wid << ", error: " << err->GetDescription();
+      ignore_result(jit->OnWorkerExited(wid, false, nullptr));
+    }
+  }
+}
+
+bool ProcessSlaveWrapper::HandleVodJitChildExited(stream_id_t sid, int status, int signal) {
+  const bool success = status == EXIT_SUCCESS && !signal;
+  auto it = vod_jits_.find(sid);
+  if (it != vod_jits_.end()) {
+    // indexer exited, its own status is broadcasted
+    VodJit* jit = it->second;
+    jit->SetIndexing(false);
+    if (success && jit->LoadIndex()) {
+      common::ErrnoError err = jit->WritePlaylists();
+      if (err) {
+        WARNING_LOG() << "Can't write playlist of vod " << sid << ", error: " << err->GetDescription();
+      }
+    }
+    return false;
+  }
+
+  for (auto jt = vod_jits_.begin(); jt != vod_jits_.end(); ++jt) {
+    VodJit* jit = jt->second;
+    VodJit::segments_t segments;
+    if (jit->OnWorkerExited(sid, success, &segments)) {
+      for (const VodJit::Segment& segment : segments) {
+        for (const std::string& evicted : vod_jit_segments_->Add(segment.path, segment.size)) {
+          ignore_result(common::file_system::remove_file(evicted));
+        }
+      }
+      RunVodJit(jit);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 Child* ProcessSlaveWrapper::FindChildByID(stream_id_t cid) const {
   DaemonServer* server = static_cast<DaemonServer*>(loop_);
   auto childs = server->GetChilds();
@@ -446,6 +761,14 @@ Child* ProcessSlaveWrapper::FindChildByID(stream_id_t cid) const {
   return nullptr;
 }
 
+bool ProcessSlaveWrapper::IsVodsLoop(const common::libev::IoLoop* server) const {
+  return server == vods_server_ || vods_workers_->IsWorkerLoop(server);
+}
+
+bool ProcessSlaveWrapper::IsCodsLoop(const common::libev::IoLoop* server) const {
+  return server == cods_server_ || cods_workers_->IsWorkerLoop(server);
+}
+
 void ProcessSlaveWrapper::BroadcastClients(const fastotv::protocol::request_t& req) {
   std::vector<common::libev::IoClient*> clients = loop_->GetClients();
   for (size_t i = 0; i < clients.size(); ++i) {
@@ -459,6 +782,52 @@ void ProcessSlaveWrapper::BroadcastClients(const fastotv::protocol::request_t& r
   }
 }
 
+void ProcessSlaveWrapper::BroadcastStreamsStatistic() {
+  DaemonServer* server = static_cast<DaemonServer*>(loop_);
+  auto childs = server->GetChilds();
+  for (auto* child : childs) {
+    ChildStream* channel = static_cast<ChildStream*>(child);
+    StatisticInfo statistic;
+    if (channel->ReadChangedStatistic(&statistic)) {
+      streams_stats_->Update(statistic);
+      if (placement_) {
+        placement_->UpdateLoad(statistic.GetStreamStruct().id, statistic.GetCpuLoad() / 100);
+      }
+    }
+  }
+
+  std::string params;
+  if (!streams_stats_->MakeTickBroadcast(&params)) {
+    return;
+  }
+
+  fastotv::protocol::request_t req;
+  common::Error err_ser = StatisitcStreamsBroadcast(params, &req);
+  if (err_ser) {
+    return;
+  }
+
+  BroadcastClients(req);
+}
+
+void ProcessSlaveWrapper::SendStreamsStatisticSnapshot(ProtocoledDaemonClient* dclient) {
+  std::string params;
+  if (!streams_stats_->MakeSnapshot(&params)) {
+    return;
+  }
+
+  fastotv::protocol::request_t req;
+  common::Error err_ser = StatisitcStreamsBroadcast(params, &req);
+  if (err_ser) {
+    return;
+  }
+
+  common::ErrnoError err = dclient->WriteRequest(req);
+  if (err) {
+    WARNING_LOG() << "Send streams statistic snapshot error: " << err->GetDescription();
+  }
+}
+
 common::ErrnoError ProcessSlaveWrapper::DaemonDataReceived(ProtocoledDaemonClient* dclient) {
   CHECK(loop_->IsLoopThread());
   std::string input_command;
@@ -584,27 +953,44 @@ void ProcessSlaveWrapper::PostLooped(common::libev::IoLoop* server) {
     server->RemoveTimer(node_stats_timer_);
     node_stats_timer_ = INVALID_TIMER_ID;
   }
+
+  if (stream_stats_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(stream_stats_timer_);
+    stream_stats_timer_ = INVALID_TIMER_ID;
+  }
+
+  if (placement_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(placement_timer_);
+    placement_timer_ = INVALID_TIMER_ID;
+  }
 }
 
 void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client, const file_path_t& file) {
-  if (client->GetServer() == vods_server_) {
+  const common::libev::IoLoop* server = client->GetServer();
+  if (IsVodsLoop(server)) {
+    if (IsGeneratedOnDemand(file)) {
+      loop_->ExecInLoopThread([this, file]() { HandleVodJitRequest(file); });
+      return;
+    }
+
     const std::string ext = file.GetExtension();
     if (common::EqualsASCII(ext, M3U8_EXTENSION, false)) {
       loop_->ExecInLoopThread([this, file]() {
+        if (vods_states_->GetState(file) != VodsCompleteness::MISSING_CHUNKS) {
+          return;
+        }
+
         const common::file_system::ascii_directory_string_path http_root(file.GetDirectory());
         auto it = vods_links_.find(http_root);
         if (it == vods_links_.end()) {
           return;
         }
 
-        bool is_full_vod = CheckIsFullVod(file);
-        if (!is_full_vod) {
-          const serialized_stream_t config = it->second;
-          CreateChildStream(config);
-        }
+        const serialized_stream_t config = it->second;
+        CreateChildStream(config);
       });
     }
-  } else if (client->GetServer() == cods_server_) {
+  } else if (IsCodsLoop(server)) {
     const std::string ext = file.GetExtension();
     if (common::EqualsASCII(ext, M3U8_EXTENSION, false)) {
       loop_->ExecInLoopThread([this, file]() {
@@ -617,14 +1003,22 @@ void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client,
         const serialized_stream_t config = it->second;
         CreateChildStream(config);
       });
-
-      if (!common::file_system::is_file_exist(file.GetPath())) {
-        sleep(5);  // may be fix :)
-      }
     }
   }
 }
 
+bool ProcessSlaveWrapper::IsGeneratedOnDemand(const file_path_t& file) {
+  size_t index;
+  if (!common::EqualsASCII(file.GetExtension(), M3U8_EXTENSION, false) &&
+      !ParseVodJitSegmentName(file.GetFileName(), &index)) {
+    return false;
+  }
+
+  const common::file_system::ascii_directory_string_path http_root(file.GetDirectory());
+  std::lock_guard<std::mutex> lock(jit_roots_mutex_);
+  return jit_roots_.find(http_root.GetPath()) != jit_roots_.end();
+}
+
 common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStopService(ProtocoledDaemonClient* dclient,
                                                                        fastotv::protocol::request_t* req) {
   CHECK(loop_->IsLoopThread());
@@ -692,6 +1086,8 @@ common::ErrnoError ProcessSlaveWrapper::HandleResponcePingService(ProtocoledDaem
 
 common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_stream_t& config_args) {
   CHECK(loop_->IsLoopThread());
+  StartupTiming startup;
+  startup.Mark(STARTUP_REQUESTED);
   common::ErrnoError err = options::ValidateConfig(config_args);
   if (err) {
     return err;
@@ -711,8 +1107,47 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
     return common::make_errno_error(common::MemSPrintf("Stream with id: %s exist, skip request.", sha.id), EINVAL);
   }
 
+  if (vod_jobs_.find(sha.id) != vod_jobs_.end()) {
+    NOTICE_LOG() << "Skip request to start vod id: " << sha.id;
+    return common::make_errno_error(common::MemSPrintf("Vod with id: %s is encoding, skip request.", sha.id), EINVAL);
+  }
+
   config_args->Insert(STREAM_LINK_PATH, common::Value::CreateStringValueFromBasicString(config_.streamlink_path));
-  return CreateChildStreamImpl(config_args, sha.id);
+  if (sha.type == VOD_ENCODE) {
+    const size_t workers = VodSplitJob::GetWorkers(config_args);
+    if (workers > 1) {
+      return StartVodSplitJob(config_args, sha.id, workers);
+    }
+  }
+
+  err = StartChildStream(config_args, sha.id, sha.type);
+  if (err) {
+    return err;
+  }
+
+  ChildStream* child = static_cast<ChildStream*>(FindChildByID(sha.id));
+  if (child) {
+    child->SetStartupTiming(startup);
+    bool startup_trace = false;
+    common::Value* startup_trace_field = config_args->Find(STARTUP_TRACE_FIELD);
+    const auto trace_path = MakeStreamStartupTracePath(feedback_dir);
+    if (startup_trace_field && startup_trace_field->GetAsBoolean(&startup_trace) && startup_trace && trace_path) {
+      child->SetStartupTracePath(trace_path->GetPath());
+    }
+  }
+  return common::ErrnoError();
+}
+
+common::ErrnoError ProcessSlaveWrapper::StartChildStream(const serialized_stream_t& config_args,
+                                                         stream_id_t sid,
+                                                         StreamType type) {
+  common::ErrnoError err = CreateChildStreamImpl(config_args, sid, type);
+  if (err) {
+    return err;
+  }
+
+  vods_states_->OnStreamStarted(sid);
+  return common::ErrnoError();
 }
 
 common::ErrnoError ProcessSlaveWrapper::HandleRequestChangedSourcesStream(stream_client_t* pclient,
@@ -748,6 +1183,102 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestChangedSourcesStream(stream
   return common::make_errno_error_inval();
 }
 
+common::ErrnoError ProcessSlaveWrapper::HandleRequestInputStallStream(stream_client_t* pclient,
+                                                                      fastotv::protocol::request_t* req) {
+  UNUSED(pclient);
+  CHECK(loop_->IsLoopThread());
+  if (req->params) {
+    const char* params_ptr = req->params->c_str();
+    json_object* jrequest_stall = json_tokener_parse(params_ptr);
+    if (!jrequest_stall) {
+      return common::make_errno_error_inval();
+    }
+
+    InputStallInfo stall_info;
+    common::Error err_des = stall_info.DeSerialize(jrequest_stall);
+    json_object_put(jrequest_stall);
+    if (err_des) {
+      const std::string err_str = err_des->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    if (stall_info.IsRecovered()) {
+      INFO_LOG() << "Stream id: " << stall_info.GetStreamID() << " input " << stall_info.GetInputID()
+                 << " recovered after " << stall_info.GetDuration() << " msec";
+    } else {
+      WARNING_LOG() << "Stream id: " << stall_info.GetStreamID() << " input " << stall_info.GetInputID()
+                    << " stalled, reason: " << stall_info.GetReason();
+    }
+
+    fastotv::protocol::request_t req;
+    common::Error err_ser = InputStallStreamBroadcast(stall_info, &req);
+    if (err_ser) {
+      const std::string err_str = err_ser->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    BroadcastClients(req);
+    return common::ErrnoError();
+  }
+
+  return common::make_errno_error_inval();
+}
+
+common::ErrnoError ProcessSlaveWrapper::HandleRequestStartupStream(stream_client_t* pclient,
+                                                                   fastotv::protocol::request_t* req) {
+  UNUSED(pclient);
+  CHECK(loop_->IsLoopThread());
+  if (req->params) {
+    const char* params_ptr = req->params->c_str();
+    json_object* jrequest_startup = json_tokener_parse(params_ptr);
+    if (!jrequest_startup) {
+      return common::make_errno_error_inval();
+    }
+
+    StartupInfo startup_info;
+    common::Error err_des = startup_info.DeSerialize(jrequest_startup);
+    json_object_put(jrequest_startup);
+    if (err_des) {
+      const std::string err_str = err_des->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    StartupTiming timing = startup_info.GetTiming();
+    std::string trace_path;
+    ChildStream* child = static_cast<ChildStream*>(FindChildByID(startup_info.GetStreamID()));
+    if (child) {
+      if (timing.IsMarked(STARTUP_FORKED)) {  // first start of process, service phases precede it
+        timing.Merge(child->GetStartupTiming());
+      }
+      trace_path = child->GetStartupTracePath();
+    }
+
+    const StartupInfo merged(startup_info.GetStreamID(), startup_info.GetRestarts(), timing);
+    INFO_LOG() << "Stream id: " << merged.GetStreamID() << " started in " << timing.GetDuration() / 1000
+               << " msec, restarts: " << merged.GetRestarts();
+    if (!trace_path.empty()) {
+      std::string trace;
+      common::Error err_trace = merged.SerializeTrace(&trace);
+      std::ofstream trace_file(trace_path, std::ios::trunc);
+      if (err_trace || !(trace_file << trace)) {
+        WARNING_LOG() << "Can't write startup trace: " << trace_path;
+      }
+    }
+
+    fastotv::protocol::request_t req;
+    common::Error err_ser = StartupStreamBroadcast(merged, &req);
+    if (err_ser) {
+      const std::string err_str = err_ser->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    BroadcastClients(req);
+    return common::ErrnoError();
+  }
+
+  return common::make_errno_error_inval();
+}
+
 common::ErrnoError ProcessSlaveWrapper::HandleRequestStatisticStream(stream_client_t* pclient,
                                                                      fastotv::protocol::request_t* req) {
   UNUSED(pclient);
@@ -767,14 +1298,10 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestStatisticStream(stream_clie
       return common::make_errno_error(err_str, EAGAIN);
     }
 
-    fastotv::protocol::request_t req;
-    common::Error err_ser = StatisitcStreamBroadcast(stat, &req);
-    if (err_ser) {
-      const std::string err_str = err_ser->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
+    streams_stats_->Update(stat);  // sent with next tick
+    if (placement_) {
+      placement_->UpdateLoad(stat.GetStreamStruct().id, stat.GetCpuLoad() / 100);
     }
-
-    BroadcastClients(req);
     return common::ErrnoError();
   }
 
@@ -837,8 +1364,23 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStopStream(Protocoled
       return common::make_errno_error(err_str, EAGAIN);
     }
 
+    auto job = vod_jobs_.find(stop_info.GetStreamID());
+    if (job != vod_jobs_.end()) {
+      // quit status is broadcasted after last worker exit
+      job->second->Cancel();
+      for (const stream_id_t& wid : job->second->GetRunningWorkers()) {
+        Child* worker = FindChildByID(wid);
+        if (worker) {
+          ignore_result(worker->Stop());
+        }
+      }
+    }
+
     Child* chan = FindChildByID(stop_info.GetStreamID());
     if (!chan) {
+      if (job != vod_jobs_.end()) {
+        return dclient->StopStreamSuccess(req->id);
+      }
       return dclient->StopFail(req->id, common::make_error("Stream not found"));
     }
 
@@ -979,6 +1521,8 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientPrepareService(Protoc
 
     const auto http_root = HttpHandler::http_directory_path_t(state_info.GetHlsDirectory());
     static_cast<HttpHandler*>(http_handler_)->SetHttpRoot(http_root);
+    const auto timeshifts_root = HttpHandler::http_directory_path_t(state_info.GetTimeshiftsDirectory());
+    static_cast<HttpHandler*>(http_handler_)->SetTimeshiftsRoot(timeshifts_root);
 
     const auto vods_root = VodsHandler::http_directory_path_t(state_info.GetVodsDirectory());
     static_cast<VodsHandler*>(vods_handler_)->SetHttpRoot(vods_root);
@@ -1018,9 +1562,22 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientSyncService(Protocole
 
     // refresh vods
     vods_links_.clear();
+    vods_states_->Clear();
     cods_links_.clear();
+    std::set<stream_id_t> stale_jits;
+    for (auto it = vod_jits_.begin(); it != vod_jits_.end(); ++it) {
+      stale_jits.insert(it->first);
+    }
     for (StreamConfig config : sync_info.GetStreams()) {
       AddStreamLine(config);
+      stream_id_t sid;
+      common::Value* id_field = config->Find(ID_FIELD);
+      if (id_field && id_field->GetAsBasicString(&sid) && VodJit::IsJit(config)) {
+        stale_jits.erase(sid);
+      }
+    }
+    for (const stream_id_t& sid : stale_jits) {
+      RemoveVodJit(sid);
     }
 
     return dclient->SyncServiceSuccess(req->id);
@@ -1044,7 +1601,11 @@ void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args)
     return;
   }
 
-  if (sha.type == VOD_ENCODE || sha.type == VOD_RELAY) {
+  if (sha.type == VOD_ENCODE && VodJit::IsJit(config_args)) {
+    // segments are kept by budget instead of cleanup by ttl
+    config_args->Insert(CLEANUP_TS_FIELD, common::Value::CreateBooleanValue(false));
+    AddVodJit(config_args, sha.id);
+  } else if (sha.type == VOD_ENCODE || sha.type == VOD_RELAY) {
     output_t output;
     if (read_output(config_args, &output)) {
       for (const OutputUri& out_uri : output) {
@@ -1053,6 +1614,7 @@ void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args)
           const common::file_system::ascii_directory_string_path http_root = out_uri.GetHttpRoot();
           config_args->Insert(CLEANUP_TS_FIELD, common::Value::CreateBooleanValue(false));
           vods_links_[http_root] = config_args;
+          vods_states_->Add(http_root, sha.id);
         }
       }
     }
@@ -1102,6 +1664,7 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientActivate(ProtocoledDa
     }
 
     dclient->SetVerified(true);
+    SendStreamsStatisticSnapshot(dclient);
     return common::ErrnoError();
   }
 
@@ -1225,6 +1788,10 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestStreamsCommand(stream_clien
     return HandleRequestChangedSourcesStream(pclient, req);
   } else if (req->method == STATISTIC_STREAM) {
     return HandleRequestStatisticStream(pclient, req);
+  } else if (req->method == INPUT_STALL_STREAM) {
+    return HandleRequestInputStallStream(pclient, req);
+  } else if (req->method == STARTUP_STREAM) {
+    return HandleRequestStartupStream(pclient, req);
   }
 
   WARNING_LOG() << "Received unknown command: " << req->method;
@@ -1276,12 +1843,15 @@ std::string ProcessSlaveWrapper::MakeServiceStats(bool full_stat) const {
   service::OnlineUsers online(daemons_client_count, static_cast<HttpHandler*>(http_handler_)->GetOnlineClients(),
                               static_cast<HttpHandler*>(vods_handler_)->GetOnlineClients(),
                               static_cast<HttpHandler*>(cods_handler_)->GetOnlineClients());
+  const SegmentsCache::Stats cache_stats = static_cast<HttpHandler*>(http_handler_)->GetCacheStats();
+  service::HttpCacheInfo http_cache(cache_stats.hits, cache_stats.misses, cache_stats.bytes);
   service::ServerInfo stat(cpu_load, node_stats_->gpu_load, uptime_str, mem_shot, hdd_shot, bytes_recv / ts_diff,
-                           bytes_send / ts_diff, sshot, current_time, online);
+                           bytes_send / ts_diff, sshot, current_time, online, http_cache);
 
   std::string node_stats;
   if (full_stat) {
-    service::FullServiceInfo fstat(config_.http_host, config_.vods_host, config_.cods_host, stat);
+    const service::PlacementInfo placement = placement_ ? placement_->MakePlacementInfo() : service::PlacementInfo();
+    service::FullServiceInfo fstat(config_.http_host, config_.vods_host, config_.cods_host, stat, placement);
     common::Error err_ser = fstat.SerializeToString(&node_stats);
     if (err_ser) {
       const std::string err_str = err_ser->GetDescription();
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <set>
 #include <string>
 
 #include <common/libev/io_loop_observer.h>
@@ -34,11 +36,27 @@ namespace fastocloud {
 namespace server {
 
 class Child;
+class CpuPlacement;
 class ProtocoledDaemonClient;
+class StatisticsAggregator;
+class VodJit;
+class VodJitSegments;
+class VodSplitJob;
+class VodsCompleteness;
+class Zygote;
+namespace base {
+class WorkersPool;
+}
 
 class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server::base::IHttpRequestsObserver {
  public:
-  enum { node_stats_send_seconds = 10, ping_timeout_clients_seconds = 60, cleanup_seconds = 3 };
+  enum {
+    node_stats_send_seconds = 10,
+    stream_stats_send_seconds = 1,
+    ping_timeout_clients_seconds = 60,
+    cleanup_seconds = 3,
+    placement_rebalance_seconds = 30
+  };
   typedef StreamConfig serialized_stream_t;
   typedef fastotv::protocol::protocol_client_t stream_client_t;
 
@@ -67,6 +85,7 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   void PostLooped(common::libev::IoLoop* server) override;
 
   void OnHttpRequest(common::libev::http::HttpClient* client, const file_path_t& file) override;
+  bool IsGeneratedOnDemand(const file_path_t& file) override;
 
   virtual common::ErrnoError HandleRequestServiceCommand(ProtocoledDaemonClient* dclient,
                                                          fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
@@ -80,13 +99,38 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
 
  private:
   Child* FindChildByID(stream_id_t cid) const;
+  bool IsVodsLoop(const common::libev::IoLoop* server) const;
+  bool IsCodsLoop(const common::libev::IoLoop* server) const;
   void BroadcastClients(const fastotv::protocol::request_t& req);
+  void BroadcastStreamsStatistic();
+  void SendStreamsStatisticSnapshot(ProtocoledDaemonClient* dclient);
 
   common::ErrnoError DaemonDataReceived(ProtocoledDaemonClient* dclient) WARN_UNUSED_RESULT;
   common::ErrnoError StreamDataReceived(stream_client_t* pclient) WARN_UNUSED_RESULT;
 
   common::ErrnoError CreateChildStream(const serialized_stream_t& config_args);
-  common::ErrnoError CreateChildStreamImpl(const serialized_stream_t& config_args, stream_id_t sid);
+  common::ErrnoError CreateChildStreamImpl(const serialized_stream_t& config_args,
+                                           stream_id_t sid,
+                                           StreamType type);
+  common::ErrnoError StartChildStream(const serialized_stream_t& config_args, stream_id_t sid, StreamType type);
+  void BroadcastQuitStatus(stream_id_t sid, int status, int signal);
+
+  // vod encoded by parallel workers
+  common::ErrnoError StartVodSplitJob(const serialized_stream_t& config_args, stream_id_t sid, size_t workers);
+  void RunVodSplitJob(VodSplitJob* job);
+  void FinishVodSplitJob(VodSplitJob* job);
+  bool HandleVodSplitChildExited(stream_id_t sid, int status, int signal);  // true if child was part of job
+
+  // vod encoded segment by segment on request
+  void AddVodJit(const serialized_stream_t& config_args, stream_id_t sid);
+  void RemoveVodJit(stream_id_t sid);
+  VodJit* FindVodJit(const common::file_system::ascii_directory_string_path& http_root) const;
+  void HandleVodJitRequest(const file_path_t& file);
+  void RunVodJit(VodJit* jit);
+  bool HandleVodJitChildExited(stream_id_t sid, int status, int signal);  // true if child was worker
+  void StartZygote();
+  void StopZygote();
+  void KillStaleZygoteStreams();
 
   // stream
   common::ErrnoError HandleRequestChangedSourcesStream(stream_client_t* pclient,
@@ -95,6 +139,11 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   common::ErrnoError HandleRequestStatisticStream(stream_client_t* pclient,
                                                   fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
 
+  common::ErrnoError HandleRequestInputStallStream(stream_client_t* pclient,
+                                                   fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+  common::ErrnoError HandleRequestStartupStream(stream_client_t* pclient,
+                                                fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+
   common::ErrnoError HandleRequestClientStartStream(ProtocoledDaemonClient* dclient,
                                                     fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestClientStopStream(ProtocoledDaemonClient* dclient,
@@ -135,24 +184,38 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   char** process_argv_;
 
   common::libev::IoLoop* loop_;
+  Zygote* zygote_;  // nullptr if streams forked from service directly
   // http
   common::libev::IoLoop* http_server_;
   common::libev::IoLoopObserver* http_handler_;
+  base::WorkersPool* http_workers_;
   // vods (video on demand)
   common::libev::IoLoop* vods_server_;
   common::libev::IoLoopObserver* vods_handler_;
+  base::WorkersPool* vods_workers_;
   // cods (channel on demand)
   common::libev::IoLoop* cods_server_;
   common::libev::IoLoopObserver* cods_handler_;
+  base::WorkersPool* cods_workers_;
 
   common::libev::timer_id_t ping_client_timer_;
   common::libev::timer_id_t node_stats_timer_;
+  common::libev::timer_id_t stream_stats_timer_;
   common::libev::timer_id_t cleanup_files_timer_;
   common::libev::timer_id_t quit_cleanup_timer_;
+  common::libev::timer_id_t placement_timer_;
   NodeStats* node_stats_;
+  StatisticsAggregator* streams_stats_;
+  VodsCompleteness* vods_states_;
+  CpuPlacement* placement_;  // nullptr if streams float freely across cores
 
   std::map<common::file_system::ascii_directory_string_path, serialized_stream_t> vods_links_;
   std::map<common::file_system::ascii_directory_string_path, serialized_stream_t> cods_links_;
+  std::map<stream_id_t, VodSplitJob*> vod_jobs_;  // by vod stream id
+  std::map<stream_id_t, VodJit*> vod_jits_;       // by vod stream id
+  VodJitSegments* vod_jit_segments_;
+  std::mutex jit_roots_mutex_;
+  std::set<std::string> jit_roots_;  // http roots of vod_jits_, read by vods serving loops
 };
 
 }  // namespace server
@@ -14,10 +14,6 @@
 
 #include "server/process_slave_wrapper.h"
 
-#if defined(OS_LINUX)
-#include <sys/prctl.h>
-#endif
-
 #include <dlfcn.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -25,11 +21,16 @@
 #include <common/file_system/file_system.h>
 #include <common/file_system/string_path_utils.h>
 
+#include "base/shared_stream_stats.h"
+#include "base/startup_timing.h"
+#include "base/stream_config_parse.h"
 #include "base/stream_info.h"
 
 #include "server/child_stream.h"
+#include "server/cpu_placement.h"
 #include "server/daemon/server.h"
 #include "server/utils/utils.h"
+#include "server/zygote.h"
 
 #include "stream/stream_wrapper.h"
 
@@ -44,7 +45,27 @@
 namespace fastocloud {
 namespace server {
 
-common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_stream_t& config_args, stream_id_t sid) {
+void ProcessSlaveWrapper::StartZygote() {
+  if (!config_.zygote) {
+    return;
+  }
+
+  zygote_ = Zygote::Start(process_argc_, process_argv_);
+}
+
+void ProcessSlaveWrapper::StopZygote() {
+  destroy(&zygote_);
+}
+
+void ProcessSlaveWrapper::KillStaleZygoteStreams() {
+  if (zygote_) {
+    zygote_->KillStaleStreams();
+  }
+}
+
+common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_stream_t& config_args,
+                                                              stream_id_t sid,
+                                                              StreamType type) {
 #if PIPE
   common::net::socket_descr_t read_command_client;
   common::net::socket_descr_t write_requests_client;
@@ -76,45 +97,54 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
   }
 #endif
 
+  // stream writes statistics here, service reads them without parsing pipe messages
+  int shared_stats_fd = INVALID_DESCRIPTOR;
+  SharedStreamStats* shared_stats =
+      zygote_ ? SharedStreamStats::CreateShared(&shared_stats_fd) : SharedStreamStats::Create();
+  if (!shared_stats) {
+    WARNING_LOG() << "Can't map shared statistics for stream id: " << sid << ", statistics will be sent via pipe";
+  }
+
+  pid_t pid = 0;
+  bool spawned = false;
+#if PIPE
+  if (zygote_ && !zygote_->IsDisabled()) {
+    std::string json;
+    if (MakeJsonFromConfig(config_args, &json)) {
+      common::ErrnoError zerr =
+          zygote_->SpawnStream(sid, json, read_command_client, write_responce_client, shared_stats_fd, &pid);
+      if (zerr) {
+        WARNING_LOG() << "Zygote can't start stream id: " << sid << ", error: " << zerr->GetDescription();
+      } else {
+        spawned = true;
+      }
+    }
+  }
+#endif
+  if (shared_stats_fd != INVALID_DESCRIPTOR) {
+    close(shared_stats_fd);  // mapping stays valid
+  }
+
+  if (!spawned) {
 #if !defined(TEST)
-  pid_t pid = fork();
+    pid = fork();
 #else
-  pid_t pid = 0;
+    pid = 0;
 #endif
+  }
   if (pid == 0) {  // child
-    typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client);
-
-    const std::string absolute_source_dir = common::file_system::absolute_path_from_relative(RELATIVE_SOURCE_DIR);
-    const std::string lib_full_path = common::file_system::make_path(absolute_source_dir, CORE_LIBRARY);
-    void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
+    StartupTiming startup;
+    startup.Mark(STARTUP_FORKED);
+    stream_exec_t stream_exec_func = nullptr;
+    void* handle = load_stream_core(&stream_exec_func);
     if (!handle) {
-      ERROR_LOG() << "Failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
-      _exit(EXIT_FAILURE);
-    }
-
-    stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(dlsym(handle, "stream_exec"));
-    char* error = dlerror();
-    if (error) {
-      ERROR_LOG() << "Failed to load start stream function error: " << error;
-      dlclose(handle);
       _exit(EXIT_FAILURE);
     }
+    startup.Mark(STARTUP_CORE_LOADED);
 
     const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
     const char* new_name = new_process_name.c_str();
-#if defined(OS_LINUX)
-    for (int i = 0; i < process_argc_; ++i) {
-      memset(process_argv_[i], 0, strlen(process_argv_[i]));
-    }
-    char* app_name = process_argv_[0];
-    strncpy(app_name, new_name, new_process_name.length());
-    app_name[new_process_name.length()] = 0;
-    prctl(PR_SET_NAME, new_name);
-#elif defined(OS_FREEBSD)
-    setproctitle(new_name);
-#else
-#pragma message "Please implement"
-#endif
+    set_stream_process_name(new_process_name, process_argc_, process_argv_);
 
 #if PIPE
 #if !defined(TEST)
@@ -139,13 +169,14 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
 #endif
 
     client->SetName(sid);
-    int res = stream_exec_func(new_name, config_args.get(), client);
+    int res = stream_exec_func(new_name, config_args.get(), client, shared_stats, &startup);
     client->Close();
     delete client;
     dlclose(handle);
     _exit(res);
   } else if (pid < 0) {
     ERROR_LOG() << "Failed to start children!";
+    SharedStreamStats::Destroy(&shared_stats);
   } else {
 #if PIPE
     // close not needed pipes
@@ -168,9 +199,12 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
 #endif
     client->SetName(sid);
     loop_->RegisterClient(client);
-    ChildStream* new_channel = new ChildStream(loop_, sid);
+    ChildStream* new_channel = new ChildStream(loop_, sid, shared_stats);
     new_channel->SetClient(client);
     loop_->RegisterChild(new_channel, pid);
+    if (placement_) {
+      placement_->Place(sid, pid, type);
+    }
   }
 
   return common::ErrnoError();
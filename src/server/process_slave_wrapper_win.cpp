@@ -25,7 +25,16 @@
 namespace fastocloud {
 namespace server {
 
-common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_stream_t& config_args, stream_id_t sid) {
+void ProcessSlaveWrapper::StartZygote() {}
+
+void ProcessSlaveWrapper::StopZygote() {}
+
+void ProcessSlaveWrapper::KillStaleZygoteStreams() {}
+
+common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_stream_t& config_args,
+                                                              stream_id_t sid,
+                                                              StreamType type) {
+  UNUSED(type);  // affinity placement is linux only
   common::net::socket_descr_t parent_sock;
   common::net::socket_descr_t child_sock;
   common::ErrnoError err = CreateSocketPair(&parent_sock, &child_sock);
@@ -105,7 +114,7 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
   tcp::Client* sock_client = new tcp::Client(loop_, common::net::socket_info(parent_sock));
   sock_client->SetName(sid);
   loop_->RegisterClient(sock_client);
-  ChildStream* child = new ChildStream(loop_, sid);
+  ChildStream* child = new ChildStream(loop_, sid, nullptr);
   child->SetClient(sock_client);
   loop_->RegisterChild(child, pi.hProcess);
   CloseHandle(pi.hThread);
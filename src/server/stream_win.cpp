@@ -24,6 +24,7 @@
 #include <fastotv/protocol/protocol.h>
 
 #include "base/config_fields.h"
+#include "base/startup_timing.h"
 #include "base/stream_config_parse.h"
 
 #include "server/tcp/client.h"
@@ -41,6 +42,8 @@ struct WinsockInit {
 }  // namespace
 
 int main(int argc, char** argv) {
+  fastocloud::StartupTiming startup;
+  startup.Mark(fastocloud::STARTUP_FORKED);
   if (argc != 3) {
     std::cerr << "Must be 3 arguments";
     return EXIT_FAILURE;
@@ -54,13 +57,18 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client);
+  typedef int (*stream_exec_t)(const char* process_name,
+                               const void* args,
+                               void* command_client,
+                               void* shared_stats,
+                               const void* startup_timing);
   stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(GetProcAddress(dll, "stream_exec"));
   if (!stream_exec_func) {
     std::cerr << "Failed to load start stream function error: " << GetLastError();
     FreeLibrary(dll);
     return EXIT_FAILURE;
   }
+  startup.Mark(fastocloud::STARTUP_CORE_LOADED);
 
   const char* hid = argv[1];
   const char* sz = argv[2];
@@ -103,7 +111,8 @@ int main(int argc, char** argv) {
   const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
   const char* new_name = new_process_name.c_str();
   int res = stream_exec_func(new_name, params_config.get(),
-                             new fastocloud::server::tcp::Client(nullptr, common::net::socket_info(cfd)));
+                             new fastocloud::server::tcp::Client(nullptr, common::net::socket_info(cfd)), nullptr,
+                             &startup);
   FreeLibrary(dll);
   return res;
 }
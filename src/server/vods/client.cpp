@@ -18,7 +18,13 @@ namespace fastocloud {
 namespace server {
 
 VodsClient::VodsClient(common::libev::IoLoop* server, const common::net::socket_info& info)
-    : base_class(server, info), is_verified_(false) {}
+    : base_class(server, info),
+      is_verified_(false),
+      reader_(),
+      output_(),
+      waiting_request_(),
+      waiting_file_(),
+      waiting_deadline_(0) {}
 
 bool VodsClient::IsVerified() const {
   return is_verified_;
@@ -28,6 +34,40 @@ void VodsClient::SetVerified(bool verified) {
   is_verified_ = verified;
 }
 
+base::HttpRequestReader* VodsClient::GetRequestReader() {
+  return &reader_;
+}
+
+base::HttpOutput* VodsClient::GetOutput() {
+  return &output_;
+}
+
+bool VodsClient::IsWaitingFile() const {
+  return !waiting_file_.empty();
+}
+
+void VodsClient::WaitFile(const std::string& request, const std::string& file_path, fastotv::timestamp_t deadline) {
+  waiting_request_ = request;
+  waiting_file_ = file_path;
+  waiting_deadline_ = deadline;
+}
+
+std::string VodsClient::GetWaitingFile() const {
+  return waiting_file_;
+}
+
+fastotv::timestamp_t VodsClient::GetWaitingDeadline() const {
+  return waiting_deadline_;
+}
+
+std::string VodsClient::StopWaitFile() {
+  const std::string request = waiting_request_;
+  waiting_request_.clear();
+  waiting_file_.clear();
+  waiting_deadline_ = 0;
+  return request;
+}
+
 const char* VodsClient::ClassName() const {
   return "VodsClient";
 }
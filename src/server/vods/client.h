@@ -14,8 +14,15 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/libev/http/http_client.h>
 
+#include <fastotv/types.h>
+
+#include "server/base/http_output.h"
+#include "server/base/http_request_reader.h"
+
 namespace fastocloud {
 namespace server {
 
@@ -28,10 +35,27 @@ class VodsClient : public common::libev::http::HttpClient {
   bool IsVerified() const;
   void SetVerified(bool verified);
 
+  base::HttpRequestReader* GetRequestReader();
+  // queued response bytes, requests aren't processed while output isn't empty
+  base::HttpOutput* GetOutput();
+
+  // request parked until file will be created or deadline
+  bool IsWaitingFile() const;
+  void WaitFile(const std::string& request, const std::string& file_path, fastotv::timestamp_t deadline);
+  std::string GetWaitingFile() const;
+  fastotv::timestamp_t GetWaitingDeadline() const;
+  std::string StopWaitFile();
+
   const char* ClassName() const override;
 
  private:
   bool is_verified_;
+  base::HttpRequestReader reader_;
+  base::HttpOutput output_;
+
+  std::string waiting_request_;
+  std::string waiting_file_;
+  fastotv::timestamp_t waiting_deadline_;
 };
 
 }  // namespace server
@@ -20,7 +20,14 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <common/file_system/file_system.h>
+#include <common/time.h>
+
+#include "base/types.h"
+
+#include "server/base/http_file_response.h"
 #include "server/base/ihttp_requests_observer.h"
 #include "server/vods/client.h"
 
@@ -28,13 +35,29 @@ namespace fastocloud {
 namespace server {
 
 VodsHandler::VodsHandler(base::IHttpRequestsObserver* observer)
-    : base_class(), http_root_(http_directory_path_t::MakeHomeDir()), observer_(observer) {}
+    : base_class(),
+      http_root_(http_directory_path_t::MakeHomeDir()),
+      observer_(observer),
+      wait_file_timeout_(0),
+      wait_generated_file_timeout_(0) {}
 
 void VodsHandler::SetHttpRoot(const http_directory_path_t& http_root) {
   http_root_ = http_root;
 }
 
+void VodsHandler::SetWaitFileTimeout(time_t timeout_sec) {
+  wait_file_timeout_ = timeout_sec;
+}
+
+void VodsHandler::SetWaitGeneratedFileTimeout(time_t timeout_sec) {
+  wait_generated_file_timeout_ = timeout_sec;
+}
+
 void VodsHandler::PreLooped(common::libev::IoLoop* server) {
+  if (wait_file_timeout_ || wait_generated_file_timeout_) {
+    ignore_result(server->CreateTimer(static_cast<double>(wait_file_check_msec) / 1000, true));
+  }
+  ignore_result(server->CreateTimer(static_cast<double>(base::HttpOutput::stall_check_msec) / 1000, true));
   base_class::PreLooped(server);
 }
 
@@ -51,6 +74,9 @@ void VodsHandler::Closed(common::libev::IoClient* client) {
 }
 
 void VodsHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  // checks are cheap, so any of timers runs both
+  CheckWaitingClients(server);
+  CloseStalledClients(server);
   base_class::TimerEmited(server, id);
 }
 
@@ -67,21 +93,28 @@ void VodsHandler::ChildStatusChanged(common::libev::IoChild* child, int status,
 }
 
 void VodsHandler::DataReceived(common::libev::IoClient* client) {
-  char buff[BUF_SIZE] = {0};
+  VodsClient* hclient = static_cast<server::VodsClient*>(client);
+  base::HttpRequestReader* reader = hclient->GetRequestReader();
+  size_t buff_size = 0;
+  char* buff = reader->PrepareRead(&buff_size);
   size_t nread = 0;
-  common::ErrnoError errn = client->SingleRead(buff, BUF_SIZE - 1, &nread);
+  common::ErrnoError errn = client->SingleRead(buff, buff_size, &nread);
   if ((errn && errn->GetErrorCode() != EAGAIN) || nread == 0) {
     ignore_result(client->Close());
     delete client;
     return base_class::DataReceived(client);
   }
 
-  VodsClient* hclient = static_cast<server::VodsClient*>(client);
-  ProcessReceived(hclient, buff, nread);
+  reader->CommitRead(nread);
+  ProcessRequests(hclient);
   base_class::DataReceived(client);
 }
 
 void VodsHandler::DataReadyToWrite(common::libev::IoClient* client) {
+  VodsClient* hclient = static_cast<server::VodsClient*>(client);
+  if (FlushOutput(hclient) && hclient->GetOutput()->IsEmpty()) {
+    ProcessRequests(hclient);  // pipelined behind sent response
+  }
   base_class::DataReadyToWrite(client);
 }
 
@@ -89,11 +122,63 @@ void VodsHandler::PostLooped(common::libev::IoLoop* server) {
   base_class::PostLooped(server);
 }
 
-void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size_t req_len) {
+void VodsHandler::CheckWaitingClients(common::libev::IoLoop* server) {
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  std::vector<common::libev::IoClient*> clients = server->GetClients();
+  for (size_t i = 0; i < clients.size(); ++i) {
+    VodsClient* vclient = static_cast<VodsClient*>(clients[i]);
+    if (!vclient->IsWaitingFile()) {
+      continue;
+    }
+
+    const std::string file_path = vclient->GetWaitingFile();
+    if (!common::file_system::is_file_exist(file_path) && current_time < vclient->GetWaitingDeadline()) {
+      continue;
+    }
+
+    const std::string request = vclient->StopWaitFile();
+    if (ProcessReceived(vclient, request, false)) {
+      ProcessRequests(vclient);  // pipelined after parked one
+    }
+  }
+}
+
+time_t VodsHandler::GetWaitTimeout(const common::file_system::ascii_file_string_path& file) const {
+  if (wait_file_timeout_ && common::EqualsASCII(file.GetExtension(), M3U8_EXTENSION, false)) {
+    return wait_file_timeout_;
+  }
+
+  if (wait_generated_file_timeout_ && observer_ && observer_->IsGeneratedOnDemand(file)) {
+    return wait_generated_file_timeout_;
+  }
+  return 0;
+}
+
+void VodsHandler::ProcessRequests(VodsClient* hclient) {
+  base::HttpRequestReader* reader = hclient->GetRequestReader();
+  base::HttpOutput* output = hclient->GetOutput();
+  while (!hclient->IsWaitingFile() && output->IsEmpty() && reader->NextRequest()) {
+    if (!ProcessReceived(hclient, reader->GetRequest(), true)) {
+      return;  // client closed
+    }
+  }
+
+  if (output->IsEmpty() && reader->IsOverflow()) {
+    static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+    common::ErrnoError err = hclient->SendError(common::http::HP_1_1, common::http::HS_BAD_REQUEST, nullptr,
+                                                "Request too large.", false, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    ignore_result(hclient->Close());
+    delete hclient;
+  }
+}
+
+bool VodsHandler::ProcessReceived(VodsClient* hclient, const std::string& request, bool can_wait) {
   static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
   common::http::HttpRequest hrequest;
-  std::string request_str(request, req_len);
-  std::pair<common::http::http_status, common::Error> result = common::http::parse_http_request(request_str, &hrequest);
+  std::pair<common::http::http_status, common::Error> result = common::http::parse_http_request(request, &hrequest);
   DEBUG_LOG() << "Http request:\n" << request;
 
   if (result.second) {
@@ -106,7 +191,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
     }
     ignore_result(hclient->Close());
     delete hclient;
-    return;
+    return false;
   }
 
   // keep alive
@@ -124,7 +209,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
     const std::string url_dirs = path.GetHpath();
@@ -140,7 +225,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
     if (observer_) {
@@ -151,12 +236,20 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
     int open_flags = O_RDONLY;
     struct stat sb;
     if (stat(file_path_str.c_str(), &sb) < 0) {
+      const time_t wait_timeout = can_wait ? GetWaitTimeout(*file_path) : 0;
+      if (wait_timeout) {
+        // channel is starting or segment is encoding, answer when file will be written
+        const fastotv::timestamp_t deadline = common::time::current_utc_mstime() + wait_timeout * 1000;
+        hclient->WaitFile(request, file_path_str, deadline);
+        return true;
+      }
+
       common::ErrnoError err =
           hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
     if (S_ISDIR(sb.st_mode)) {
@@ -165,7 +258,18 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
+    }
+
+    const std::string mime = path.GetMime();
+    const base::HttpFileResponse response(hrequest, sb);
+    base::HttpOutput* output = hclient->GetOutput();
+    if (!response.HasBody()) {  // not modified or bad range
+      response.QueueHeaders(output, protocol, mime.c_str(), IsKeepAlive, PROJECT_NAME_TITLE);
+      if (!IsKeepAlive) {
+        output->SetCloseOnEmpty();
+      }
+      return FlushOutput(hclient);
     }
 
     int file = open(file_path_str.c_str(), open_flags);
@@ -175,33 +279,62 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       }
-      return;
+      return true;
     }
 
-    const std::string mime = path.GetMime();
-    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, extra_header, mime.c_str(),
-                                                  &sb.st_size, &sb.st_mtime, IsKeepAlive, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    response.QueueHeaders(output, protocol, mime.c_str(), IsKeepAlive, PROJECT_NAME_TITLE);
+    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
+      response.QueueBody(output, file);
+      DEBUG_LOG() << "Sending file path: " << file_path_str << ", offset: " << response.GetOffset()
+                  << ", size: " << response.GetLength();
+    } else {
       ::close(file);
-      return;
     }
+  }
 
-    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
-      common::ErrnoError err = hclient->SendFileByFd(protocol, file, sb.st_size);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        DEBUG_LOG() << "Sent file path: " << file_path_str << ", size: " << sb.st_size;
-      }
-    }
+  if (!IsKeepAlive) {
+    hclient->GetOutput()->SetCloseOnEmpty();
+  }
+  return FlushOutput(hclient);
+}
+
+bool VodsHandler::FlushOutput(VodsClient* hclient) {
+  base::HttpOutput* output = hclient->GetOutput();
+  common::ErrnoError err = output->Flush(hclient->GetInfo().fd());
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    ignore_result(hclient->Close());
+    delete hclient;
+    return false;
+  }
 
-    ::close(file);
+  // loop wakes us up when client can take the rest
+  const common::libev::IoClient::flags_t flags = output->IsEmpty() ? EV_READ : EV_READ | EV_WRITE;
+  if (hclient->GetFlags() != flags) {
+    hclient->SetFlags(flags);
   }
 
-  if (!IsKeepAlive) {
+  if (output->IsEmpty() && output->IsCloseOnEmpty()) {
     ignore_result(hclient->Close());
     delete hclient;
+    return false;
+  }
+  return true;
+}
+
+void VodsHandler::CloseStalledClients(common::libev::IoLoop* server) {
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  std::vector<common::libev::IoClient*> clients = server->GetClients();
+  for (size_t i = 0; i < clients.size(); ++i) {
+    VodsClient* vclient = static_cast<VodsClient*>(clients[i]);
+    if (!vclient->GetOutput()->IsStalled(current_time)) {
+      continue;
+    }
+
+    WARNING_LOG() << "Vods client doesn't read response for " << base::HttpOutput::stall_timeout_msec
+                  << " msec, closing";
+    ignore_result(vclient->Close());
+    delete vclient;
   }
 }
 
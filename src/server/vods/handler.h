@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/file_system/path.h>
 
 #include "server/base/iserver_handler.h"
@@ -28,12 +30,16 @@ class IHttpRequestsObserver;
 
 class VodsHandler : public base::IServerHandler {
  public:
-  enum { BUF_SIZE = 4096 };
+  enum { wait_file_check_msec = 100 };
   typedef base::IServerHandler base_class;
   typedef common::file_system::ascii_directory_string_path http_directory_path_t;
   explicit VodsHandler(base::IHttpRequestsObserver* observer);
 
   void SetHttpRoot(const http_directory_path_t& http_root);
+  // missing playlists are answered when created or after timeout, 0 answers them immediately
+  void SetWaitFileTimeout(time_t timeout_sec);
+  // the same for files which observer generates on demand
+  void SetWaitGeneratedFileTimeout(time_t timeout_sec);
 
   void PreLooped(common::libev::IoLoop* server) override;
 
@@ -51,10 +57,19 @@ class VodsHandler : public base::IServerHandler {
   void PostLooped(common::libev::IoLoop* server) override;
 
  private:
-  void ProcessReceived(VodsClient* hclient, const char* request, size_t req_len);
+  void ProcessRequests(VodsClient* hclient);
+  // false if client closed
+  bool ProcessReceived(VodsClient* hclient, const std::string& request, bool can_wait) WARN_UNUSED_RESULT;
+  // sends queued output or waits writability, false if client closed
+  bool FlushOutput(VodsClient* hclient) WARN_UNUSED_RESULT;
+  void CheckWaitingClients(common::libev::IoLoop* server);
+  void CloseStalledClients(common::libev::IoLoop* server);
+  time_t GetWaitTimeout(const common::file_system::ascii_file_string_path& file) const;  // 0 if not waited
 
   http_directory_path_t http_root_;
   base::IHttpRequestsObserver* const observer_;
+  time_t wait_file_timeout_;
+  time_t wait_generated_file_timeout_;
 };
 
 }  // namespace server
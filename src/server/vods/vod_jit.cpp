@@ -0,0 +1,304 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/vods/vod_jit.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+
+#include "base/config_fields.h"
+
+#include "utils/chunk_info.h"
+#include "utils/m3u8_reader.h"
+
+namespace fastocloud {
+namespace server {
+
+VodJit::VodJit(stream_id_t sid, const StreamConfig& config, size_t prefetch)
+    : sid_(sid),
+      config_(config),
+      prefetch_(prefetch),
+      outputs_(VodSplitJob::GetOutputs(config)),
+      index_(),
+      indexing_(false),
+      queue_(),
+      running_() {}
+
+stream_id_t VodJit::GetID() const {
+  return sid_;
+}
+
+StreamConfig VodJit::GetConfig() const {
+  return config_;
+}
+
+bool VodJit::HasHttpRoot(const http_root_t& http_root) const {
+  for (const VodSplitJob::Output& output : outputs_) {
+    if (output.http_root == http_root) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VodJit::IsIndexing() const {
+  return indexing_;
+}
+
+void VodJit::SetIndexing(bool indexing) {
+  indexing_ = indexing;
+}
+
+bool VodJit::IsIndexed() const {
+  return !index_.empty();
+}
+
+bool VodJit::LoadIndex() {
+  if (outputs_.empty()) {
+    return false;
+  }
+
+  // all outputs are encoded by the same workers, index is the same
+  vod_ranges_t index;
+  if (!ReadVodRanges(MakeVodJitIndexPath(outputs_.front().http_root), &index)) {
+    return false;
+  }
+
+  index_ = index;
+  queue_.clear();
+  return true;
+}
+
+common::ErrnoError VodJit::WritePlaylists() const {
+  for (const VodSplitJob::Output& output : outputs_) {
+    common::ErrnoError err = WritePlaylist(output.http_root, output.filename, index_);
+    if (err) {
+      return err;
+    }
+  }
+  return common::ErrnoError();
+}
+
+VodJit::segments_t VodJit::GetReadySegments() const {
+  segments_t segments;
+  for (const VodRange& range : index_) {
+    for (const VodSplitJob::Output& output : outputs_) {
+      const auto path = output.http_root.MakeFileStringPath(MakeVodJitSegmentName(range.index));
+      struct stat sb;
+      if (path && stat(path->GetPath().c_str(), &sb) == 0) {
+        segments.push_back({path->GetPath(), static_cast<size_t>(sb.st_size)});
+      }
+    }
+  }
+  return segments;
+}
+
+bool VodJit::Request(size_t index) {
+  if (index >= index_.size()) {
+    return false;
+  }
+
+  queue_.clear();
+  for (size_t i = index; i < index_.size() && i <= index + prefetch_; ++i) {
+    if (!IsSegmentReady(i) && !IsRunning(i)) {
+      queue_.push_back(i);
+    }
+  }
+  return true;
+}
+
+bool VodJit::TakeSegment(stream_id_t* wid, StreamConfig* config) {
+  if (!wid || !config) {
+    return false;
+  }
+
+  // requested segment and its prefetch, workers of old position are counted too
+  if (queue_.empty() || running_.size() > prefetch_) {
+    return false;
+  }
+
+  const VodRange range = index_[queue_.front()];
+  queue_.pop_front();
+  const stream_id_t lwid = VodSplitJob::MakeWorkerID(sid_, range.index);
+  running_[lwid] = range.index;
+  *wid = lwid;
+  *config = VodSplitJob::MakeWorkerConfig(config_, range, lwid);
+  return true;
+}
+
+bool VodJit::OnWorkerExited(stream_id_t wid, bool success, segments_t* segments) {
+  auto it = running_.find(wid);
+  if (it == running_.end()) {
+    return false;
+  }
+
+  const size_t index = it->second;
+  running_.erase(it);
+  if (!success) {
+    return true;  // encoded again on next request
+  }
+
+  for (const VodSplitJob::Output& output : outputs_) {
+    Segment segment;
+    common::ErrnoError err = MakeSegment(output.http_root, output.filename, index, &segment);
+    if (err) {
+      WARNING_LOG() << "Can't make segment " << index << " of vod " << sid_
+                    << ", error: " << err->GetDescription();
+      continue;
+    }
+
+    if (segments) {
+      segments->push_back(segment);
+    }
+  }
+  return true;
+}
+
+std::vector<stream_id_t> VodJit::GetRunningWorkers() const {
+  std::vector<stream_id_t> workers;
+  for (auto it = running_.begin(); it != running_.end(); ++it) {
+    workers.push_back(it->first);
+  }
+  return workers;
+}
+
+bool VodJit::IsJit(const StreamConfig& config) {
+  bool jit;
+  common::Value* jit_field = config->Find(VOD_JIT_FIELD);
+  return jit_field && jit_field->GetAsBoolean(&jit) && jit;
+}
+
+common::ErrnoError VodJit::WritePlaylist(const http_root_t& http_root,
+                                         const std::string& filename,
+                                         const vod_ranges_t& index) {
+  const auto playlist_path = http_root.MakeFileStringPath(filename);
+  if (!playlist_path || index.empty()) {
+    return common::make_errno_error_inval();
+  }
+
+  std::vector<utils::ChunkInfo> chunks;
+  for (const VodRange& range : index) {
+    if (range.stop_msec == VodRange::open_stop) {  // indexer always knows duration
+      return common::make_errno_error("Vod index without duration", EINVAL);
+    }
+
+    const uint64_t duration = (range.stop_msec - range.start_msec) * (utils::ChunkInfo::SECOND / 1000);
+    chunks.push_back(utils::ChunkInfo(MakeVodJitSegmentName(range.index), duration, range.index));
+  }
+
+  return VodSplitJob::WriteVodPlaylist(*playlist_path, chunks);
+}
+
+common::ErrnoError VodJit::MakeSegment(const http_root_t& http_root,
+                                       const std::string& filename,
+                                       size_t index,
+                                       Segment* segment) {
+  if (!segment) {
+    return common::make_errno_error_inval();
+  }
+
+  const file_path_t range_playlist = VodSplitJob::MakeRangePlaylistPath(http_root, filename, index);
+  utils::M3u8Reader reader;
+  if (!reader.Parse(range_playlist)) {
+    return common::make_errno_error(common::MemSPrintf("Can't read playlist of vod segment: %lu", index), EINVAL);
+  }
+
+  const auto segment_path = http_root.MakeFileStringPath(MakeVodJitSegmentName(index));
+  const std::vector<utils::ChunkInfo> chunks = reader.GetChunks();
+  if (!segment_path || chunks.empty()) {
+    return common::make_errno_error_inval();
+  }
+
+  // worker writes whole segment as one chunk, so normally it is only renamed on loop; chunks of range split by
+  // older worker are joined by concatenation; segment appears only when complete, waiting requests are answered
+  // after rename
+  const std::string path = segment_path->GetPath();
+  const std::string tmp_path = path + ".tmp";
+  std::vector<std::string> chunk_paths;
+  for (const utils::ChunkInfo& chunk : chunks) {
+    const auto chunk_path = http_root.MakeFileStringPath(chunk.path);
+    if (!chunk_path) {
+      return common::make_errno_error_inval();
+    }
+    chunk_paths.push_back(chunk_path->GetPath());
+  }
+
+  if (chunk_paths.size() == 1) {
+    if (rename(chunk_paths[0].c_str(), tmp_path.c_str()) != 0) {
+      return common::make_errno_error(errno);
+    }
+  } else {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    for (const std::string& chunk_path : chunk_paths) {
+      std::ifstream in(chunk_path, std::ios::binary);
+      if (!in.is_open() || !(out << in.rdbuf())) {
+        out.close();
+        unlink(tmp_path.c_str());
+        return common::make_errno_error(common::MemSPrintf("Can't join chunk: %s", chunk_path), EIO);
+      }
+    }
+    if (!out.flush()) {
+      out.close();
+      unlink(tmp_path.c_str());
+      return common::make_errno_error("Can't write vod segment", EIO);
+    }
+    for (const std::string& chunk_path : chunk_paths) {
+      unlink(chunk_path.c_str());
+    }
+  }
+
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    const int err = errno;
+    unlink(tmp_path.c_str());  // encoded again on next request
+    return common::make_errno_error(err);
+  }
+  unlink(range_playlist.GetPath().c_str());
+
+  struct stat sb;
+  if (stat(path.c_str(), &sb) != 0) {
+    return common::make_errno_error(errno);
+  }
+
+  *segment = {path, static_cast<size_t>(sb.st_size)};
+  return common::ErrnoError();
+}
+
+bool VodJit::IsSegmentReady(size_t index) const {
+  for (const VodSplitJob::Output& output : outputs_) {
+    const auto path = output.http_root.MakeFileStringPath(MakeVodJitSegmentName(index));
+    if (!path || !common::file_system::is_file_exist(path->GetPath())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VodJit::IsRunning(size_t index) const {
+  for (auto it = running_.begin(); it != running_.end(); ++it) {
+    if (it->second == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace server
+}  // namespace fastocloud
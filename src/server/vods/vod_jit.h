@@ -0,0 +1,93 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include "base/stream_config.h"
+#include "base/types.h"
+#include "base/vod_range.h"
+
+#include "server/vods/vod_split_job.h"
+
+namespace fastocloud {
+namespace server {
+
+// Just in time vod: stream process only indexes keyframes, playlist is written from index and every segment is
+// encoded by worker process when player requests it. Next segments are prefetched by spare workers.
+class VodJit {
+ public:
+  typedef VodSplitJob::http_root_t http_root_t;
+  typedef VodSplitJob::playlist_t file_path_t;
+
+  struct Segment {
+    std::string path;
+    size_t size;
+  };
+  typedef std::vector<Segment> segments_t;
+
+  VodJit(stream_id_t sid, const StreamConfig& config, size_t prefetch);
+
+  stream_id_t GetID() const;
+  StreamConfig GetConfig() const;
+  bool HasHttpRoot(const http_root_t& http_root) const;
+
+  bool IsIndexing() const;  // indexer process is running
+  void SetIndexing(bool indexing);
+  bool IsIndexed() const;
+  bool LoadIndex();
+  common::ErrnoError WritePlaylists() const WARN_UNUSED_RESULT;
+  segments_t GetReadySegments() const;  // generated before, on disk
+
+  // queues requested segment and prefetch of next ones, prefetch queued for old position is dropped
+  bool Request(size_t index);
+  // next segment if there is free worker, returns worker id and its config
+  bool TakeSegment(stream_id_t* wid, StreamConfig* config);
+  // false if process is not worker of this vod, generated segments are appended on success
+  bool OnWorkerExited(stream_id_t wid, bool success, segments_t* segments);
+  std::vector<stream_id_t> GetRunningWorkers() const;
+
+  static bool IsJit(const StreamConfig& config);
+  static common::ErrnoError WritePlaylist(const http_root_t& http_root,
+                                          const std::string& filename,
+                                          const vod_ranges_t& index) WARN_UNUSED_RESULT;
+  // joins chunks encoded by worker into segment listed in playlist
+  static common::ErrnoError MakeSegment(const http_root_t& http_root,
+                                        const std::string& filename,
+                                        size_t index,
+                                        Segment* segment) WARN_UNUSED_RESULT;
+
+ private:
+  bool IsSegmentReady(size_t index) const;
+  bool IsRunning(size_t index) const;
+
+  const stream_id_t sid_;
+  const StreamConfig config_;
+  const size_t prefetch_;
+  const VodSplitJob::outputs_t outputs_;
+
+  vod_ranges_t index_;
+  bool indexing_;
+  std::deque<size_t> queue_;               // segment indexes, requested first
+  std::map<stream_id_t, size_t> running_;  // segment index by worker id
+};
+
+}  // namespace server
+}  // namespace fastocloud
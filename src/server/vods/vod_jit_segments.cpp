@@ -0,0 +1,68 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/vods/vod_jit_segments.h"
+
+namespace fastocloud {
+namespace server {
+
+VodJitSegments::VodJitSegments(size_t max_bytes) : max_bytes_(max_bytes), entries_(), index_(), bytes_(0) {}
+
+std::vector<std::string> VodJitSegments::Add(const std::string& path, size_t size) {
+  Remove(path);
+  entries_.push_front({path, size});
+  index_[path] = entries_.begin();
+  bytes_ += size;
+
+  std::vector<std::string> evicted;
+  while (bytes_ > max_bytes_ && entries_.size() > 1) {
+    const Entry& oldest = entries_.back();
+    evicted.push_back(oldest.path);
+    bytes_ -= oldest.size;
+    index_.erase(oldest.path);
+    entries_.pop_back();
+  }
+  return evicted;
+}
+
+void VodJitSegments::Touch(const std::string& path) {
+  auto it = index_.find(path);
+  if (it == index_.end()) {
+    return;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+}
+
+void VodJitSegments::Remove(const std::string& path) {
+  auto it = index_.find(path);
+  if (it == index_.end()) {
+    return;
+  }
+
+  bytes_ -= it->second->size;
+  entries_.erase(it->second);
+  index_.erase(it);
+}
+
+size_t VodJitSegments::GetBytes() const {
+  return bytes_;
+}
+
+size_t VodJitSegments::GetCount() const {
+  return entries_.size();
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,53 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fastocloud {
+namespace server {
+
+// Segments of just in time vods generated on request, kept on disk while they fit into budget.
+// Least recently requested segments are evicted first, owned by main loop.
+class VodJitSegments {
+ public:
+  explicit VodJitSegments(size_t max_bytes);
+
+  // returns segments to remove from disk, added one is never evicted
+  std::vector<std::string> Add(const std::string& path, size_t size);
+  void Touch(const std::string& path);
+  void Remove(const std::string& path);
+
+  size_t GetBytes() const;
+  size_t GetCount() const;
+
+ private:
+  struct Entry {
+    std::string path;
+    size_t size;
+  };
+  typedef std::list<Entry> entries_t;
+
+  const size_t max_bytes_;
+  entries_t entries_;  // most recently used first
+  std::unordered_map<std::string, entries_t::iterator> index_;
+  size_t bytes_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
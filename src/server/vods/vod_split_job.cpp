@@ -0,0 +1,324 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/vods/vod_split_job.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <common/sprintf.h>
+
+#include "base/config_fields.h"
+#include "base/inputs_outputs.h"
+#include "base/stream_config_parse.h"
+
+#include "server/vods/vods_completeness.h"
+
+#include "utils/m3u8_reader.h"
+#include "utils/m3u8_writer.h"
+
+#define M3U8_ENDLIST "#EXT-X-ENDLIST"
+
+namespace fastocloud {
+namespace server {
+
+VodSplitJob::VodSplitJob(stream_id_t sid, const StreamConfig& config, size_t workers)
+    : sid_(sid),
+      config_(config),
+      workers_(workers),
+      outputs_(GetOutputs(config)),
+      ranges_(),
+      attempts_(),
+      queue_(),
+      running_(),
+      cancelled_(false),
+      failed_(false) {}
+
+stream_id_t VodSplitJob::GetID() const {
+  return sid_;
+}
+
+size_t VodSplitJob::GetWorkersCount() const {
+  return workers_;
+}
+
+vod_ranges_t VodSplitJob::GetRanges() const {
+  return ranges_;
+}
+
+bool VodSplitJob::IsCancelled() const {
+  return cancelled_;
+}
+
+bool VodSplitJob::IsFailed() const {
+  return failed_;
+}
+
+bool VodSplitJob::IsFinished() const {
+  return running_.empty() && (queue_.empty() || cancelled_);
+}
+
+bool VodSplitJob::LoadRanges() {
+  if (outputs_.empty()) {
+    return false;
+  }
+
+  // all outputs are encoded by the same workers, ranges are the same
+  vod_ranges_t ranges;
+  if (!ReadVodRanges(MakeVodRangesPath(outputs_.front().http_root), &ranges)) {
+    return false;
+  }
+
+  SetRanges(ranges);
+  return true;
+}
+
+void VodSplitJob::SetRanges(const vod_ranges_t& ranges) {
+  ranges_ = ranges;
+  attempts_.assign(ranges.size(), 0);
+  queue_.clear();
+}
+
+void VodSplitJob::QueueAllRanges() {
+  queue_.clear();
+  for (const VodRange& range : ranges_) {
+    queue_.push_back(range.index);
+  }
+}
+
+size_t VodSplitJob::QueueMissingRanges() {
+  queue_.clear();
+  for (const VodRange& range : ranges_) {
+    for (const Output& output : outputs_) {
+      if (!IsRangeComplete(MakeRangePlaylistPath(output.http_root, output.filename, range.index))) {
+        queue_.push_back(range.index);
+        break;
+      }
+    }
+  }
+  return queue_.size();
+}
+
+bool VodSplitJob::TakeRange(stream_id_t* wid, StreamConfig* config) {
+  if (!wid || !config) {
+    return false;
+  }
+
+  if (cancelled_ || queue_.empty() || running_.size() >= workers_) {
+    return false;
+  }
+
+  const VodRange range = ranges_[queue_.front()];
+  queue_.pop_front();
+  const stream_id_t lwid = MakeWorkerID(sid_, range.index);
+  running_[lwid] = range.index;
+  attempts_[range.index]++;
+  *wid = lwid;
+  *config = MakeWorkerConfig(config_, range, lwid);
+  return true;
+}
+
+bool VodSplitJob::OnWorkerExited(stream_id_t wid, bool success) {
+  auto it = running_.find(wid);
+  if (it == running_.end()) {
+    return false;
+  }
+
+  const size_t index = it->second;
+  running_.erase(it);
+  if (success || cancelled_) {
+    return true;
+  }
+
+  if (attempts_[index] < max_range_attempts) {
+    queue_.push_back(index);
+  } else {
+    failed_ = true;
+  }
+  return true;
+}
+
+std::vector<stream_id_t> VodSplitJob::GetRunningWorkers() const {
+  std::vector<stream_id_t> workers;
+  for (auto it = running_.begin(); it != running_.end(); ++it) {
+    workers.push_back(it->first);
+  }
+  return workers;
+}
+
+void VodSplitJob::Cancel() {
+  cancelled_ = true;
+  queue_.clear();
+}
+
+common::ErrnoError VodSplitJob::StitchPlaylists() const {
+  for (const Output& output : outputs_) {
+    common::ErrnoError err = StitchPlaylist(output.http_root, output.filename, ranges_);
+    if (err) {
+      return err;
+    }
+  }
+  return common::ErrnoError();
+}
+
+size_t VodSplitJob::GetWorkers(const StreamConfig& config) {
+  if (config->Find(VOD_RANGE_FIELD)) {  // worker itself
+    return 1;
+  }
+
+  bool jit;
+  common::Value* jit_field = config->Find(VOD_JIT_FIELD);
+  if (jit_field && jit_field->GetAsBoolean(&jit) && jit) {  // segments are encoded on request
+    return 1;
+  }
+
+  int workers;
+  common::Value* workers_field = config->Find(VOD_WORKERS_FIELD);
+  if (!workers_field || !workers_field->GetAsInteger(&workers) || workers < 2) {
+    return 1;
+  }
+  return workers;
+}
+
+VodSplitJob::outputs_t VodSplitJob::GetOutputs(const StreamConfig& config) {
+  outputs_t outputs;
+  output_t output;
+  if (read_output(config, &output)) {
+    for (const OutputUri& out_uri : output) {
+      common::uri::Url ouri = out_uri.GetOutput();
+      if (ouri.GetScheme() == common::uri::Url::http) {
+        outputs.push_back({out_uri.GetHttpRoot(), ouri.GetPath().GetFileName()});
+      }
+    }
+  }
+  return outputs;
+}
+
+stream_id_t VodSplitJob::MakeWorkerID(stream_id_t sid, size_t index) {
+  return common::MemSPrintf("%s_r%lu", sid, index);
+}
+
+VodSplitJob::playlist_t VodSplitJob::MakeRangePlaylistPath(const http_root_t& http_root,
+                                                          const std::string& filename,
+                                                          size_t index) {
+  const auto path = http_root.MakeFileStringPath(MakeVodRangePrefix(index) + filename);
+  return path ? *path : playlist_t();
+}
+
+bool VodSplitJob::IsRangeComplete(const playlist_t& playlist) {
+  // playlist of worker which didn't reach end of range has no footer
+  std::ifstream file(playlist.GetPath());
+  if (!file.is_open()) {
+    return false;
+  }
+
+  const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (data.find(M3U8_ENDLIST) == std::string::npos) {
+    return false;
+  }
+  return VodsCompleteness::IsFullVod(playlist);
+}
+
+common::ErrnoError VodSplitJob::StitchPlaylist(const http_root_t& http_root,
+                                               const std::string& filename,
+                                               const vod_ranges_t& ranges) {
+  std::vector<utils::ChunkInfo> chunks;
+  for (const VodRange& range : ranges) {
+    utils::M3u8Reader reader;
+    if (!reader.Parse(MakeRangePlaylistPath(http_root, filename, range.index))) {
+      return common::make_errno_error(common::MemSPrintf("Can't read playlist of vod range: %lu", range.index), EINVAL);
+    }
+
+    const std::vector<utils::ChunkInfo> range_chunks = reader.GetChunks();
+    chunks.insert(chunks.end(), range_chunks.begin(), range_chunks.end());
+  }
+
+  const auto playlist_path = http_root.MakeFileStringPath(filename);
+  if (!playlist_path) {
+    return common::make_errno_error_inval();
+  }
+
+  return WriteVodPlaylist(*playlist_path, chunks);
+}
+
+common::ErrnoError VodSplitJob::WriteVodPlaylist(const playlist_t& playlist,
+                                                 const std::vector<utils::ChunkInfo>& chunks) {
+  uint64_t max_duration = 0;
+  for (const utils::ChunkInfo& chunk : chunks) {
+    max_duration = std::max(max_duration, chunk.duration);
+  }
+
+  // players never see half written playlist
+  const std::string path = playlist.GetPath();
+  const playlist_t tmp_path(path + ".tmp");
+  utils::M3u8Writer writer;
+  common::ErrnoError err =
+      writer.Open(tmp_path, common::file_system::File::FLAG_CREATE_ALWAYS | common::file_system::File::FLAG_WRITE);
+  if (err) {
+    return err;
+  }
+
+  const uint64_t target_duration = (max_duration + utils::ChunkInfo::SECOND - 1) / utils::ChunkInfo::SECOND;
+  err = writer.WriteHeader(0, target_duration);
+  for (size_t i = 0; i < chunks.size() && !err; ++i) {
+    err = writer.WriteLine(chunks[i]);
+  }
+  if (!err) {
+    err = writer.WriteFooter();
+  }
+
+  common::ErrnoError close_err = writer.Close();
+  if (err || close_err) {
+    return err ? err : close_err;
+  }
+
+  if (rename(tmp_path.GetPath().c_str(), path.c_str()) != 0) {
+    return common::make_errno_error(errno);
+  }
+  return common::ErrnoError();
+}
+
+StreamConfig VodSplitJob::MakeWorkerConfig(const StreamConfig& vod_config, const VodRange& range, stream_id_t wid) {
+  std::string json;
+  StreamConfig config;
+  if (MakeJsonFromConfig(vod_config, &json)) {
+    config = StreamConfig(MakeConfigFromJson(json));
+  }
+  if (!config) {
+    return config;
+  }
+
+  // every worker has own logs next to the stream ones
+  std::string feedback_dir;
+  common::Value* feedback_field = config->Find(FEEDBACK_DIR_FIELD);
+  if (feedback_field && feedback_field->GetAsBasicString(&feedback_dir)) {
+    const auto worker_dir =
+        http_root_t(feedback_dir).MakeDirectoryStringPath(common::MemSPrintf("range_%lu", range.index));
+    if (worker_dir) {
+      config->Insert(FEEDBACK_DIR_FIELD, common::Value::CreateStringValueFromBasicString(worker_dir->GetPath()));
+    }
+  }
+
+  config->Insert(ID_FIELD, common::Value::CreateStringValueFromBasicString(wid));
+  config->Insert(VOD_RANGE_FIELD, common::Value::CreateStringValueFromBasicString(common::ConvertToString(range)));
+  config->Insert(CLEANUP_TS_FIELD, common::Value::CreateBooleanValue(false));
+  return config;
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,102 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/file_system/path.h>
+
+#include "base/stream_config.h"
+#include "base/types.h"
+#include "base/vod_range.h"
+
+#include "utils/chunk_info.h"
+
+namespace fastocloud {
+namespace server {
+
+// Vod with more than one worker is encoded by pool of stream processes, first one only probes keyframes and
+// writes ranges. Workers take ranges from shared queue one by one, so fast workers do more of them; failed range
+// is queued again. Finished job stitches range playlists into vod playlist with continuous timestamps.
+class VodSplitJob {
+ public:
+  enum { max_range_attempts = 2 };
+  typedef common::file_system::ascii_directory_string_path http_root_t;
+  typedef common::file_system::ascii_file_string_path playlist_t;
+
+  struct Output {
+    http_root_t http_root;
+    std::string filename;
+  };
+  typedef std::vector<Output> outputs_t;
+
+  VodSplitJob(stream_id_t sid, const StreamConfig& config, size_t workers);
+
+  stream_id_t GetID() const;
+  size_t GetWorkersCount() const;
+  vod_ranges_t GetRanges() const;
+  bool IsCancelled() const;
+  bool IsFailed() const;
+  bool IsFinished() const;  // no running workers and nothing to encode
+
+  // false if vod was not splitted yet or can't be splitted
+  bool LoadRanges();
+  void SetRanges(const vod_ranges_t& ranges);
+
+  void QueueAllRanges();
+  size_t QueueMissingRanges();  // ranges with incomplete playlist or removed chunks
+
+  // next range if there is free worker, returns worker id and its config
+  bool TakeRange(stream_id_t* wid, StreamConfig* config);
+  // false if process is not worker of this job
+  bool OnWorkerExited(stream_id_t wid, bool success);
+  std::vector<stream_id_t> GetRunningWorkers() const;
+  void Cancel();
+
+  common::ErrnoError StitchPlaylists() const WARN_UNUSED_RESULT;
+
+  // workers of splitted vod, 1 if config is encoded by single pipeline
+  static size_t GetWorkers(const StreamConfig& config);
+  static outputs_t GetOutputs(const StreamConfig& config);  // http outputs
+  static stream_id_t MakeWorkerID(stream_id_t sid, size_t index);
+  static StreamConfig MakeWorkerConfig(const StreamConfig& vod_config, const VodRange& range, stream_id_t wid);
+  static playlist_t MakeRangePlaylistPath(const http_root_t& http_root, const std::string& filename, size_t index);
+  static bool IsRangeComplete(const playlist_t& playlist);
+  static common::ErrnoError StitchPlaylist(const http_root_t& http_root,
+                                           const std::string& filename,
+                                           const vod_ranges_t& ranges) WARN_UNUSED_RESULT;
+  static common::ErrnoError WriteVodPlaylist(const playlist_t& playlist,
+                                             const std::vector<utils::ChunkInfo>& chunks) WARN_UNUSED_RESULT;
+
+ private:
+  const stream_id_t sid_;
+  const StreamConfig config_;
+  const size_t workers_;
+  const outputs_t outputs_;
+
+  vod_ranges_t ranges_;
+  std::vector<size_t> attempts_;           // by range index
+  std::deque<size_t> queue_;               // range indexes
+  std::map<stream_id_t, size_t> running_;  // range index by worker id
+  bool cancelled_;
+  bool failed_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
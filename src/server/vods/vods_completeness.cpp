@@ -0,0 +1,122 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/vods/vods_completeness.h"
+
+#include <string>
+
+#include <common/file_system/file_system.h>
+
+#include "utils/m3u8_reader.h"
+
+namespace fastocloud {
+namespace server {
+
+VodsCompleteness::Vod::Vod() : sid(), encoding(false), playlists() {}
+
+VodsCompleteness::VodsCompleteness() : vods_() {}
+
+void VodsCompleteness::Add(const http_root_t& http_root, stream_id_t sid) {
+  Vod& vod = vods_[http_root.GetPath()];
+  vod.sid = sid;
+  vod.playlists.clear();
+}
+
+void VodsCompleteness::Clear() {
+  vods_.clear();
+}
+
+VodsCompleteness::State VodsCompleteness::GetState(const playlist_t& playlist) {
+  const http_root_t http_root(playlist.GetDirectory());
+  auto it = vods_.find(http_root.GetPath());
+  if (it == vods_.end()) {
+    return NOT_VOD;
+  }
+
+  Vod& vod = it->second;
+  if (vod.encoding) {
+    return ENCODING;
+  }
+
+  const std::string path = playlist.GetPath();
+  auto pit = vod.playlists.find(path);
+  if (pit != vod.playlists.end()) {
+    return pit->second;
+  }
+
+  const State state = IsFullVod(playlist) ? COMPLETE : MISSING_CHUNKS;
+  vod.playlists[path] = state;
+  return state;
+}
+
+void VodsCompleteness::OnStreamStarted(stream_id_t sid) {
+  for (auto& vod : vods_) {
+    if (vod.second.sid == sid) {
+      vod.second.encoding = true;
+      vod.second.playlists.clear();
+    }
+  }
+}
+
+void VodsCompleteness::OnStreamExited(stream_id_t sid) {
+  for (auto& vod : vods_) {
+    if (vod.second.sid == sid) {
+      vod.second.encoding = false;
+      vod.second.playlists.clear();
+    }
+  }
+}
+
+void VodsCompleteness::OnChunksRemoved(const http_root_t& http_root) {
+  auto it = vods_.find(http_root.GetPath());
+  if (it == vods_.end()) {
+    return;
+  }
+
+  for (auto& playlist : it->second.playlists) {
+    playlist.second = MISSING_CHUNKS;
+  }
+}
+
+bool VodsCompleteness::IsFullVod(const playlist_t& playlist) {
+  utils::M3u8Reader reader;
+  if (!reader.Parse(playlist)) {
+    return false;
+  }
+
+  const http_root_t dir(playlist.GetDirectory());
+  for (const std::string& variant : reader.GetVariants()) {  // adaptive vod is full when every rendition is
+    const auto variant_path = dir.MakeFileStringPath(variant);
+    if (!variant_path || !IsFullVod(*variant_path)) {
+      return false;
+    }
+  }
+
+  const auto chunks = reader.GetChunks();
+  for (const utils::ChunkInfo& chunk : chunks) {
+    const auto chunk_path = dir.MakeFileStringPath(chunk.path);
+    if (!chunk_path) {
+      return false;
+    }
+
+    if (!common::file_system::is_file_exist(chunk_path->GetPath())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,64 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <common/file_system/path.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+namespace server {
+
+// Completeness of vods playlists, kept by main loop alongside vods links.
+// Playlist is parsed and its chunks are checked only once after invalidation,
+// so playlist requests for ready vods cost a hash lookup.
+class VodsCompleteness {
+ public:
+  enum State { NOT_VOD = 0, ENCODING, COMPLETE, MISSING_CHUNKS };
+  typedef common::file_system::ascii_directory_string_path http_root_t;
+  typedef common::file_system::ascii_file_string_path playlist_t;
+
+  VodsCompleteness();
+
+  void Add(const http_root_t& http_root, stream_id_t sid);
+  void Clear();
+
+  State GetState(const playlist_t& playlist);
+
+  // playlists of vod are checked again after its stream exit
+  void OnStreamStarted(stream_id_t sid);
+  void OnStreamExited(stream_id_t sid);
+  // chunks were removed from folder by cleanup
+  void OnChunksRemoved(const http_root_t& http_root);
+
+  static bool IsFullVod(const playlist_t& playlist);
+
+ private:
+  struct Vod {
+    Vod();
+
+    stream_id_t sid;
+    bool encoding;
+    std::unordered_map<std::string, State> playlists;  // checked playlists by path
+  };
+
+  std::unordered_map<std::string, Vod> vods_;  // by http root
+};
+
+}  // namespace server
+}  // namespace fastocloud
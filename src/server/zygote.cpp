@@ -0,0 +1,319 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/zygote.h"
+
+#if defined(OS_LINUX)
+#include <sys/prctl.h>
+#endif
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <common/file_system/file_system.h>
+#include <common/file_system/string_path_utils.h>
+#include <common/sprintf.h>
+
+#include "base/shared_stream_stats.h"
+#include "base/startup_timing.h"
+#include "base/stream_config.h"
+#include "base/stream_config_parse.h"
+
+#include "pipe/client.h"
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+typedef int (*stream_preinit_t)();
+
+void RunStream(stream_exec_t stream_exec,
+               const stream_id_t& sid,
+               const std::string& config_json,
+               const int* fds,
+               int argc,
+               char** argv) {
+  StartupTiming startup;
+  startup.Mark(STARTUP_FORKED);
+  startup.Set(STARTUP_CORE_LOADED, startup.Get(STARTUP_FORKED));  // loaded by zygote
+  const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
+  set_stream_process_name(new_process_name, argc, argv);
+
+  StreamConfig config(MakeConfigFromJson(config_json));
+  if (!config) {
+    ERROR_LOG() << "Invalid config of stream id: " << sid;
+    _exit(EXIT_FAILURE);
+  }
+
+  SharedStreamStats* shared_stats = nullptr;
+  if (fds[2] != INVALID_DESCRIPTOR) {
+    shared_stats = SharedStreamStats::Attach(fds[2]);
+    close(fds[2]);
+  }
+
+  pipe::Client* client = new pipe::Client(nullptr, fds[0], fds[1]);
+  client->SetName(sid);
+  int res = stream_exec(new_process_name.c_str(), config.get(), client, shared_stats, &startup);
+  client->Close();
+  delete client;
+  _exit(res);
+}
+
+// double fork, so stream is reparented to service when intermediate process exits
+pid_t ForkStream(stream_exec_t stream_exec,
+                 int zygote_fd,
+                 const stream_id_t& sid,
+                 const std::string& config_json,
+                 const int* fds,
+                 int argc,
+                 char** argv) {
+  int pid_pipe[2];
+  if (::pipe(pid_pipe) == ERROR_RESULT_VALUE) {
+    return -1;
+  }
+
+  pid_t middle = fork();
+  if (middle == 0) {
+    close(pid_pipe[0]);
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(pid_pipe[1]);
+      close(zygote_fd);
+      RunStream(stream_exec, sid, config_json, fds, argc, argv);
+    }
+    ssize_t res = write(pid_pipe[1], &pid, sizeof(pid));
+    _exit(res == static_cast<ssize_t>(sizeof(pid)) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  close(pid_pipe[1]);
+  if (middle < 0) {
+    close(pid_pipe[0]);
+    return -1;
+  }
+
+  pid_t pid = -1;
+  ssize_t nread = 0;
+  do {
+    nread = read(pid_pipe[0], &pid, sizeof(pid));
+  } while (nread < 0 && errno == EINTR);
+  close(pid_pipe[0]);
+  if (nread != static_cast<ssize_t>(sizeof(pid))) {
+    pid = -1;
+  }
+
+  while (waitpid(middle, nullptr, 0) < 0 && errno == EINTR) {
+  }
+  return pid;
+}
+
+}  // namespace
+
+void* load_stream_core(stream_exec_t* stream_exec) {
+  if (!stream_exec) {
+    return nullptr;
+  }
+
+  const std::string absolute_source_dir = common::file_system::absolute_path_from_relative(RELATIVE_SOURCE_DIR);
+  const std::string lib_full_path = common::file_system::make_path(absolute_source_dir, CORE_LIBRARY);
+  void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
+  if (!handle) {
+    ERROR_LOG() << "Failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
+    return nullptr;
+  }
+
+  stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(dlsym(handle, "stream_exec"));
+  char* error = dlerror();
+  if (error) {
+    ERROR_LOG() << "Failed to load start stream function error: " << error;
+    dlclose(handle);
+    return nullptr;
+  }
+
+  *stream_exec = stream_exec_func;
+  return handle;
+}
+
+void set_stream_process_name(const std::string& name, int argc, char** argv) {
+  const char* new_name = name.c_str();
+#if defined(OS_LINUX)
+  for (int i = 0; i < argc; ++i) {
+    memset(argv[i], 0, strlen(argv[i]));
+  }
+  char* app_name = argv[0];
+  strncpy(app_name, new_name, name.length());
+  app_name[name.length()] = 0;
+  prctl(PR_SET_NAME, new_name);
+#elif defined(OS_FREEBSD)
+  UNUSED(argc);
+  UNUSED(argv);
+  setproctitle(new_name);
+#else
+#pragma message "Please implement"
+#endif
+}
+
+Zygote* Zygote::Start(int argc, char** argv) {
+#if defined(OS_LINUX)
+  if (prctl(PR_SET_CHILD_SUBREAPER, 1) == ERROR_RESULT_VALUE) {
+    WARNING_LOG() << "Can't become child subreaper, zygote disabled";
+    return nullptr;
+  }
+
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) == ERROR_RESULT_VALUE) {
+    WARNING_LOG() << "Can't create zygote socket, zygote disabled";
+    return nullptr;
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(sv[0]);
+    Run(sv[1], argc, argv);
+    _exit(EXIT_SUCCESS);
+  }
+
+  close(sv[1]);
+  if (pid < 0) {
+    close(sv[0]);
+    WARNING_LOG() << "Can't fork zygote, zygote disabled";
+    return nullptr;
+  }
+
+  INFO_LOG() << "Zygote started pid: " << pid;
+  return new Zygote(pid, sv[0]);
+#else
+  UNUSED(argc);
+  UNUSED(argv);
+  return nullptr;
+#endif
+}
+
+Zygote::Zygote(pid_t pid, int fd) : pid_(pid), fd_(fd), seq_(0), backoff_() {}
+
+Zygote::~Zygote() {
+  KillStaleStreams();
+  close(fd_);  // zygote exits when socket closed
+  if (backoff_.GetFailures() || backoff_.IsExhausted()) {
+    kill(pid_, SIGKILL);  // may be stuck
+  }
+  while (waitpid(pid_, nullptr, 0) < 0 && errno == EINTR) {
+  }
+}
+
+common::ErrnoError Zygote::SpawnStream(const stream_id_t& sid,
+                                       const std::string& config_json,
+                                       int read_command_fd,
+                                       int write_responce_fd,
+                                       int shared_stats_fd,
+                                       pid_t* pid) {
+  if (!pid) {
+    return common::make_errno_error_inval();
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (!backoff_.CanSpawn(now)) {
+    return common::make_errno_error("Zygote disabled", ECHILD);
+  }
+
+  KillStaleStreams();
+  const uint32_t seq = ++seq_;
+  const int fds[ZYGOTE_MAX_FDS] = {read_command_fd, write_responce_fd, shared_stats_fd};
+  const size_t nfds = shared_stats_fd == INVALID_DESCRIPTOR ? ZYGOTE_MAX_FDS - 1 : ZYGOTE_MAX_FDS;
+  common::ErrnoError err = SendSpawnRequest(fd_, seq, sid, config_json, fds, nfds);
+  if (err) {
+    const int code = err->GetErrorCode();
+    if (code == EAGAIN) {  // zygote doesn't read requests
+      OnSpawnFailed(now, err);
+    } else if (code == EPIPE || code == ECONNRESET) {
+      backoff_.Exhaust();
+      WARNING_LOG() << "Zygote is gone, zygote disabled, error: " << err->GetDescription();
+    }
+    return err;
+  }
+
+  err = WaitSpawnReply(fd_, seq, reply_timeout_msec, pid);
+  if (!err) {
+    backoff_.OnSuccess();
+    return err;
+  }
+
+  const int code = err->GetErrorCode();
+  if (code == ETIMEDOUT) {
+    OnSpawnFailed(now, err);
+  } else if (code != ECHILD) {  // socket is broken, zygote can't be forked again from threaded service
+    backoff_.Exhaust();
+    WARNING_LOG() << "Zygote is gone, zygote disabled, error: " << err->GetDescription();
+  }
+  return err;
+}
+
+void Zygote::OnSpawnFailed(std::chrono::steady_clock::time_point now, common::ErrnoError err) {
+  backoff_.OnFailure(now);
+  if (backoff_.IsExhausted()) {
+    WARNING_LOG() << "Zygote failed " << backoff_.GetFailures() << " times in a row, zygote disabled, error: "
+                  << err->GetDescription();
+    return;
+  }
+  WARNING_LOG() << "Zygote failed, streams are forked by service for a while, error: " << err->GetDescription();
+}
+
+bool Zygote::IsDisabled() const {
+  return !backoff_.CanSpawn(std::chrono::steady_clock::now());
+}
+
+void Zygote::KillStaleStreams() {
+  // no request is waited here, so every reply is stale
+  KillStaleSpawns(fd_);
+}
+
+void Zygote::Run(int fd, int argc, char** argv) {
+  set_stream_process_name(STREAMER_NAME "_zygote", argc, argv);
+
+  stream_exec_t stream_exec = nullptr;
+  void* handle = load_stream_core(&stream_exec);
+  if (!handle) {
+    _exit(EXIT_FAILURE);
+  }
+
+  stream_preinit_t stream_preinit = reinterpret_cast<stream_preinit_t>(dlsym(handle, "stream_preinit"));
+  if (stream_preinit) {
+    stream_preinit();
+  }
+
+  std::vector<char> buffer;
+  SpawnRequest request;
+  while (ReadSpawnRequest(fd, &buffer, &request)) {
+    SpawnReply reply = {request.seq, -1};
+    if (request.seq) {
+      reply.pid = ForkStream(stream_exec, fd, request.sid, request.config_json, request.fds, argc, argv);
+    }
+
+    for (size_t i = 0; i < request.nfds; ++i) {
+      close(request.fds[i]);
+    }
+    ignore_result(SendSpawnReply(fd, reply));
+  }
+
+  dlclose(handle);
+  _exit(EXIT_SUCCESS);
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,83 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <string>
+
+#include <common/error.h>
+
+#include "base/types.h"
+
+#include "server/zygote_protocol.h"
+
+namespace fastocloud {
+namespace server {
+
+typedef int (*stream_exec_t)(const char* process_name,
+                             const void* args,
+                             void* command_client,
+                             void* shared_stats,
+                             const void* startup_timing);
+
+// dlopen of CORE_LIBRARY, nullptr if failed
+void* load_stream_core(stream_exec_t* stream_exec);
+// renames current process to STREAMER_NAME_<sid>, argv is overwritten
+void set_stream_process_name(const std::string& name, int argc, char** argv);
+
+// Pre-forked helper process with core library loaded and stream backend initialized (registry loaded, common
+// plugins preloaded). Forks ready to run stream processes on request, they are reparented to service (child
+// subreaper) so service waits them as own children.
+class Zygote {
+ public:
+  enum { reply_timeout_msec = 500 };
+
+  // must be called before service starts threads, nullptr if platform not supported or fork failed
+  static Zygote* Start(int argc, char** argv);
+  ~Zygote();
+
+  // descriptors are duplicated into stream process, caller still owns and closes them
+  // shared_stats_fd is descriptor from SharedStreamStats::CreateShared or INVALID_DESCRIPTOR
+  // waits reply not longer than reply_timeout_msec, on failure caller should fork itself; zygote which didn't reply
+  // is skipped for a backoff and disabled after SpawnBackoff::max_failures in a row or when it exited
+  common::ErrnoError SpawnStream(const stream_id_t& sid,
+                                 const std::string& config_json,
+                                 int read_command_fd,
+                                 int write_responce_fd,
+                                 int shared_stats_fd,
+                                 pid_t* pid) WARN_UNUSED_RESULT;
+
+  bool IsDisabled() const;  // true while backing off too
+
+  // kills streams from replies that came after their request timed out, caller already forked them itself
+  void KillStaleStreams();
+
+ private:
+  Zygote(pid_t pid, int fd);
+
+  static void Run(int fd, int argc, char** argv);
+  void OnSpawnFailed(std::chrono::steady_clock::time_point now, common::ErrnoError err);
+
+  const pid_t pid_;
+  const int fd_;
+  uint32_t seq_;  // id of the last request
+  SpawnBackoff backoff_;
+
+  DISALLOW_COPY_AND_ASSIGN(Zygote);
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,241 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/zygote_protocol.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+
+namespace fastocloud {
+namespace server {
+namespace {
+
+union ControlBuffer {
+  char buffer[CMSG_SPACE(sizeof(int) * ZYGOTE_MAX_FDS)];
+  struct cmsghdr align;
+};
+
+void KillStaleSpawn(const SpawnReply& reply) {
+  if (reply.pid > 0) {
+    WARNING_LOG() << "Zygote late reply, kill stream pid: " << reply.pid;
+    kill(reply.pid, SIGKILL);
+  }
+}
+
+}  // namespace
+
+SpawnRequest::SpawnRequest()
+    : seq(0), sid(), config_json(), fds{INVALID_DESCRIPTOR, INVALID_DESCRIPTOR, INVALID_DESCRIPTOR}, nfds(0) {}
+
+common::ErrnoError SendSpawnRequest(int fd,
+                                    uint32_t seq,
+                                    const stream_id_t& sid,
+                                    const std::string& config_json,
+                                    const int* fds,
+                                    size_t nfds) {
+  if (!fds || nfds == 0 || nfds > ZYGOTE_MAX_FDS) {
+    return common::make_errno_error_inval();
+  }
+
+  SpawnRequestHeader header = {seq, static_cast<uint32_t>(sid.size()), static_cast<uint32_t>(config_json.size())};
+  if (sizeof(header) + sid.size() + config_json.size() > zygote_max_request_size) {
+    return common::make_errno_error("Stream config is too big for zygote", EINVAL);
+  }
+
+  struct iovec iov[3];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = const_cast<char*>(sid.data());
+  iov[1].iov_len = sid.size();
+  iov[2].iov_base = const_cast<char*>(config_json.data());
+  iov[2].iov_len = config_json.size();
+
+  ControlBuffer control;
+  memset(&control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 3;
+  msg.msg_control = control.buffer;
+  msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+
+  if (sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT) == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+  return common::ErrnoError();
+}
+
+common::ErrnoError WaitSpawnReply(int fd, uint32_t seq, int timeout_msec, pid_t* pid) {
+  if (!pid) {
+    return common::make_errno_error_inval();
+  }
+
+  // reply takes about as long as fork, wait is bounded in case zygote got stuck
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_msec);
+  while (true) {
+    const auto left =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int res = left > 0 ? poll(&pfd, 1, left) : 0;
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res < 0) {
+      return common::make_errno_error(errno);
+    }
+    if (res == 0) {
+      return common::make_errno_error("Zygote reply timeout", ETIMEDOUT);
+    }
+
+    SpawnReply reply;
+    ssize_t nread = recv(fd, &reply, sizeof(reply), MSG_DONTWAIT);
+    if (nread < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (nread == 0 || (nread < 0 && errno == ECONNRESET)) {  // reset if it exited with requests not read
+      return common::make_errno_error("Zygote exited", EPIPE);
+    }
+    if (nread < 0) {
+      return common::make_errno_error(errno);
+    }
+    if (nread != static_cast<ssize_t>(sizeof(reply))) {
+      continue;
+    }
+    if (reply.seq != seq) {
+      KillStaleSpawn(reply);
+      continue;
+    }
+    if (reply.pid <= 0) {
+      return common::make_errno_error("Zygote can't fork stream", ECHILD);
+    }
+
+    *pid = reply.pid;
+    return common::ErrnoError();
+  }
+}
+
+void KillStaleSpawns(int fd) {
+  while (true) {
+    SpawnReply reply;
+    ssize_t nread = recv(fd, &reply, sizeof(reply), MSG_DONTWAIT);
+    if (nread < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nread <= 0) {
+      return;
+    }
+    if (nread == static_cast<ssize_t>(sizeof(reply))) {
+      KillStaleSpawn(reply);
+    }
+  }
+}
+
+bool ReadSpawnRequest(int fd, std::vector<char>* buffer, SpawnRequest* request) {
+  if (!buffer || !request) {
+    return false;
+  }
+
+  *request = SpawnRequest();
+  buffer->resize(zygote_max_request_size);
+  struct iovec iov;
+  iov.iov_base = buffer->data();
+  iov.iov_len = buffer->size();
+  ControlBuffer control;
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buffer;
+  msg.msg_controllen = sizeof(control.buffer);
+  ssize_t nread = 0;
+  do {
+    nread = recvmsg(fd, &msg, 0);
+  } while (nread < 0 && errno == EINTR);
+  if (nread <= 0) {  // service closed socket
+    return false;
+  }
+
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      request->nfds = std::min<size_t>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int), ZYGOTE_MAX_FDS);
+      memcpy(request->fds, CMSG_DATA(cmsg), sizeof(int) * request->nfds);
+    }
+  }
+
+  SpawnRequestHeader header;
+  const size_t size = nread;
+  if ((msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || request->nfds < 2 || size < sizeof(header)) {
+    return true;
+  }
+
+  memcpy(&header, buffer->data(), sizeof(header));
+  if (sizeof(header) + header.sid_size + header.config_size != size) {
+    return true;
+  }
+
+  const char* payload = buffer->data() + sizeof(header);
+  request->seq = header.seq;
+  request->sid = stream_id_t(payload, header.sid_size);
+  request->config_json = std::string(payload + header.sid_size, header.config_size);
+  return true;
+}
+
+bool SendSpawnReply(int fd, const SpawnReply& reply) {
+  return send(fd, &reply, sizeof(reply), MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(reply));
+}
+
+SpawnBackoff::SpawnBackoff() : failures_(0), retry_time_(), exhausted_(false) {}
+
+bool SpawnBackoff::IsExhausted() const {
+  return exhausted_;
+}
+
+bool SpawnBackoff::CanSpawn(time_point_t now) const {
+  return !exhausted_ && now >= retry_time_;
+}
+
+void SpawnBackoff::OnSuccess() {
+  failures_ = 0;
+  retry_time_ = time_point_t();
+}
+
+void SpawnBackoff::OnFailure(time_point_t now) {
+  if (++failures_ >= max_failures) {
+    exhausted_ = true;
+    return;
+  }
+  retry_time_ = now + std::chrono::milliseconds(static_cast<int64_t>(backoff_msec) << (failures_ - 1));
+}
+
+void SpawnBackoff::Exhaust() {
+  exhausted_ = true;
+}
+
+size_t SpawnBackoff::GetFailures() const {
+  return failures_;
+}
+
+}  // namespace server
+}  // namespace fastocloud
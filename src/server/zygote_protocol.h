@@ -0,0 +1,101 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include "base/types.h"
+
+#define ZYGOTE_MAX_FDS 3
+
+namespace fastocloud {
+namespace server {
+
+// Service and zygote talk over SOCK_SEQPACKET socket: request is header, sid and config json in one packet with
+// command/response descriptors (and shared stats one) attached, reply is SpawnReply. Every request has own seq,
+// reply with other seq belongs to request which timed out, service already forked that stream itself.
+struct SpawnRequestHeader {
+  uint32_t seq;
+  uint32_t sid_size;
+  uint32_t config_size;
+};
+
+struct SpawnReply {
+  uint32_t seq;  // seq of request, 0 if request was malformed
+  pid_t pid;     // -1 if fork failed
+};
+
+struct SpawnRequest {
+  SpawnRequest();
+
+  uint32_t seq;  // 0 if request is malformed
+  stream_id_t sid;
+  std::string config_json;
+  int fds[ZYGOTE_MAX_FDS];  // INVALID_DESCRIPTOR if not sent
+  size_t nfds;
+};
+
+enum { zygote_max_request_size = 128 * 1024 };
+
+// service side, never blocks, EAGAIN means zygote doesn't read requests
+common::ErrnoError SendSpawnRequest(int fd,
+                                    uint32_t seq,
+                                    const stream_id_t& sid,
+                                    const std::string& config_json,
+                                    const int* fds,
+                                    size_t nfds) WARN_UNUSED_RESULT;
+// service side, waits reply with seq not longer than timeout_msec (ETIMEDOUT), streams of stale replies are killed,
+// ECHILD if zygote couldn't fork, EPIPE if it exited
+common::ErrnoError WaitSpawnReply(int fd, uint32_t seq, int timeout_msec, pid_t* pid) WARN_UNUSED_RESULT;
+// service side, kills streams of replies which are already there, no request is waited when it is called
+void KillStaleSpawns(int fd);
+
+// zygote side, blocks, false if service closed socket; received descriptors are owned by caller even if request
+// is malformed
+bool ReadSpawnRequest(int fd, std::vector<char>* buffer, SpawnRequest* request);
+bool SendSpawnReply(int fd, const SpawnReply& reply);
+
+// zygote which didn't reply is skipped for a backoff which doubles with every failure in a row,
+// after max_failures in a row it isn't used anymore
+class SpawnBackoff {
+ public:
+  typedef std::chrono::steady_clock::time_point time_point_t;
+  enum { max_failures = 3, backoff_msec = 5000 };
+
+  SpawnBackoff();
+
+  bool IsExhausted() const;
+  bool CanSpawn(time_point_t now) const;
+
+  void OnSuccess();
+  void OnFailure(time_point_t now);
+  void Exhaust();  // zygote is gone, there is nothing to wait for
+
+  size_t GetFailures() const;
+
+ private:
+  size_t failures_;  // in a row
+  time_point_t retry_time_;
+  bool exhausted_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -50,4 +50,34 @@ common::Error StatisticStreamBroadcast(const StatisticInfo& params, fastotv::pro
   return common::Error();
 }
 
+common::Error InputStallStreamBroadcast(const InputStallInfo& params, fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  std::string req_str;
+  common::Error err_ser = params.SerializeToString(&req_str);
+  if (err_ser) {
+    return err_ser;
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(INPUT_STALL_STREAM, req_str);
+  return common::Error();
+}
+
+common::Error StartupStreamBroadcast(const StartupInfo& params, fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  std::string req_str;
+  common::Error err_ser = params.SerializeToString(&req_str);
+  if (err_ser) {
+    return err_ser;
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(STARTUP_STREAM, req_str);
+  return common::Error();
+}
+
 }  // namespace fastocloud
@@ -17,6 +17,8 @@
 #include <fastotv/protocol/types.h>
 
 #include "stream_commands/commands_info/changed_sources_info.h"
+#include "stream_commands/commands_info/input_stall_info.h"
+#include "stream_commands/commands_info/startup_info.h"
 #include "stream_commands/commands_info/statistic_info.h"
 
 namespace fastocloud {
@@ -24,5 +26,7 @@ namespace fastocloud {
 // Broadcast
 common::Error ChangedSourcesStreamBroadcast(const ChangedSouresInfo& params, fastotv::protocol::request_t* req);
 common::Error StatisticStreamBroadcast(const StatisticInfo& params, fastotv::protocol::request_t* req);
+common::Error InputStallStreamBroadcast(const InputStallInfo& params, fastotv::protocol::request_t* req);
+common::Error StartupStreamBroadcast(const StartupInfo& params, fastotv::protocol::request_t* req);
 
 }  // namespace fastocloud
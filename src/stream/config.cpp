@@ -18,7 +18,13 @@ namespace fastocloud {
 namespace stream {
 
 Config::Config(StreamType type, size_t max_restart_attempts, const input_t& input, const output_t& output)
-    : type_(type), max_restart_attempts_(max_restart_attempts), ttl_sec_(), input_(input), output_(output) {}
+    : type_(type),
+      max_restart_attempts_(max_restart_attempts),
+      ttl_sec_(),
+      stall_timeout_msec_(),
+      trace_elements_(false),
+      input_(input),
+      output_(output) {}
 
 Config::~Config() {}
 
@@ -58,6 +64,22 @@ void Config::SetTimeToLifeStream(ttl_t ttl) {
   ttl_sec_ = ttl;
 }
 
+Config::stall_timeout_t Config::GetStallTimeout() const {
+  return stall_timeout_msec_;
+}
+
+void Config::SetStallTimeout(stall_timeout_t timeout) {
+  stall_timeout_msec_ = timeout;
+}
+
+bool Config::GetTraceElements() const {
+  return trace_elements_;
+}
+
+void Config::SetTraceElements(bool trace) {
+  trace_elements_ = trace;
+}
+
 Config* Config::Clone() const {
   return new Config(*this);
 }
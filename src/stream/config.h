@@ -25,6 +25,7 @@ class Config : public common::ClonableBase<Config> {
  public:
   enum { report_delay_sec = 10 };
   typedef common::Optional<time_t> ttl_t;
+  typedef common::Optional<size_t> stall_timeout_t;
   Config(StreamType type, size_t max_restart_attempts, const input_t& input, const output_t& output);
   virtual ~Config();
 
@@ -42,12 +43,20 @@ class Config : public common::ClonableBase<Config> {
   ttl_t GetTimeToLifeStream() const;
   void SetTimeToLifeStream(ttl_t ttl);
 
+  stall_timeout_t GetStallTimeout() const;  // msec, stream default for input type if not set, 0 turns it off
+  void SetStallTimeout(stall_timeout_t timeout);
+
+  bool GetTraceElements() const;  // per element rates and processing time in statistic, off by default
+  void SetTraceElements(bool trace);
+
   Config* Clone() const override;
 
  private:
   StreamType type_;
   size_t max_restart_attempts_;
   ttl_t ttl_sec_;
+  stall_timeout_t stall_timeout_msec_;
+  bool trace_elements_;
 
   input_t input_;
   output_t output_;
@@ -202,6 +202,18 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
     conf.SetTimeToLifeStream(ttl_sec);
   }
 
+  int stall_timeout_msec;
+  common::Value* stall_timeout_field = config_args->Find(STALL_TIMEOUT_FIELD);
+  if (stall_timeout_field && stall_timeout_field->GetAsInteger(&stall_timeout_msec) && stall_timeout_msec >= 0) {
+    conf.SetStallTimeout(stall_timeout_msec);
+  }
+
+  bool trace_elements;
+  common::Value* trace_elements_field = config_args->Find(TRACE_ELEMENTS_FIELD);
+  if (trace_elements_field && trace_elements_field->GetAsBoolean(&trace_elements)) {
+    conf.SetTraceElements(trace_elements);
+  }
+
   streams::AudioVideoConfig aconf(conf);
   bool have_video;
   common::Value* have_video_field = config_args->Find(HAVE_VIDEO_FIELD);
@@ -279,6 +291,18 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
       econfig->SetRelayVideo(relay_video);
     }
 
+    bool hot_swap;
+    common::Value* hot_swap_field = config_args->Find(HOT_SWAP_FIELD);
+    if (hot_swap_field && hot_swap_field->GetAsBoolean(&hot_swap)) {
+      econfig->SetHotSwap(hot_swap);
+    }
+
+    bool input_redundancy;
+    common::Value* input_redundancy_field = config_args->Find(INPUT_REDUNDANCY_FIELD);
+    if (input_redundancy_field && input_redundancy_field->GetAsBoolean(&input_redundancy)) {
+      econfig->SetInputRedundancy(input_redundancy);
+    }
+
     bool deinterlace;
     common::Value* deinterlace_field = config_args->Find(DEINTERLACE_FIELD);
     if (deinterlace_field && deinterlace_field->GetAsBoolean(&deinterlace)) {
@@ -364,6 +388,23 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
       }
     }
 
+    common::ArrayValue* renditions_arr = nullptr;
+    common::Value* renditions_field = config_args->Find(RENDITIONS_FIELD);
+    if (renditions_field && renditions_field->GetAsList(&renditions_arr)) {
+      renditions_t renditions;
+      for (size_t i = 0; i < renditions_arr->GetSize(); ++i) {
+        common::Value* rendition = nullptr;
+        common::HashValue* rendition_hash = nullptr;
+        if (renditions_arr->Get(i, &rendition) && rendition->GetAsHash(&rendition_hash)) {
+          const auto rend = Rendition::MakeRendition(rendition_hash);
+          if (rend) {
+            renditions.push_back(*rend);
+          }
+        }
+      }
+      econfig->SetRenditions(renditions);
+    }
+
     common::media::Rational rat;
     common::Value* rat_field = config_args->Find(ASPECT_RATIO_FIELD);
     std::string rat_str;
@@ -393,6 +434,25 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
       if (cleanup_ts_field && cleanup_ts_field->GetAsBoolean(&cleanup_ts)) {
         vconf->SetCleanupTS(cleanup_ts);
       }
+
+      int workers;
+      common::Value* workers_field = config_args->Find(VOD_WORKERS_FIELD);
+      if (workers_field && workers_field->GetAsInteger(&workers) && workers > 0) {
+        vconf->SetWorkers(workers);
+      }
+
+      std::string range_str;
+      VodRange range;
+      common::Value* range_field = config_args->Find(VOD_RANGE_FIELD);
+      if (range_field && range_field->GetAsBasicString(&range_str) && common::ConvertFromString(range_str, &range)) {
+        vconf->SetRange(range);
+      }
+
+      bool jit;
+      common::Value* jit_field = config_args->Find(VOD_JIT_FIELD);
+      if (jit_field && jit_field->GetAsBoolean(&jit)) {
+        vconf->SetJit(jit);
+      }
     }
 
     *config = econfig;
@@ -0,0 +1,422 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/element_tracer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "stream/elements/element.h"
+
+namespace {
+
+bool GetLevelProperty(GstElement* element, const char* property, guint64* out) {
+  GObjectClass* klass = G_OBJECT_GET_CLASS(element);
+  if (!g_object_class_find_property(klass, property)) {
+    return false;
+  }
+
+  GValue value = G_VALUE_INIT;
+  g_value_init(&value, G_TYPE_UINT64);  // queue levels are guint or guint64, both transformable
+  g_object_get_property(G_OBJECT(element), property, &value);
+  *out = g_value_get_uint64(&value);
+  g_value_unset(&value);
+  return true;
+}
+
+// percent of the nearest limit among buffers, bytes and time limits of queue and queue2
+int GetQueueFill(GstElement* element) {
+  static const char* const kLevels[][2] = {{"current-level-buffers", "max-size-buffers"},
+                                           {"current-level-bytes", "max-size-bytes"},
+                                           {"current-level-time", "max-size-time"}};
+
+  int fill = fastocloud::ElementStats::no_queue;
+  for (const auto& level : kLevels) {
+    guint64 current = 0;
+    guint64 max = 0;
+    if (!GetLevelProperty(element, level[0], &current) || !GetLevelProperty(element, level[1], &max)) {
+      continue;
+    }
+
+    fill = std::max(fill, 0);
+    if (max) {  // 0 is unlimited
+      fill = std::max(fill, static_cast<int>(std::min(current * 100 / max, static_cast<guint64>(100))));
+    }
+  }
+  return fill;
+}
+
+// upper estimate of buffers element keeps inside: queue limits, encoder lookahead, reordering and frame threads
+guint64 GetHeldBuffers(GstElement* element) {
+  static const char* const kHeld[] = {"max-size-buffers", "rc-lookahead", "lookahead", "bframes"};
+
+  guint64 held = 0;
+  for (const char* property : kHeld) {
+    guint64 value = 0;
+    if (GetLevelProperty(element, property, &value)) {
+      held += value;
+    }
+  }
+
+  guint64 threads = 0;
+  if (GetLevelProperty(element, "threads", &threads)) {
+    held += threads ? threads : g_get_num_processors() * 3 / 2;  // x264 frame threads in auto mode
+  }
+  return held;
+}
+
+}  // namespace
+
+namespace fastocloud {
+namespace stream {
+
+ProcTimeHistogram::ProcTimeHistogram() : counts_(), collected_() {
+  for (size_t i = 0; i < buckets_count; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void ProcTimeHistogram::Add(proctime_t usec) {
+  counts_[GetBucket(usec)].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ProcTimeHistogram::CollectPercentiles(proctime_t* p50, proctime_t* p95, proctime_t* p99) {
+  if (!p50 || !p95 || !p99) {
+    return false;
+  }
+
+  uint64_t diff[buckets_count];
+  uint64_t total = 0;
+  for (size_t i = 0; i < buckets_count; ++i) {
+    const uint64_t current = counts_[i].load(std::memory_order_relaxed);
+    diff[i] = current - collected_[i];
+    collected_[i] = current;
+    total += diff[i];
+  }
+
+  if (!total) {
+    return false;
+  }
+
+  const uint64_t percents[] = {50, 95, 99};
+  proctime_t* results[] = {p50, p95, p99};
+  size_t bucket = 0;
+  uint64_t seen = diff[0];
+  for (size_t i = 0; i < SIZEOFMASS(percents); ++i) {
+    const uint64_t rank = (total * percents[i] + 99) / 100;  // nearest rank
+    while (seen < rank && bucket + 1 < buckets_count) {
+      seen += diff[++bucket];
+    }
+    *results[i] = GetBucketValue(bucket);
+  }
+  return true;
+}
+
+size_t ProcTimeHistogram::GetBucket(proctime_t usec) {
+  if (usec < sub_buckets) {
+    return usec;
+  }
+
+  size_t power = 2;  // sub_buckets is 1 << 2
+  while (usec >> (power + 1)) {
+    power++;
+  }
+
+  const size_t sub = (usec >> (power - 2)) & (sub_buckets - 1);
+  return std::min(sub_buckets + (power - 2) * sub_buckets + sub, static_cast<size_t>(buckets_count - 1));
+}
+
+ProcTimeHistogram::proctime_t ProcTimeHistogram::GetBucketValue(size_t bucket) {
+  if (bucket < sub_buckets) {
+    return bucket;
+  }
+
+  const size_t power = (bucket - sub_buckets) / sub_buckets + 2;
+  const proctime_t sub = (bucket - sub_buckets) % sub_buckets;
+  const proctime_t width = static_cast<proctime_t>(1) << (power - 2);
+  return (sub_buckets + sub) * width + width / 2;
+}
+
+class ElementTracer::ElementTrace {
+ public:
+  // buffers inside of element waiting to be matched by pts, table is twice bigger than element can keep
+  enum { min_pending = 64, max_pending = 8192, pending_probes = 8 };
+  // buffers dropped inside of element never leave, their slots are reused after this
+  enum { pending_timeout_usec = 30 * G_USEC_PER_SEC };
+
+  ElementTrace(GstElement* element, const std::string& name)
+      : element_(GST_ELEMENT(gst_object_ref(element))),
+        name_(name),
+        pads_(),
+        refs_(1),
+        in_buffers_(0),
+        out_buffers_(0),
+        collected_in_(0),
+        collected_out_(0),
+        pending_bits_(GetPendingBits(element)),
+        pending_(new Pending[static_cast<size_t>(1) << pending_bits_]),
+        proctime_() {
+    for (size_t i = 0; i < GetPendingSize(); ++i) {
+      pending_[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+      pending_[i].time.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  GstElement* GetElement() const { return element_; }
+
+  const std::string& GetName() const { return name_; }
+
+  bool HasPad(GstPad* pad) const {
+    for (const auto& attached : pads_) {
+      if (attached.first == pad) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void AttachPad(GstPad* pad) {
+    // no scheduling flags, so pushed and pulled buffers both are seen
+    const GstPadProbeType mask =
+        static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST);
+    const GstPadProbeCallback callback =
+        GST_PAD_DIRECTION(pad) == GST_PAD_SINK ? sink_callback_probe : src_callback_probe;
+    Ref();  // released by probe destroy notify
+    gulong id = gst_pad_add_probe(pad, mask, callback, this, destroy_callback_probe);  // not idle, never 0
+    pads_.push_back(std::make_pair(GST_PAD(gst_object_ref(pad)), id));
+  }
+
+  // removes probes and drops references to gstreamer objects, trace is deleted with last probe
+  void Detach() {
+    for (const auto& attached : pads_) {
+      gst_pad_remove_probe(attached.first, attached.second);
+      gst_object_unref(attached.first);
+    }
+    pads_.clear();
+    gst_object_unref(element_);
+    Unref();
+  }
+
+  void Collect(ElementStats* stats, gint64 elapsed_usec) {
+    const uint64_t in = in_buffers_.load(std::memory_order_relaxed);
+    const uint64_t out = out_buffers_.load(std::memory_order_relaxed);
+    if (elapsed_usec > 0) {
+      stats->SetInputRate(static_cast<double>(in - collected_in_) * G_USEC_PER_SEC / elapsed_usec);
+      stats->SetOutputRate(static_cast<double>(out - collected_out_) * G_USEC_PER_SEC / elapsed_usec);
+    }
+    collected_in_ = in;
+    collected_out_ = out;
+
+    ProcTimeHistogram::proctime_t p50, p95, p99;
+    if (proctime_.CollectPercentiles(&p50, &p95, &p99)) {
+      stats->SetProcTime(p50, p95, p99);
+    }
+    stats->SetQueueFill(GetQueueFill(element_));
+  }
+
+ private:
+  // slot is claimed by cas of pts, so several sink pads and src pad threads don't need a lock
+  struct Pending {
+    std::atomic<GstClockTime> pts;  // GST_CLOCK_TIME_NONE if free
+    std::atomic<gint64> time;       // monotonic usec
+  };
+  static const GstClockTime claimed_pts = GST_CLOCK_TIME_NONE - 1;  // time is being written
+
+  static size_t GetPendingBits(GstElement* element) {
+    const guint64 wanted = std::min(std::max(GetHeldBuffers(element) * 2, static_cast<guint64>(min_pending)),
+                                    static_cast<guint64>(max_pending));
+    size_t bits = 0;
+    while ((static_cast<guint64>(1) << bits) < wanted) {
+      bits++;
+    }
+    return bits;
+  }
+
+  size_t GetPendingSize() const { return static_cast<size_t>(1) << pending_bits_; }
+
+  size_t GetPendingSlot(GstClockTime pts, size_t probe) const {
+    const uint64_t hash = pts * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15);  // pts are multiples of frame duration
+    return ((hash >> (64 - pending_bits_)) + probe) & (GetPendingSize() - 1);
+  }
+
+  ~ElementTrace() {}
+
+  void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  void Enter(GstBuffer* buffer, gint64 now) {
+    in_buffers_.fetch_add(1, std::memory_order_relaxed);
+    if (!GST_BUFFER_PTS_IS_VALID(buffer)) {
+      return;
+    }
+
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    for (size_t i = 0; i < pending_probes; ++i) {
+      Pending* pending = &pending_[GetPendingSlot(pts, i)];
+      GstClockTime current = pending->pts.load(std::memory_order_acquire);
+      const bool is_free = current == GST_CLOCK_TIME_NONE ||
+                           (current != claimed_pts &&
+                            now - pending->time.load(std::memory_order_relaxed) > pending_timeout_usec);
+      if (is_free && pending->pts.compare_exchange_strong(current, claimed_pts, std::memory_order_acq_rel)) {
+        pending->time.store(now, std::memory_order_relaxed);
+        pending->pts.store(pts, std::memory_order_release);
+        return;
+      }
+    }
+    // all probed slots are busy, this buffer is only counted
+  }
+
+  void Leave(GstBuffer* buffer, gint64 now) {
+    out_buffers_.fetch_add(1, std::memory_order_relaxed);
+    if (!GST_BUFFER_PTS_IS_VALID(buffer)) {
+      return;
+    }
+
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    for (size_t i = 0; i < pending_probes; ++i) {  // reordering encoders keep pts
+      Pending* pending = &pending_[GetPendingSlot(pts, i)];
+      GstClockTime current = pending->pts.load(std::memory_order_acquire);
+      if (current != pts) {
+        continue;
+      }
+
+      const gint64 enter_time = pending->time.load(std::memory_order_relaxed);
+      if (pending->pts.compare_exchange_strong(current, GST_CLOCK_TIME_NONE, std::memory_order_acq_rel)) {
+        proctime_.Add(now > enter_time ? now - enter_time : 0);
+        return;
+      }
+    }
+  }
+
+  template <typename F>
+  static void ForEachBuffer(GstPadProbeInfo* info, F func) {
+    void* data = GST_PAD_PROBE_INFO_DATA(info);
+    if (GST_IS_BUFFER(data)) {
+      func(GST_PAD_PROBE_INFO_BUFFER(info));
+    } else if (GST_IS_BUFFER_LIST(data)) {
+      GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+      guint len = gst_buffer_list_length(buffer_list);
+      for (guint i = 0; i < len; ++i) {
+        func(gst_buffer_list_get(buffer_list, i));
+      }
+    }
+  }
+
+  static GstPadProbeReturn sink_callback_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    UNUSED(pad);
+    ElementTrace* trace = reinterpret_cast<ElementTrace*>(user_data);
+    const gint64 now = g_get_monotonic_time();
+    ForEachBuffer(info, [trace, now](GstBuffer* buffer) { trace->Enter(buffer, now); });
+    return GST_PAD_PROBE_OK;
+  }
+
+  static GstPadProbeReturn src_callback_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    UNUSED(pad);
+    ElementTrace* trace = reinterpret_cast<ElementTrace*>(user_data);
+    const gint64 now = g_get_monotonic_time();
+    ForEachBuffer(info, [trace, now](GstBuffer* buffer) { trace->Leave(buffer, now); });
+    return GST_PAD_PROBE_OK;
+  }
+
+  static void destroy_callback_probe(gpointer user_data) {
+    ElementTrace* trace = reinterpret_cast<ElementTrace*>(user_data);
+    trace->Unref();
+  }
+
+  GstElement* const element_;
+  const std::string name_;
+  std::vector<std::pair<GstPad*, gulong>> pads_;  // main loop only
+  std::atomic<int> refs_;
+
+  std::atomic<uint64_t> in_buffers_;
+  std::atomic<uint64_t> out_buffers_;
+  uint64_t collected_in_;
+  uint64_t collected_out_;
+
+  const size_t pending_bits_;
+  std::unique_ptr<Pending[]> pending_;  // open addressing by pts
+
+  ProcTimeHistogram proctime_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElementTrace);
+};
+
+ElementTracer::ElementTracer() : traces_(), collect_time_(g_get_monotonic_time()) {}
+
+ElementTracer::~ElementTracer() {
+  for (ElementTrace* trace : traces_) {
+    trace->Detach();
+  }
+  traces_.clear();
+}
+
+void ElementTracer::Sync(const elements_line_t& elements) {
+  for (auto it = traces_.begin(); it != traces_.end();) {
+    GstElement* element = (*it)->GetElement();
+    auto found = std::find_if(elements.begin(), elements.end(),
+                              [element](elements::Element* el) { return el->GetGstElement() == element; });
+    if (found == elements.end()) {
+      (*it)->Detach();
+      it = traces_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (elements::Element* el : elements) {
+    GstElement* element = el->GetGstElement();
+    auto found = std::find_if(traces_.begin(), traces_.end(),
+                              [element](ElementTrace* trace) { return trace->GetElement() == element; });
+    ElementTrace* trace = nullptr;
+    if (found == traces_.end()) {
+      trace = new ElementTrace(element, el->GetName());
+      traces_.push_back(trace);
+    } else {
+      trace = *found;
+    }
+    gst_element_foreach_pad(element, attach_pad, trace);  // dynamic pads are picked up by next call
+  }
+}
+
+void ElementTracer::Collect(elements_stats_t* stats) {
+  const gint64 now = g_get_monotonic_time();
+  const gint64 elapsed = now - collect_time_;
+  collect_time_ = now;
+
+  stats->clear();
+  for (ElementTrace* trace : traces_) {
+    ElementStats element_stats(trace->GetName());
+    trace->Collect(&element_stats, elapsed);
+    stats->push_back(element_stats);
+  }
+}
+
+gboolean ElementTracer::attach_pad(GstElement* element, GstPad* pad, gpointer user_data) {
+  UNUSED(element);
+  ElementTrace* trace = reinterpret_cast<ElementTrace*>(user_data);
+  if (!trace->HasPad(pad)) {
+    trace->AttachPad(pad);
+  }
+  return TRUE;
+}
+
+}  // namespace stream
+}  // namespace fastocloud
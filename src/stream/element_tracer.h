@@ -0,0 +1,81 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <gst/gstelement.h>
+
+#include <atomic>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "base/element_stats.h"
+
+#include "stream/gst_types.h"
+
+namespace fastocloud {
+namespace stream {
+
+// log scale histogram, 4 buckets per power of two keep error of value below 12.5%,
+// lock free for streaming threads, percentiles are taken from main loop
+class ProcTimeHistogram {
+ public:
+  typedef ElementStats::proctime_t proctime_t;
+  enum { sub_buckets = 4, buckets_count = 96 };  // last bucket takes everything above ~29 sec
+
+  ProcTimeHistogram();
+
+  void Add(proctime_t usec);
+  // percentiles of values added since previous call, false if nothing was added; main loop only
+  bool CollectPercentiles(proctime_t* p50, proctime_t* p95, proctime_t* p99);
+
+  static size_t GetBucket(proctime_t usec);
+  static proctime_t GetBucketValue(size_t bucket);  // middle of bucket range
+
+ private:
+  std::atomic<uint64_t> counts_[buckets_count];
+  uint64_t collected_[buckets_count];
+
+  DISALLOW_COPY_AND_ASSIGN(ProcTimeHistogram);
+};
+
+// Opt-in tracer of pipeline elements, buffer probes on every pad of traced elements aggregate in process:
+// buffer rates of sink and src pads, processing time as delay between the same buffer (matched by pts)
+// entering sink pad and leaving src pad, for queues it is the time spent in queue.
+// Pending buffers are sized from queue limits and encoder lookahead, so deep encoders like x264enc are matched.
+// Fill levels of queues are polled on collect.
+class ElementTracer {
+ public:
+  ElementTracer();
+  ~ElementTracer();
+
+  // traces elements and pads appeared since previous call, forgets removed elements; main loop only
+  void Sync(const elements_line_t& elements);
+  // stats since previous call in order of tracing; main loop only
+  void Collect(elements_stats_t* stats);
+
+ private:
+  class ElementTrace;
+
+  static gboolean attach_pad(GstElement* element, GstPad* pad, gpointer user_data);
+
+  std::vector<ElementTrace*> traces_;
+  gint64 collect_time_;  // monotonic
+
+  DISALLOW_COPY_AND_ASSIGN(ElementTracer);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
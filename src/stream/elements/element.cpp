@@ -254,6 +254,45 @@ void ElementCapsFilter::SetCaps(GstCaps* caps) {
   SetProperty("caps", caps);
 }
 
+void ElementInterVideoSink::SetChannel(const std::string& channel) {
+  SetProperty("channel", channel);
+}
+
+void ElementInterVideoSrc::SetChannel(const std::string& channel) {
+  SetProperty("channel", channel);
+}
+
+void ElementInterAudioSink::SetChannel(const std::string& channel) {
+  SetProperty("channel", channel);
+}
+
+void ElementInterAudioSrc::SetChannel(const std::string& channel) {
+  SetProperty("channel", channel);
+}
+
+void ElementInputSelector::SetSyncStreams(bool sync_streams) {
+  SetProperty("sync-streams", sync_streams);
+}
+
+void ElementInputSelector::SetSyncMode(gint sync_mode) {
+  SetProperty("sync-mode", sync_mode);
+}
+
+void ElementInputSelector::SetCacheBuffers(bool cache_buffers) {
+  SetProperty("cache-buffers", cache_buffers);
+}
+
+bool ElementInputSelector::SetActivePad(const std::string& pad_name) {
+  GstPad* pad = gst_element_get_static_pad(GetGstElement(), pad_name.c_str());
+  if (!pad) {
+    return false;
+  }
+
+  SetProperty("active-pad", static_cast<void*>(pad));
+  gst_object_unref(pad);
+  return true;
+}
+
 void ElementQueue2::SetMaxSizeBuffers(guint val) {
   SetProperty("max-size-buffers", val);
 }
@@ -437,6 +476,11 @@ DECLARE_ELEMENT_TRAITS_SPECIALIZATION(AUTO_VIDEO_CONVERT)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(TS_PARSE)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(AVDEC_H264)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(TS_DEMUX)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INTER_VIDEO_SINK)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INTER_VIDEO_SRC)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INTER_AUDIO_SINK)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INTER_AUDIO_SRC)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INPUT_SELECTOR)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(AVDEC_AC3)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(AVDEC_AC3_FIXED)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(SOUP_HTTP_CLIENT_SINK)
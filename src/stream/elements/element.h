@@ -123,6 +123,11 @@ enum SupportedElements {
   ELEMENT_TS_PARSE,
   ELEMENT_AVDEC_H264,
   ELEMENT_TS_DEMUX,
+  ELEMENT_INTER_VIDEO_SINK,
+  ELEMENT_INTER_VIDEO_SRC,
+  ELEMENT_INTER_AUDIO_SINK,
+  ELEMENT_INTER_AUDIO_SRC,
+  ELEMENT_INPUT_SELECTOR,
   ELEMENT_AVDEC_AC3,
   ELEMENT_AVDEC_AC3_FIXED,
   ELEMENT_SOUP_HTTP_CLIENT_SINK,
@@ -403,6 +408,50 @@ class ElementCapsFilter : public ElementEx<ELEMENT_CAPS_FILTER> {
   void SetCaps(GstCaps* caps);
 };
 
+// inter elements pass data between pipelines parts which can be rebuilt independently
+class ElementInterVideoSink : public ElementEx<ELEMENT_INTER_VIDEO_SINK> {
+ public:
+  typedef ElementEx<ELEMENT_INTER_VIDEO_SINK> base_class;
+  using base_class::base_class;
+
+  void SetChannel(const std::string& channel);  // Default: "default"
+};
+
+class ElementInterVideoSrc : public ElementEx<ELEMENT_INTER_VIDEO_SRC> {
+ public:
+  typedef ElementEx<ELEMENT_INTER_VIDEO_SRC> base_class;
+  using base_class::base_class;
+
+  void SetChannel(const std::string& channel);  // Default: "default", last frame for 1 sec, then black
+};
+
+class ElementInterAudioSink : public ElementEx<ELEMENT_INTER_AUDIO_SINK> {
+ public:
+  typedef ElementEx<ELEMENT_INTER_AUDIO_SINK> base_class;
+  using base_class::base_class;
+
+  void SetChannel(const std::string& channel);  // Default: "default"
+};
+
+class ElementInterAudioSrc : public ElementEx<ELEMENT_INTER_AUDIO_SRC> {
+ public:
+  typedef ElementEx<ELEMENT_INTER_AUDIO_SRC> base_class;
+  using base_class::base_class;
+
+  void SetChannel(const std::string& channel);  // Default: "default", silence when nothing is received
+};
+
+class ElementInputSelector : public ElementEx<ELEMENT_INPUT_SELECTOR> {
+ public:
+  typedef ElementEx<ELEMENT_INPUT_SELECTOR> base_class;
+  using base_class::base_class;
+
+  void SetSyncStreams(bool sync_streams = true);     // Default: true
+  void SetSyncMode(gint sync_mode = 0);              // 0 - active segment, 1 - clock; Default: 0
+  void SetCacheBuffers(bool cache_buffers = false);  // Default: false
+  bool SetActivePad(const std::string& pad_name);    // switches immediately, false if there is no such sink pad
+};
+
 template <typename T>
 T* make_element(const std::string& name) {
   T* element = new T(name);
@@ -266,6 +266,21 @@ bool IsH264Encoder(const std::string& encoder) {
          encoder == ElementMFXH264Enc::GetPluginName();
 }
 
+const char* get_video_encoder_gop_property(const std::string& encoder) {
+  if (encoder == ElementX264Enc::GetPluginName() || encoder == ElementX265Enc::GetPluginName()) {
+    return "key-int-max";
+  } else if (encoder == ElementOpenH264Enc::GetPluginName() || encoder == ElementNvX264Enc::GetPluginName() ||
+             encoder == ElementMsdkH264Enc::GetPluginName() || encoder == ElementMFXH264Enc::GetPluginName()) {
+    return "gop-size";
+  } else if (encoder == ElementVAAPIH264Enc::GetPluginName()) {
+    return "keyframe-period";
+  } else if (encoder == ElementEAVCEnc::GetPluginName()) {
+    return "gop-max-length";
+  }
+
+  return nullptr;
+}
+
 }  // namespace encoders
 }  // namespace elements
 }  // namespace stream
@@ -125,6 +125,8 @@ elements_line_t build_video_encoder(const std::string& codec,
                                     element_id_t encoder_id);
 
 bool IsH264Encoder(const std::string& encoder);
+// property which limits distance between keyframes in frames, nullptr if unknown for encoder
+const char* get_video_encoder_gop_property(const std::string& encoder);
 
 }  // namespace encoders
 }  // namespace elements
@@ -33,19 +33,38 @@ ElementRTPMux* make_rtpmux(element_id_t muxer_id) {
   return make_muxer<ElementRTPMux>(muxer_id);
 }
 
-Element* make_muxer(common::uri::Url::scheme scheme, element_id_t muxer_id) {
+bool GetPackaging(common::uri::Url::scheme scheme, Packaging* packaging) {
+  if (!packaging) {
+    return false;
+  }
+
   if (scheme == common::uri::Url::rtmp) {
-    return make_flvmux(true, muxer_id);
+    *packaging = FLV_PACKAGING;
+    return true;
   } else if (scheme == common::uri::Url::udp) {
-    return make_rtpmux(muxer_id);
-  } else if (scheme == common::uri::Url::tcp) {
-    return make_mpegtsmux(muxer_id);
-  } else if (scheme == common::uri::Url::http) {
-    return make_mpegtsmux(muxer_id);
+    *packaging = RTP_PACKAGING;
+    return true;
+  } else if (scheme == common::uri::Url::tcp || scheme == common::uri::Url::http) {
+    *packaging = MPEGTS_PACKAGING;
+    return true;
   }
 
-  NOTREACHED() << "Unknown output scheme: " << scheme;
-  return nullptr;
+  return false;
+}
+
+Element* make_muxer(common::uri::Url::scheme scheme, element_id_t muxer_id) {
+  Packaging packaging;
+  if (!GetPackaging(scheme, &packaging)) {
+    NOTREACHED() << "Unknown output scheme: " << scheme;
+    return nullptr;
+  }
+
+  if (packaging == FLV_PACKAGING) {
+    return make_flvmux(true, muxer_id);
+  } else if (packaging == RTP_PACKAGING) {
+    return make_rtpmux(muxer_id);
+  }
+  return make_mpegtsmux(muxer_id);
 }
 
 void ElementFLVMux::SetStreamable(bool streamable) {
@@ -50,6 +50,10 @@ ElementFLVMux* make_flvmux(bool streamable, element_id_t muxer_id);
 ElementRTPMux* make_rtpmux(element_id_t muxer_id);
 ElementMPEGTSMux* make_mpegtsmux(element_id_t muxer_id);
 
+// outputs with the same packaging can share one muxer
+enum Packaging { FLV_PACKAGING, RTP_PACKAGING, MPEGTS_PACKAGING };
+bool GetPackaging(common::uri::Url::scheme scheme, Packaging* packaging) WARN_UNUSED_RESULT;
+
 Element* make_muxer(common::uri::Url::scheme scheme, element_id_t muxer_id);
 
 }  // namespace muxer
@@ -25,12 +25,13 @@ namespace sink {
 
 HlsOutput MakeHlsOutput(const common::uri::Url& uri,
                         const common::file_system::ascii_directory_string_path& http_root,
-                        const std::string& filename) {
+                        const std::string& filename,
+                        const std::string& prefix) {
   elements::sink::HlsOutput hout;
   const std::string http_root_str = http_root.GetPath();
   fastotv::timestamp_t t = common::time::current_utc_mstime();
-  hout.location = http_root_str + GenHttpTsTemplate(t);
-  hout.play_locataion = http_root_str + filename;
+  hout.location = http_root_str + prefix + GenHttpTsTemplate(t);
+  hout.play_locataion = http_root_str + prefix + filename;
   hout.playlist_root = uri.GetHpath();
   hout.paylist_length = 5;
   hout.max_files = 10;
@@ -39,11 +40,12 @@ HlsOutput MakeHlsOutput(const common::uri::Url& uri,
 
 HlsOutput MakeVodHlsOutput(const common::uri::Url& uri,
                            const common::file_system::ascii_directory_string_path& http_root,
-                           const std::string& filename) {
+                           const std::string& filename,
+                           const std::string& prefix) {
   elements::sink::HlsOutput hout;
   const std::string http_root_str = http_root.GetPath();
-  hout.location = http_root_str + GenVodHttpTsTemplate();
-  hout.play_locataion = http_root_str + filename;
+  hout.location = http_root_str + prefix + GenVodHttpTsTemplate();
+  hout.play_locataion = http_root_str + prefix + filename;
   hout.playlist_root = uri.GetHpath();
   hout.paylist_length = 0;
   hout.max_files = 0;
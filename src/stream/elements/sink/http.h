@@ -37,12 +37,15 @@ struct HlsOutput {
   uint32_t max_files;
 };
 
+// prefix is prepended to playlist and chunk names, renditions of adaptive stream share one http root
 HlsOutput MakeHlsOutput(const common::uri::Url& uri,
                         const common::file_system::ascii_directory_string_path& http_root,
-                        const std::string& filename);
+                        const std::string& filename,
+                        const std::string& prefix = std::string());
 HlsOutput MakeVodHlsOutput(const common::uri::Url& uri,
                            const common::file_system::ascii_directory_string_path& http_root,
-                           const std::string& filename);
+                           const std::string& filename,
+                           const std::string& prefix = std::string());
 
 class ElementHLSSink : public ElementBinEx<ELEMENT_HLS_SINK> {
  public:
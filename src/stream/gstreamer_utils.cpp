@@ -14,10 +14,17 @@
 
 #include "stream/gstreamer_utils.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <gst/gstutils.h>  // for gst_pad_query_caps
 
 #include <common/macros.h>
 
+#define FEED_FILE_WILLNEED_SIZE (1024 * 1024)
+
 namespace fastocloud {
 namespace stream {
 
@@ -143,5 +150,61 @@ bool get_type_from_caps(GstCaps* caps, std::string* type_title, std::string* typ
   return true;
 }
 
+int open_feed_file(const std::string& path, off_t* size) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return INVALID_DESCRIPTOR;
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == ERROR_RESULT_VALUE || !S_ISREG(sb.st_mode) || sb.st_size == 0) {
+    ::close(fd);
+    return INVALID_DESCRIPTOR;
+  }
+
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(fd, 0, sb.st_size < FEED_FILE_WILLNEED_SIZE ? sb.st_size : FEED_FILE_WILLNEED_SIZE,
+                POSIX_FADV_WILLNEED);
+  *size = sb.st_size;
+  return fd;
+}
+
+GstBufferPool* make_buffer_pool(guint size) {
+  GstBufferPool* pool = gst_buffer_pool_new();
+  GstStructure* config = gst_buffer_pool_get_config(pool);
+  gst_buffer_pool_config_set_params(config, nullptr, size, 0, 0);
+  if (!gst_buffer_pool_set_config(pool, config) || !gst_buffer_pool_set_active(pool, TRUE)) {
+    gst_object_unref(pool);
+    return nullptr;
+  }
+  return pool;
+}
+
+GstBuffer* read_file_buffer(GstBufferPool* pool, int fd, off_t offset) {
+  GstBuffer* buffer = nullptr;
+  if (gst_buffer_pool_acquire_buffer(pool, &buffer, nullptr) != GST_FLOW_OK) {
+    return nullptr;
+  }
+
+  GstMapInfo info;
+  if (!gst_buffer_map(buffer, &info, GST_MAP_WRITE)) {
+    gst_buffer_unref(buffer);
+    return nullptr;
+  }
+
+  ssize_t readed;
+  do {
+    readed = pread(fd, info.data, info.size, offset);
+  } while (readed == ERROR_RESULT_VALUE && errno == EINTR);
+  gst_buffer_unmap(buffer, &info);
+  if (readed <= 0) {
+    gst_buffer_unref(buffer);
+    return nullptr;
+  }
+
+  gst_buffer_set_size(buffer, readed);  // pool restores full size when buffer comes back
+  return buffer;
+}
+
 }  // namespace stream
 }  // namespace fastocloud
@@ -14,7 +14,10 @@
 
 #pragma once
 
-#include <gst/gstelement.h>  // for GstElement
+#include <sys/types.h>  // for off_t
+
+#include <gst/gstbufferpool.h>  // for GstBufferPool
+#include <gst/gstelement.h>     // for GstElement
 
 #include <string>  // for string
 
@@ -33,5 +36,16 @@ T gvalue_cast(const GValue* val);
 
 bool get_type_from_caps(GstCaps* caps, std::string* type_title, std::string* type_full);
 
+// opens regular non empty file for sequential reading and starts readahead of its head,
+// returns INVALID_DESCRIPTOR if file can't be played
+int open_feed_file(const std::string& path, off_t* size);
+
+// active pool of buffers with size bytes each, memory is reused after downstream releases buffers
+GstBufferPool* make_buffer_pool(guint size);
+
+// reads up to pool buffer size bytes at offset, nullptr at end of file or on error,
+// so file truncated while playing just ends early
+GstBuffer* read_file_buffer(GstBufferPool* pool, int fd, off_t offset);
+
 }  // namespace stream
 }  // namespace fastocloud
@@ -30,7 +30,7 @@ namespace fastocloud {
 namespace stream {
 
 IBaseBuilder::IBaseBuilder(const Config* config, IBaseBuilderObserver* observer)
-    : config_(config), observer_(observer), pipeline_(gst_pipeline_new("pipeline")), pipeline_elements_() {}
+    : config_(config), observer_(observer), pipeline_(nullptr), pipeline_elements_() {}
 
 IBaseBuilder::~IBaseBuilder() {}
 
@@ -129,6 +129,7 @@ bool IBaseBuilder::CreatePipeLine(GstElement** pipeline, elements_line_t* elemen
     return false;
   }
 
+  pipeline_ = gst_pipeline_new("pipeline");
   if (!InitPipeline()) {
     return false;
   }
@@ -138,5 +139,23 @@ bool IBaseBuilder::CreatePipeLine(GstElement** pipeline, elements_line_t* elemen
   return true;
 }
 
+bool IBaseBuilder::CreateInput(GstElement* pipeline, elements_line_t* elements) {
+  if (!pipeline || !elements) {
+    return false;
+  }
+
+  pipeline_ = pipeline;
+  if (!InitInput()) {
+    return false;
+  }
+
+  *elements = pipeline_elements_;
+  return true;
+}
+
+bool IBaseBuilder::InitInput() {
+  return false;
+}
+
 }  // namespace stream
 }  // namespace fastocloud
@@ -42,6 +42,8 @@ class IBaseBuilder : public ILinker {
   const Config* GetConfig() const;
 
   bool CreatePipeLine(GstElement** pipeline, elements_line_t* elements) WARN_UNUSED_RESULT;
+  // builds input part into running pipeline, elements are only the new ones
+  bool CreateInput(GstElement* pipeline, elements_line_t* elements) WARN_UNUSED_RESULT;
 
   elements::Element* GetElementByName(const std::string& name) const;
 
@@ -57,6 +59,7 @@ class IBaseBuilder : public ILinker {
   virtual elements::Element* CreateSink(const OutputUri& output, element_id_t sink_id);
 
   virtual bool InitPipeline() WARN_UNUSED_RESULT = 0;
+  virtual bool InitInput() WARN_UNUSED_RESULT;
 
   void HandleInputSrcPadCreated(pad::Pad* pad, element_id_t id, const common::uri::Url& url);
   void HandleOutputSinkPadCreated(pad::Pad* pad, element_id_t id, const common::uri::Url& url, bool need_push);
@@ -64,7 +67,7 @@ class IBaseBuilder : public ILinker {
  private:
   const Config* const config_;
   IBaseBuilderObserver* const observer_;
-  GstElement* const pipeline_;
+  GstElement* pipeline_;
   elements_line_t pipeline_elements_;
 };
 
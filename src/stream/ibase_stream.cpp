@@ -21,6 +21,7 @@
 #include <gst/base/gstbasesrc.h>  // for GstBaseSrc
 #include <gst/video/video.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -34,9 +35,11 @@
 
 #include "stream/dumpers/dumpers_factory.h"
 #include "stream/elements/element.h"
+#include "stream/element_tracer.h"
 #include "stream/elements/sink/http.h"
 #include "stream/gstreamer_utils.h"
 #include "stream/ibase_builder.h"
+#include "stream/pad/pad.h"
 #include "stream/probes.h"  // for Probe (ptr only), PROBE_IN, PROBE_OUT
 
 #define MIN_OUT_DATA(SEC) 4 * 1024 * SEC  // 4 kBps
@@ -48,6 +51,9 @@
 #define VAAPI_I965_ENV "i965"
 #define VAAPI_I965_DRIVER_PATH "/usr/local/lib/dri/"
 
+#define EXIT_INFO_NAME "exit_info"
+#define RESTART_INPUT_INFO_NAME "restart_input_info"
+
 #if defined(OS_WIN)
 int setenv(const char* key, const char* value, int set) {
   UNUSED(set);
@@ -110,18 +116,85 @@ void RedirectGstLog(GstDebugCategory* category,
   }
 }
 
+struct InputBoundary {
+  const fastocloud::stream::elements_line_t* input;
+  std::vector<GstPad*>* peers;
+};
+
+bool IsInputElement(const fastocloud::stream::elements_line_t& input, GstObject* object) {
+  for (fastocloud::stream::elements::Element* el : input) {
+    GstObject* input_object = GST_OBJECT(el->GetGstElement());
+    if (object == input_object || gst_object_has_as_ancestor(object, input_object)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// sink pads outside of input which input pushes into
+gboolean collect_boundary_pad(GstElement* element, GstPad* pad, gpointer user_data) {
+  UNUSED(element);
+  InputBoundary* boundary = static_cast<InputBoundary*>(user_data);
+  GstPad* peer = gst_pad_get_peer(pad);
+  if (!peer) {
+    return TRUE;
+  }
+
+  GstObject* parent = gst_pad_get_parent(peer);
+  if (parent && !IsInputElement(*boundary->input, parent)) {
+    boundary->peers->push_back(peer);
+    peer = nullptr;
+  }
+
+  if (parent) {
+    gst_object_unref(parent);
+  }
+  if (peer) {
+    gst_object_unref(peer);
+  }
+  return TRUE;
+}
+
+void ApplyProbeStats(const fastocloud::stream::ProbeStats& diff, fastocloud::ChannelStats* stats) {
+  if (!diff.total_buffers && !diff.total_bytes) {
+    return;
+  }
+
+  stats->SetTotalBytes(stats->GetTotalBytes() + diff.total_bytes);
+  stats->SetTotalBuffers(stats->GetTotalBuffers() + diff.total_buffers);
+  stats->SetKeyFrames(stats->GetKeyFrames() + diff.key_frames);
+  stats->SetDiscontBuffers(stats->GetDiscontBuffers() + diff.discont_buffers);
+  stats->SetGapBuffers(stats->GetGapBuffers() + diff.gap_buffers);
+  if (GST_CLOCK_TIME_IS_VALID(diff.last_pts)) {
+    stats->SetLastPts(diff.last_pts);
+  }
+  if (GST_CLOCK_TIME_IS_VALID(diff.last_dts)) {
+    stats->SetLastDts(diff.last_dts);
+  }
+  if (diff.last_arrival) {
+    // convert monotonic arrival time of the last buffer into wall clock
+    const gint64 ago_msec = (g_get_monotonic_time() - diff.last_arrival) / 1000;
+    stats->SetLastUpdateTime(common::time::current_utc_mstime() - ago_msec);
+  }
+}
+
+// http source of hls/dash downloads playlist and segments in bursts and goes quiet between them
+bool IsPulledInput(const common::uri::Url& url) {
+  const common::uri::Url::scheme sh = url.GetScheme();
+  return sh == common::uri::Url::http || sh == common::uri::Url::https;
+}
+
 }  // namespace
 
 namespace fastocloud {
 namespace stream {
 
 void streams_init(int argc, char** argv, EncoderType enc) {
-  if (gst_is_initialized()) {
-    return;
-  }
-
+  const bool preinited = gst_is_initialized();  // zygote already loaded registry
 #ifdef HAVE_X11
-  XInitThreads();
+  if (!preinited) {
+    XInitThreads();
+  }
 #endif
 
   if (enc == GPU_MFX) {
@@ -147,13 +220,20 @@ void streams_init(int argc, char** argv, EncoderType enc) {
     }
   }
   if (common::logging::CURRENT_LOG_LEVEL() == common::logging::LOG_LEVEL_DEBUG) {
-    int res = setenv("GST_DEBUG", "3", 1);
-    if (res == SUCCESS_RESULT_VALUE) {
+    if (preinited) {
+      gst_debug_set_default_threshold(GST_LEVEL_FIXME);
       gst_debug_add_log_function(RedirectGstLog, nullptr, nullptr);
+    } else {
+      int res = setenv("GST_DEBUG", "3", 1);
+      if (res == SUCCESS_RESULT_VALUE) {
+        gst_debug_add_log_function(RedirectGstLog, nullptr, nullptr);
+      }
     }
   }
 
-  gst_init(&argc, &argv);
+  if (!preinited) {
+    gst_init(&argc, &argv);
+  }
   const char* va_dr_name = getenv("LIBVA_DRIVER_NAME");
   if (!va_dr_name) {
     va_dr_name = "(null)";
@@ -171,21 +251,36 @@ void streams_deinit() {
 
 IBaseStream::IStreamClient::~IStreamClient() {}
 
+IBaseStream::InputWatch::InputWatch()
+    : stalled(true),
+      position(GST_CLOCK_TIME_NONE),
+      progress_time(0),
+      window_bytes(0),
+      window_start(0),
+      low_bitrate(false) {}
+
 IBaseStream::IBaseStream(const Config* config, IStreamClient* client, StreamStruct* stats)
     : common::IMetaClassInfo(),
       client_(client),
       config_(config),
       probe_in_(),
       probe_out_(),
+      probe_decoded_(),
       loop_(g_main_loop_new(ctx_holder::instance()->ctx, FALSE)),
       pipeline_(nullptr),
+      pipeline_elements_(),
+      tracer_(nullptr),
       status_tick_(0),
       no_data_panic_tick_(0),
       stats_(stats),
       last_exit_status_(EXIT_INNER),
       is_live_(false),
+      input_offset_(0),
+      input_restart_time_(0),
+      restart_input_timer_id_(0),
       flags_(INITED_NOTHING),
-      desire_flags_(INITED_NOTHING) {
+      desire_flags_(INITED_NOTHING),
+      inputs_watch_() {
   /*INFO_LOG() << "Api inited input: " <<
      common::ConvertToString(api_->GetInput())
              << ", output: " << common::ConvertToString(api_->GetOutput());*/
@@ -225,6 +320,15 @@ void IBaseStream::PreExecCleanup(time_t old_life_time) {
 
 void IBaseStream::PostExecCleanup() {}
 
+bool IBaseStream::PrePlay(ExitStatus* status) {
+  UNUSED(status);
+  return true;
+}
+
+GstElement* IBaseStream::GetPipeline() const {
+  return pipeline_;
+}
+
 bool IBaseStream::InitPipeLine() {
   IBaseBuilder* builder = CreateBuilder();
   if (!builder->CreatePipeLine(&pipeline_, &pipeline_elements_)) {
@@ -242,17 +346,42 @@ bool IBaseStream::InitPipeLine() {
 }
 
 void IBaseStream::ClearOutProbes() {
+  CollectProbeStats();
   for (OutputProbe* probe : probe_out_) {
     delete probe;
   }
   probe_out_.clear();
 }
 
+void IBaseStream::ClearInProbes(const elements_line_t& input) {
+  CollectProbeStats();
+  for (auto it = probe_in_.begin(); it != probe_in_.end();) {
+    InputProbe* probe = *it;
+    GstPad* pad = probe->GetPad();
+    GstObject* parent = pad ? gst_pad_get_parent(pad) : nullptr;
+    const bool in_input = !pad || (parent && IsInputElement(input, parent));
+    if (parent) {
+      gst_object_unref(parent);
+    }
+    if (!in_input) {
+      ++it;
+      continue;
+    }
+    delete probe;
+    it = probe_in_.erase(it);
+  }
+}
+
 void IBaseStream::ClearInProbes() {
+  CollectProbeStats();
   for (InputProbe* probe : probe_in_) {
     delete probe;
   }
   probe_in_.clear();
+  for (DecodedProbe* probe : probe_decoded_) {
+    delete probe;
+  }
+  probe_decoded_.clear();
 }
 
 size_t IBaseStream::CountInputEOS() const {
@@ -309,6 +438,8 @@ IBaseStream::~IBaseStream() {
   g_main_loop_unref(loop_);
   ClearOutProbes();
   ClearInProbes();
+  delete tracer_;
+  tracer_ = nullptr;
   for (elements::Element* el : pipeline_elements_) {
     delete el;
   }
@@ -330,8 +461,22 @@ ExitStatus IBaseStream::Exec() {
     return EXIT_INNER;
   }
 
+  ExitStatus pre_play_status = EXIT_SELF;
+  if (!PrePlay(&pre_play_status)) {
+    Stop();
+    PostExecCleanup();
+    return pre_play_status;
+  }
+
+  if (config_->GetTraceElements()) {
+    tracer_ = new ElementTracer;
+    tracer_->Sync(pipeline_elements_);
+    stats_->elements.clear();
+  }
+
   GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
   guint main_timeout_id = g_timeout_add(main_timer_msecs, main_timer_callback, this);
+  guint stall_timeout_id = g_timeout_add(stall_check_msecs, stall_check_callback, this);
 
   gst_bus_set_sync_handler(bus, sync_bus_callback, this, remove_notify_callback);
   guint bus_watch_id = gst_bus_add_watch(bus, async_bus_callback, this);
@@ -352,9 +497,18 @@ ExitStatus IBaseStream::Exec() {
   DCHECK(res);
   res = g_source_remove(main_timeout_id);
   DCHECK(res);
+  res = g_source_remove(stall_timeout_id);
+  DCHECK(res);
+  if (restart_input_timer_id_) {
+    res = g_source_remove(restart_input_timer_id_);
+    DCHECK(res);
+    restart_input_timer_id_ = 0;
+  }
 
   SetStatus(INIT);  // emulating loop statuses
   Stop();
+  delete tracer_;
+  tracer_ = nullptr;
 
   stats_->restarts++;
   PostExecCleanup();
@@ -441,7 +595,7 @@ void IBaseStream::SetAudioInited(bool val) {
   if (val) {
     flags_ |= INITED_AUDIO;
   } else {
-    flags_ &= INITED_AUDIO;
+    flags_ &= ~INITED_AUDIO;
   }
 }
 
@@ -464,6 +618,176 @@ void IBaseStream::Restart() {
   stats_->restarts++;
 }
 
+void IBaseStream::RestartInput() {
+  if (!IsInputRestartable()) {
+    Quit(EXIT_INNER);
+    return;
+  }
+
+  GstStructure* result =
+      gst_structure_new(RESTART_INPUT_INFO_NAME, "time", G_TYPE_INT64, g_get_monotonic_time(), nullptr);
+  GstMessage* message = gst_message_new_application(GST_OBJECT(pipeline_), result);
+  bool res = gst_element_post_message(pipeline_, message);
+  if (!res) {
+    WARNING_LOG() << "Failed to post restart input message.";
+  }
+}
+
+bool IBaseStream::IsInputRestartable() const {
+  return false;
+}
+
+bool IBaseStream::GetDecodedProbeStats(element_id_t id, ProbeStats* stats) {
+  if (!stats) {
+    return false;
+  }
+
+  for (InputProbe* probe : probe_in_) {
+    if (probe->GetID() != id) {
+      continue;
+    }
+    DecodedProbe* decoded = GetDecodedProbe(id, probe->GetUrl());
+    if (!decoded) {
+      return false;
+    }
+    *stats = decoded->GetStats();
+    return true;
+  }
+  return false;
+}
+
+bool IBaseStream::GetInputProbeStats(element_id_t id, ProbeStats* stats) const {
+  if (!stats) {
+    return false;
+  }
+
+  for (InputProbe* probe : probe_in_) {
+    if (probe->GetID() == id) {
+      *stats = probe->GetStats();
+      return true;
+    }
+  }
+  return false;
+}
+
+elements_line_t IBaseStream::GetInputElements() const {
+  return elements_line_t();
+}
+
+GstClockTimeDiff IBaseStream::GetInputOffset() const {
+  return input_offset_;
+}
+
+void IBaseStream::HandleRestartInput(gint64 request_time) {
+  if (restart_input_timer_id_ || request_time < input_restart_time_) {  // already scheduled or rebuilt after request
+    return;
+  }
+
+  const gint64 since_msec = (g_get_monotonic_time() - input_restart_time_) / 1000;
+  if (input_restart_time_ && since_msec < restart_input_interval_msecs) {
+    const guint delay_msec = static_cast<guint>(restart_input_interval_msecs - since_msec);
+    restart_input_timer_id_ = g_timeout_add(delay_msec, restart_input_callback, this);
+    return;
+  }
+
+  input_restart_time_ = g_get_monotonic_time();
+  if (!SwapInput()) {
+    WARNING_LOG() << "Can't rebuild input, restarting stream.";
+    Quit(EXIT_INNER);
+  }
+}
+
+bool IBaseStream::SwapInput() {
+  const elements_line_t input = GetInputElements();
+  if (input.empty()) {
+    return false;
+  }
+
+  const gint64 start_time = g_get_monotonic_time();
+  SetVideoInited(false);
+  SetAudioInited(false);
+  IBaseBuilder* builder = CreateBuilder();
+  bool is_live_input = false;
+  bool res = RebuildInputElements(input, builder, &is_live_input);
+  delete builder;
+  if (!res) {
+    return false;
+  }
+
+  ResetDataWait();
+  stats_->restarts++;
+  const input_t inputs = config_->GetInput();
+  if (client_ && !inputs.empty()) {
+    client_->OnInputChanged(inputs[0]);
+  }
+  INFO_LOG() << "Input rebuilt in " << (g_get_monotonic_time() - start_time) / 1000 << " msec, live: " << is_live_input;
+  return true;
+}
+
+bool IBaseStream::RebuildInputElements(const elements_line_t& input, IBaseBuilder* builder, bool* is_live_input) {
+  if (!builder || !is_live_input) {
+    return false;
+  }
+
+  // flushing unblocks streaming threads of input which wait on downstream queues,
+  // flush stop doesn't reset time, so running time of outputs goes on
+  std::vector<GstPad*> boundary;
+  InputBoundary collector = {&input, &boundary};
+  for (elements::Element* el : input) {
+    gst_element_foreach_src_pad(el->GetGstElement(), collect_boundary_pad, &collector);
+  }
+  for (GstPad* pad : boundary) {
+    gst_pad_send_event(pad, gst_event_new_flush_start());
+  }
+
+  for (elements::Element* el : input) {
+    gst_element_set_state(el->GetGstElement(), GST_STATE_NULL);
+  }
+  ClearInProbes(input);
+  for (elements::Element* el : input) {
+    GstElement* element = el->GetGstElement();
+    pipeline_elements_.erase(std::remove(pipeline_elements_.begin(), pipeline_elements_.end(), el),
+                             pipeline_elements_.end());
+    delete el;  // disconnects signals, element is released by bin
+    gst_bin_remove(GST_BIN(pipeline_), element);
+  }
+
+  for (GstPad* pad : boundary) {
+    gst_pad_send_event(pad, gst_event_new_flush_stop(FALSE));
+    gst_object_unref(pad);
+  }
+
+  elements_line_t new_input;
+  if (!builder->CreateInput(pipeline_, &new_input)) {
+    return false;
+  }
+
+  *is_live_input = false;
+  for (elements::Element* el : new_input) {
+    GstElement* element = el->GetGstElement();
+    if (GST_IS_BASE_SRC(element) && gst_base_src_is_live(GST_BASE_SRC(element))) {
+      *is_live_input = true;
+    }
+    pipeline_elements_.push_back(el);
+  }
+
+  // not live input starts from zero, shift it to current running time of outputs
+  input_offset_ = 0;
+  GstClock* clock = gst_element_get_clock(pipeline_);
+  if (clock) {
+    if (!*is_live_input) {
+      input_offset_ = gst_clock_get_time(clock) - gst_element_get_base_time(pipeline_);
+    }
+    gst_object_unref(clock);
+  }
+
+  // downstream first, so pads are ready before data flows
+  for (auto it = new_input.rbegin(); it != new_input.rend(); ++it) {
+    gst_element_sync_state_with_parent((*it)->GetGstElement());
+  }
+  return true;
+}
+
 void IBaseStream::Stop() {
   SetPipelineState(GST_STATE_NULL);
 }
@@ -488,7 +812,7 @@ void IBaseStream::ResetDataWait() {
 
 void IBaseStream::Quit(ExitStatus status) {
   GstElement* pipeline = pipeline_;
-  GstStructure* result = gst_structure_new("exit_info", "status", G_TYPE_INT, status, nullptr);
+  GstStructure* result = gst_structure_new(EXIT_INFO_NAME, "status", G_TYPE_INT, status, nullptr);
   GstMessage* message = gst_message_new_application(GST_OBJECT(pipeline), result);
   bool res = gst_element_post_message(pipeline, message);
   if (!res) {
@@ -515,7 +839,7 @@ GstBusSyncReply IBaseStream::HandleSyncBusMessageReceived(GstBus* bus, GstMessag
   GstObject* src = GST_MESSAGE_SRC(message);
   if (type == GST_MESSAGE_APPLICATION) {
     GstObject* pipeline = GST_OBJECT(pipeline_);
-    if (src == pipeline && g_main_loop_is_running(loop_)) {
+    if (src == pipeline && gst_message_has_name(message, EXIT_INFO_NAME) && g_main_loop_is_running(loop_)) {
       const GstStructure* exit_status_struct = gst_message_get_structure(message);
       const GValue* status_val = gst_structure_get_value(exit_status_struct, "status");
       gint exit_status = gvalue_cast<gint>(status_val);
@@ -553,15 +877,127 @@ void IBaseStream::OnOutputDataOK() {
 void IBaseStream::OnInputDataFailed() {
   WARNING_LOG() << "There is no input data for a last " << no_data_panic_sec << " seconds.";
   // handle streamlink
-  Quit(EXIT_INNER);
+  RestartInput();
 }
 
 void IBaseStream::OnInputDataOK() {}
 
+size_t IBaseStream::GetStallTimeout(const InputUri& input) const {
+  if (!IsStallDetectable()) {
+    return 0;
+  }
+
+  const Config::stall_timeout_t timeout = config_->GetStallTimeout();
+  if (timeout) {  // 0 turns detection off
+    return *timeout;
+  }
+  return IsPulledInput(input.GetInput()) ? http_stall_timeout_msecs : stall_timeout_msecs;
+}
+
+bool IBaseStream::IsStallDetectable() const {
+  return !IsVod();
+}
+
+void IBaseStream::OnInputStalled(element_id_t id, StallReason reason) {
+  WARNING_LOG() << "Input " << id << " stalled, reason: " << reason;
+  RestartInput();
+}
+
+gboolean IBaseStream::HandleStallCheckTick() {
+  const gint64 now = g_get_monotonic_time();
+  const input_t inputs = config_->GetInput();
+  for (InputProbe* source_probe : probe_in_) {
+    const element_id_t id = source_probe->GetID();
+    if (id >= inputs.size()) {
+      continue;
+    }
+
+    const size_t timeout_msec = GetStallTimeout(inputs[id]);
+    if (!timeout_msec) {
+      continue;
+    }
+
+    // bursts of pulled input aren't seen after demuxer, source pad is watched only if there is nothing else
+    Probe* probe = source_probe;
+    if (IsPulledInput(inputs[id].GetInput())) {
+      DecodedProbe* decoded = GetDecodedProbe(id, source_probe->GetUrl());
+      if (decoded) {
+        probe = decoded;
+      }
+    }
+
+    const gint64 timeout_usec = static_cast<gint64>(timeout_msec) * 1000;
+    const ProbeStats pstats = probe->GetStats();
+    if (!pstats.last_arrival) {  // input which never got data is left for no data panic
+      continue;
+    }
+
+    InputWatch* watch = &inputs_watch_[id];
+    const GstClockTime position = GST_CLOCK_TIME_IS_VALID(pstats.last_pts) ? pstats.last_pts : pstats.last_dts;
+    if (!GST_CLOCK_TIME_IS_VALID(position)) {
+      watch->progress_time = pstats.last_arrival;  // source without timestamps, arrival is all we have
+    } else if (position != watch->position) {
+      watch->position = position;
+      watch->progress_time = now;
+    }
+
+    if (!watch->window_start || pstats.total_bytes < watch->window_bytes) {  // first look or rebuilt probe
+      watch->window_start = now;
+      watch->window_bytes = pstats.total_bytes;
+      watch->low_bitrate = false;
+    } else if (now - watch->window_start >= timeout_usec) {
+      const size_t bytes_per_sec =
+          (pstats.total_bytes - watch->window_bytes) * G_USEC_PER_SEC / static_cast<size_t>(now - watch->window_start);
+      watch->low_bitrate = false;
+      if (desire_flags_ != INITED_NOTHING && id < stats_->input.size()) {
+        const common::media::DesireBytesPerSec desire = stats_->input[id].GetDesireBytesPerSecond();
+        watch->low_bitrate = desire.IsValid() && bytes_per_sec < desire.min / stall_low_bitrate_divider;
+      }
+      watch->window_start = now;
+      watch->window_bytes = pstats.total_bytes;
+    }
+
+    bool stalled = true;
+    StallReason reason = STALL_NO_DATA;
+    if (now - pstats.last_arrival > timeout_usec) {
+      reason = STALL_NO_DATA;
+    } else if (now - watch->progress_time > timeout_usec) {
+      reason = STALL_NO_PROGRESS;
+    } else if (watch->low_bitrate) {
+      reason = STALL_LOW_BITRATE;
+    } else {
+      stalled = false;
+    }
+
+    if (stalled == watch->stalled) {
+      continue;
+    }
+
+    watch->stalled = stalled;
+    if (!stalled) {
+      if (client_) {
+        client_->OnInputRecovered(this, inputs[id]);
+      }
+      continue;
+    }
+
+    if (client_) {
+      client_->OnInputStalled(this, inputs[id], reason, (now - pstats.last_arrival) / 1000);
+    }
+    OnInputStalled(id, reason);
+  }
+  return TRUE;
+}
+
 gboolean IBaseStream::HandleMainTimerTick() {
   const time_t up_time = GetElipsedTime();
   const size_t diff = (no_data_panic_sec - no_data_panic_tick_ + up_time) + 1;
 
+  CollectProbeStats();
+  if (tracer_) {
+    tracer_->Sync(pipeline_elements_);
+  }
+
   size_t checkpoint_diff_in_total = 0;
   common::media::DesireBytesPerSec checkpoint_desire_in_total;
   size_t input_stream_count = stats_->input.size();
@@ -616,6 +1052,9 @@ gboolean IBaseStream::HandleMainTimerTick() {
   if (IsActive()) {
     if (status_tick_ <= up_time) {
       status_tick_ = up_time + Config::report_delay_sec;  // update status timestamp
+      if (tracer_) {
+        tracer_->Collect(&stats_->elements);
+      }
       if (client_) {
         client_->OnTimeoutUpdated(this);
       }
@@ -632,6 +1071,20 @@ gboolean IBaseStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* mes
   GstObject* src = GST_MESSAGE_SRC(message);
   if (type == GST_MESSAGE_BUFFERING) {
     HandleBufferingMessage(message);
+  } else if (type == GST_MESSAGE_APPLICATION) {
+    if (src == GST_OBJECT(pipeline_) && gst_message_has_name(message, RESTART_INPUT_INFO_NAME)) {
+      gint64 request_time = 0;
+      gst_structure_get_int64(gst_message_get_structure(message), "time", &request_time);
+      HandleRestartInput(request_time);
+    }
+  } else if (type == GST_MESSAGE_ERROR) {
+    if (IsInputRestartable() && IsInputElement(GetInputElements(), src)) {
+      GError* err = nullptr;
+      gst_message_parse_error(message, &err, nullptr);
+      WARNING_LOG() << "Input error: " << (err ? err->message : "unknown") << ", restarting input.";
+      g_clear_error(&err);
+      HandleRestartInput(g_get_monotonic_time());
+    }
   } else if (type == GST_MESSAGE_CLOCK_LOST) {
     GstClock* clock = nullptr;
     gst_message_parse_clock_lost(message, &clock);
@@ -643,7 +1096,7 @@ gboolean IBaseStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* mes
       common::uri::Url::scheme sh = input_url.GetScheme();
       if (sh == common::uri::Url::http || sh == common::uri::Url::https) {
         GstBaseSrc* basesrc = reinterpret_cast<GstBaseSrc*>(src);
-        UpdateInputProbeStats(probe_in_[i], basesrc->segment.duration);
+        probe_in_[i]->AccountBytes(basesrc->segment.duration);
       }
     }
     DEBUG_LOG() << "ASYNC GST_MESSAGE_DURATION_CHANGED: " << GST_OBJECT_NAME(src);
@@ -750,16 +1203,56 @@ void IBaseStream::HandleOutputProbeEvent(OutputProbe* probe, GstEvent* event) {
 }
 
 elements::Element* IBaseStream::GetElementByName(const std::string& name) const {
+  elements::Element* el = FindElementByName(name);
+  if (!el) {
+    NOTREACHED() << "Not founded element name: " << name;
+  }
+  return el;
+}
+
+elements::Element* IBaseStream::FindElementByName(const std::string& name) const {
   for (elements::Element* el : pipeline_elements_) {
     if (el->GetName() == name) {
       return el;
     }
   }
-
-  NOTREACHED() << "Not founded element name: " << name;
   return nullptr;
 }
 
+DecodedProbe* IBaseStream::GetDecodedProbe(element_id_t id, const common::uri::Url& url) {
+  for (auto it = probe_decoded_.begin(); it != probe_decoded_.end(); ++it) {
+    DecodedProbe* probe = *it;
+    if (probe->GetID() != id) {
+      continue;
+    }
+    if (probe->GetPad()) {
+      return probe;
+    }
+    // pad was destroyed with pipeline, counters of old pipeline mustn't be used
+    delete probe;
+    probe_decoded_.erase(it);
+    break;
+  }
+
+  elements::Element* udb = FindElementByName(common::MemSPrintf(UDB_VIDEO_NAME_1U, id));
+  if (!udb) {
+    udb = FindElementByName(common::MemSPrintf(UDB_AUDIO_NAME_1U, id));
+  }
+  if (!udb) {
+    return nullptr;
+  }
+
+  pad::Pad* sink_pad = udb->StaticPad("sink");
+  DecodedProbe* probe = nullptr;
+  if (sink_pad->IsValid()) {
+    probe = new DecodedProbe(id, url, this);
+    probe->Link(sink_pad->GetGstPad());
+    probe_decoded_.push_back(probe);
+  }
+  delete sink_pad;
+  return probe;
+}
+
 void IBaseStream::HandleBufferingMessage(GstMessage* message) {
   UNUSED(message);
 }
@@ -795,6 +1288,13 @@ GstStateChangeReturn IBaseStream::SetPipelineState(GstState state) {
 
 // callbacks
 
+gboolean IBaseStream::restart_input_callback(gpointer user_data) {
+  IBaseStream* stream = reinterpret_cast<IBaseStream*>(user_data);
+  stream->restart_input_timer_id_ = 0;
+  stream->HandleRestartInput(g_get_monotonic_time());
+  return FALSE;
+}
+
 gboolean IBaseStream::main_timer_callback(gpointer user_data) {
   /*
     Restart if no data, set new checkpoint
@@ -807,17 +1307,22 @@ gboolean IBaseStream::main_timer_callback(gpointer user_data) {
   return res;
 }
 
-void IBaseStream::UpdateInputProbeStats(const InputProbe* probe, gsize size) {
-  if (probe->GetID() < stats_->input.size()) {
-    const size_t prev_total = stats_->input[probe->GetID()].GetTotalBytes();
-    stats_->input[probe->GetID()].SetTotalBytes(prev_total + size);
-  }
+gboolean IBaseStream::stall_check_callback(gpointer user_data) {
+  IBaseStream* stream = reinterpret_cast<IBaseStream*>(user_data);
+  return stream->HandleStallCheckTick();
 }
 
-void IBaseStream::UpdateOutputProbeStats(const OutputProbe* probe, gsize size) {
-  if (probe->GetID() < stats_->output.size()) {
-    const size_t prev_total = stats_->output[probe->GetID()].GetTotalBytes();
-    stats_->output[probe->GetID()].SetTotalBytes(prev_total + size);
+void IBaseStream::CollectProbeStats() {
+  for (InputProbe* probe : probe_in_) {
+    if (probe->GetID() < stats_->input.size()) {
+      ApplyProbeStats(probe->CollectStats(), &stats_->input[probe->GetID()]);
+    }
+  }
+
+  for (OutputProbe* probe : probe_out_) {
+    if (probe->GetID() < stats_->output.size()) {
+      ApplyProbeStats(probe->CollectStats(), &stats_->output[probe->GetID()]);
+    }
   }
 }
 
@@ -16,6 +16,7 @@
 
 #include <gst/gstevent.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -32,8 +33,11 @@ namespace fastocloud {
 namespace stream {
 
 class IBaseBuilder;
+class ElementTracer;
 class InputProbe;
+class DecodedProbe;
 class OutputProbe;
+struct ProbeStats;
 class Config;
 
 enum ExitStatus { EXIT_SELF, EXIT_INNER };
@@ -57,6 +61,8 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
                                                        GstPadProbeInfo* info) = 0;
     virtual GstPadProbeInfo* OnCheckReveivedData(IBaseStream* stream, InputProbe* probe, GstPadProbeInfo* info) = 0;
     virtual void OnInputChanged(const InputUri& uri) = 0;
+    virtual void OnInputStalled(IBaseStream* stream, const InputUri& uri, StallReason reason, gint64 silence_msec) = 0;
+    virtual void OnInputRecovered(IBaseStream* stream, const InputUri& uri) = 0;  // also when data appears first time
     virtual void OnPipelineCreated(IBaseStream* stream) = 0;
     virtual ~IStreamClient();
   };
@@ -66,7 +72,12 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
     main_timer_msecs = 1000,
     no_data_panic_sec = 60,
     src_timeout_sec = no_data_panic_sec * 2,
-    cleanup_life_period_sec = 15 * 2 * 10  // 2x15 sec and 10 chunks
+    cleanup_life_period_sec = 15 * 2 * 10,  // 2x15 sec and 10 chunks
+    restart_input_interval_msecs = 1000,    // flapping input is not rebuilt more often
+    stall_check_msecs = 250,
+    stall_timeout_msecs = 1500,       // pushed input, used when config doesn't set stall_timeout
+    http_stall_timeout_msecs = 8000,  // pulled input, watched after demuxer, segments may come late
+    stall_low_bitrate_divider = 4     // data rate below 1/4 of desired is a stall
   };
 
   // channel_id_t not empty
@@ -77,6 +88,11 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   ExitStatus Exec();
   void Restart();
 
+  // thread safe, rebuilds only input part of pipeline, encoders and outputs keep running,
+  // stream which can't do it exits with EXIT_INNER
+  void RestartInput();
+  virtual bool IsInputRestartable() const;
+
   bool IsLive() const;
 
   void Quit(ExitStatus status);
@@ -90,15 +106,14 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
   bool IsVod() const;
 
+  size_t GetStallTimeout(const InputUri& input) const;  // msec, 0 if stall detection is off
+
   virtual void HandleInputProbeEvent(InputProbe* probe, GstEvent* event);
   virtual void HandleOutputProbeEvent(OutputProbe* probe, GstEvent* event);
 
   virtual GstPadProbeInfo* CheckProbeData(InputProbe* probe, GstPadProbeInfo* buff);
   virtual GstPadProbeInfo* CheckProbeDataOutput(OutputProbe* probe, GstPadProbeInfo* buff);
 
-  void UpdateInputProbeStats(const InputProbe* probe, gsize size);
-  void UpdateOutputProbeStats(const OutputProbe* probe, gsize size);
-
   const Config* GetConfig() const;
 
   void LinkInputPad(GstPad* pad, element_id_t id, const common::uri::Url& url);
@@ -111,6 +126,7 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
  protected:
   elements::Element* GetElementByName(const std::string& name) const;
+  elements::Element* FindElementByName(const std::string& name) const;  // nullptr if there is no such element
 
   bool IsAudioInited() const;
   bool IsVideoInited() const;
@@ -121,6 +137,20 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   void SetAudioInited(bool val);
   void SetVideoInited(bool val);
 
+  // elements rebuilt by RestartInput, everything linked to them stays in pipeline
+  virtual elements_line_t GetInputElements() const;
+  // running time of pipeline when not live input was restarted, new input pads are shifted by it
+  GstClockTimeDiff GetInputOffset() const;
+  // lock-free snapshot of input probe counters, false if input with such id has no probe
+  bool GetInputProbeStats(element_id_t id, ProbeStats* stats) const;
+  // same for buffers entering udb element of input, false if input has no probe or pipeline no such element
+  bool GetDecodedProbeStats(element_id_t id, ProbeStats* stats);
+  // tears down input elements in running pipeline and builds them again with builder, probes on their pads
+  // are dropped, elements downstream of input are flushed but keep running
+  bool RebuildInputElements(const elements_line_t& input,
+                            IBaseBuilder* builder,
+                            bool* is_live_input) WARN_UNUSED_RESULT;
+
   void OnInpudSrcPadCreated(pad::Pad* src_pad, element_id_t id, const common::uri::Url& url) override = 0;
   void OnOutputSinkPadCreated(pad::Pad* sink_pad,
                               element_id_t id,
@@ -129,6 +159,10 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
   virtual IBaseBuilder* CreateBuilder() = 0;
 
+  // pipeline is built but not started, stream which finished its work here returns false and exit status
+  virtual bool PrePlay(ExitStatus* status);
+  GstElement* GetPipeline() const;
+
   virtual void PreLoop() = 0;
   virtual void PostLoop(ExitStatus status) = 0;
 
@@ -140,6 +174,12 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   virtual GstBusSyncReply HandleSyncBusMessageReceived(GstBus* bus, GstMessage* message);
   virtual gboolean HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* message);
 
+  // false if input is fed on demand, so gaps in data are normal and inputs aren't watched for stalls
+  virtual bool IsStallDetectable() const;
+  // input stopped delivering, rebuilds input by default
+  virtual void OnInputStalled(element_id_t id, StallReason reason);
+  virtual gboolean HandleStallCheckTick();
+
   virtual void OnInputDataFailed();
   virtual void OnInputDataOK();
 
@@ -163,20 +203,30 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
   std::vector<InputProbe*> probe_in_;
   std::vector<OutputProbe*> probe_out_;
+  std::vector<DecodedProbe*> probe_decoded_;  // pulled inputs only, linked by stall check
 
   bool InitPipeLine();
   void ClearOutProbes();
   void ClearInProbes();
+  void ClearInProbes(const elements_line_t& input);  // only probes on pads of input elements
+  void CollectProbeStats();
+  // probe after demuxer of input, nullptr if pipeline has no such element
+  DecodedProbe* GetDecodedProbe(element_id_t id, const common::uri::Url& url);
   void ResetDataWait();
+  void HandleRestartInput(gint64 request_time);
+  bool SwapInput();
 
   static GstBusSyncReply sync_bus_callback(GstBus* bus, GstMessage* message, gpointer user_data);
   static gboolean main_timer_callback(gpointer user_data);
+  static gboolean stall_check_callback(gpointer user_data);
+  static gboolean restart_input_callback(gpointer user_data);
   static gboolean async_bus_callback(GstBus* bus, GstMessage* message, gpointer user_data);
 
   //! Gstreamer loop pointer. You set it up with you custom run-loop.
   GMainLoop* const loop_;
   GstElement* pipeline_;
   elements_line_t pipeline_elements_;
+  ElementTracer* tracer_;  // nullptr if elements tracing is off
 
   time_t status_tick_;
   time_t no_data_panic_tick_;
@@ -186,9 +236,25 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   ExitStatus last_exit_status_;
   bool is_live_;
 
+  GstClockTimeDiff input_offset_;
+  gint64 input_restart_time_;  // monotonic
+  guint restart_input_timer_id_;
+
   int flags_;
   int desire_flags_;
 
+  struct InputWatch {
+    InputWatch();
+
+    bool stalled;  // true until data is seen
+    GstClockTime position;
+    gint64 progress_time;  // monotonic, when position moved last time
+    size_t window_bytes;
+    gint64 window_start;
+    bool low_bitrate;
+  };
+  std::map<element_id_t, InputWatch> inputs_watch_;  // survives input rebuilds, probes don't
+
   DISALLOW_COPY_AND_ASSIGN(IBaseStream);
 };
 
@@ -27,8 +27,32 @@ Consistency::Consistency()
       saw_stream_start(FALSE),
       saw_serialized_event(FALSE) {}
 
+ProbeStats::ProbeStats()
+    : total_bytes(0),
+      total_buffers(0),
+      key_frames(0),
+      discont_buffers(0),
+      gap_buffers(0),
+      last_pts(GST_CLOCK_TIME_NONE),
+      last_dts(GST_CLOCK_TIME_NONE),
+      last_arrival(0) {}
+
 Probe::Probe(element_id_t id, const common::uri::Url& url, IBaseStream* stream)
-    : stream_(stream), id_(id), id_buffer_(0), pad_(nullptr), consistency_(), url_(url) {
+    : stream_(stream),
+      id_(id),
+      id_buffer_(0),
+      pad_(nullptr),
+      consistency_(),
+      url_(url),
+      total_bytes_(0),
+      total_buffers_(0),
+      key_frames_(0),
+      discont_buffers_(0),
+      gap_buffers_(0),
+      last_pts_(GST_CLOCK_TIME_NONE),
+      last_dts_(GST_CLOCK_TIME_NONE),
+      last_arrival_(0),
+      collected_() {
   CHECK(stream);
 }
 
@@ -65,6 +89,64 @@ Consistency Probe::GetConsistency() const {
   return consistency_;
 }
 
+ProbeStats Probe::GetStats() const {
+  ProbeStats stats;
+  stats.total_bytes = total_bytes_.load(std::memory_order_relaxed);
+  stats.total_buffers = total_buffers_.load(std::memory_order_relaxed);
+  stats.key_frames = key_frames_.load(std::memory_order_relaxed);
+  stats.discont_buffers = discont_buffers_.load(std::memory_order_relaxed);
+  stats.gap_buffers = gap_buffers_.load(std::memory_order_relaxed);
+  stats.last_pts = last_pts_.load(std::memory_order_relaxed);
+  stats.last_dts = last_dts_.load(std::memory_order_relaxed);
+  stats.last_arrival = last_arrival_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+ProbeStats Probe::CollectStats() {
+  const ProbeStats current = GetStats();
+  ProbeStats diff = current;
+  diff.total_bytes -= collected_.total_bytes;
+  diff.total_buffers -= collected_.total_buffers;
+  diff.key_frames -= collected_.key_frames;
+  diff.discont_buffers -= collected_.discont_buffers;
+  diff.gap_buffers -= collected_.gap_buffers;
+  collected_ = current;
+  return diff;
+}
+
+void Probe::AccountBytes(size_t size) {
+  total_bytes_.fetch_add(size, std::memory_order_relaxed);
+}
+
+void Probe::AccountBuffer(GstBuffer* buffer) {
+  total_bytes_.fetch_add(gst_buffer_get_size(buffer), std::memory_order_relaxed);
+  total_buffers_.fetch_add(1, std::memory_order_relaxed);
+  if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    key_frames_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT)) {
+    discont_buffers_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_GAP)) {
+    gap_buffers_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (GST_BUFFER_PTS_IS_VALID(buffer)) {
+    last_pts_.store(GST_BUFFER_PTS(buffer), std::memory_order_relaxed);
+  }
+  if (GST_BUFFER_DTS_IS_VALID(buffer)) {
+    last_dts_.store(GST_BUFFER_DTS(buffer), std::memory_order_relaxed);
+  }
+  last_arrival_.store(g_get_monotonic_time(), std::memory_order_relaxed);
+}
+
+void Probe::AccountBufferList(GstBufferList* buffer_list) {
+  guint len = gst_buffer_list_length(buffer_list);
+  for (guint i = 0; i < len; ++i) {
+    GstBuffer* buffer = gst_buffer_list_get(buffer_list, i);
+    AccountBuffer(buffer);
+  }
+}
+
 void Probe::destroy_callback_probe(gpointer user_data) {
   Probe* probe = reinterpret_cast<Probe*>(user_data);
   probe->ClearInner();
@@ -84,7 +166,10 @@ GstPadProbeReturn InputProbe::source_callback_probe_buffer(GstPad* pad, GstPadPr
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
   if (GST_IS_BUFFER(data)) {
     GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateInputProbeStats(probe, gst_buffer_get_size(buffer));
+    probe->AccountBuffer(buffer);
+  } else if (GST_IS_BUFFER_LIST(data)) {
+    GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(checked_info);
+    probe->AccountBufferList(buffer_list);
   } else if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
     const gchar* event_name = GST_EVENT_TYPE_NAME(event);
@@ -205,14 +290,10 @@ GstPadProbeReturn OutputProbe::sink_callback_probe_buffer(GstPad* pad, GstPadPro
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
   if (GST_IS_BUFFER(data)) {
     GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateOutputProbeStats(probe, gst_buffer_get_size(buffer));
+    probe->AccountBuffer(buffer);
   } else if (GST_IS_BUFFER_LIST(data)) {
     GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(checked_info);
-    guint len = gst_buffer_list_length(buffer_list);
-    for (guint i = 0; i < len; ++i) {
-      GstBuffer* buffer = gst_buffer_list_get(buffer_list, i);
-      stream->UpdateOutputProbeStats(probe, gst_buffer_get_size(buffer));
-    }
+    probe->AccountBufferList(buffer_list);
   } else if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
     const gchar* event_name = GST_EVENT_TYPE_NAME(event);
@@ -290,5 +371,47 @@ void OutputProbe::Link(GstPad* pad) {
   DEBUG_LOG() << "Output probe added id: " << id_probe;
 }
 
+DecodedProbe::DecodedProbe(element_id_t id, const common::uri::Url& url, IBaseStream* stream)
+    : base_class(id, url, stream) {}
+
+GstPadProbeReturn DecodedProbe::sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  UNUSED(pad);
+  DecodedProbe* probe = reinterpret_cast<DecodedProbe*>(user_data);
+  void* data = GST_PAD_PROBE_INFO_DATA(info);
+  if (GST_IS_BUFFER(data)) {
+    probe->AccountBuffer(GST_PAD_PROBE_INFO_BUFFER(info));
+  } else if (GST_IS_BUFFER_LIST(data)) {
+    probe->AccountBufferList(GST_PAD_PROBE_INFO_BUFFER_LIST(info));
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void DecodedProbe::Link(GstPad* pad) {
+  if (!pad) {
+    return;
+  }
+
+  Clear();
+
+  GstPadDirection dir = gst_pad_get_direction(pad);
+  gulong id_probe = 0;
+  if (dir == GST_PAD_SINK) {
+    id_probe = gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER |
+                                                                   GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                 sink_callback_probe_buffer, this, &destroy_callback_probe);
+  } else {
+    NOTREACHED();
+  }
+
+  if (!id_probe) {
+    CRITICAL_LOG() << "Cannot add decoded probe";
+    return;
+  }
+
+  pad_ = pad;
+  id_buffer_ = id_probe;
+  DEBUG_LOG() << "Decoded probe added id: " << id_probe;
+}
+
 }  // namespace stream
 }  // namespace fastocloud
@@ -16,6 +16,7 @@
 
 #include <common/utils.h>
 
+#include <atomic>
 #include <string>  // for string
 
 #include <gst/gstpad.h>  // for GstPad, GstPadProbeInfo, GstPadProbeReturn
@@ -38,6 +39,19 @@ struct Consistency {
   gboolean saw_serialized_event;
 };
 
+struct ProbeStats {
+  ProbeStats();
+
+  size_t total_bytes;
+  size_t total_buffers;
+  size_t key_frames;  // buffers without DELTA_UNIT flag
+  size_t discont_buffers;
+  size_t gap_buffers;
+  GstClockTime last_pts;
+  GstClockTime last_dts;
+  gint64 last_arrival;  // g_get_monotonic_time of the last buffer, 0 if nothing arrived yet
+};
+
 class Probe {
  public:
   Probe(element_id_t id, const common::uri::Url& url, IBaseStream* stream);
@@ -51,9 +65,19 @@ class Probe {
   GstPad* GetPad() const;
   Consistency GetConsistency() const;
 
+  // lock-free snapshot, safe to call while streaming threads update counters
+  ProbeStats GetStats() const;
+  // counters accumulated since previous call, last_* fields are taken as is; main loop only
+  ProbeStats CollectStats();
+
+  void AccountBytes(size_t size);
+
  protected:
   static void destroy_callback_probe(gpointer user_data);
 
+  void AccountBuffer(GstBuffer* buffer);
+  void AccountBufferList(GstBufferList* buffer_list);
+
   void Clear();
 
  private:
@@ -69,6 +93,17 @@ class Probe {
   const common::uri::Url url_;
 
  private:
+  std::atomic<size_t> total_bytes_;
+  std::atomic<size_t> total_buffers_;
+  std::atomic<size_t> key_frames_;
+  std::atomic<size_t> discont_buffers_;
+  std::atomic<size_t> gap_buffers_;
+  std::atomic<GstClockTime> last_pts_;
+  std::atomic<GstClockTime> last_dts_;
+  std::atomic<gint64> last_arrival_;
+
+  ProbeStats collected_;
+
   DISALLOW_COPY_AND_ASSIGN(Probe);
 };
 
@@ -98,5 +133,18 @@ class OutputProbe : public Probe {
   const bool need_push_;
 };
 
+// counts buffers entering element after demuxer/decoder of input, pulled sources deliver in bursts
+// so their progress is seen only here
+class DecodedProbe : public Probe {
+ public:
+  typedef Probe base_class;
+  DecodedProbe(element_id_t id, const common::uri::Url& url, IBaseStream* stream);
+
+  void Link(GstPad* pad) override;
+
+ private:
+  static GstPadProbeReturn sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+};
+
 }  // namespace stream
 }  // namespace fastocloud
@@ -72,7 +72,9 @@ TimeShiftInfo make_timeshift_info(const StreamConfig& config) {
 StreamController::StreamController(const common::file_system::ascii_directory_string_path& feedback_dir,
                                    const common::file_system::ascii_file_string_path& streamlink_path,
                                    fastotv::protocol::protocol_client_t* command_client,
-                                   StreamStruct* mem)
+                                   StreamStruct* mem,
+                                   SharedStreamStats* shared_stats,
+                                   const StartupTiming& startup)
     : IBaseStream::IStreamClient(),
       feedback_dir_(feedback_dir),
       streamlink_path_(streamlink_path),
@@ -87,6 +89,15 @@ StreamController::StreamController(const common::file_system::ascii_directory_st
       ttl_master_timer_(0),
       libev_started_(2),
       mem_(mem),
+      shared_stats_(shared_stats),
+      stalled_inputs_(),
+      startup_mutex_(),
+      startup_(startup),
+      startup_restarts_(0),
+      startup_wait_segment_(false),
+      startup_reported_(false),
+      startup_input_marked_(false),
+      startup_output_marked_(false),
       origin_(nullptr),
 #if defined(OS_WIN)
       process_metrics_(common::process::ProcessMetrics::CreateProcessMetrics(GetCurrentProcess()))
@@ -122,6 +133,7 @@ common::Error StreamController::Init(const StreamConfig& config_args) {
   }
 
   streams_init(0, nullptr, enc);
+  MarkStartup(STARTUP_INITED);
   return common::Error();
 }
 
@@ -142,6 +154,7 @@ int StreamController::Exec() {
   });
   libev_started_.Wait();
 
+  bool restart = false;
   while (!stop_) {
     chunk_index_t start_chunk_index = invalid_chunk_index;
     if (config_->GetType() == TIMESHIFT_PLAYER) {  // if timeshift player or cathcup player
@@ -170,7 +183,10 @@ int StreamController::Exec() {
     int stabled_status = EXIT_SUCCESS;
     int signal_number = 0;
     fastotv::timestamp_t start_utc_now = common::time::current_utc_mstime();
+    ResetStartup(restart, config_);
+    restart = true;
     const std::unique_ptr<Config> config_copy(make_config_copy(config_, &gena));
+    MarkStartup(STARTUP_LINKS_GENERATED);
     origin_ =
         StreamsFactory::GetInstance().CreateStream(config_copy.get(), this, mem_, timeshift_info_, start_chunk_index);
     if (!origin_) {
@@ -181,6 +197,7 @@ int StreamController::Exec() {
     bool is_vod = origin_->IsVod();
     ExitStatus res = origin_->Exec();
     destroy(&origin_);
+    ReportStartup();  // pipeline exited before first segment, report phases it reached
     if (res == EXIT_INNER) {
       stabled_status = EXIT_FAILURE;
     }
@@ -189,8 +206,8 @@ int StreamController::Exec() {
     fastotv::timestamp_t diff_utc_time = end_utc_now - start_utc_now;
     INFO_LOG() << "Stream exit with status: " << (stabled_status ? "FAILURE" : "SUCCESS")
                << ", signal: " << signal_number << ", working time: " << diff_utc_time << " msec.";
-    if (is_vod) {
-      break;
+    if (is_vod) {  // service learns whether vod was encoded from exit code
+      return stabled_status;
     }
 
     bool is_longer_work = diff_utc_time > restart_after_frozen_sec * 10 * 1000;
@@ -247,6 +264,10 @@ void StreamController::Restart() {
     std::unique_lock<std::mutex> lock(stop_mutex_);
     stop_cond_.notify_all();
   }
+  if (origin_ && origin_->IsInputRestartable()) {  // encoders and outputs keep running
+    origin_->RestartInput();
+    return;
+  }
   StopStream();
 }
 
@@ -430,6 +451,11 @@ void StreamController::OnStatusChanged(IBaseStream* stream, StreamStatus status)
 GstPadProbeInfo* StreamController::OnCheckReveivedData(IBaseStream* stream, InputProbe* probe, GstPadProbeInfo* info) {
   UNUSED(stream);
   UNUSED(probe);
+  if (!startup_input_marked_.load(std::memory_order_relaxed) &&
+      (GST_PAD_PROBE_INFO_TYPE(info) & (GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST)) &&
+      !startup_input_marked_.exchange(true)) {
+    MarkStartup(STARTUP_FIRST_INPUT_BUFFER);
+  }
   return info;
 }
 
@@ -438,6 +464,11 @@ GstPadProbeInfo* StreamController::OnCheckReveivedOutputData(IBaseStream* stream
                                                              GstPadProbeInfo* info) {
   UNUSED(stream);
   UNUSED(probe);
+  if (!startup_output_marked_.load(std::memory_order_relaxed) &&
+      (GST_PAD_PROBE_INFO_TYPE(info) & (GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST)) &&
+      !startup_output_marked_.exchange(true)) {
+    MarkStartup(STARTUP_FIRST_OUTPUT_BUFFER);
+  }
   return info;
 }
 
@@ -466,8 +497,27 @@ void StreamController::OnTimeoutUpdated(IBaseStream* stream) {
 }
 
 void StreamController::OnASyncMessageReceived(IBaseStream* stream, GstMessage* message) {
-  UNUSED(stream);
-  UNUSED(message);
+  GstMessageType type = GST_MESSAGE_TYPE(message);
+  if (type == GST_MESSAGE_STATE_CHANGED) {
+    if (GST_MESSAGE_SRC(message) != GST_OBJECT(stream->GetPipeline())) {
+      return;
+    }
+
+    GstState old_state, new_state, pending_state;
+    gst_message_parse_state_changed(message, &old_state, &new_state, &pending_state);
+    if (new_state == GST_STATE_PAUSED) {
+      MarkStartup(STARTUP_PAUSED);
+    } else if (new_state == GST_STATE_PLAYING) {
+      MarkStartup(STARTUP_PLAYING);
+    }
+  } else if (type == GST_MESSAGE_ELEMENT) {
+    // chunk closed by multifilesink of hlssink or by splitmuxsink of hlssink2
+    const GstStructure* structure = gst_message_get_structure(message);
+    if (gst_structure_has_name(structure, "GstMultiFileSink") ||
+        gst_structure_has_name(structure, "splitmuxsink-fragment-closed")) {
+      MarkStartup(STARTUP_FIRST_SEGMENT);
+    }
+  }
 }
 
 void StreamController::OnSyncMessageReceived(IBaseStream* stream, GstMessage* message) {
@@ -480,13 +530,93 @@ void StreamController::OnInputChanged(const InputUri& uri) {
   static_cast<StreamServer*>(loop_)->SendChangeSourcesBroadcast(ch);
 }
 
+void StreamController::OnInputStalled(IBaseStream* stream,
+                                      const InputUri& uri,
+                                      StallReason reason,
+                                      gint64 silence_msec) {
+  UNUSED(stream);
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  stalled_inputs_[uri.GetID()] = {reason, current_time - silence_msec};
+  InputStallInfo stall(mem_->id, uri.GetID(), reason, false, current_time, silence_msec);
+  static_cast<StreamServer*>(loop_)->SendInputStallBroadcast(stall);
+}
+
+void StreamController::OnInputRecovered(IBaseStream* stream, const InputUri& uri) {
+  UNUSED(stream);
+  const auto it = stalled_inputs_.find(uri.GetID());
+  if (it == stalled_inputs_.end()) {
+    return;
+  }
+
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  InputStallInfo stall(mem_->id, uri.GetID(), it->second.reason, true, current_time, current_time - it->second.start);
+  stalled_inputs_.erase(it);
+  static_cast<StreamServer*>(loop_)->SendInputStallBroadcast(stall);
+}
+
 void StreamController::OnPipelineCreated(IBaseStream* stream) {
+  MarkStartup(STARTUP_PIPELINE_CREATED);
   auto dump_file = feedback_dir_.MakeFileStringPath(DUMP_FILE_NAME);
   if (dump_file) {
     stream->DumpIntoFile(*dump_file);
   }
 }
 
+void StreamController::ResetStartup(bool restart, const Config* config) {
+  bool wait_segment = false;
+  for (const OutputUri& output : config->GetOutput()) {
+    if (output.GetOutput().GetScheme() == common::uri::Url::http) {
+      wait_segment = true;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(startup_mutex_);
+  if (restart) {  // process phases belong to first start
+    startup_ = StartupTiming();
+  }
+  startup_restarts_ = mem_->restarts;  // counted when pipeline exits
+  startup_wait_segment_ = wait_segment;
+  startup_reported_ = false;
+  startup_input_marked_ = false;
+  startup_output_marked_ = false;
+  startup_.Mark(STARTUP_STARTING);
+}
+
+void StreamController::MarkStartup(StartupPhase phase) {
+  bool completed = false;
+  {
+    std::unique_lock<std::mutex> lock(startup_mutex_);
+    if (startup_reported_) {
+      return;
+    }
+
+    startup_.Mark(phase);
+    completed = phase == STARTUP_FIRST_SEGMENT || (phase == STARTUP_FIRST_OUTPUT_BUFFER && !startup_wait_segment_);
+  }
+
+  if (completed) {
+    ReportStartup();
+  }
+}
+
+void StreamController::ReportStartup() {
+  StartupTiming startup;
+  size_t restarts;
+  {
+    std::unique_lock<std::mutex> lock(startup_mutex_);
+    if (startup_reported_) {
+      return;
+    }
+    startup_reported_ = true;
+    startup = startup_;
+    restarts = startup_restarts_;
+  }
+
+  INFO_LOG() << "Stream start took " << startup.GetDuration() / 1000 << " msec, restarts: " << restarts;
+  StartupInfo info(mem_->id, restarts, startup);
+  static_cast<StreamServer*>(loop_)->SendStartupBroadcast(info);
+}
+
 void StreamController::DumpStreamStatus(StreamStruct* stat) {
   const double cpu_load = process_metrics_->GetPlatformIndependentCPUUsage();
 #if defined(OS_LINUX) || defined(OS_ANDROID)
@@ -496,6 +626,11 @@ void StreamController::DumpStreamStatus(StreamStruct* stat) {
   const size_t rss = 0;
 #endif
   const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  if (shared_stats_) {
+    shared_stats_->Publish(*stat, cpu_load, rss, current_time);
+    return;
+  }
+
   StatisticInfo statistic(*stat, cpu_load, rss, current_time);
   static_cast<StreamServer*>(loop_)->SendStatisticBroadcast(statistic);
 }
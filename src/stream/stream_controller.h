@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string>
 #include <thread>
 
@@ -25,6 +28,8 @@
 #include <fastotv/protocol/protocol.h>
 #include <fastotv/protocol/types.h>
 
+#include "base/shared_stream_stats.h"
+#include "base/startup_timing.h"
 #include "base/stream_config.h"
 #include "stream/ibase_stream.h"
 #include "stream/timeshift.h"
@@ -39,7 +44,9 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   StreamController(const common::file_system::ascii_directory_string_path& feedback_dir,
                    const common::file_system::ascii_file_string_path& streamlink_path,
                    fastotv::protocol::protocol_client_t* command_client,
-                   StreamStruct* mem);
+                   StreamStruct* mem,
+                   SharedStreamStats* shared_stats,
+                   const StartupTiming& startup);
 
   common::Error Init(const StreamConfig& config_args);
 
@@ -91,11 +98,17 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   void OnSyncMessageReceived(IBaseStream* stream, GstMessage* message) override;
   void OnASyncMessageReceived(IBaseStream* stream, GstMessage* message) override;
   void OnInputChanged(const InputUri& uri) override;
+  void OnInputStalled(IBaseStream* stream, const InputUri& uri, StallReason reason, gint64 silence_msec) override;
+  void OnInputRecovered(IBaseStream* stream, const InputUri& uri) override;
 
   void OnPipelineCreated(IBaseStream* stream) override;
 
   common::ErrnoError SendResponceToParent(const std::string& cmd) WARN_UNUSED_RESULT;
 
+  void ResetStartup(bool restart, const Config* config);
+  void MarkStartup(StartupPhase phase);  // called from streaming threads too
+  void ReportStartup();
+
   void DumpStreamStatus(StreamStruct* stat);
 
   const common::file_system::ascii_directory_string_path feedback_dir_;
@@ -114,6 +127,21 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   common::threads::barrier libev_started_;
 
   StreamStruct* mem_;
+  SharedStreamStats* shared_stats_;  // service reads statistics from here, pipe used if nullptr
+
+  struct InputStall {
+    StallReason reason;
+    fastotv::timestamp_t start;  // utc msec, when data stopped
+  };
+  std::map<channel_id_t, InputStall> stalled_inputs_;  // kept across stream restarts, to report time to recover
+
+  std::mutex startup_mutex_;
+  StartupTiming startup_;  // of current start, process phases only for first one
+  size_t startup_restarts_;
+  bool startup_wait_segment_;
+  bool startup_reported_;
+  std::atomic<bool> startup_input_marked_;  // buffer probes check it without lock
+  std::atomic<bool> startup_output_marked_;
 
   //
   IBaseStream* origin_;
@@ -55,6 +55,26 @@ void StreamServer::SendStatisticBroadcast(const StatisticInfo& statistic) {
   WriteRequest(req);
 }
 
+void StreamServer::SendInputStallBroadcast(const InputStallInfo& stall) {
+  fastotv::protocol::request_t req;
+  common::Error err = InputStallStreamBroadcast(stall, &req);
+  if (err) {
+    return;
+  }
+
+  WriteRequest(req);
+}
+
+void StreamServer::SendStartupBroadcast(const StartupInfo& startup) {
+  fastotv::protocol::request_t req;
+  common::Error err = StartupStreamBroadcast(startup, &req);
+  if (err) {
+    return;
+  }
+
+  WriteRequest(req);
+}
+
 common::libev::IoChild* StreamServer::CreateChild() {
   NOTREACHED();
   return nullptr;
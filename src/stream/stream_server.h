@@ -20,6 +20,8 @@
 #include <fastotv/protocol/types.h>
 
 #include "stream_commands/commands_info/changed_sources_info.h"
+#include "stream_commands/commands_info/input_stall_info.h"
+#include "stream_commands/commands_info/startup_info.h"
 #include "stream_commands/commands_info/statistic_info.h"
 
 namespace fastocloud {
@@ -37,6 +39,8 @@ class StreamServer : public common::libev::IoLoop {
 
   void SendChangeSourcesBroadcast(const ChangedSouresInfo& change) WARN_UNUSED_RESULT;
   void SendStatisticBroadcast(const StatisticInfo& statistic) WARN_UNUSED_RESULT;
+  void SendInputStallBroadcast(const InputStallInfo& stall) WARN_UNUSED_RESULT;
+  void SendStartupBroadcast(const StartupInfo& startup) WARN_UNUSED_RESULT;
 
   common::libev::IoChild* CreateChild() override;
   common::libev::IoClient* CreateClient(const common::net::socket_info& info) override;
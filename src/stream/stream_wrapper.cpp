@@ -16,23 +16,34 @@
 
 #include <string>
 
+#include <gst/gst.h>
+
 #include <common/file_system/string_path_utils.h>
 
 #include "base/config_fields.h"
 #include "base/constants.h"
 
+#include "stream/ibase_stream.h"
 #include "stream/stream_controller.h"
 
 namespace {
 
 const size_t kMaxSizeLogFile = 1024 * 1024;
 
+// plugins used by most of pipelines, gpu plugins are not here since they depend on per stream environment
+const char* const kPreloadPlugins[] = {
+    "coreelements", "typefindfunctions", "playback", "app", "mpegtsmux", "mpegtsdemux", "videoparsersbad",
+    "audioparsers", "videoconvert", "videoscale", "audioconvert", "audioresample", "x264", "libav", "hls", "udp",
+    "tcp", "flv", "rtmp", "soup"};
+
 int start_stream(const std::string& process_name,
                  const common::file_system::ascii_directory_string_path& feedback_dir,
                  const common::file_system::ascii_file_string_path& streamlink_path,
                  common::logging::LOG_LEVEL logs_level,
                  const fastocloud::StreamConfig& config_args,
                  fastotv::protocol::protocol_client_t* command_client,
+                 fastocloud::SharedStreamStats* shared_stats,
+                 const fastocloud::StartupTiming& startup,
                  const fastocloud::StreamInfo& sha) {
   auto log_file = feedback_dir.MakeFileStringPath(LOGS_FILE_NAME);
   if (log_file) {
@@ -42,7 +53,8 @@ int start_stream(const std::string& process_name,
   NOTICE_LOG() << "Running " PROJECT_VERSION_HUMAN;
 
   const std::unique_ptr<fastocloud::StreamStruct> mem(new fastocloud::StreamStruct(sha));
-  fastocloud::stream::StreamController proc(feedback_dir, streamlink_path, command_client, mem.get());
+  fastocloud::stream::StreamController proc(feedback_dir, streamlink_path, command_client, mem.get(), shared_stats,
+                                            startup);
   common::Error err = proc.Init(config_args);
   if (err) {
     WARNING_LOG() << err->GetDescription();
@@ -57,7 +69,11 @@ int start_stream(const std::string& process_name,
 
 }  // namespace
 
-int stream_exec(const char* process_name, const void* args, void* command_client) {
+int stream_exec(const char* process_name,
+                const void* args,
+                void* command_client,
+                void* shared_stats,
+                const void* startup_timing) {
   if (!process_name || !args || !command_client) {
     CRITICAL_LOG() << "Invalid arguments.";
     return EXIT_FAILURE;
@@ -87,6 +103,26 @@ int stream_exec(const char* process_name, const void* args, void* command_client
   }
 
   fastotv::protocol::protocol_client_t* client = static_cast<fastotv::protocol::protocol_client_t*>(command_client);
+  fastocloud::SharedStreamStats* stats = static_cast<fastocloud::SharedStreamStats*>(shared_stats);
+  fastocloud::StartupTiming startup;
+  if (startup_timing) {
+    startup = *static_cast<const fastocloud::StartupTiming*>(startup_timing);
+  }
+  startup.Mark(fastocloud::STARTUP_CORE_LOADED);  // if loader didn't mark it
   return start_stream(process_name, common::file_system::ascii_directory_string_path(feedback_dir),
-                      common::file_system::ascii_file_string_path(streamlink_path), logs_level, sargs, client, sha);
+                      common::file_system::ascii_file_string_path(streamlink_path), logs_level, sargs, client, stats,
+                      startup, sha);
+}
+
+int stream_preinit() {
+  fastocloud::stream::streams_init(0, nullptr);
+  for (const char* name : kPreloadPlugins) {
+    GstPlugin* plugin = gst_plugin_load_by_name(name);
+    if (!plugin) {
+      DEBUG_LOG() << "Plugin " << name << " not preloaded";
+      continue;
+    }
+    gst_object_unref(plugin);
+  }
+  return EXIT_SUCCESS;
 }
@@ -14,4 +14,13 @@
 
 #pragma once
 
-extern "C" int stream_exec(const char* process_name, const void* args, void* command_client);
+// shared_stats: fastocloud::SharedStreamStats mapped by service or nullptr
+// startup_timing: fastocloud::StartupTiming with phases marked before stream core was called or nullptr
+extern "C" int stream_exec(const char* process_name,
+                           const void* args,
+                           void* command_client,
+                           void* shared_stats,
+                           const void* startup_timing);
+
+// initializes stream backend and loads common plugins, called once by zygote before it forks streams
+extern "C" int stream_preinit();
@@ -20,6 +20,7 @@
 #include <common/sprintf.h>
 
 #include "base/constants.h"
+#include "base/gst_constants.h"
 
 #include "stream/elements/audio/audio.h"
 #if defined(MACHINE_LEARNING)
@@ -33,18 +34,60 @@
 #include "stream/elements/encoders/video.h"
 #include "stream/elements/parser/audio.h"
 #include "stream/elements/parser/video.h"
+#include "stream/elements/sink/http.h"
 #include "stream/elements/sink/screen.h"
 #include "stream/elements/video/video.h"
 
+#include "stream/ibase_stream.h"
 #include "stream/pad/pad.h"
 
+#include "utils/m3u8_writer.h"
+
 namespace fastocloud {
 namespace stream {
 namespace streams {
 namespace builders {
+namespace {
+// renditions share http root of output, playlist and chunks of each one are prefixed with its number
+std::string MakeRenditionPrefix(size_t rendition) {
+  return common::MemSPrintf("%lu_", rendition);
+}
+
+common::ErrnoError WriteMasterPlaylist(const common::file_system::ascii_directory_string_path& http_root,
+                                       const std::string& filename,
+                                       const renditions_t& renditions,
+                                       bit_rate_t audio_bitrate) {
+  const auto master_path = http_root.MakeFileStringPath(filename);
+  if (!master_path) {
+    return common::make_errno_error_inval();
+  }
+
+  utils::M3u8Writer writer;
+  common::ErrnoError err = writer.Open(
+      *master_path, common::file_system::File::FLAG_CREATE_ALWAYS | common::file_system::File::FLAG_WRITE);
+  if (err) {
+    return err;
+  }
+
+  err = writer.WriteMasterHeader();
+  for (size_t i = 0; i < renditions.size() && !err; ++i) {
+    const Rendition rendition = renditions[i];
+    const common::draw::Size size = rendition.GetSize();
+    // bitrates are in kbit/s, BANDWIDTH is bits per second of video and audio together
+    uint64_t bandwidth = *rendition.GetVideoBitrate();
+    if (audio_bitrate) {
+      bandwidth += *audio_bitrate;
+    }
+    err = writer.WriteVariant(bandwidth * 1000, size.width, size.height, MakeRenditionPrefix(i) + filename);
+  }
+
+  common::ErrnoError close_err = writer.Close();
+  return err ? err : close_err;
+}
+}  // namespace
 
 EncodingStreamBuilder::EncodingStreamBuilder(const EncodeConfig* api, SrcDecodeBinStream* observer)
-    : SrcDecodeStreamBuilder(api, observer) {}
+    : SrcDecodeStreamBuilder(api, observer), rendition_tees_() {}
 
 Connector EncodingStreamBuilder::BuildPostProc(Connector conn) {
   const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
@@ -98,7 +141,10 @@ SupportedAudioCodec EncodingStreamBuilder::GetAudioCodecType() const {
 
 Connector EncodingStreamBuilder::BuildConverter(Connector conn) {
   const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
-  if (config->HaveVideo()) {
+  const renditions_t renditions = config->GetRenditions();
+  if (config->HaveVideo() && !renditions.empty()) {
+    conn.video = BuildVideoRenditions(conn.video, renditions);
+  } else if (config->HaveVideo()) {
     elements_line_t video_encoder = BuildVideoConverter(0);
     if (!video_encoder.empty()) {
       ElementLink(conn.video, video_encoder.front());
@@ -147,8 +193,10 @@ elements_line_t EncodingStreamBuilder::BuildVideoPostProc(element_id_t video_id)
   elements::Element* first = nullptr;
   elements::Element* last = nullptr;
 
-  const common::draw::Size size = conf->GetSize();
-  const auto framerate = conf->GetFramerate();
+  // in adaptive mode every rendition is scaled on its own branch
+  const bool is_ladder = !conf->GetRenditions().empty();
+  const common::draw::Size size = is_ladder ? common::draw::Size() : conf->GetSize();
+  const frame_rate_t framerate = is_ladder ? frame_rate_t() : conf->GetFramerate();
   if (conf->IsGpu()) {
     if (conf->IsMfxGpu()) {
       elements::ElementMFXVpp* post = new elements::ElementMFXVpp(common::MemSPrintf(POST_PROC_NAME_1U, video_id));
@@ -311,6 +359,190 @@ elements_line_t EncodingStreamBuilder::BuildAudioConverter(element_id_t audio_id
   return {first, last};
 }
 
+elements::Element* EncodingStreamBuilder::BuildVideoRenditionScaler(const Rendition& rendition,
+                                                                     elements::Element* link_to,
+                                                                     element_id_t rendition_id) {
+  const EncodeConfig* conf = static_cast<const EncodeConfig*>(GetConfig());
+
+  const common::draw::Size size = rendition.GetSize();
+  const frame_rate_t framerate = rendition.GetFramerate() ? rendition.GetFramerate() : conf->GetFramerate();
+  if (conf->IsMfxGpu()) {
+    elements::ElementMFXVpp* post =
+        new elements::ElementMFXVpp(common::MemSPrintf(RENDITION_POST_PROC_NAME_1U, rendition_id));
+    post->SetForceAspectRatio(false);
+    post->SetWidth(size.width);
+    post->SetHeight(size.height);
+    if (framerate) {
+      post->SetFrameRate(*framerate);
+    }
+    ElementAdd(post);
+    ElementLink(link_to, post);
+    return post;
+  } else if (conf->IsGpu()) {
+    elements::ElementVaapiPostProc* post =
+        new elements::ElementVaapiPostProc(common::MemSPrintf(RENDITION_POST_PROC_NAME_1U, rendition_id));
+    post->SetDinterlaceMode(2);  // (2): disabled - shared post proc already did it
+    post->SetFormat(2);          // GST_VIDEO_FORMAT_I420
+    post->SetForceAspectRatio(false);
+    post->SetWidth(size.width);
+    post->SetHeight(size.height);
+    ElementAdd(post);
+    ElementLink(link_to, post);
+    if (framerate) {  // vaapipostproc can't change rate, gop alignment needs the same rate in all renditions
+      return elements::encoders::build_video_framerate(*framerate, this, post, rendition_id);
+    }
+    return post;
+  }
+
+  elements::Element* last = elements::encoders::build_video_scale(size.width, size.height, this, link_to, rendition_id);
+  if (framerate) {
+    last = elements::encoders::build_video_framerate(*framerate, this, last, rendition_id);
+  }
+  return last;
+}
+
+elements_line_t EncodingStreamBuilder::BuildVideoRenditionEncoder(const Rendition& rendition,
+                                                                  element_id_t rendition_id) {
+  const EncodeConfig* conf = static_cast<const EncodeConfig*>(GetConfig());
+
+  const std::string vcodec = conf->GetVideoEncoder();
+  video_encoders_args_t video_args = conf->GetVideoEncoderArgs();
+  video_encoders_str_args_t video_str_args = conf->GetVideoEncoderStrArgs();
+  // players switch renditions on segment borders, so keyframes have to be at the same time in all of them:
+  // one gop per segment and no scene cut keyframes, explicit encoder args win
+  const frame_rate_t framerate = rendition.GetFramerate() ? rendition.GetFramerate() : conf->GetFramerate();
+  const char* gop_property = elements::encoders::get_video_encoder_gop_property(vcodec);
+  if (gop_property && framerate) {
+    video_args.insert(std::make_pair(vcodec + "." + gop_property, *framerate * TS_DURATION));
+  }
+  if (vcodec == elements::encoders::ElementX264Enc::GetPluginName()) {
+    video_str_args.insert(std::make_pair(X264_ENC_OPTION_STRING, "scenecut=0"));
+  }
+
+  return elements::encoders::build_video_encoder(vcodec, rendition.GetVideoBitrate(), video_args, video_str_args, this,
+                                                 rendition_id);
+}
+
+elements::Element* EncodingStreamBuilder::BuildVideoRenditions(elements::Element* link_to,
+                                                               const renditions_t& renditions) {
+  const EncodeConfig* conf = static_cast<const EncodeConfig*>(GetConfig());
+
+  elements::ElementTee* decoded_tee = new elements::ElementTee(common::MemSPrintf(DECODED_VIDEO_TEE_NAME_1U, 0));
+  ElementAdd(decoded_tee);
+  ElementLink(link_to, decoded_tee);
+
+  const std::string vcodec = conf->GetVideoEncoder();
+  for (size_t i = 0; i < renditions.size(); ++i) {
+    elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(RENDITION_QUEUE_NAME_1U, i));
+    ElementAdd(queue);
+    ElementLink(decoded_tee, queue);
+
+    elements::Element* last = BuildVideoRenditionScaler(renditions[i], queue, i);
+    elements_line_t video_encoder = BuildVideoRenditionEncoder(renditions[i], i);
+    ElementLink(last, video_encoder.front());
+    last = video_encoder.back();
+
+    if (elements::encoders::IsH264Encoder(vcodec)) {
+      elements::parser::ElementH264Parse* premux_parser = elements::parser::make_h264_parser(i);
+      ElementAdd(premux_parser);
+      ElementLink(last, premux_parser);
+      last = premux_parser;
+    }
+
+    elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(VIDEO_TEE_NAME_1U, i));
+    ElementAdd(tee);
+    ElementLink(last, tee);
+    rendition_tees_.push_back(tee);
+  }
+
+  return rendition_tees_.front();
+}
+
+Connector EncodingStreamBuilder::BuildOutput(Connector conn) {
+  if (rendition_tees_.size() < 2) {
+    return SrcDecodeStreamBuilder::BuildOutput(conn);
+  }
+
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const renditions_t renditions = config->GetRenditions();
+  output_t out = config->GetOutput();
+  std::vector<element_id_t> http_outputs;
+  std::vector<element_id_t> other_outputs;
+  for (size_t i = 0; i < out.size(); ++i) {
+    const OutputUri output = out[i];
+    common::uri::Url uri = output.GetOutput();
+    SinkDeviceType dt;
+    if (IsDeviceOutUrl(uri, &dt)) {  // monitor
+      CRITICAL_LOG() << "Decklink not supported for encoding based streams!";
+      continue;
+    }
+
+    if (uri.GetScheme() != common::uri::Url::http) {  // not adaptive protocols get the first rendition
+      other_outputs.push_back(i);
+      continue;
+    }
+
+    if (uri.GetPath().GetFileName().empty()) {
+      CRITICAL_LOG() << "Empty playlist name, please create urls like http://localhost/master.m3u8";
+      continue;
+    }
+    http_outputs.push_back(i);
+  }
+
+  BuildGroupedOutputs({rendition_tees_.front(), conn.audio}, other_outputs);
+  if (http_outputs.empty()) {
+    return conn;
+  }
+
+  const common::uri::Url http_uri = out[http_outputs.front()].GetOutput();
+  for (size_t r = 0; r < rendition_tees_.size(); ++r) {
+    // first rendition keeps element names of single rendition pipeline
+    std::vector<element_id_t> sink_ids;
+    for (element_id_t i : http_outputs) {
+      sink_ids.push_back(r * out.size() + i);
+    }
+
+    elements_line_t links = BuildSharedMuxer({rendition_tees_[r], conn.audio}, http_uri, sink_ids.front(), sink_ids);
+    for (size_t j = 0; j < http_outputs.size(); ++j) {
+      elements::Element* sink = BuildRenditionOutput(out[http_outputs[j]], r, http_outputs[j], sink_ids[j]);
+      ElementAdd(sink);
+      ElementLink(links[j], sink);
+    }
+  }
+
+  for (element_id_t i : http_outputs) {
+    const OutputUri output = out[i];
+    const std::string filename = output.GetOutput().GetPath().GetFileName();
+    common::ErrnoError err = WriteMasterPlaylist(output.GetHttpRoot(), filename, renditions, config->GetAudioBitrate());
+    if (err) {
+      WARNING_LOG() << "Can't write master playlist: " << err->GetDescription();
+    }
+  }
+  return conn;
+}
+
+elements::Element* EncodingStreamBuilder::BuildRenditionOutput(const OutputUri& output,
+                                                               size_t rendition,
+                                                               element_id_t output_id,
+                                                               element_id_t sink_id) {
+  IBaseStream* stream = static_cast<IBaseStream*>(GetObserver());
+  common::uri::Url uri = output.GetOutput();
+  const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
+  const std::string filename = uri.GetPath().GetFileName();
+  const std::string prefix = MakeRenditionPrefix(rendition);
+  elements::sink::HlsOutput hout = stream->IsVod()
+                                       ? elements::sink::MakeVodHlsOutput(uri, http_root, filename, prefix)
+                                       : elements::sink::MakeHlsOutput(uri, http_root, filename, prefix);
+  elements::Element* sink = elements::sink::make_http_sink(sink_id, hout);
+  pad::Pad* sink_pad = sink->StaticPad("sink");
+  if (sink_pad->IsValid()) {
+    // all renditions are accounted in statistics of the configured output
+    HandleOutputSinkPadCreated(sink_pad, output_id, uri, output.GetHlsType() == OutputUri::HLS_PUSH);
+  }
+  delete sink_pad;
+  return sink;
+}
+
 #if defined(MACHINE_LEARNING)
 void EncodingStreamBuilder::HandleMLElementCreated(elements::machine_learning::ElementVideoMLFilter* machine) {
   EncodingStream* stream = static_cast<EncodingStream*>(GetObserver());
@@ -37,6 +37,7 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
   EncodingStreamBuilder(const EncodeConfig* api, SrcDecodeBinStream* observer);
   Connector BuildPostProc(Connector conn) override;
   Connector BuildConverter(Connector conn) override;
+  Connector BuildOutput(Connector conn) override;
 
   SupportedVideoCodec GetVideoCodecType() const override;
   SupportedAudioCodec GetAudioCodecType() const override;
@@ -48,9 +49,24 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
   virtual elements_line_t BuildVideoConverter(element_id_t video_id);
   virtual elements_line_t BuildAudioConverter(element_id_t audio_id);
 
+  // adaptive ladder, decoded video is shared, each rendition is scaled and encoded on its own branch
+  virtual elements::Element* BuildVideoRenditionScaler(const Rendition& rendition,
+                                                       elements::Element* link_to,
+                                                       element_id_t rendition_id);
+  virtual elements_line_t BuildVideoRenditionEncoder(const Rendition& rendition, element_id_t rendition_id);
+
 #if defined(MACHINE_LEARNING)
   void HandleMLElementCreated(fastocloud::stream::elements::machine_learning::ElementVideoMLFilter* machine);
 #endif
+
+ private:
+  elements::Element* BuildVideoRenditions(elements::Element* link_to, const renditions_t& renditions);
+  elements::Element* BuildRenditionOutput(const OutputUri& output,
+                                          size_t rendition,
+                                          element_id_t output_id,
+                                          element_id_t sink_id);
+
+  elements_line_t rendition_tees_;
 };
 
 }  // namespace builders
@@ -0,0 +1,106 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/builders/encoding/redundant_encoding_stream_builder.h"
+
+#include <common/sprintf.h>
+
+#include "stream/elements/sources/build_input.h"
+#include "stream/ibase_stream.h"
+#include "stream/pad/pad.h"
+#include "stream/streams/encoding/redundant_encoding_stream.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+namespace builders {
+
+RedundantEncodingStreamBuilder::RedundantEncodingStreamBuilder(const EncodeConfig* api,
+                                                               RedundantEncodingStream* observer)
+    : EncodingStreamBuilder(api, observer), input_id_() {}
+
+RedundantEncodingStreamBuilder::RedundantEncodingStreamBuilder(const EncodeConfig* api,
+                                                               RedundantEncodingStream* observer,
+                                                               element_id_t input_id)
+    : EncodingStreamBuilder(api, observer), input_id_(input_id) {}
+
+Connector RedundantEncodingStreamBuilder::BuildInput() {
+  if (input_id_) {
+    BuildInputBranch(*input_id_);
+    return {nullptr, nullptr};
+  }
+
+  const Config* config = GetConfig();
+  for (size_t i = 0; i < config->GetInput().size(); ++i) {
+    BuildInputBranch(i);
+  }
+  return {nullptr, nullptr};
+}
+
+void RedundantEncodingStreamBuilder::BuildInputBranch(element_id_t id) {
+  const Config* config = GetConfig();
+  const InputUri uri = config->GetInput()[id];
+  const common::uri::Url url = uri.GetInput();
+  elements::Element* src = elements::sources::make_src(uri, id, IBaseStream::src_timeout_sec);
+  pad::Pad* src_pad = src->StaticPad("src");
+  if (src_pad->IsValid()) {
+    HandleInputSrcPadCreated(src_pad, id, url);
+  }
+  delete src_pad;
+  ElementAdd(src);
+
+  elements::ElementDecodebin* decodebin = new elements::ElementDecodebin(common::MemSPrintf(DECODEBIN_NAME_1U, id));
+  ElementAdd(decodebin);
+  ElementLink(src, decodebin);
+  HandleDecodebinCreated(decodebin);
+}
+
+Connector RedundantEncodingStreamBuilder::BuildUdbConnections(Connector conn) {
+  CHECK(conn.video == nullptr) << "Must be video empty channel.";
+  CHECK(conn.audio == nullptr) << "Must be audio empty channel.";
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const size_t inputs_count = config->GetInput().size();
+  if (config->HaveVideo()) {
+    elements::ElementInputSelector* selector =
+        new elements::ElementInputSelector(common::MemSPrintf(VIDEO_SELECTOR_NAME_1U, 0));
+    // inactive inputs are dropped instead of blocked, so switching never waits for a stalled one
+    selector->SetSyncStreams(false);
+    ElementAdd(selector);
+    // request pads are created in link order, input i lands on sink_i
+    for (size_t i = 0; i < inputs_count; ++i) {
+      elements::ElementQueue* video_queue = new elements::ElementQueue(common::MemSPrintf(UDB_VIDEO_NAME_1U, i));
+      ElementAdd(video_queue);
+      ElementLink(video_queue, selector);
+    }
+    conn.video = selector;
+  }
+  if (config->HaveAudio()) {
+    elements::ElementInputSelector* selector =
+        new elements::ElementInputSelector(common::MemSPrintf(AUDIO_SELECTOR_NAME_1U, 0));
+    selector->SetSyncStreams(false);
+    ElementAdd(selector);
+    for (size_t i = 0; i < inputs_count; ++i) {
+      elements::ElementQueue* audio_queue = new elements::ElementQueue(common::MemSPrintf(UDB_AUDIO_NAME_1U, i));
+      ElementAdd(audio_queue);
+      ElementLink(audio_queue, selector);
+    }
+    conn.audio = selector;
+  }
+  return conn;
+}
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,46 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "stream/streams/builders/encoding/encoding_stream_builder.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+class RedundantEncodingStream;
+namespace builders {
+
+// every input gets own source, decodebin and udb queues, decoded streams meet in input selectors
+class RedundantEncodingStreamBuilder : public EncodingStreamBuilder {
+ public:
+  typedef common::Optional<element_id_t> input_id_t;  // not set if all inputs are built
+
+  RedundantEncodingStreamBuilder(const EncodeConfig* api, RedundantEncodingStream* observer);
+  // CreateInput builds source and decodebin of this input only, other inputs keep running
+  RedundantEncodingStreamBuilder(const EncodeConfig* api, RedundantEncodingStream* observer, element_id_t input_id);
+
+  Connector BuildInput() override;
+  Connector BuildUdbConnections(Connector conn) override;
+
+ private:
+  void BuildInputBranch(element_id_t id);
+
+  const input_id_t input_id_;
+};
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,54 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/builders/encoding/vod_encoding_stream_builder.h"
+
+#include <algorithm>
+#include <string>
+
+#include "stream/elements/sink/http.h"
+#include "stream/streams/vod/vod_encoding_stream.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+namespace builders {
+
+VodEncodingStreamBuilder::VodEncodingStreamBuilder(const VodEncodeConfig* api, VodEncodeStream* observer)
+    : EncodingStreamBuilder(api, observer) {}
+
+elements::Element* VodEncodingStreamBuilder::CreateSink(const OutputUri& output, element_id_t sink_id) {
+  const VodEncodeConfig* config = static_cast<const VodEncodeConfig*>(GetConfig());
+  const VodEncodeConfig::vod_range_t range = config->GetRange();
+  common::uri::Url uri = output.GetOutput();
+  if (!range || uri.GetScheme() != common::uri::Url::http) {
+    return EncodingStreamBuilder::CreateSink(output, sink_id);
+  }
+
+  const std::string filename = uri.GetPath().GetFileName();
+  elements::sink::HlsOutput hout =
+      elements::sink::MakeVodHlsOutput(uri, output.GetHttpRoot(), filename, MakeVodRangePrefix(range->index));
+  elements::sink::ElementHLSSink* sink = elements::sink::make_http_sink(sink_id, hout);
+  if (config->GetJit() && range->stop_msec != VodRange::open_stop) {
+    // whole jit segment goes into one chunk, so service only renames it
+    const int64_t duration_sec = (range->stop_msec - range->start_msec) / 1000 + 1;
+    sink->SetTargetDuration(static_cast<guint>(std::max<int64_t>(duration_sec, TS_DURATION)));
+  }
+  return sink;
+}
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -30,6 +30,11 @@ bool GstBaseBuilder::InitPipeline() {
   return true;
 }
 
+bool GstBaseBuilder::InitInput() {
+  BuildInput();
+  return true;
+}
+
 }  // namespace builders
 }  // namespace streams
 }  // namespace stream
@@ -38,6 +38,7 @@ class GstBaseBuilder : public IBaseBuilder {
 
  protected:
   bool InitPipeline() override final;
+  bool InitInput() override final;
 };
 
 }  // namespace builders
@@ -14,6 +14,10 @@
 
 #include "stream/streams/builders/src_decodebin_stream_builder.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include <common/sprintf.h>
 
 #include "stream/ibase_stream.h"
@@ -26,6 +30,7 @@
 
 #include "stream/streams/configs/audio_video_config.h"
 
+#include "stream/elements/audio/audio.h"
 #include "stream/elements/muxer/muxer.h"
 #include "stream/elements/pay/audio.h"
 #include "stream/elements/pay/video.h"
@@ -58,6 +63,33 @@ elements::Element* make_audio_pay(SupportedAudioCodec acodec, element_id_t pay_i
   NOTREACHED() << "Please add rtp pay for audio codec type: " << acodec;
   return nullptr;
 }
+
+// eos comes here only after decoded streams ended, unlike eos on source pad which pulled inputs (hls playlist
+// download) send while demuxer still plays
+GstPadProbeReturn inter_sink_eos_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  UNUSED(pad);
+  GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+  if (GST_EVENT_TYPE(event) != GST_EVENT_EOS) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  IBaseStream* stream = static_cast<IBaseStream*>(user_data);
+  stream->RestartInput();
+  return GST_PAD_PROBE_DROP;  // outputs never see input eos, new input is built instead
+}
+
+void watch_input_eos(elements::Element* inter_sink, IBaseStream* stream) {
+  if (!stream) {
+    return;
+  }
+
+  pad::Pad* sink_pad = inter_sink->StaticPad("sink");
+  if (sink_pad->IsValid()) {
+    gst_pad_add_probe(sink_pad->GetGstPad(), GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, inter_sink_eos_probe, stream,
+                      nullptr);
+  }
+  delete sink_pad;
+}
 }  // namespace
 namespace streams {
 namespace builders {
@@ -111,24 +143,67 @@ Connector SrcDecodeStreamBuilder::BuildUdbConnections(Connector conn) {
   CHECK(conn.video == nullptr) << "Must be video empty channel.";
   CHECK(conn.audio == nullptr) << "Must be audio empty channel.";
   const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  SrcDecodeBinStream* stream = static_cast<SrcDecodeBinStream*>(GetObserver());
+  const bool restartable_input = stream && stream->IsInputRestartable();
   if (config->HaveVideo()) {
     elements::Element* vudb = BuildVideoUdbConnection();
     CHECK(vudb);
     ElementAdd(vudb);
-    conn.video = vudb;
+    conn.video = restartable_input ? BuildVideoInterConnection(vudb) : vudb;
   }
   if (config->HaveAudio()) {
     elements::Element* audb = BuildAudioUdbConnection();
     CHECK(audb);
     ElementAdd(audb);
-    conn.audio = audb;
+    conn.audio = restartable_input ? BuildAudioInterConnection(audb) : audb;
   }
   return conn;
 }
 
+elements::Element* SrcDecodeStreamBuilder::BuildVideoInterConnection(elements::Element* udb) {
+  const std::string channel = udb->GetName();
+  elements::ElementInterVideoSink* sink =
+      new elements::ElementInterVideoSink(common::MemSPrintf(INTER_VIDEO_SINK_NAME_1U, 0));
+  sink->SetChannel(channel);
+  ElementAdd(sink);
+  ElementLink(udb, sink);
+  watch_input_eos(sink, static_cast<SrcDecodeBinStream*>(GetObserver()));
+
+  // repeats last frame for a second, then black until new input is linked
+  elements::ElementInterVideoSrc* src =
+      new elements::ElementInterVideoSrc(common::MemSPrintf(INTER_VIDEO_SRC_NAME_1U, 0));
+  src->SetChannel(channel);
+  ElementAdd(src);
+  return src;
+}
+
+elements::Element* SrcDecodeStreamBuilder::BuildAudioInterConnection(elements::Element* udb) {
+  const std::string channel = udb->GetName();
+  // decoders may output planar audio, inter sink takes only interleaved
+  elements::audio::ElementAudioConvert* convert =
+      new elements::audio::ElementAudioConvert(common::MemSPrintf(INTER_AUDIO_CONVERT_NAME_1U, 0));
+  ElementAdd(convert);
+  ElementLink(udb, convert);
+
+  elements::ElementInterAudioSink* sink =
+      new elements::ElementInterAudioSink(common::MemSPrintf(INTER_AUDIO_SINK_NAME_1U, 0));
+  sink->SetChannel(channel);
+  ElementAdd(sink);
+  ElementLink(convert, sink);
+  watch_input_eos(sink, static_cast<SrcDecodeBinStream*>(GetObserver()));
+
+  // silence until new input is linked
+  elements::ElementInterAudioSrc* src =
+      new elements::ElementInterAudioSrc(common::MemSPrintf(INTER_AUDIO_SRC_NAME_1U, 0));
+  src->SetChannel(channel);
+  ElementAdd(src);
+  return src;
+}
+
 Connector SrcDecodeStreamBuilder::BuildOutput(Connector conn) {
   const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
   output_t out = config->GetOutput();
+  std::vector<element_id_t> outputs;
   for (size_t i = 0; i < out.size(); ++i) {
     const OutputUri output = out[i];
     SinkDeviceType dt;
@@ -137,51 +212,103 @@ Connector SrcDecodeStreamBuilder::BuildOutput(Connector conn) {
       continue;
     }
 
-    common::uri::Url uri = output.GetOutput();
-    common::uri::Url::scheme scheme = uri.GetScheme();
-    bool is_rtp_out = scheme == common::uri::Url::udp;
-    elements::Element* mux = elements::muxer::make_muxer(scheme, i);
-    ElementAdd(mux);
-
-    if (config->HaveVideo()) {
-      elements::ElementQueue* video_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(video_tee_queue);
-      elements::Element* next = video_tee_queue;
-      ElementLink(conn.video, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
+    outputs.push_back(i);
+  }
+
+  BuildGroupedOutputs(conn, outputs);
+  return conn;
+}
+
+void SrcDecodeStreamBuilder::BuildGroupedOutputs(Connector conn, const std::vector<element_id_t>& outputs) {
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  output_t out = config->GetOutput();
+  std::map<elements::muxer::Packaging, std::vector<element_id_t>> groups;
+  for (element_id_t i : outputs) {
+    elements::muxer::Packaging packaging;
+    if (!elements::muxer::GetPackaging(out[i].GetOutput().GetScheme(), &packaging)) {
+      CRITICAL_LOG() << "Unknown output url: " << out[i].GetOutput().GetUrl();
+      continue;
     }
+    groups[packaging].push_back(i);
+  }
 
-    if (config->HaveAudio()) {
-      elements::ElementQueue* audio_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(audio_tee_queue);
-      elements::Element* next = audio_tee_queue;
-      ElementLink(conn.audio, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
+  for (const auto& group : groups) {
+    const std::vector<element_id_t>& ids = group.second;
+    const element_id_t first = ids.front();
+    elements_line_t links = BuildSharedMuxer(conn, out[first].GetOutput(), first, ids);
+    for (size_t j = 0; j < ids.size(); ++j) {
+      elements::Element* sink = BuildGenericOutput(out[ids[j]], ids[j]);
+      ElementAdd(sink);
+      ElementLink(links[j], sink);
     }
+  }
+}
 
-    elements::Element* sink = BuildGenericOutput(output, i);
-    ElementAdd(sink);
-    ElementLink(mux, sink);
+elements_line_t SrcDecodeStreamBuilder::BuildSharedMuxer(Connector conn,
+                                                         const common::uri::Url& uri,
+                                                         element_id_t mux_id,
+                                                         const std::vector<element_id_t>& sink_ids) {
+  elements::Element* mux = BuildMuxer(conn, uri, mux_id);
+  if (sink_ids.size() == 1) {
+    return {mux};
   }
-  return conn;
+
+  elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(MUXER_TEE_NAME_1U, mux_id));
+  ElementAdd(tee);
+  ElementLink(mux, tee);
+  elements_line_t links;
+  for (element_id_t sink_id : sink_ids) {
+    elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(MUXER_TEE_QUEUE_NAME_1U, sink_id));
+    ElementAdd(queue);
+    ElementLink(tee, queue);
+    links.push_back(queue);
+  }
+  return links;
+}
+
+elements::Element* SrcDecodeStreamBuilder::BuildMuxer(Connector conn,
+                                                      const common::uri::Url& uri,
+                                                      element_id_t mux_id) {
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  common::uri::Url::scheme scheme = uri.GetScheme();
+  bool is_rtp_out = scheme == common::uri::Url::udp;
+  elements::Element* mux = elements::muxer::make_muxer(scheme, mux_id);
+  ElementAdd(mux);
+
+  if (config->HaveVideo()) {
+    elements::ElementQueue* video_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, mux_id));
+    ElementAdd(video_tee_queue);
+    elements::Element* next = video_tee_queue;
+    ElementLink(conn.video, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), mux_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+
+  if (config->HaveAudio()) {
+    elements::ElementQueue* audio_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, mux_id));
+    ElementAdd(audio_tee_queue);
+    elements::Element* next = audio_tee_queue;
+    ElementLink(conn.audio, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), mux_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+  return mux;
 }
 
 }  // namespace builders
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "stream/streams/builders/gst_base_builder.h"
 
 namespace fastocloud {
@@ -45,7 +47,22 @@ class SrcDecodeStreamBuilder : public GstBaseBuilder {
   virtual SupportedAudioCodec GetAudioCodecType() const = 0;
 
  protected:
+  // outputs which need identical packaging share one muxer, its stream is teed into every sink
+  void BuildGroupedOutputs(Connector conn, const std::vector<element_id_t>& outputs);
+  // returns element to link each of sink_ids to: the muxer itself for a single sink, tee queues otherwise
+  elements_line_t BuildSharedMuxer(Connector conn,
+                                   const common::uri::Url& uri,
+                                   element_id_t mux_id,
+                                   const std::vector<element_id_t>& sink_ids);
+  // muxer fed from conn tees, sink is linked by caller
+  elements::Element* BuildMuxer(Connector conn, const common::uri::Url& uri, element_id_t mux_id);
+
   void HandleDecodebinCreated(elements::ElementDecodebin* decodebin);
+
+ private:
+  // decoded data crosses inter elements, so input can be rebuilt while everything behind keeps running
+  elements::Element* BuildVideoInterConnection(elements::Element* udb);
+  elements::Element* BuildAudioInterConnection(elements::Element* udb);
 };
 
 }  // namespace builders
@@ -42,6 +42,7 @@ EncodeConfig::EncodeConfig(const base_class& config)
       video_bit_rate_(),
       audio_bit_rate_(),
       logo_(),
+      renditions_(),
 #if defined(MACHINE_LEARNING)
       learning_(),
       learning_overlay_(),
@@ -49,7 +50,9 @@ EncodeConfig::EncodeConfig(const base_class& config)
       decklink_video_mode_(DEFAULT_DECKLINK_VIDEO_MODE),
       aspect_ratio_(),
       relay_video_(false),
-      relay_audio_(false) {
+      relay_audio_(false),
+      hot_swap_(false),
+      input_redundancy_(false) {
 }
 
 bool EncodeConfig::GetRelayVideo() const {
@@ -68,6 +71,22 @@ void EncodeConfig::SetRelayAudio(bool ra) {
   relay_audio_ = ra;
 }
 
+bool EncodeConfig::GetHotSwap() const {
+  return hot_swap_;
+}
+
+void EncodeConfig::SetHotSwap(bool swap) {
+  hot_swap_ = swap;
+}
+
+bool EncodeConfig::GetInputRedundancy() const {
+  return input_redundancy_;
+}
+
+void EncodeConfig::SetInputRedundancy(bool redundancy) {
+  input_redundancy_ = redundancy;
+}
+
 void EncodeConfig::SetVolume(volume_t volume) {
   volume_ = volume;
 }
@@ -184,6 +203,14 @@ EncodeConfig::logo_t EncodeConfig::GetLogo() const {
   return logo_;
 }
 
+renditions_t EncodeConfig::GetRenditions() const {
+  return renditions_;
+}
+
+void EncodeConfig::SetRenditions(const renditions_t& renditions) {
+  renditions_ = renditions;
+}
+
 #if defined(MACHINE_LEARNING)
 EncodeConfig::deep_learning_t EncodeConfig::GetDeepLearning() const {
   return learning_;
@@ -222,7 +249,8 @@ EncodeConfig* EncodeConfig::Clone() const {
   return new EncodeConfig(*this);
 }
 
-VodEncodeConfig::VodEncodeConfig(const base_class& config) : base_class(config), cleanup_ts_(false) {}
+VodEncodeConfig::VodEncodeConfig(const base_class& config)
+    : base_class(config), cleanup_ts_(false), workers_(1), range_(), jit_(false) {}
 
 bool VodEncodeConfig::GetCleanupTS() const {
   return cleanup_ts_;
@@ -232,6 +260,30 @@ void VodEncodeConfig::SetCleanupTS(bool cleanup) {
   cleanup_ts_ = cleanup;
 }
 
+size_t VodEncodeConfig::GetWorkers() const {
+  return workers_;
+}
+
+void VodEncodeConfig::SetWorkers(size_t workers) {
+  workers_ = workers;
+}
+
+VodEncodeConfig::vod_range_t VodEncodeConfig::GetRange() const {
+  return range_;
+}
+
+void VodEncodeConfig::SetRange(const vod_range_t& range) {
+  range_ = range;
+}
+
+bool VodEncodeConfig::GetJit() const {
+  return jit_;
+}
+
+void VodEncodeConfig::SetJit(bool jit) {
+  jit_ = jit;
+}
+
 VodEncodeConfig* VodEncodeConfig::Clone() const {
   return new VodEncodeConfig(*this);
 }
@@ -22,6 +22,8 @@
 #include "base/machine_learning/deep_learning_overlay.h"
 #endif
 #include "base/logo.h"
+#include "base/rendition.h"
+#include "base/vod_range.h"
 
 #include "stream/streams/configs/audio_video_config.h"
 
@@ -48,6 +50,12 @@ class EncodeConfig : public AudioVideoConfig {
   bool GetRelayAudio() const;
   void SetRelayAudio(bool ra);
 
+  bool GetHotSwap() const;  // encoding, input is rebuilt without restarting encoders and outputs
+  void SetHotSwap(bool swap);
+
+  bool GetInputRedundancy() const;  // encoding, all inputs are ingested, output follows the healthiest one
+  void SetInputRedundancy(bool redundancy);
+
   volume_t GetVolume() const;  // encoding
   void SetVolume(volume_t volume);
 
@@ -87,6 +95,9 @@ class EncodeConfig : public AudioVideoConfig {
   logo_t GetLogo() const;  // encoding
   void SetLogo(const logo_t& logo);
 
+  renditions_t GetRenditions() const;  // encoding, adaptive ladder instead of size/video bitrate
+  void SetRenditions(const renditions_t& renditions);
+
 #if defined(MACHINE_LEARNING)
   deep_learning_t GetDeepLearning() const;  // encoding
   void SetDeepLearning(const deep_learning_t& learning);
@@ -122,6 +133,7 @@ class EncodeConfig : public AudioVideoConfig {
   bit_rate_t audio_bit_rate_;
 
   logo_t logo_;
+  renditions_t renditions_;
 #if defined(MACHINE_LEARNING)
   deep_learning_t learning_;
   deep_learning_overlay_t learning_overlay_;
@@ -132,20 +144,35 @@ class EncodeConfig : public AudioVideoConfig {
 
   bool relay_video_;
   bool relay_audio_;
+  bool hot_swap_;
+  bool input_redundancy_;
 };
 
 class VodEncodeConfig : public EncodeConfig {
  public:
   typedef EncodeConfig base_class;
+  typedef common::Optional<VodRange> vod_range_t;
   explicit VodEncodeConfig(const base_class& config);
 
   bool GetCleanupTS() const;
   void SetCleanupTS(bool cleanup);
 
+  size_t GetWorkers() const;  // more than one splits vod into keyframe ranges encoded in parallel
+  void SetWorkers(size_t workers);
+
+  vod_range_t GetRange() const;  // only this range of input is encoded, set for workers of splitted vod
+  void SetRange(const vod_range_t& range);
+
+  bool GetJit() const;  // vod is only indexed, segments are encoded by service on request
+  void SetJit(bool jit);
+
   VodEncodeConfig* Clone() const override;
 
  private:
   bool cleanup_ts_;
+  size_t workers_;
+  vod_range_t range_;
+  bool jit_;
 };
 
 typedef EncodeConfig CodEncodeConfig;
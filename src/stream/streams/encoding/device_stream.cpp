@@ -28,6 +28,10 @@ const char* DeviceStream::ClassName() const {
   return "DeviceStream";
 }
 
+bool DeviceStream::IsInputRestartable() const {
+  return false;
+}
+
 IBaseBuilder* DeviceStream::CreateBuilder() {
   const EncodeConfig* econf = static_cast<const EncodeConfig*>(GetConfig());
   return new builders::encoding::DeviceStreamBuilder(econf, this);
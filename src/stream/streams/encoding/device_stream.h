@@ -25,6 +25,7 @@ class DeviceStream : public EncodingStream {
  public:
   DeviceStream(const EncodeConfig* config, IStreamClient* client, StreamStruct* stats);
   const char* ClassName() const override;
+  bool IsInputRestartable() const override;  // own input, never swapped
 
  protected:
   IBaseBuilder* CreateBuilder() override;
@@ -48,6 +48,11 @@ const char* EncodingStream::ClassName() const {
   return GetType() == ENCODE ? "EncodingStream" : "CodEncodeStream";
 }
 
+bool EncodingStream::IsInputRestartable() const {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  return config->GetHotSwap() && !IsVod();
+}
+
 void EncodingStream::HandleBufferingMessage(GstMessage* message) {
   if (IsLive()) {
     return;
@@ -208,6 +213,10 @@ void EncodingStream::HandleDecodeBinPadAdded(GstElement* src, GstPad* new_pad) {
   }
 
   if (!gst_pad_is_linked(sink_pad->GetGstPad())) {
+    const GstClockTimeDiff offset = GetInputOffset();
+    if (offset) {
+      gst_pad_set_offset(new_pad, offset);
+    }
     GstPadLinkReturn ret = gst_pad_link(new_pad, sink_pad->GetGstPad());
     if (GST_PAD_LINK_FAILED(ret)) {
       WARNING_LOG() << "Failed to link: " << GST_ELEMENT_NAME(src) << " " << GST_PAD_NAME(new_pad) << " "
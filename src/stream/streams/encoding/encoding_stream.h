@@ -41,6 +41,8 @@ class EncodingStream : public SrcDecodeBinStream {
 
   const char* ClassName() const override;
 
+  bool IsInputRestartable() const override;
+
  protected:
   IBaseBuilder* CreateBuilder() override;
 
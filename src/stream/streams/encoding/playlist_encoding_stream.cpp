@@ -42,6 +42,14 @@ const char* PlaylistEncodingStream::ClassName() const {
   return "PlaylistEncodingStream";
 }
 
+bool PlaylistEncodingStream::IsInputRestartable() const {
+  return false;
+}
+
+bool PlaylistEncodingStream::IsStallDetectable() const {
+  return false;
+}
+
 void PlaylistEncodingStream::OnAppSrcCreatedCreated(elements::sources::ElementAppSrc* src) {
   app_src_ = src;
   gboolean res = src->RegisterNeedDataCallback(PlaylistEncodingStream::need_data_callback, this);
@@ -39,9 +39,11 @@ class PlaylistEncodingStream : public EncodingStream {
   ~PlaylistEncodingStream() override;
 
   const char* ClassName() const override;
+  bool IsInputRestartable() const override;  // own input, never swapped
 
  protected:
   void PreLoop() override;
+  bool IsStallDetectable() const override;  // files are fed on demand
 
   virtual void OnAppSrcCreatedCreated(elements::sources::ElementAppSrc* src);
   IBaseBuilder* CreateBuilder() override;
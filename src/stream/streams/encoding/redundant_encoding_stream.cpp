@@ -0,0 +1,334 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/encoding/redundant_encoding_stream.h"
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#include "stream/gstreamer_utils.h"
+#include "stream/pad/pad.h"
+#include "stream/probes.h"
+#include "stream/streams/builders/encoding/redundant_encoding_stream_builder.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+
+RedundantEncodingStream::InputHealth::InputHealth()
+    : window_bytes(0),
+      window_start(0),
+      average_rate(0),
+      low_rate(false),
+      healthy_since(0),
+      stalled_since(0),
+      rebuild_time(0),
+      started(false),
+      failed(false) {}
+
+RedundantEncodingStream::RedundantEncodingStream(const EncodeConfig* config,
+                                                 IStreamClient* client,
+                                                 StreamStruct* stats)
+    : base_class(config, client, stats),
+      inputs_health_(),
+      active_input_(0),
+      loop_start_(0),
+      health_check_timer_id_(0) {}
+
+const char* RedundantEncodingStream::ClassName() const {
+  return "RedundantEncodingStream";
+}
+
+bool RedundantEncodingStream::IsInputRestartable() const {
+  return false;
+}
+
+element_id_t RedundantEncodingStream::GetActiveInput() const {
+  return active_input_;
+}
+
+IBaseBuilder* RedundantEncodingStream::CreateBuilder() {
+  const EncodeConfig* econf = static_cast<const EncodeConfig*>(GetConfig());
+  return new builders::RedundantEncodingStreamBuilder(econf, this);
+}
+
+void RedundantEncodingStream::PreLoop() {
+  base_class::PreLoop();
+
+  const Config* conf = GetConfig();
+  inputs_health_ = std::vector<InputHealth>(conf->GetInput().size());
+  active_input_ = 0;
+  loop_start_ = g_get_monotonic_time();
+  health_check_timer_id_ = g_timeout_add(health_check_msecs, health_check_callback, this);
+}
+
+void RedundantEncodingStream::PostLoop(ExitStatus status) {
+  if (health_check_timer_id_) {
+    bool res = g_source_remove(health_check_timer_id_);
+    DCHECK(res);
+    health_check_timer_id_ = 0;
+  }
+  base_class::PostLoop(status);
+}
+
+void RedundantEncodingStream::HandleDecodeBinPadAdded(GstElement* src, GstPad* new_pad) {
+  const gchar* new_pad_type = pad_get_type(new_pad);
+  if (!new_pad_type) {
+    NOTREACHED();
+    return;
+  }
+
+  element_id_t elem_id;
+  if (!GetElementId(GST_ELEMENT_NAME(src), &elem_id)) {
+    return;
+  }
+
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  INFO_LOG() << "Pad added: " << new_pad_type << ", input: " << elem_id;
+  elements::Element* dest = nullptr;
+  bool is_video = strncmp(new_pad_type, "video", 5) == 0;
+  bool is_audio = strncmp(new_pad_type, "audio", 5) == 0;
+  if (is_video) {
+    if (config->HaveVideo()) {
+      dest = GetElementByName(common::MemSPrintf(UDB_VIDEO_NAME_1U, elem_id));
+    }
+  } else if (is_audio) {
+    if (config->HaveAudio()) {
+      const char* gst_pad_name = GST_PAD_NAME(new_pad);
+      const auto audio_select = config->GetAudioSelect();
+      int current_audio_track = 0;
+      if (!audio_select || (GetPadId(gst_pad_name, &current_audio_track) && *audio_select == current_audio_track)) {
+        dest = GetElementByName(common::MemSPrintf(UDB_AUDIO_NAME_1U, elem_id));
+      }
+    }
+  } else {
+    // something else
+  }
+
+  if (!dest) {
+    return;
+  }
+
+  // every input has own udb queues, first pad of each kind wins, inited flags are not used
+  pad::Pad* sink_pad = dest->StaticPad("sink");
+  if (!sink_pad->IsValid()) {
+    delete sink_pad;
+    return;
+  }
+
+  if (!gst_pad_is_linked(sink_pad->GetGstPad())) {
+    GstPadLinkReturn ret = gst_pad_link(new_pad, sink_pad->GetGstPad());
+    if (GST_PAD_LINK_FAILED(ret)) {
+      WARNING_LOG() << "Failed to link: " << GST_ELEMENT_NAME(src) << " " << GST_PAD_NAME(new_pad) << " "
+                    << new_pad_type;
+    } else {
+      DEBUG_LOG() << "Pad emitted: " << GST_ELEMENT_NAME(src) << " " << GST_PAD_NAME(new_pad) << " " << new_pad_type;
+    }
+  } else {
+    DEBUG_LOG() << "pad-emitter: pad is linked";
+  }
+  delete sink_pad;
+}
+
+gboolean RedundantEncodingStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* message) {
+  if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+    GstObject* src = GST_MESSAGE_SRC(message);
+    for (element_id_t i = 0; i < inputs_health_.size(); ++i) {
+      for (elements::Element* el : GetInputBranch(i)) {
+        GstObject* input_object = GST_OBJECT(el->GetGstElement());
+        if (src == input_object || gst_object_has_as_ancestor(src, input_object)) {
+          GError* err = nullptr;
+          gst_message_parse_error(message, &err, nullptr);
+          WARNING_LOG() << "Input " << i << " error: " << (err ? err->message : "unknown") << ", rebuilding it.";
+          g_clear_error(&err);
+          inputs_health_[i].failed = true;
+        }
+      }
+    }
+  }
+  return base_class::HandleAsyncBusMessageReceived(bus, message);
+}
+
+void RedundantEncodingStream::OnInputStalled(element_id_t id, StallReason reason) {
+  INFO_LOG() << "Input " << id << " stalled, reason: " << reason << ", active input: " << active_input_;
+  if (id < inputs_health_.size()) {
+    inputs_health_[id].failed = true;
+  }
+}
+
+gboolean RedundantEncodingStream::HandleHealthCheck() {
+  const gint64 now = g_get_monotonic_time();
+  for (element_id_t i = 0; i < inputs_health_.size(); ++i) {
+    UpdateInputHealth(i, now);
+  }
+
+  // inputs connect at different speed, nothing is judged until first rate window is closed
+  if (inputs_health_.empty() || now - loop_start_ < rate_window_msecs * 1000) {
+    return TRUE;
+  }
+
+  element_id_t target = active_input_;
+  if (!inputs_health_[active_input_].healthy_since) {
+    for (element_id_t i = 0; i < inputs_health_.size(); ++i) {
+      if (inputs_health_[i].healthy_since) {
+        target = i;
+        break;
+      }
+    }
+  } else if (active_input_ != 0) {
+    const gint64 primary_healthy_since = inputs_health_[0].healthy_since;
+    if (primary_healthy_since && now - primary_healthy_since >= primary_failback_sec * G_USEC_PER_SEC) {
+      target = 0;
+    }
+  }
+
+  if (target != active_input_) {
+    ignore_result(SwitchInput(target));
+  }
+
+  // failed input, backup too, is brought back behind selector, failback waits until it is healthy again
+  for (element_id_t i = 0; i < inputs_health_.size(); ++i) {
+    InputHealth* health = &inputs_health_[i];
+    const gint64 dead_msecs = health->started ? input_rebuild_msecs : input_connect_msecs;
+    const bool dead = health->stalled_since && now - health->stalled_since >= dead_msecs * 1000;
+    if (!health->failed && !dead) {
+      continue;
+    }
+    if (health->rebuild_time && now - health->rebuild_time < input_rebuild_interval_msecs * 1000) {
+      continue;
+    }
+    if (!RebuildInput(i, now)) {
+      WARNING_LOG() << "Can't rebuild input: " << i;
+    }
+  }
+  return TRUE;
+}
+
+void RedundantEncodingStream::UpdateInputHealth(element_id_t id, gint64 now) {
+  InputHealth* health = &inputs_health_[id];
+  ProbeStats stats;
+  if (!GetInputProbeStats(id, &stats)) {
+    health->healthy_since = 0;
+    if (!health->stalled_since) {
+      health->stalled_since = now;
+    }
+    return;
+  }
+
+  if (!health->window_start || stats.total_bytes < health->window_bytes) {
+    health->window_start = now;
+    health->window_bytes = stats.total_bytes;
+  } else if (now - health->window_start >= rate_window_msecs * 1000) {
+    const gint64 window_usec = now - health->window_start;
+    const size_t rate = (stats.total_bytes - health->window_bytes) * G_USEC_PER_SEC / static_cast<size_t>(window_usec);
+    health->low_rate = health->average_rate && rate < health->average_rate / low_rate_divider;
+    // slow average, sustained bitrate change stops being degradation after a few windows
+    health->average_rate = health->average_rate ? (health->average_rate * 7 + rate) / 8 : rate;
+    health->window_start = now;
+    health->window_bytes = stats.total_bytes;
+  }
+
+  bool stalled = !stats.last_arrival || now - stats.last_arrival > input_stall_msecs * 1000;
+  // source may deliver while decoder gives nothing, input is alive only when decoded buffers reach selector,
+  // rebuilt input only when they come from new source
+  ProbeStats decoded;
+  if (GetDecodedProbeStats(id, &decoded)) {
+    stalled |= decoded.last_arrival <= health->rebuild_time || now - decoded.last_arrival > input_stall_msecs * 1000;
+  }
+
+  if (!stalled) {
+    health->stalled_since = 0;
+    health->started = true;
+  } else if (!health->stalled_since) {
+    health->stalled_since = now;
+  }
+
+  if (stalled || health->low_rate) {
+    health->healthy_since = 0;
+  } else if (!health->healthy_since) {
+    health->healthy_since = now;
+  }
+}
+
+bool RedundantEncodingStream::SwitchInput(element_id_t id) {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const std::string pad_name = common::MemSPrintf("sink_%lu", id);
+  if (config->HaveVideo()) {
+    elements::ElementInputSelector* selector = static_cast<elements::ElementInputSelector*>(
+        GetElementByName(common::MemSPrintf(VIDEO_SELECTOR_NAME_1U, 0)));
+    if (!selector || !selector->SetActivePad(pad_name)) {
+      WARNING_LOG() << "Can't switch video to input: " << id;
+      return false;
+    }
+  }
+  if (config->HaveAudio()) {
+    elements::ElementInputSelector* selector = static_cast<elements::ElementInputSelector*>(
+        GetElementByName(common::MemSPrintf(AUDIO_SELECTOR_NAME_1U, 0)));
+    if (!selector || !selector->SetActivePad(pad_name)) {
+      WARNING_LOG() << "Can't switch audio to input: " << id;
+      return false;
+    }
+  }
+
+  INFO_LOG() << "Input switched: " << active_input_ << " => " << id;
+  active_input_ = id;
+  const input_t inputs = config->GetInput();
+  if (client_) {
+    client_->OnInputChanged(inputs[id]);
+  }
+  return true;
+}
+
+bool RedundantEncodingStream::RebuildInput(element_id_t id, gint64 now) {
+  const gint64 start_time = g_get_monotonic_time();
+  InputHealth* health = &inputs_health_[id];
+  *health = InputHealth();
+  health->rebuild_time = now;
+
+  // buffers of active input may be in flight, flush of its udb queues reaches outputs, it is rebuilt only when
+  // nothing healthy was there to switch to
+  const EncodeConfig* econf = static_cast<const EncodeConfig*>(GetConfig());
+  builders::RedundantEncodingStreamBuilder builder(econf, this, id);
+  bool is_live_input = false;
+  if (!RebuildInputElements(GetInputBranch(id), &builder, &is_live_input)) {
+    return false;
+  }
+
+  INFO_LOG() << "Input " << id << " rebuilt in " << (g_get_monotonic_time() - start_time) / 1000
+             << " msec, active input: " << active_input_;
+  return true;
+}
+
+elements_line_t RedundantEncodingStream::GetInputBranch(element_id_t id) const {
+  elements_line_t branch;
+  elements::Element* src = FindElementByName(common::MemSPrintf(SRC_NAME_1U, id));
+  if (src) {
+    branch.push_back(src);
+  }
+  elements::Element* decodebin = FindElementByName(common::MemSPrintf(DECODEBIN_NAME_1U, id));
+  if (decodebin) {
+    branch.push_back(decodebin);
+  }
+  return branch;
+}
+
+gboolean RedundantEncodingStream::health_check_callback(gpointer user_data) {
+  RedundantEncodingStream* stream = reinterpret_cast<RedundantEncodingStream*>(user_data);
+  return stream->HandleHealthCheck();
+}
+
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
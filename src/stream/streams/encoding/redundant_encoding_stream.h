@@ -0,0 +1,98 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "stream/streams/encoding/encoding_stream.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+
+namespace builders {
+class RedundantEncodingStreamBuilder;
+}
+
+// all inputs are decoded all the time, input selectors forward only the active one;
+// failover is a pad switch driven by per-input stall and data-rate checks, pipeline keeps running;
+// source and decodebin of failed input are rebuilt in place behind selector, so it can be taken back
+class RedundantEncodingStream : public EncodingStream {
+  friend class builders::RedundantEncodingStreamBuilder;
+
+ public:
+  typedef EncodingStream base_class;
+  enum {
+    health_check_msecs = 100,
+    input_stall_msecs = 500,      // no buffers for this long, input is dead
+    rate_window_msecs = 1000,     // data-rate is measured over this window
+    low_rate_divider = 4,         // rate below 1/4 of own average, input is degraded
+    primary_failback_sec = 10,    // primary must be healthy this long before it is taken back
+    input_rebuild_msecs = 3000,   // no buffers for this long, source branch of input is rebuilt
+    input_connect_msecs = 15000,  // same for new or rebuilt input which hasn't delivered anything yet
+    input_rebuild_interval_msecs = 5000  // rebuilt input isn't rebuilt again sooner
+  };
+
+  RedundantEncodingStream(const EncodeConfig* config, IStreamClient* client, StreamStruct* stats);
+
+  const char* ClassName() const override;
+  bool IsInputRestartable() const override;  // backups take over, failed input is rebuilt alone
+
+  element_id_t GetActiveInput() const;  // thread safe
+
+ protected:
+  IBaseBuilder* CreateBuilder() override;
+
+  void PreLoop() override;
+  void PostLoop(ExitStatus status) override;
+
+  void HandleDecodeBinPadAdded(GstElement* src, GstPad* new_pad) override;
+  gboolean HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* message) override;
+  void OnInputStalled(element_id_t id, StallReason reason) override;  // health check switches away from it
+
+  virtual gboolean HandleHealthCheck();
+
+ private:
+  struct InputHealth {
+    InputHealth();
+
+    size_t window_bytes;
+    gint64 window_start;
+    size_t average_rate;  // bytes per sec, 0 until first window is closed
+    bool low_rate;
+    gint64 healthy_since;  // 0 if input is stalled or degraded
+    gint64 stalled_since;  // 0 if buffers flow
+    gint64 rebuild_time;   // 0 if never rebuilt
+    bool started;          // buffers came since loop start or rebuild
+    bool failed;           // source posted error or stall watch reported it, rebuilt on next check
+  };
+
+  static gboolean health_check_callback(gpointer user_data);
+
+  void UpdateInputHealth(element_id_t id, gint64 now);
+  bool SwitchInput(element_id_t id);
+  bool RebuildInput(element_id_t id, gint64 now);
+  elements_line_t GetInputBranch(element_id_t id) const;  // source and decodebin, those of them which exist
+
+  std::vector<InputHealth> inputs_health_;
+  std::atomic<element_id_t> active_input_;
+  gint64 loop_start_;
+  guint health_check_timer_id_;
+};
+
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
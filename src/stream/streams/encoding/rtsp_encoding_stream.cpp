@@ -34,6 +34,10 @@ const char* RtspEncodingStream::ClassName() const {
   return "RtspEncodingStream";
 }
 
+bool RtspEncodingStream::IsInputRestartable() const {
+  return false;
+}
+
 IBaseBuilder* RtspEncodingStream::CreateBuilder() {
   const EncodeConfig* econf = static_cast<const EncodeConfig*>(GetConfig());
   return new builders::RtspEncodingStreamBuilder(econf, this);
@@ -35,6 +35,7 @@ class RtspEncodingStream : public EncodingStream {
  public:
   RtspEncodingStream(const EncodeConfig* config, IStreamClient* client, StreamStruct* stats);
   const char* ClassName() const override;
+  bool IsInputRestartable() const override;  // own input, never swapped
 
  protected:
   IBaseBuilder* CreateBuilder() override;
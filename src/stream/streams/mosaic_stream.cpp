@@ -365,6 +365,10 @@ void MosaicStream::PostLoop(ExitStatus status) {
   UNUSED(status);
 }
 
+void MosaicStream::OnInputStalled(element_id_t id, StallReason reason) {
+  WARNING_LOG() << "Mosaic input " << id << " stalled, reason: " << reason;
+}
+
 void MosaicStream::decodebin_pad_added_callback(GstElement* src, GstPad* new_pad, gpointer user_data) {
   MosaicStream* stream = reinterpret_cast<MosaicStream*>(user_data);
   stream->HandleDecodeBinPadAdded(src, new_pad);
@@ -67,6 +67,7 @@ class MosaicStream : public IBaseStream {
 
   void PreLoop() override;
   void PostLoop(ExitStatus status) override;
+  void OnInputStalled(element_id_t id, StallReason reason) override;  // one frozen tile doesn't restart others
 
   virtual void ConnectDecodebinSignals(elements::ElementDecodebin* decodebin);
   virtual void ConnectCairoSignals(elements::video::ElementCairoOverlay* cairo, const MosaicImageOptions& options);
@@ -14,28 +14,48 @@
 
 #include "stream/streams/relay/playlist_relay_stream.h"
 
+#include <unistd.h>
+
 #include <string>
 
 #include <gst/app/gstappsrc.h>  // for GST_APP_SRC
 
 #include "stream/elements/sources/appsrc.h"
+#include "stream/gstreamer_utils.h"
 #include "stream/pad/pad.h"
 
 #include "stream/streams/builders/relay/playlist_relay_stream_builder.h"
 
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE (188 * 348)                      // whole ts packets, ~64 KiB
+#define NEXT_FILE_PREPARE_SIZE (BUFFER_SIZE * 16)  // open next file when less than this left in current
 
 namespace fastocloud {
 namespace stream {
 namespace streams {
 
 PlaylistRelayStream::PlaylistRelayStream(const PlaylistRelayConfig* config, IStreamClient* client, StreamStruct* stats)
-    : RelayStream(config, client, stats), app_src_(nullptr), current_file_(nullptr), curent_pos_(0) {}
+    : RelayStream(config, client, stats),
+      app_src_(nullptr),
+      pool_(nullptr),
+      current_file_(INVALID_DESCRIPTOR),
+      current_size_(0),
+      current_offset_(0),
+      next_file_(INVALID_DESCRIPTOR),
+      next_size_(0),
+      next_prepared_(false),
+      next_input_(),
+      curent_pos_(0) {}
 
 PlaylistRelayStream::~PlaylistRelayStream() {
-  if (current_file_) {
-    fclose(current_file_);
-    current_file_ = nullptr;
+  CloseCurrentFile();
+  if (next_file_ != INVALID_DESCRIPTOR) {
+    ::close(next_file_);
+    next_file_ = INVALID_DESCRIPTOR;
+  }
+  if (pool_) {
+    gst_buffer_pool_set_active(pool_, FALSE);
+    gst_object_unref(pool_);
+    pool_ = nullptr;
   }
 }
 
@@ -56,6 +76,10 @@ IBaseBuilder* PlaylistRelayStream::CreateBuilder() {
 
 void PlaylistRelayStream::PreLoop() {}
 
+bool PlaylistRelayStream::IsStallDetectable() const {
+  return false;
+}
+
 void PlaylistRelayStream::PostLoop(ExitStatus status) {
   RelayStream::PostLoop(status);
 }
@@ -64,32 +88,44 @@ void PlaylistRelayStream::HandleNeedData(GstElement* pipeline, guint rsize) {
   UNUSED(pipeline);
   UNUSED(rsize);
 
-  char* ptr = static_cast<char*>(calloc(BUFFER_SIZE, sizeof(char)));
-  if (!ptr) {
-    app_src_->SendEOS();  // send  eos
-    return;
+  if (!pool_) {
+    pool_ = make_buffer_pool(BUFFER_SIZE);
+    if (!pool_) {
+      WARNING_LOG() << "Can't create buffer pool for playlist";
+      Quit(EXIT_INNER);
+      return;
+    }
   }
 
-  size_t size = 0;
-  while (size == 0) {
-    if (!current_file_) {
-      current_file_ = OpenNextFile();
+  // files that turned out empty or truncated are skipped, every file is tried once
+  const PlaylistRelayConfig* rconf = static_cast<const PlaylistRelayConfig*>(GetConfig());
+  const size_t max_files = rconf->GetInput().size() + 1;
+  GstBuffer* buffer = nullptr;
+  for (size_t i = 0; !buffer && i <= max_files; ++i) {
+    if (current_file_ == INVALID_DESCRIPTOR && !TakeNextFile()) {
+      break;
     }
 
-    if (!current_file_) {
-      app_src_->SendEOS();  // send  eos
-      free(ptr);
-      return;
+    buffer = read_file_buffer(pool_, current_file_, current_offset_);
+    if (!buffer) {
+      WARNING_LOG() << "Playing file ended before expected size, skipped";
+      CloseCurrentFile();
+      continue;
     }
 
-    size = fread(ptr, sizeof(char), BUFFER_SIZE, current_file_);
-    if (size == 0) {
-      fclose(current_file_);
-      current_file_ = nullptr;
+    current_offset_ += gst_buffer_get_size(buffer);
+    if (current_offset_ >= current_size_) {
+      CloseCurrentFile();
+    } else if (!next_prepared_ && current_size_ - current_offset_ <= NEXT_FILE_PREPARE_SIZE) {
+      PrepareNextFile();
     }
   }
 
-  GstBuffer* buffer = gst_buffer_new_wrapped(ptr, size);
+  if (!buffer) {
+    app_src_->SendEOS();  // send  eos
+    return;
+  }
+
   GstFlowReturn ret = app_src_->PushBuffer(buffer);
   if (ret != GST_FLOW_OK) {
     WARNING_LOG() << "gst_app_src_push_buffer failed: " << gst_flow_get_name(ret);
@@ -102,37 +138,61 @@ void PlaylistRelayStream::need_data_callback(GstElement* pipeline, guint size, g
   return stream->HandleNeedData(pipeline, size);
 }
 
-FILE* PlaylistRelayStream::OpenNextFile() {
+bool PlaylistRelayStream::TakeNextFile() {
+  if (!next_prepared_) {
+    PrepareNextFile();
+  }
+
+  next_prepared_ = false;
+  if (next_file_ == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  current_file_ = next_file_;
+  current_size_ = next_size_;
+  current_offset_ = 0;
+  next_file_ = INVALID_DESCRIPTOR;
+  INFO_LOG() << "File " << next_input_.GetInput().GetPath().GetPath() << " open for playing";
+  if (client_) {
+    client_->OnInputChanged(next_input_);
+  }
+  return true;
+}
+
+void PlaylistRelayStream::PrepareNextFile() {
   const PlaylistRelayConfig* rconf = static_cast<const PlaylistRelayConfig*>(GetConfig());
   const bool loop = rconf->GetLoop();
+  next_prepared_ = true;
 
-  if (!loop) {
-    input_t input = rconf->GetInput();
+  input_t input = rconf->GetInput();
+  for (size_t tries = 0; tries < input.size(); ++tries) {
     if (curent_pos_ >= input.size()) {
-      INFO_LOG() << "No more files for playing";
-      return nullptr;  // EOS
+      if (!loop) {
+        break;
+      }
+      curent_pos_ = 0;
     }
-  }
 
-  input_t input = rconf->GetInput();
-  if (curent_pos_ >= input.size()) {
-    curent_pos_ = 0;
+    InputUri iuri = input[curent_pos_++];
+    common::uri::Url uri = iuri.GetInput();
+    common::uri::Upath path = uri.GetPath();
+    std::string cur_path = path.GetPath();
+    next_file_ = open_feed_file(cur_path, &next_size_);
+    if (next_file_ != INVALID_DESCRIPTOR) {
+      next_input_ = iuri;
+      return;
+    }
+    WARNING_LOG() << "File " << cur_path << " can't open for playing, skipped";
   }
 
-  InputUri iuri = input[curent_pos_++];
-  common::uri::Url uri = iuri.GetInput();
-  common::uri::Upath path = uri.GetPath();
-  std::string cur_path = path.GetPath();
-  FILE* file = fopen(cur_path.c_str(), "rb");
-  if (file) {
-    INFO_LOG() << "File " << cur_path << " open for playing";
-    if (client_) {
-      client_->OnInputChanged(iuri);
-    }
-  } else {
-    WARNING_LOG() << "File " << cur_path << "can't open for playing";
+  INFO_LOG() << "No more files for playing";
+}
+
+void PlaylistRelayStream::CloseCurrentFile() {
+  if (current_file_ != INVALID_DESCRIPTOR) {
+    ::close(current_file_);
+    current_file_ = INVALID_DESCRIPTOR;
   }
-  return file;
 }
 
 }  // namespace streams
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <sys/types.h>  // for off_t
+
+#include <gst/gstbufferpool.h>  // for GstBufferPool
+
 #include "stream/streams/relay/relay_stream.h"
 
 namespace fastocloud {
@@ -46,16 +50,26 @@ class PlaylistRelayStream : public RelayStream {
 
   void PreLoop() override;
   void PostLoop(ExitStatus status) override;
+  bool IsStallDetectable() const override;  // files are fed on demand
 
   virtual void HandleNeedData(GstElement* pipeline, guint rsize);
 
  private:
   static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
 
-  FILE* OpenNextFile();
+  bool TakeNextFile();
+  void PrepareNextFile();
+  void CloseCurrentFile();
 
   elements::sources::ElementAppSrc* app_src_;
-  FILE* current_file_;
+  GstBufferPool* pool_;
+  int current_file_;
+  off_t current_size_;
+  off_t current_offset_;
+  int next_file_;  // opened ahead of time before current file ends
+  off_t next_size_;
+  bool next_prepared_;
+  InputUri next_input_;
   size_t curent_pos_;
 };
 
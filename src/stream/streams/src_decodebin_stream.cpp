@@ -14,8 +14,11 @@
 
 #include "stream/streams/src_decodebin_stream.h"
 
+#include <common/sprintf.h>
+
 #include "stream/config.h"
 #include "stream/pad/pad.h"
+#include "stream/stypes.h"
 
 namespace fastocloud {
 namespace stream {
@@ -116,6 +119,11 @@ void SrcDecodeBinStream::OnDecodebinCreated(elements::ElementDecodebin* decodebi
   ConnectDecodebinSignals(decodebin);
 }
 
+elements_line_t SrcDecodeBinStream::GetInputElements() const {
+  return {GetElementByName(common::MemSPrintf(SRC_NAME_1U, 0)),
+          GetElementByName(common::MemSPrintf(DECODEBIN_NAME_1U, 0))};
+}
+
 }  // namespace streams
 }  // namespace stream
 }  // namespace fastocloud
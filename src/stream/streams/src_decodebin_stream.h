@@ -42,6 +42,8 @@ class SrcDecodeBinStream : public IBaseStream {
                               bool need_push) override;
   virtual void OnDecodebinCreated(elements::ElementDecodebin* decodebin);
 
+  elements_line_t GetInputElements() const override;  // source and decodebin
+
   IBaseBuilder* CreateBuilder() override = 0;
 
   void PreLoop() override;
@@ -14,13 +14,8 @@
 
 #include "stream/streams/timeshift/catchup_stream.h"
 
-#include <algorithm>
-
 #include "base/constants.h"
 
-#include "utils/m3u8_reader.h"
-#include "utils/m3u8_writer.h"
-
 #include "stream/gst_macros.h"
 
 #define PLAYLIST_NAME "master.m3u8"
@@ -35,16 +30,7 @@ CatchupStream::CatchupStream(const TimeshiftConfig* config,
                              const TimeShiftInfo& info,
                              IStreamClient* client,
                              StreamStruct* stats)
-    : base_class(config, info, client, stats), chunks_() {
-  auto m3u8_path = info.timshift_dir.MakeFileStringPath(PLAYLIST_NAME);
-  if (!m3u8_path) {
-    return;
-  }
-
-  utils::M3u8Reader reader;
-  reader.Parse(*m3u8_path);
-  chunks_ = reader.GetChunks();
-}
+    : base_class(config, info, client, stats), playlist_(), playlist_opened_(false), recording_chunk_() {}
 
 const char* CatchupStream::ClassName() const {
   return "CatchupStream";
@@ -60,51 +46,53 @@ IBaseBuilder* CatchupStream::CreateBuilder() {
   return new builders::CatchupStreamBuilder(tconf, this);
 }
 
-void CatchupStream::WriteM3u8List() {
+void CatchupStream::AppendChunk(utils::ChunkInfo chunk) {
   TimeShiftInfo tinf = GetTimeshiftInfo();
   auto m3u8_path = tinf.timshift_dir.MakeFileStringPath(PLAYLIST_NAME);
   if (!m3u8_path) {
     return;
   }
 
-  utils::M3u8Writer fl;
-  common::ErrnoError err =
-      fl.Open(*m3u8_path, common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE);
-  if (err) {
-    return;
-  }
-
   const TimeshiftConfig* tconf = static_cast<const TimeshiftConfig*>(GetConfig());
   time_t duration = tconf->GetTimeShiftChunkDuration();
-  chunk_index_t first_index = 0;
-  if (!chunks_.empty()) {
-    first_index = chunks_[0].index;
-  }
-  err = fl.WriteHeader(first_index, duration);
-  if (err) {
-    WARNING_LOG() << "Failed to write m3u8 header to " << m3u8_path->GetPath() << ": " << err->GetDescription();
-    return;
-  }
-  GstClockTime total_time = 0;
-  for (size_t i = 0; i < chunks_.size(); ++i) {
-    if (!GST_CLOCK_TIME_IS_VALID(chunks_[i].duration)) {
-      chunks_[i].duration = duration * GST_SECOND;
-    }
-    total_time += chunks_[i].duration;
-    err = fl.WriteLine(chunks_[i]);
+  if (!playlist_opened_) {
+    common::ErrnoError err = playlist_.OpenAppend(*m3u8_path, chunk.index, duration);
     if (err) {
-      WARNING_LOG() << "Failed to write chunk info to " << m3u8_path->GetPath() << ": " << err->GetDescription();
+      WARNING_LOG() << "Failed to open m3u8 " << m3u8_path->GetPath() << ": " << err->GetDescription();
       return;
     }
+    playlist_opened_ = true;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID(chunk.duration)) {
+    chunk.duration = duration * GST_SECOND;
+  }
+  common::ErrnoError err = playlist_.WriteLine(chunk);
+  if (err) {
+    WARNING_LOG() << "Failed to write chunk info to " << m3u8_path->GetPath() << ": " << err->GetDescription();
+  }
+}
+
+void CatchupStream::FinishPlaylist() {
+  if (!recording_chunk_.path.empty()) {
+    AppendChunk(recording_chunk_);
+    recording_chunk_ = utils::ChunkInfo();
   }
-  err = fl.WriteFooter();
+
+  if (!playlist_opened_) {
+    return;
+  }
+
+  common::ErrnoError err = playlist_.WriteFooter();
   if (err) {
-    WARNING_LOG() << "Failed to write m3u8 footer to " << m3u8_path->GetPath() << ": " << err->GetDescription();
+    WARNING_LOG() << "Failed to write m3u8 footer: " << err->GetDescription();
   }
+  ignore_result(playlist_.Close());
+  playlist_opened_ = false;
 }
 
 void CatchupStream::PostLoop(ExitStatus status) {
-  WriteM3u8List();
+  FinishPlaylist();
   base_class::PostLoop(status);
 }
 
@@ -117,16 +105,16 @@ gchararray CatchupStream::OnPathSet(GstElement* splitmux, guint fragment_id, Gst
     if (buffer) {
       GstClockTime curr_time = GST_BUFFER_DTS_OR_PTS(buffer);
       if (GST_CLOCK_TIME_IS_VALID(curr_time) && GST_CLOCK_TIME_IS_VALID(chunk_.duration)) {
-        GstClockTime diff = GST_CLOCK_DIFF(chunk_.duration, curr_time);
-        if (!chunks_.empty()) {
-          chunks_[chunks_.size() - 1].duration = diff;
-        }
+        recording_chunk_.duration = GST_CLOCK_DIFF(chunk_.duration, curr_time);
       }
       chunk_.duration = curr_time;
     }
   }
 
-  chunks_.push_back(chunk);
+  if (!recording_chunk_.path.empty()) {  // previous chunk is finished now
+    AppendChunk(recording_chunk_);
+  }
+  recording_chunk_ = chunk;
   return base_class::OnPathSet(splitmux, fragment_id, sample);
 }
 
@@ -14,10 +14,10 @@
 
 #pragma once
 
-#include <vector>
-
 #include "stream/streams/timeshift/timeshift_recorder_stream.h"
 
+#include "utils/m3u8_writer.h"
+
 namespace fastocloud {
 namespace stream {
 namespace streams {
@@ -37,8 +37,12 @@ class CatchupStream : public TimeShiftRecorderStream {
   gchararray OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample) override;
 
  private:
-  void WriteM3u8List();
-  std::vector<utils::ChunkInfo> chunks_;
+  void AppendChunk(utils::ChunkInfo chunk);
+  void FinishPlaylist();
+
+  utils::M3u8Writer playlist_;
+  bool playlist_opened_;
+  utils::ChunkInfo recording_chunk_;
 };
 
 }  // namespace streams
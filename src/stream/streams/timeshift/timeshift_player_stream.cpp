@@ -40,6 +40,10 @@ IBaseBuilder* TimeShiftPlayerStream::CreateBuilder() {
   return new builders::TimeShiftPlayerBuilder(GetTimeshiftInfo(), start_chunk_index_, rconf, this);
 }
 
+bool TimeShiftPlayerStream::IsStallDetectable() const {
+  return false;
+}
+
 void TimeShiftPlayerStream::OnInputDataFailed() {
   OnInputDataOK();
 }
@@ -37,6 +37,7 @@ class TimeShiftPlayerStream : public RelayStream {
  protected:
   IBaseBuilder* CreateBuilder() override;
 
+  bool IsStallDetectable() const override;  // chunks show up only when recorded
   void OnInputDataFailed() override;
 
  private:
@@ -14,6 +14,8 @@
 
 #include "stream/streams/timeshift/timeshift_recorder_stream.h"
 
+#include <sys/stat.h>
+
 #include <string>
 
 #include <common/file_system/string_path_utils.h>
@@ -54,13 +56,19 @@ TimeShiftRecorderStream::TimeShiftRecorderStream(const TimeshiftConfig* config,
                                                  const TimeShiftInfo& info,
                                                  IStreamClient* client,
                                                  StreamStruct* stats)
-    : base_class(config, info, client, stats), chunk_(), audio_pad_(nullptr), video_pad_(nullptr) {}
+    : base_class(config, info, client, stats),
+      chunk_(),
+      audio_pad_(nullptr),
+      video_pad_(nullptr),
+      index_(info.timshift_dir),
+      recording_chunk_({invalid_chunk_index, 0, 0, 0}) {}
 
 const char* TimeShiftRecorderStream::ClassName() const {
   return "TimeShiftRecorderStream";
 }
 
 TimeShiftRecorderStream::~TimeShiftRecorderStream() {
+  FinishRecordingChunk();
   elements::Element* splitmuxsink = GetElementByName(common::MemSPrintf(SPLIT_SINK_NAME_1U, 0));
   if (audio_pad_) {
     splitmuxsink->ReleaseRequestedPad(audio_pad_);
@@ -74,6 +82,12 @@ TimeShiftRecorderStream::~TimeShiftRecorderStream() {
 
 void TimeShiftRecorderStream::OnSplitmuxsinkCreated(Connector conn, elements::sink::ElementSplitMuxSink* sink) {
   TimeShiftInfo tinfo = GetTimeshiftInfo();
+  const TimeshiftConfig* tconf = static_cast<const TimeshiftConfig*>(GetConfig());
+  common::ErrnoError err = index_.Recover(tconf->GetTimeShiftChunkDuration() * 1000);
+  if (err) {
+    WARNING_LOG() << "Failed to recover timeshift index " << index_.GetPath() << ": " << err->GetDescription();
+  }
+
   chunk_index_t index = invalid_chunk_index;
   time_t file_created_time = 0;
   if (tinfo.FindLastChunk(&index, &file_created_time)) {
@@ -118,6 +132,10 @@ gboolean TimeShiftRecorderStream::HandleMainTimerTick() {
   if (el % no_data_panic_sec == 0) {
     const time_t max_life_time = common::time::current_utc_mstime() / 1000 - tinfo.timeshift_chunk_life_time;
     RemoveOldFilesByTime(tinfo.timshift_dir, max_life_time, CHUNK_EXT);
+    common::ErrnoError err = index_.RemoveOlder(static_cast<int64_t>(max_life_time) * 1000);
+    if (err) {
+      WARNING_LOG() << "Failed to trim timeshift index " << index_.GetPath() << ": " << err->GetDescription();
+    }
   }
   return base_class::HandleMainTimerTick();
 }
@@ -127,17 +145,7 @@ void TimeShiftRecorderStream::OnOutputDataFailed() {
 }
 
 chunk_index_t TimeShiftRecorderStream::CalcNextIndex() const {
-  chunk_index_t index = chunk_.index;
-  if (index == invalid_chunk_index) {
-    index = 0;
-  }
-
-  std::string old_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, index);
-  if (common::file_system::is_file_exist(old_path)) {  // if chunk exist move to next
-    index++;
-  }
-
-  return index;
+  return index_.GetNextIndex(chunk_.index);
 }
 
 gchararray TimeShiftRecorderStream::OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample) {
@@ -145,12 +153,35 @@ gchararray TimeShiftRecorderStream::OnPathSet(GstElement* splitmux, guint fragme
   UNUSED(fragment_id);
   UNUSED(sample);
 
+  FinishRecordingChunk();
   chunk_index_t ind = CalcNextIndex();
   chunk_.index = ind;
+  recording_chunk_ = {ind, common::time::current_utc_mstime(), 0, 0};
   std::string new_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, chunk_.index);
   return strdup(new_path.c_str());
 }
 
+void TimeShiftRecorderStream::FinishRecordingChunk() {
+  if (recording_chunk_.index == invalid_chunk_index) {
+    return;
+  }
+
+  TimeShiftChunk chunk = recording_chunk_;
+  recording_chunk_.index = invalid_chunk_index;
+  const std::string path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, chunk.index);
+  struct stat sb;
+  if (stat(path.c_str(), &sb) != 0) {
+    return;
+  }
+
+  chunk.duration = common::time::current_utc_mstime() - chunk.start_time;
+  chunk.size = sb.st_size;
+  common::ErrnoError err = index_.Append(chunk);
+  if (err) {
+    WARNING_LOG() << "Failed to index chunk " << path << ": " << err->GetDescription();
+  }
+}
+
 gchararray TimeShiftRecorderStream::path_setter_callback(GstElement* splitmux, guint fragment_id, gpointer user_data) {
   return path_setter_full_callback(splitmux, fragment_id, nullptr, user_data);
 }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "stream/streams/timeshift/itimeshift_recorder_stream.h"
+#include "stream/timeshift_index.h"
 
 #include "utils/chunk_info.h"
 
@@ -59,6 +60,8 @@ class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
   utils::ChunkInfo chunk_;
 
  private:
+  void FinishRecordingChunk();
+
   static gchararray path_setter_callback(GstElement* splitmux, guint fragment_id, gpointer user_data);
   static gchararray path_setter_full_callback(GstElement* splitmux,
                                               guint fragment_id,
@@ -67,6 +70,9 @@ class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
 
   pad::Pad* audio_pad_;
   pad::Pad* video_pad_;
+
+  TimeShiftIndex index_;
+  TimeShiftChunk recording_chunk_;
 };
 
 }  // namespace streams
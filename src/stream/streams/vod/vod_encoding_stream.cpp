@@ -14,24 +14,130 @@
 
 #include "stream/streams/vod/vod_encoding_stream.h"
 
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <common/file_system/file_system.h>
+
 #include "base/utils.h"
 
+#include "stream/gstreamer_utils.h"
+#include "stream/streams/builders/encoding/vod_encoding_stream_builder.h"
+
 namespace fastocloud {
 namespace stream {
 namespace streams {
 
 VodEncodeStream::VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, StreamStruct* stats)
-    : base_class(config, client, stats) {
+    : base_class(config, client, stats), video_pad_(nullptr), first_video_msec_(-1) {
   CHECK(config->IsVod());
 }
 
+VodEncodeStream::~VodEncodeStream() {
+  if (video_pad_) {
+    gst_object_unref(video_pad_);
+    video_pad_ = nullptr;
+  }
+}
+
 const char* VodEncodeStream::ClassName() const {
   return "VodEncodeStream";
 }
 
+IBaseBuilder* VodEncodeStream::CreateBuilder() {
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  return new builders::VodEncodingStreamBuilder(vconfig, this);
+}
+
+bool VodEncodeStream::PrePlay(ExitStatus* status) {
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  const VodEncodeConfig::vod_range_t range = vconfig->GetRange();
+  if (range) {
+    if (!SeekToRange(*range)) {
+      WARNING_LOG() << "Can't seek to vod range: " << common::ConvertToString(*range);
+      *status = EXIT_INNER;
+      return false;
+    }
+    return true;
+  }
+
+  if (!IsPlanner()) {
+    return true;
+  }
+
+  Pause();
+  vod_ranges_t ranges;
+  const bool is_jit = vconfig->GetJit();
+  const size_t min_ranges = is_jit ? 1 : 2;
+  if (!WaitPreroll() || !ProbeRanges(&ranges) || ranges.size() < min_ranges) {
+    WARNING_LOG() << "Vod can't be splitted into keyframe ranges, it is encoded by single pipeline.";
+    gst_element_seek_simple(GetPipeline(), GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, 0);
+    return true;
+  }
+
+  for (const OutputUri& output : vconfig->GetOutput()) {
+    if (output.GetOutput().GetScheme() != common::uri::Url::http) {
+      continue;
+    }
+
+    const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
+    common::ErrnoError err =
+        WriteVodRanges(is_jit ? MakeVodJitIndexPath(http_root) : MakeVodRangesPath(http_root), ranges);
+    if (err) {
+      WARNING_LOG() << "Can't write vod ranges: " << err->GetDescription() << ", it is encoded by single pipeline.";
+      RemoveVodRanges();  // service must not find ranges of some outputs
+      gst_element_seek_simple(GetPipeline(), GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, 0);
+      return true;
+    }
+  }
+
+  if (is_jit) {
+    INFO_LOG() << "Vod indexed by " << ranges.size() << " segments.";
+  } else {
+    INFO_LOG() << "Vod splitted into " << ranges.size() << " keyframe ranges for " << vconfig->GetWorkers()
+               << " workers.";
+  }
+  *status = EXIT_SELF;
+  return false;
+}
+
+void VodEncodeStream::HandleDecodeBinPadAdded(GstElement* src, GstPad* new_pad) {
+  base_class::HandleDecodeBinPadAdded(src, new_pad);
+
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  const VodEncodeConfig::vod_range_t range = vconfig->GetRange();
+  if (range) {
+    // running time starts from zero after seek, range keeps timestamps of its place in vod
+    const GstClockTimeDiff offset = range->start_msec * GST_MSECOND;
+    gst_pad_set_offset(new_pad, gst_pad_get_offset(new_pad) + offset);
+    return;
+  }
+
+  const gchar* new_pad_type = pad_get_type(new_pad);
+  if (!IsPlanner() || video_pad_ || !new_pad_type || strncmp(new_pad_type, "video", 5) != 0) {
+    return;
+  }
+
+  video_pad_ = GST_PAD(gst_object_ref(new_pad));
+  gst_pad_add_probe(new_pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+                    keyframe_probe_callback, this, nullptr);
+}
+
+void VodEncodeStream::PreExecCleanup(time_t old_life_time) {
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  if (vconfig->GetRange()) {  // chunks of other ranges are kept, chunks of this one are rewritten
+    return;
+  }
+
+  base_class::PreExecCleanup(old_life_time);
+  RemoveVodRanges();
+}
+
 void VodEncodeStream::PostExecCleanup() {
   const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
-  if (vconfig->GetCleanupTS()) {
+  if (vconfig->GetCleanupTS() && !vconfig->GetRange()) {
     for (const OutputUri& output : vconfig->GetOutput()) {
       common::uri::Url uri = output.GetOutput();
       common::uri::Url::scheme scheme = uri.GetScheme();
@@ -44,6 +150,147 @@ void VodEncodeStream::PostExecCleanup() {
   }
 }
 
+bool VodEncodeStream::IsPlanner() const {
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  return (vconfig->GetWorkers() > 1 || vconfig->GetJit()) && !vconfig->GetRange() && vconfig->GetRenditions().empty();
+}
+
+bool VodEncodeStream::WaitPreroll() {
+  const GstStateChangeReturn ret =
+      gst_element_get_state(GetPipeline(), nullptr, nullptr, preroll_timeout_sec * GST_SECOND);
+  return ret == GST_STATE_CHANGE_SUCCESS;
+}
+
+bool VodEncodeStream::SeekToRange(const VodRange& range) {
+  Pause();
+  if (!WaitPreroll()) {
+    return false;
+  }
+
+  const bool is_open = range.stop_msec == VodRange::open_stop;
+  const GstSeekFlags flags = static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+  if (!gst_element_seek(GetPipeline(), 1.0, GST_FORMAT_TIME, flags, GST_SEEK_TYPE_SET, range.start_msec * GST_MSECOND,
+                        is_open ? GST_SEEK_TYPE_NONE : GST_SEEK_TYPE_SET,
+                        is_open ? GST_CLOCK_TIME_NONE : range.stop_msec * GST_MSECOND)) {
+    return false;
+  }
+
+  if (!WaitPreroll()) {
+    return false;
+  }
+
+  DisableSinksSync();
+  return true;
+}
+
+bool VodEncodeStream::ProbeRanges(vod_ranges_t* ranges) {
+  gint64 duration = 0;
+  if (!video_pad_ || !gst_pad_query_duration(video_pad_, GST_FORMAT_TIME, &duration) || duration <= 0) {
+    return false;
+  }
+
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  const int64_t duration_msec = duration / GST_MSECOND;
+  const bool is_jit = vconfig->GetJit();
+  const size_t count =
+      is_jit ? CalcVodSegmentsCount(duration_msec) : CalcVodRangesCount(duration_msec, vconfig->GetWorkers());
+  std::vector<int64_t> keyframes;
+  for (size_t i = 1; i < count; ++i) {
+    int64_t keyframe_msec = 0;
+    if (!ProbeKeyframe(duration_msec * i / count, &keyframe_msec)) {
+      return false;
+    }
+    keyframes.push_back(keyframe_msec);
+  }
+
+  // segments of just in time vod are listed before encoding, so last one needs known duration
+  *ranges = MakeVodRanges(keyframes, is_jit ? duration_msec : VodRange::open_stop);
+  return true;
+}
+
+bool VodEncodeStream::ProbeKeyframe(int64_t position_msec, int64_t* keyframe_msec) {
+  // demuxer snaps key unit seek to previous keyframe, decoding starts from it
+  first_video_msec_ = -1;
+  const GstSeekFlags flags =
+      static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE);
+  if (!gst_element_seek_simple(GetPipeline(), GST_FORMAT_TIME, flags, position_msec * GST_MSECOND)) {
+    return false;
+  }
+
+  if (!WaitPreroll()) {
+    return false;
+  }
+
+  const int64_t keyframe = first_video_msec_;
+  if (keyframe < 0) {
+    return false;
+  }
+
+  *keyframe_msec = keyframe;
+  return true;
+}
+
+void VodEncodeStream::DisableSinksSync() {
+  // range is encoded offline, sinks don't wait for clock and shifted running time
+  GstIterator* it = gst_bin_iterate_recurse(GST_BIN(GetPipeline()));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+    GstElement* element = GST_ELEMENT(g_value_get_object(&item));
+    if (GST_OBJECT_FLAG_IS_SET(element, GST_ELEMENT_FLAG_SINK) &&
+        g_object_class_find_property(G_OBJECT_GET_CLASS(element), "sync")) {
+      g_object_set(element, "sync", FALSE, nullptr);
+    }
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+}
+
+GstPadProbeReturn VodEncodeStream::keyframe_probe_callback(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  VodEncodeStream* stream = reinterpret_cast<VodEncodeStream*>(user_data);
+  if (info->type & GST_PAD_PROBE_TYPE_EVENT_FLUSH) {
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_FLUSH_STOP) {
+      stream->first_video_msec_ = -1;
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (stream->first_video_msec_ >= 0 || !buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstEvent* segment_event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+  if (!segment_event) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  const GstSegment* segment = nullptr;
+  gst_event_parse_segment(segment_event, &segment);
+  const guint64 stream_time = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+  gst_event_unref(segment_event);
+  if (GST_CLOCK_TIME_IS_VALID(stream_time)) {
+    stream->first_video_msec_ = stream_time / GST_MSECOND;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void VodEncodeStream::RemoveVodRanges() {
+  const VodEncodeConfig* vconfig = static_cast<const VodEncodeConfig*>(GetConfig());
+  for (const OutputUri& output : vconfig->GetOutput()) {
+    if (output.GetOutput().GetScheme() != common::uri::Url::http) {
+      continue;
+    }
+
+    const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
+    for (const std::string& path : {MakeVodRangesPath(http_root).GetPath(), MakeVodJitIndexPath(http_root).GetPath()}) {
+      if (common::file_system::is_file_exist(path)) {
+        ignore_result(common::file_system::remove_file(path));
+      }
+    }
+  }
+}
+
 }  // namespace streams
 }  // namespace stream
 }  // namespace fastocloud
@@ -14,21 +14,47 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "stream/streams/encoding/encoding_stream.h"
 
 namespace fastocloud {
 namespace stream {
 namespace streams {
 
+// Vod with more than one worker is splitted: first run only probes keyframes and writes ranges next to playlist,
+// then service starts workers which encode one range each and stitches range playlists into vod playlist.
+// Just in time vod is planned the same way by segment sized ranges, service encodes them on request.
 class VodEncodeStream : public EncodingStream {
  public:
   typedef EncodingStream base_class;
+  enum { preroll_timeout_sec = 30 };
   VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, StreamStruct* stats);
+  ~VodEncodeStream() override;
 
   const char* ClassName() const override;
 
  protected:
+  IBaseBuilder* CreateBuilder() override;
+  bool PrePlay(ExitStatus* status) override;
+  void HandleDecodeBinPadAdded(GstElement* src, GstPad* new_pad) override;
+
+  void PreExecCleanup(time_t old_life_time) override;
   void PostExecCleanup() override;
+
+ private:
+  bool IsPlanner() const;
+  bool WaitPreroll();
+  bool SeekToRange(const VodRange& range);
+  bool ProbeRanges(vod_ranges_t* ranges);
+  bool ProbeKeyframe(int64_t position_msec, int64_t* keyframe_msec);
+  void DisableSinksSync();
+  void RemoveVodRanges();
+
+  static GstPadProbeReturn keyframe_probe_callback(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+  GstPad* video_pad_;                      // decoded video of planner, keyframes are probed on it
+  std::atomic<int64_t> first_video_msec_;  // stream time of first decoded frame after flushing seek
 };
 
 }  // namespace streams
@@ -23,6 +23,7 @@
 #include "stream/streams/encoding/encoding_only_audio_stream.h"
 #include "stream/streams/encoding/encoding_only_video_stream.h"
 #include "stream/streams/encoding/playlist_encoding_stream.h"
+#include "stream/streams/encoding/redundant_encoding_stream.h"
 #include "stream/streams/encoding/rtsp_encoding_stream.h"
 #include "stream/streams/mosaic_stream.h"
 #include "stream/streams/relay/playlist_relay_stream.h"
@@ -75,6 +76,10 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
   } else if (type == ENCODE || type == COD_ENCODE) {
     const streams::EncodeConfig* econfig = static_cast<const streams::EncodeConfig*>(config);
     if (input.size() > 1) {
+      if (econfig->GetInputRedundancy()) {  // primary and backups
+        return new streams::RedundantEncodingStream(econfig, client, stats);
+      }
+
       bool is_playlist = true;
       for (InputUri iuri : input) {
         common::uri::Url input_uri = iuri.GetInput();
@@ -27,9 +27,19 @@
 
 #define VIDEO_TEE_NAME_1U "video_tee_%lu"
 #define AUDIO_TEE_NAME_1U "audio_tee_%lu"
+#define DECODED_VIDEO_TEE_NAME_1U "decoded_video_tee_%lu"
+#define RENDITION_QUEUE_NAME_1U "rendition_queue_%lu"
+#define RENDITION_POST_PROC_NAME_1U "rendition_post_proc_%lu"
 
 #define UDB_VIDEO_NAME_1U "udb_conn_video_%lu"
 #define UDB_AUDIO_NAME_1U "udb_conn_audio_%lu"
+#define INTER_VIDEO_SINK_NAME_1U "inter_video_sink_%lu"
+#define INTER_VIDEO_SRC_NAME_1U "inter_video_src_%lu"
+#define INTER_AUDIO_CONVERT_NAME_1U "inter_audio_convert_%lu"
+#define INTER_AUDIO_SINK_NAME_1U "inter_audio_sink_%lu"
+#define INTER_AUDIO_SRC_NAME_1U "inter_audio_src_%lu"
+#define VIDEO_SELECTOR_NAME_1U "video_selector_%lu"
+#define AUDIO_SELECTOR_NAME_1U "audio_selector_%lu"
 
 #define POST_PROC_NAME_1U "post_proc_%lu"
 #define VIDEO_LOGO_NAME_1U "videologo_%lu"
@@ -78,6 +88,8 @@
 #define AUDIO_PARSER_NAME_1U "audio_parser_%lu"
 #define VIDEO_PARSER_NAME_1U "video_parser_%lu"
 #define MUXER_NAME_1U "muxer_%lu"
+#define MUXER_TEE_NAME_1U "muxer_tee_%lu"
+#define MUXER_TEE_QUEUE_NAME_1U "muxer_tee_queue_%lu"
 
 #define AUDIO_PAY_NAME_1U "audio_pay_%lu"
 #define VIDEO_PAY_NAME_1U "video_pay_%lu"
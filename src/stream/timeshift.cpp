@@ -26,6 +26,7 @@
 
 #include "base/constants.h"
 #include "stream/stypes.h"
+#include "stream/timeshift_index.h"
 
 namespace fastocloud {
 namespace stream {
@@ -70,6 +71,26 @@ bool TimeShiftInfo::FindChunkToPlay(time_t chunk_duration, chunk_index_t* index)
     CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
   }
 
+  const TimeShiftIndex chunks_index(timshift_dir);
+  if (chunks_index.IsExist()) {
+    const int64_t desired_msec = static_cast<int64_t>(desired_time) * 1000;
+    TimeShiftChunk chunk;
+    if (!chunks_index.FindChunk(desired_msec, &chunk)) {
+      // recording chunk is not indexed yet, play the last finished one
+      if (!chunks_index.GetLastChunk(&chunk)) {
+        return false;
+      }
+      const int64_t ahead = desired_msec - chunk.GetEndTime();
+      if (ahead < 0 || ahead >= static_cast<int64_t>(chunk_duration) * 1000) {
+        return false;
+      }
+    }
+
+    *index = chunk.index;
+    INFO_LOG() << "Select " << *index << " part, diff msec " << desired_msec - chunk.start_time;
+    return true;
+  }
+
   auto files = common::file_system::ScanFolder(timshift_dir, CHUNK_EXT, false, &filter_files);
   if (files.empty()) {
     return false;
@@ -112,6 +133,14 @@ bool TimeShiftInfo::FindLastChunk(chunk_index_t* index, time_t* file_created_tim
     CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
   }
 
+  const TimeShiftIndex chunks_index(timshift_dir);
+  TimeShiftChunk chunk;
+  if (chunks_index.GetLastChunk(&chunk)) {
+    *index = chunk.index;
+    *file_created_time = chunk.GetEndTime() / 1000;
+    return true;
+  }
+
   auto files = common::file_system::ScanFolder(timshift_dir, CHUNK_EXT, false, &filter_files);
   if (files.empty()) {
     return false;
@@ -0,0 +1,372 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/timeshift_index.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <common/convert2string.h>
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#define TIMESHIFT_INDEX_FILE_NAME "chunks.idx"
+
+#if !defined(O_BINARY)
+#define O_BINARY 0
+#endif
+
+namespace fastocloud {
+namespace stream {
+
+namespace {
+static_assert(TimeShiftIndex::record_size == 32, "TimeShiftChunk must stay a fixed on disk record");
+
+bool ReadRecords(int fd, size_t pos, size_t count, TimeShiftChunk* chunks) {
+  const off_t offset = static_cast<off_t>(pos * TimeShiftIndex::record_size);
+  if (lseek(fd, offset, SEEK_SET) != offset) {
+    return false;
+  }
+
+  char* data = reinterpret_cast<char*>(chunks);
+  const size_t size = count * TimeShiftIndex::record_size;
+  size_t readed = 0;
+  while (readed < size) {
+    ssize_t res = read(fd, data + readed, size - readed);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      return false;
+    }
+    readed += res;
+  }
+  return true;
+}
+
+bool WriteAll(int fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t res = write(fd, ptr + written, size - written);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      return false;
+    }
+    written += res;
+  }
+  return true;
+}
+
+// reader side of the index, a partially written tail record is ignored
+class IndexFile {
+ public:
+  explicit IndexFile(const std::string& path) : fd_(open(path.c_str(), O_RDONLY | O_BINARY)), count_(0) {
+    struct stat sb;
+    if (fd_ != INVALID_DESCRIPTOR && fstat(fd_, &sb) == 0) {
+      count_ = sb.st_size / TimeShiftIndex::record_size;
+    }
+  }
+
+  ~IndexFile() {
+    if (fd_ != INVALID_DESCRIPTOR) {
+      ::close(fd_);
+    }
+  }
+
+  size_t GetCount() const { return count_; }
+
+  bool Read(size_t pos, TimeShiftChunk* chunk) const {
+    if (pos >= count_) {
+      return false;
+    }
+    return ReadRecords(fd_, pos, 1, chunk);
+  }
+
+  // up to count records from pos with one read
+  bool ReadRange(size_t pos, size_t count, std::vector<TimeShiftChunk>* chunks) const {
+    chunks->clear();
+    if (pos >= count_ || count == 0) {
+      return true;
+    }
+
+    chunks->resize(std::min(count, count_ - pos));
+    return ReadRecords(fd_, pos, chunks->size(), chunks->data());
+  }
+
+  // first record which ends after utc_msec, count_ if none
+  size_t LowerBoundByEnd(int64_t utc_msec) const {
+    size_t first = 0;
+    size_t last = count_;
+    while (first < last) {
+      const size_t middle = first + (last - first) / 2;
+      TimeShiftChunk chunk;
+      if (!Read(middle, &chunk)) {
+        return count_;
+      }
+      if (chunk.GetEndTime() <= utc_msec) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+    return first;
+  }
+
+ private:
+  const int fd_;
+  size_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexFile);
+};
+
+bool compare_chunks(const TimeShiftChunk& first, const TimeShiftChunk& second) {
+  return first.index < second.index;
+}
+
+// chunks with index greater than after, times restored from file modification time (end of chunk)
+std::vector<TimeShiftChunk> CollectChunks(const common::file_system::ascii_directory_string_path& dir,
+                                          chunk_index_t after,
+                                          int64_t prev_end,
+                                          int64_t chunk_duration_msec) {
+  std::vector<TimeShiftChunk> result;
+  const auto files = common::file_system::ScanFolder(dir, CHUNK_EXT, false);
+  for (const auto& file : files) {
+    chunk_index_t index;
+    if (!common::ConvertFromString(file.GetBaseFileName(), &index)) {
+      continue;
+    }
+    if (after != invalid_chunk_index && index <= after) {
+      continue;
+    }
+
+    struct stat sb;
+    if (stat(file.GetPath().c_str(), &sb) != 0) {
+      continue;
+    }
+
+    const int64_t end = static_cast<int64_t>(sb.st_mtime) * 1000;
+    TimeShiftChunk chunk = {index, end - chunk_duration_msec, chunk_duration_msec, static_cast<uint64_t>(sb.st_size)};
+    result.push_back(chunk);
+  }
+
+  std::sort(result.begin(), result.end(), compare_chunks);
+  for (auto& chunk : result) {  // keep records ordered by time
+    const int64_t end = chunk.GetEndTime();
+    chunk.start_time = std::min(std::max(chunk.start_time, prev_end), end);
+    chunk.duration = end - chunk.start_time;
+    prev_end = end;
+  }
+  return result;
+}
+
+common::ErrnoError AppendRecords(const std::string& path, const std::vector<TimeShiftChunk>& chunks) {
+  if (chunks.empty()) {
+    return common::ErrnoError();
+  }
+
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_BINARY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  const bool ok = WriteAll(fd, chunks.data(), chunks.size() * TimeShiftIndex::record_size);
+  const int err = errno;
+  ::close(fd);
+  if (!ok) {
+    return common::make_errno_error(err);
+  }
+  return common::ErrnoError();
+}
+
+// readers keep the old file open, so replace it at once
+common::ErrnoError ReplaceRecords(const std::string& path, const std::vector<TimeShiftChunk>& chunks) {
+  const std::string tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  const bool ok = WriteAll(fd, chunks.data(), chunks.size() * TimeShiftIndex::record_size);
+  const int err = errno;
+  ::close(fd);
+  if (!ok) {
+    ignore_result(unlink(tmp_path.c_str()));
+    return common::make_errno_error(err);
+  }
+
+#if defined(OS_WIN)
+  ignore_result(unlink(path.c_str()));
+#endif
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    const int rename_err = errno;
+    ignore_result(unlink(tmp_path.c_str()));
+    return common::make_errno_error(rename_err);
+  }
+  return common::ErrnoError();
+}
+}  // namespace
+
+int64_t TimeShiftChunk::GetEndTime() const {
+  return start_time + duration;
+}
+
+TimeShiftIndex::TimeShiftIndex(const common::file_system::ascii_directory_string_path& dir)
+    : dir_(dir), path_(dir.GetPath() + TIMESHIFT_INDEX_FILE_NAME), mutex_() {}
+
+std::string TimeShiftIndex::GetPath() const {
+  return path_;
+}
+
+bool TimeShiftIndex::IsExist() const {
+  return common::file_system::is_file_exist(path_);
+}
+
+bool TimeShiftIndex::FindChunk(int64_t utc_msec, TimeShiftChunk* chunk) const {
+  if (!chunk) {
+    return false;
+  }
+
+  const IndexFile file(path_);
+  TimeShiftChunk first;
+  if (!file.Read(0, &first) || utc_msec < first.start_time) {
+    return false;
+  }
+
+  // chunk which contains utc_msec or the first one after a recording gap
+  return file.Read(file.LowerBoundByEnd(utc_msec), chunk);
+}
+
+bool TimeShiftIndex::GetFirstChunk(TimeShiftChunk* chunk) const {
+  if (!chunk) {
+    return false;
+  }
+
+  const IndexFile file(path_);
+  return file.Read(0, chunk);
+}
+
+bool TimeShiftIndex::GetLastChunk(TimeShiftChunk* chunk) const {
+  if (!chunk) {
+    return false;
+  }
+
+  const IndexFile file(path_);
+  const size_t count = file.GetCount();
+  return count != 0 && file.Read(count - 1, chunk);
+}
+
+bool TimeShiftIndex::GetChunks(int64_t from_msec,
+                               int64_t to_msec,
+                               size_t max_count,
+                               std::vector<TimeShiftChunk>* chunks) const {
+  if (!chunks) {
+    return false;
+  }
+
+  const IndexFile file(path_);
+  std::vector<TimeShiftChunk> result;
+  if (!file.ReadRange(file.LowerBoundByEnd(from_msec), max_count, &result)) {
+    return false;
+  }
+
+  // records are ordered by time, the tail starting after range is dropped
+  size_t count = 0;
+  while (count < result.size() && result[count].start_time < to_msec) {
+    count++;
+  }
+  result.resize(count);
+  *chunks = result;
+  return true;
+}
+
+bool TimeShiftIndex::GetChunksBefore(int64_t until_msec, size_t count, std::vector<TimeShiftChunk>* chunks) const {
+  if (!chunks) {
+    return false;
+  }
+
+  const IndexFile file(path_);
+  const size_t last = file.LowerBoundByEnd(until_msec);
+  const size_t first = last > count ? last - count : 0;
+  std::vector<TimeShiftChunk> result;
+  if (!file.ReadRange(first, last - first, &result)) {
+    return false;
+  }
+
+  *chunks = result;
+  return true;
+}
+
+chunk_index_t TimeShiftIndex::GetNextIndex(chunk_index_t current) const {
+  const chunk_index_t index = current == invalid_chunk_index ? 0 : current;
+  TimeShiftChunk last;
+  if (GetLastChunk(&last)) {  // file of recorded chunk may be gone, its record is still served
+    return std::max(index, last.index + 1);
+  }
+
+  const std::string path = common::MemSPrintf("%s%llu" CHUNK_EXT, dir_.GetPath(), index);
+  return common::file_system::is_file_exist(path) ? index + 1 : index;
+}
+
+common::ErrnoError TimeShiftIndex::Append(const TimeShiftChunk& chunk) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return AppendRecords(path_, {chunk});
+}
+
+common::ErrnoError TimeShiftIndex::RemoveOlder(int64_t utc_msec) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<TimeShiftChunk> rest;
+  {
+    const IndexFile file(path_);
+    const size_t first_alive = file.LowerBoundByEnd(utc_msec);
+    if (first_alive == 0) {
+      return common::ErrnoError();
+    }
+
+    if (!file.ReadRange(first_alive, file.GetCount() - first_alive, &rest)) {
+      return common::make_errno_error("Failed to read timeshift index", EIO);
+    }
+  }
+
+  return ReplaceRecords(path_, rest);
+}
+
+common::ErrnoError TimeShiftIndex::Recover(int64_t chunk_duration_msec) {
+  TimeShiftChunk last;
+  if (!GetLastChunk(&last)) {
+    return Rebuild(chunk_duration_msec);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto chunks = CollectChunks(dir_, last.index, last.GetEndTime(), chunk_duration_msec);
+  return AppendRecords(path_, chunks);
+}
+
+common::ErrnoError TimeShiftIndex::Rebuild(int64_t chunk_duration_msec) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto chunks = CollectChunks(dir_, invalid_chunk_index, 0, chunk_duration_msec);
+  return ReplaceRecords(path_, chunks);
+}
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,80 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include "stream/timeshift.h"
+
+namespace fastocloud {
+namespace stream {
+
+// one fixed size record per finished chunk, times in utc msec
+struct TimeShiftChunk {
+  chunk_index_t index;
+  int64_t start_time;
+  int64_t duration;
+  uint64_t size;
+
+  int64_t GetEndTime() const;
+};
+
+// Append-only catalogue of the timeshift folder, kept next to the chunks.
+// Records are sorted by index and time, so lookups are binary searches over the file
+// instead of directory scans; the writer is the recorder, readers may live in other processes.
+class TimeShiftIndex {
+ public:
+  enum { record_size = sizeof(TimeShiftChunk) };
+
+  explicit TimeShiftIndex(const common::file_system::ascii_directory_string_path& dir);
+
+  std::string GetPath() const;
+  bool IsExist() const;
+
+  bool FindChunk(int64_t utc_msec, TimeShiftChunk* chunk) const WARN_UNUSED_RESULT;
+  bool GetFirstChunk(TimeShiftChunk* chunk) const WARN_UNUSED_RESULT;
+  bool GetLastChunk(TimeShiftChunk* chunk) const WARN_UNUSED_RESULT;
+  // up to max_count first chunks overlapping [from_msec, to_msec)
+  bool GetChunks(int64_t from_msec,
+                 int64_t to_msec,
+                 size_t max_count,
+                 std::vector<TimeShiftChunk>* chunks) const WARN_UNUSED_RESULT;
+  // up to count last chunks finished before until_msec
+  bool GetChunksBefore(int64_t until_msec, size_t count, std::vector<TimeShiftChunk>* chunks) const WARN_UNUSED_RESULT;
+  // index for chunk after current one (invalid_chunk_index if none yet), never one which is already recorded,
+  // files decide only while there are no records
+  chunk_index_t GetNextIndex(chunk_index_t current) const;
+
+  common::ErrnoError Append(const TimeShiftChunk& chunk) WARN_UNUSED_RESULT;
+  // drops records of chunks finished before utc_msec
+  common::ErrnoError RemoveOlder(int64_t utc_msec) WARN_UNUSED_RESULT;
+  // rebuilds missing index or indexes chunks written after the last record
+  common::ErrnoError Recover(int64_t chunk_duration_msec) WARN_UNUSED_RESULT;
+  common::ErrnoError Rebuild(int64_t chunk_duration_msec) WARN_UNUSED_RESULT;
+
+ private:
+  const common::file_system::ascii_directory_string_path dir_;
+  const std::string path_;
+  std::mutex mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftIndex);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -19,3 +19,5 @@
 
 #define CHANGED_SOURCES_STREAM "changed_source_stream"
 #define STATISTIC_STREAM "statistic_stream"
+#define INPUT_STALL_STREAM "input_stall_stream"
+#define STARTUP_STREAM "startup_stream"
@@ -22,6 +22,12 @@
 #define FIELD_STATS_TOTAL_BYTES "total_bytes"
 #define FIELD_STATS_BYTES_PER_SECOND "bps"
 #define FIELD_STATS_DESIRE_BYTES_PER_SECOND "dbps"
+#define FIELD_STATS_TOTAL_BUFFERS "total_buffers"
+#define FIELD_STATS_KEY_FRAMES "key_frames"
+#define FIELD_STATS_DISCONT_BUFFERS "discont_buffers"
+#define FIELD_STATS_GAP_BUFFERS "gap_buffers"
+#define FIELD_STATS_LAST_PTS "last_pts"
+#define FIELD_STATS_LAST_DTS "last_dts"
 
 namespace fastocloud {
 namespace details {
@@ -50,6 +56,24 @@ common::Error ChannelStatsInfo::SerializeFields(json_object* out) const {
   size_t bps = stats_.GetBps();
   json_object_object_add(out, FIELD_STATS_BYTES_PER_SECOND, json_object_new_int64(bps));
 
+  size_t buffers = stats_.GetTotalBuffers();
+  json_object_object_add(out, FIELD_STATS_TOTAL_BUFFERS, json_object_new_int64(buffers));
+
+  size_t key_frames = stats_.GetKeyFrames();
+  json_object_object_add(out, FIELD_STATS_KEY_FRAMES, json_object_new_int64(key_frames));
+
+  size_t discont = stats_.GetDiscontBuffers();
+  json_object_object_add(out, FIELD_STATS_DISCONT_BUFFERS, json_object_new_int64(discont));
+
+  size_t gap = stats_.GetGapBuffers();
+  json_object_object_add(out, FIELD_STATS_GAP_BUFFERS, json_object_new_int64(gap));
+
+  uint64_t pts = stats_.GetLastPts();
+  json_object_object_add(out, FIELD_STATS_LAST_PTS, json_object_new_int64(pts));
+
+  uint64_t dts = stats_.GetLastDts();
+  json_object_object_add(out, FIELD_STATS_LAST_DTS, json_object_new_int64(dts));
+
   common::media::DesireBytesPerSec dbps = stats_.GetDesireBytesPerSecond();
   std::string dbps_str = common::ConvertToString(dbps);
   json_object_object_add(out, FIELD_STATS_DESIRE_BYTES_PER_SECOND, json_object_new_string(dbps_str.c_str()));
@@ -89,6 +113,42 @@ common::Error ChannelStatsInfo::DoDeSerialize(json_object* serialized) {
     stats.SetBps(json_object_get_int64(jbps));
   }
 
+  json_object* jbuf = nullptr;
+  json_bool jbuf_exists = json_object_object_get_ex(serialized, FIELD_STATS_TOTAL_BUFFERS, &jbuf);
+  if (jbuf_exists) {
+    stats.SetTotalBuffers(json_object_get_int64(jbuf));
+  }
+
+  json_object* jkf = nullptr;
+  json_bool jkf_exists = json_object_object_get_ex(serialized, FIELD_STATS_KEY_FRAMES, &jkf);
+  if (jkf_exists) {
+    stats.SetKeyFrames(json_object_get_int64(jkf));
+  }
+
+  json_object* jdis = nullptr;
+  json_bool jdis_exists = json_object_object_get_ex(serialized, FIELD_STATS_DISCONT_BUFFERS, &jdis);
+  if (jdis_exists) {
+    stats.SetDiscontBuffers(json_object_get_int64(jdis));
+  }
+
+  json_object* jgap = nullptr;
+  json_bool jgap_exists = json_object_object_get_ex(serialized, FIELD_STATS_GAP_BUFFERS, &jgap);
+  if (jgap_exists) {
+    stats.SetGapBuffers(json_object_get_int64(jgap));
+  }
+
+  json_object* jpts = nullptr;
+  json_bool jpts_exists = json_object_object_get_ex(serialized, FIELD_STATS_LAST_PTS, &jpts);
+  if (jpts_exists) {
+    stats.SetLastPts(json_object_get_int64(jpts));
+  }
+
+  json_object* jdts = nullptr;
+  json_bool jdts_exists = json_object_object_get_ex(serialized, FIELD_STATS_LAST_DTS, &jdts);
+  if (jdts_exists) {
+    stats.SetLastDts(json_object_get_int64(jdts));
+  }
+
   json_object* jdbps = nullptr;
   json_bool jdbps_exists = json_object_object_get_ex(serialized, FIELD_STATS_DESIRE_BYTES_PER_SECOND, &jdbps);
   common::media::DesireBytesPerSec dbps;
@@ -0,0 +1,110 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/commands_info/details/element_stats_info.h"
+
+#include <string>
+
+#define FIELD_ELEMENT_NAME "name"
+#define FIELD_ELEMENT_INPUT_RATE "in_rate"
+#define FIELD_ELEMENT_OUTPUT_RATE "out_rate"
+#define FIELD_ELEMENT_PROCTIME_P50 "proctime_p50"
+#define FIELD_ELEMENT_PROCTIME_P95 "proctime_p95"
+#define FIELD_ELEMENT_PROCTIME_P99 "proctime_p99"
+#define FIELD_ELEMENT_QUEUE_FILL "queue_fill"
+
+namespace fastocloud {
+namespace details {
+
+ElementStatsInfo::ElementStatsInfo() : ElementStatsInfo(ElementStats()) {}
+
+ElementStatsInfo::ElementStatsInfo(const ElementStats& stats) : stats_(stats) {}
+
+ElementStats ElementStatsInfo::GetElementStats() const {
+  return stats_;
+}
+
+common::Error ElementStatsInfo::SerializeFields(json_object* out) const {
+  const std::string name = stats_.GetName();
+  if (name.empty()) {
+    return common::make_error_inval();
+  }
+
+  json_object_object_add(out, FIELD_ELEMENT_NAME, json_object_new_string(name.c_str()));
+  json_object_object_add(out, FIELD_ELEMENT_INPUT_RATE, json_object_new_double(stats_.GetInputRate()));
+  json_object_object_add(out, FIELD_ELEMENT_OUTPUT_RATE, json_object_new_double(stats_.GetOutputRate()));
+  json_object_object_add(out, FIELD_ELEMENT_PROCTIME_P50, json_object_new_int64(stats_.GetProcTimeP50()));
+  json_object_object_add(out, FIELD_ELEMENT_PROCTIME_P95, json_object_new_int64(stats_.GetProcTimeP95()));
+  json_object_object_add(out, FIELD_ELEMENT_PROCTIME_P99, json_object_new_int64(stats_.GetProcTimeP99()));
+  const int queue_fill = stats_.GetQueueFill();
+  if (queue_fill != ElementStats::no_queue) {
+    json_object_object_add(out, FIELD_ELEMENT_QUEUE_FILL, json_object_new_int(queue_fill));
+  }
+  return common::Error();
+}
+
+common::Error ElementStatsInfo::DoDeSerialize(json_object* serialized) {
+  json_object* jname = nullptr;
+  json_bool jname_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_NAME, &jname);
+  if (!jname_exists) {
+    return common::make_error_inval();
+  }
+  ElementStats stats(json_object_get_string(jname));
+
+  json_object* jin = nullptr;
+  json_bool jin_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_INPUT_RATE, &jin);
+  if (jin_exists) {
+    stats.SetInputRate(json_object_get_double(jin));
+  }
+
+  json_object* jout = nullptr;
+  json_bool jout_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_OUTPUT_RATE, &jout);
+  if (jout_exists) {
+    stats.SetOutputRate(json_object_get_double(jout));
+  }
+
+  ElementStats::proctime_t p50 = 0;
+  json_object* jp50 = nullptr;
+  json_bool jp50_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_PROCTIME_P50, &jp50);
+  if (jp50_exists) {
+    p50 = json_object_get_int64(jp50);
+  }
+
+  ElementStats::proctime_t p95 = 0;
+  json_object* jp95 = nullptr;
+  json_bool jp95_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_PROCTIME_P95, &jp95);
+  if (jp95_exists) {
+    p95 = json_object_get_int64(jp95);
+  }
+
+  ElementStats::proctime_t p99 = 0;
+  json_object* jp99 = nullptr;
+  json_bool jp99_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_PROCTIME_P99, &jp99);
+  if (jp99_exists) {
+    p99 = json_object_get_int64(jp99);
+  }
+  stats.SetProcTime(p50, p95, p99);
+
+  json_object* jqueue = nullptr;
+  json_bool jqueue_exists = json_object_object_get_ex(serialized, FIELD_ELEMENT_QUEUE_FILL, &jqueue);
+  if (jqueue_exists) {
+    stats.SetQueueFill(json_object_get_int(jqueue));
+  }
+
+  *this = ElementStatsInfo(stats);
+  return common::Error();
+}
+
+}  // namespace details
+}  // namespace fastocloud
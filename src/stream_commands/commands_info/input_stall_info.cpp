@@ -0,0 +1,126 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/commands_info/input_stall_info.h"
+
+#include <string>
+
+#define INPUT_STALL_INFO_ID_FIELD "id"
+#define INPUT_STALL_INFO_INPUT_FIELD "input"
+#define INPUT_STALL_INFO_REASON_FIELD "reason"
+#define INPUT_STALL_INFO_RECOVERED_FIELD "recovered"
+#define INPUT_STALL_INFO_TIMESTAMP_FIELD "timestamp"
+#define INPUT_STALL_INFO_DURATION_FIELD "duration"
+
+namespace fastocloud {
+
+InputStallInfo::InputStallInfo()
+    : base_class(), id_(), input_id_(0), reason_(STALL_NO_DATA), recovered_(false), timestamp_(0), duration_(0) {}
+
+InputStallInfo::InputStallInfo(stream_id_t sid,
+                               channel_id_t input_id,
+                               StallReason reason,
+                               bool recovered,
+                               fastotv::timestamp_t timestamp,
+                               fastotv::timestamp_t duration)
+    : base_class(),
+      id_(sid),
+      input_id_(input_id),
+      reason_(reason),
+      recovered_(recovered),
+      timestamp_(timestamp),
+      duration_(duration) {}
+
+stream_id_t InputStallInfo::GetStreamID() const {
+  return id_;
+}
+
+channel_id_t InputStallInfo::GetInputID() const {
+  return input_id_;
+}
+
+StallReason InputStallInfo::GetReason() const {
+  return reason_;
+}
+
+bool InputStallInfo::IsRecovered() const {
+  return recovered_;
+}
+
+fastotv::timestamp_t InputStallInfo::GetTimestamp() const {
+  return timestamp_;
+}
+
+fastotv::timestamp_t InputStallInfo::GetDuration() const {
+  return duration_;
+}
+
+common::Error InputStallInfo::SerializeFields(json_object* out) const {
+  json_object_object_add(out, INPUT_STALL_INFO_ID_FIELD, json_object_new_string(id_.c_str()));
+  json_object_object_add(out, INPUT_STALL_INFO_INPUT_FIELD, json_object_new_int64(input_id_));
+  json_object_object_add(out, INPUT_STALL_INFO_REASON_FIELD, json_object_new_int(reason_));
+  json_object_object_add(out, INPUT_STALL_INFO_RECOVERED_FIELD, json_object_new_boolean(recovered_));
+  json_object_object_add(out, INPUT_STALL_INFO_TIMESTAMP_FIELD, json_object_new_int64(timestamp_));
+  json_object_object_add(out, INPUT_STALL_INFO_DURATION_FIELD, json_object_new_int64(duration_));
+  return common::Error();
+}
+
+common::Error InputStallInfo::DoDeSerialize(json_object* serialized) {
+  json_object* jid = nullptr;
+  json_bool jid_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_ID_FIELD, &jid);
+  if (!jid_exists) {
+    return common::make_error_inval();
+  }
+
+  json_object* jinput = nullptr;
+  json_bool jinput_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_INPUT_FIELD, &jinput);
+  if (!jinput_exists) {
+    return common::make_error_inval();
+  }
+
+  json_object* jreason = nullptr;
+  json_bool jreason_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_REASON_FIELD, &jreason);
+  if (!jreason_exists) {
+    return common::make_error_inval();
+  }
+
+  json_object* jtimestamp = nullptr;
+  json_bool jtimestamp_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_TIMESTAMP_FIELD, &jtimestamp);
+  if (!jtimestamp_exists) {
+    return common::make_error_inval();
+  }
+
+  InputStallInfo inf;
+  inf.id_ = json_object_get_string(jid);
+  inf.input_id_ = json_object_get_int64(jinput);
+  inf.reason_ = static_cast<StallReason>(json_object_get_int(jreason));
+  inf.timestamp_ = json_object_get_int64(jtimestamp);
+
+  json_object* jrecovered = nullptr;
+  json_bool jrecovered_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_RECOVERED_FIELD, &jrecovered);
+  if (jrecovered_exists) {
+    inf.recovered_ = json_object_get_boolean(jrecovered);
+  }
+
+  json_object* jduration = nullptr;
+  json_bool jduration_exists = json_object_object_get_ex(serialized, INPUT_STALL_INFO_DURATION_FIELD, &jduration);
+  if (jduration_exists) {
+    inf.duration_ = json_object_get_int64(jduration);
+  }
+
+  *this = inf;
+  return common::Error();
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,55 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <common/serializer/json_serializer.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+
+// input stall detected or gone, pair of events with same input gives time to recover
+class InputStallInfo : public common::serializer::JsonSerializer<InputStallInfo> {
+ public:
+  typedef JsonSerializer<InputStallInfo> base_class;
+  InputStallInfo();
+  InputStallInfo(stream_id_t sid,
+                 channel_id_t input_id,
+                 StallReason reason,
+                 bool recovered,
+                 fastotv::timestamp_t timestamp,
+                 fastotv::timestamp_t duration);
+
+  stream_id_t GetStreamID() const;
+  channel_id_t GetInputID() const;
+  StallReason GetReason() const;
+  bool IsRecovered() const;
+  fastotv::timestamp_t GetTimestamp() const;  // utc msec of event
+  fastotv::timestamp_t GetDuration() const;   // msec, without data when stalled, stall length when recovered
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  stream_id_t id_;
+  channel_id_t input_id_;
+  StallReason reason_;
+  bool recovered_;
+  fastotv::timestamp_t timestamp_;
+  fastotv::timestamp_t duration_;
+};
+
+}  // namespace fastocloud
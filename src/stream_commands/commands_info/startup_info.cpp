@@ -0,0 +1,144 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/commands_info/startup_info.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#define STARTUP_INFO_ID_FIELD "id"
+#define STARTUP_INFO_RESTARTS_FIELD "restarts"
+#define STARTUP_INFO_DURATION_FIELD "duration"
+#define STARTUP_INFO_PHASES_FIELD "phases"
+
+namespace fastocloud {
+
+StartupInfo::StartupInfo() : base_class(), id_(), restarts_(0), timing_() {}
+
+StartupInfo::StartupInfo(stream_id_t sid, size_t restarts, const StartupTiming& timing)
+    : base_class(), id_(sid), restarts_(restarts), timing_(timing) {}
+
+stream_id_t StartupInfo::GetStreamID() const {
+  return id_;
+}
+
+size_t StartupInfo::GetRestarts() const {
+  return restarts_;
+}
+
+StartupTiming StartupInfo::GetTiming() const {
+  return timing_;
+}
+
+common::Error StartupInfo::SerializeTrace(std::string* out) const {
+  if (!out || timing_.IsEmpty()) {
+    return common::make_error_inval();
+  }
+
+  // phases may end out of order (input buffers arrive while pausing), every span starts at previous mark in time
+  std::vector<std::pair<StartupTiming::mono_usec_t, StartupPhase>> marks;
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    const StartupPhase phase = static_cast<StartupPhase>(i);
+    if (timing_.IsMarked(phase)) {
+      marks.push_back(std::make_pair(timing_.Get(phase), phase));
+    }
+  }
+  std::stable_sort(marks.begin(), marks.end());
+
+  json_object* jevents = json_object_new_array();
+  json_object* jprocess = json_object_new_object();
+  json_object_object_add(jprocess, "name", json_object_new_string("process_name"));
+  json_object_object_add(jprocess, "ph", json_object_new_string("M"));
+  json_object_object_add(jprocess, "pid", json_object_new_int(1));
+  json_object* jprocess_args = json_object_new_object();
+  json_object_object_add(jprocess_args, "name", json_object_new_string(id_.c_str()));
+  json_object_object_add(jprocess, "args", jprocess_args);
+  json_object_array_add(jevents, jprocess);
+
+  const StartupTiming::mono_usec_t origin = marks.front().first;
+  for (size_t i = 1; i < marks.size(); ++i) {
+    json_object* jevent = json_object_new_object();
+    const std::string name = common::ConvertToString(marks[i].second);
+    json_object_object_add(jevent, "name", json_object_new_string(name.c_str()));
+    json_object_object_add(jevent, "cat", json_object_new_string("startup"));
+    json_object_object_add(jevent, "ph", json_object_new_string("X"));
+    json_object_object_add(jevent, "ts", json_object_new_int64(marks[i - 1].first - origin));
+    json_object_object_add(jevent, "dur", json_object_new_int64(marks[i].first - marks[i - 1].first));
+    json_object_object_add(jevent, "pid", json_object_new_int(1));
+    json_object_object_add(jevent, "tid", json_object_new_int(1));
+    json_object* jargs = json_object_new_object();
+    json_object_object_add(jargs, STARTUP_INFO_RESTARTS_FIELD, json_object_new_int64(restarts_));
+    json_object_object_add(jevent, "args", jargs);
+    json_object_array_add(jevents, jevent);
+  }
+
+  json_object* jtrace = json_object_new_object();
+  json_object_object_add(jtrace, "traceEvents", jevents);
+  json_object_object_add(jtrace, "displayTimeUnit", json_object_new_string("ms"));
+  *out = json_object_to_json_string_ext(jtrace, JSON_C_TO_STRING_PLAIN);
+  json_object_put(jtrace);
+  return common::Error();
+}
+
+common::Error StartupInfo::SerializeFields(json_object* out) const {
+  json_object_object_add(out, STARTUP_INFO_ID_FIELD, json_object_new_string(id_.c_str()));
+  json_object_object_add(out, STARTUP_INFO_RESTARTS_FIELD, json_object_new_int64(restarts_));
+  json_object_object_add(out, STARTUP_INFO_DURATION_FIELD, json_object_new_int64(timing_.GetDuration()));
+
+  json_object* jphases = json_object_new_object();
+  for (int i = 0; i < STARTUP_PHASES_COUNT; ++i) {
+    const StartupPhase phase = static_cast<StartupPhase>(i);
+    if (timing_.IsMarked(phase)) {
+      const std::string name = common::ConvertToString(phase);
+      json_object_object_add(jphases, name.c_str(), json_object_new_int64(timing_.Get(phase)));
+    }
+  }
+  json_object_object_add(out, STARTUP_INFO_PHASES_FIELD, jphases);
+  return common::Error();
+}
+
+common::Error StartupInfo::DoDeSerialize(json_object* serialized) {
+  json_object* jid = nullptr;
+  json_bool jid_exists = json_object_object_get_ex(serialized, STARTUP_INFO_ID_FIELD, &jid);
+  if (!jid_exists) {
+    return common::make_error_inval();
+  }
+
+  json_object* jphases = nullptr;
+  json_bool jphases_exists = json_object_object_get_ex(serialized, STARTUP_INFO_PHASES_FIELD, &jphases);
+  if (!jphases_exists || !json_object_is_type(jphases, json_type_object)) {
+    return common::make_error_inval();
+  }
+
+  StartupInfo inf;
+  inf.id_ = json_object_get_string(jid);
+  json_object_object_foreach(jphases, key, val) {
+    StartupPhase phase;
+    if (common::ConvertFromString(key, &phase)) {  // unknown phases of newer streams are skipped
+      inf.timing_.Set(phase, json_object_get_int64(val));
+    }
+  }
+
+  json_object* jrestarts = nullptr;
+  json_bool jrestarts_exists = json_object_object_get_ex(serialized, STARTUP_INFO_RESTARTS_FIELD, &jrestarts);
+  if (jrestarts_exists) {
+    inf.restarts_ = json_object_get_int64(jrestarts);
+  }
+
+  *this = inf;
+  return common::Error();
+}
+
+}  // namespace fastocloud
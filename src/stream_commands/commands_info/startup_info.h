@@ -0,0 +1,50 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include <common/serializer/json_serializer.h>
+
+#include "base/startup_timing.h"
+#include "base/types.h"
+
+namespace fastocloud {
+
+// timings of one stream start, sent when first segment is written or pipeline exits before that
+class StartupInfo : public common::serializer::JsonSerializer<StartupInfo> {
+ public:
+  typedef JsonSerializer<StartupInfo> base_class;
+  StartupInfo();
+  StartupInfo(stream_id_t sid, size_t restarts, const StartupTiming& timing);
+
+  stream_id_t GetStreamID() const;
+  size_t GetRestarts() const;
+  StartupTiming GetTiming() const;
+
+  // chrome trace event format, opened by chrome://tracing or perfetto
+  common::Error SerializeTrace(std::string* out) const WARN_UNUSED_RESULT;
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  stream_id_t id_;
+  size_t restarts_;
+  StartupTiming timing_;
+};
+
+}  // namespace fastocloud
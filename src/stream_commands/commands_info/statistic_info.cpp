@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include "stream_commands/commands_info/details/channel_stats_info.h"
+#include "stream_commands/commands_info/details/element_stats_info.h"
 
 #define STREAM_ID_FIELD "id"
 #define STREAM_TYPE_FIELD "type"
@@ -31,6 +32,7 @@
 
 #define STREAM_INPUT_STREAMS_FIELD "input_streams"
 #define STREAM_OUTPUT_STREAMS_FIELD "output_streams"
+#define STREAM_ELEMENTS_FIELD "elements"
 
 namespace fastocloud {
 
@@ -93,6 +95,20 @@ common::Error StatisticInfo::SerializeFields(json_object* out) const {
   }
   json_object_object_add(out, STREAM_OUTPUT_STREAMS_FIELD, joutput_streams);
 
+  if (!stream_struct_.elements.empty()) {
+    json_object* jelements = json_object_new_array();
+    for (const auto& element : stream_struct_.elements) {
+      json_object* jelement = nullptr;
+      details::ElementStatsInfo einf(element);
+      common::Error err = einf.Serialize(&jelement);
+      if (err) {
+        continue;
+      }
+      json_object_array_add(jelements, jelement);
+    }
+    json_object_object_add(out, STREAM_ELEMENTS_FIELD, jelements);
+  }
+
   json_object_object_add(out, STREAM_LOOP_START_TIME_FIELD, json_object_new_int64(stream_struct_.loop_start_time));
   json_object_object_add(out, STREAM_RSS_FIELD, json_object_new_int64(rss_bytes_));
   json_object_object_add(out, STREAM_CPU_FIELD, json_object_new_double(cpu_load_));
@@ -153,6 +169,23 @@ common::Error StatisticInfo::DoDeSerialize(json_object* serialized) {
     }
   }
 
+  elements_stats_t elements;
+  json_object* jelements = nullptr;
+  json_bool jelements_exists = json_object_object_get_ex(serialized, STREAM_ELEMENTS_FIELD, &jelements);
+  if (jelements_exists) {
+    size_t len = json_object_array_length(jelements);
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jelement = json_object_array_get_idx(jelements, i);
+      details::ElementStatsInfo einf;
+      common::Error err = einf.DeSerialize(jelement);
+      if (err) {
+        continue;
+      }
+
+      elements.push_back(einf.GetElementStats());
+    }
+  }
+
   StreamStatus st = NEW;
   json_object* jstatus = nullptr;
   json_bool jstatus_exists = json_object_object_get_ex(serialized, STREAM_STATUS_FIELD, &jstatus);
@@ -212,6 +245,7 @@ common::Error StatisticInfo::DoDeSerialize(json_object* serialized) {
 
   StreamStruct strct(cid, type, st, input, output, start_time, loop_start_time, restarts);
   strct.idle_time = idle_time;
+  strct.elements = elements;
   *this = StatisticInfo(strct, cpu_load, rss, time);
   return common::Error();
 }
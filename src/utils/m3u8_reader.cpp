@@ -14,172 +14,239 @@
 
 #include "utils/m3u8_reader.h"
 
-#include <regex>
-#include <string>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
 
-#include <common/convert2string.h>
+#include <string>
 
 #define CHUNK_EXT ".ts"
-#define CHUNK_EXT_RE "\\" CHUNK_EXT
-
-#define M3U8_HEADER "#EXTM3U"
-#define M3U8_VERSION "#EXT-X-VERSION:%d"
-#define M3U8_ALLOW_CACHE "#EXT-X-ALLOW-CACHE:%s"
-#define M3U8_MEDIA_SEQUENCE "#EXT-X-MEDIA-SEQUENCE:%d"
-#define M3U8_TARGET_DURATION "#EXT-X-TARGETDURATION:%d"
-#define M3U8_CHUNK_HEADER "#EXTINF:%lf"
+
+#define M3U8_VERSION "#EXT-X-VERSION:"
+#define M3U8_ALLOW_CACHE "#EXT-X-ALLOW-CACHE:"
+#define M3U8_MEDIA_SEQUENCE "#EXT-X-MEDIA-SEQUENCE:"
+#define M3U8_TARGET_DURATION "#EXT-X-TARGETDURATION:"
+#define M3U8_CHUNK_HEADER "#EXTINF:"
 #define M3U8_FOOTER "#EXT-X-ENDLIST"
-#define SECOND 1000000000
-#define MAX_LINE 255
+#define M3U8_STREAM_INF "#EXT-X-STREAM-INF:"
 
 namespace {
 
-bool GetNonEmptyLine(FILE* file, std::string* line) {
-  if (!line) {
+struct Line {
+  const char* data;
+  size_t size;
+
+  bool Equals(const char* str, size_t len) const { return size == len && memcmp(data, str, len) == 0; }
+  bool GetTagValue(const char* tag, size_t len, Line* value) const {
+    if (size < len || memcmp(data, tag, len) != 0) {
+      return false;
+    }
+    *value = {data + len, size - len};
+    return true;
+  }
+};
+
+#define LINE_EQUALS(line, str) (line).Equals(str, sizeof(str) - 1)
+#define LINE_TAG_VALUE(line, tag, value) (line).GetTagValue(tag, sizeof(tag) - 1, value)
+
+// next non empty line without surrounding spaces, any length, \n or \r\n endings
+bool GetNonEmptyLine(const char** pos, const char* end, Line* line) {
+  const char* cur = *pos;
+  while (cur < end) {
+    const char* eol = static_cast<const char*>(memchr(cur, '\n', end - cur));
+    if (!eol) {
+      eol = end;
+    }
+
+    const char* first = cur;
+    const char* last = eol;
+    cur = eol == end ? end : eol + 1;
+    while (first < last && isspace(static_cast<unsigned char>(*first))) {
+      first++;
+    }
+    while (last > first && isspace(static_cast<unsigned char>(*(last - 1)))) {
+      last--;
+    }
+    if (first != last) {
+      *pos = cur;
+      *line = {first, static_cast<size_t>(last - first)};
+      return true;
+    }
+  }
+
+  *pos = end;
+  return false;
+}
+
+bool ParseInt(const Line& value, int* out) {
+  if (value.size == 0 || value.size > 9) {
     return false;
   }
 
-  char t[MAX_LINE] = {0};
-  while (true) {
-    if (!fgets(t, MAX_LINE, file)) {
+  int result = 0;
+  for (size_t i = 0; i < value.size; ++i) {
+    if (!isdigit(static_cast<unsigned char>(value.data[i]))) {
       return false;
     }
+    result = result * 10 + (value.data[i] - '0');
+  }
+  *out = result;
+  return true;
+}
 
-    auto it = std::find_if(std::begin(t), std::end(t), [](char c) { return !std::isspace(c); });
-    if (it != std::end(t) && *it != 0) {
-      *line = t;
-      return true;
+// #EXTINF:<duration>,[<title>]
+bool ParseDuration(const Line& value, double* out) {
+  double result = 0;
+  double scale = 0;
+  size_t len = 0;
+  for (; len < value.size && value.data[len] != ','; ++len) {
+    const char c = value.data[len];
+    if (c == '.' && scale == 0) {
+      scale = 1;
+    } else if (isdigit(static_cast<unsigned char>(c))) {
+      result = result * 10 + (c - '0');
+      scale *= 10;
+    } else {
+      return false;
     }
   }
+  if (len == 0 || len == value.size) {
+    return false;
+  }
+
+  *out = scale > 1 ? result / scale : result;
+  return true;
+}
+
+// index is the number right before extension: 1497615343667_segment10012.ts
+bool ParseChunkIndex(const Line& uri, uint64_t* out) {
+  const size_t ext_size = sizeof(CHUNK_EXT) - 1;
+  if (uri.size <= ext_size || memcmp(uri.data + uri.size - ext_size, CHUNK_EXT, ext_size) != 0) {
+    return false;
+  }
+
+  const size_t end = uri.size - ext_size;
+  size_t start = end;
+  while (start > 0 && isdigit(static_cast<unsigned char>(uri.data[start - 1]))) {
+    start--;
+  }
+  if (start == end || end - start > 19) {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (size_t i = start; i < end; ++i) {
+    result = result * 10 + (uri.data[i] - '0');
+  }
+  *out = result;
+  return true;
 }
 
-void RemoveTrailingSpaces(std::string* str) {
-  if (!str || str->empty()) {
-    return;
+bool ReadWholeFile(const std::string& path, std::string* data) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
   }
-  while (std::isspace(str->back())) {
-    str->pop_back();
+
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    size = ftell(file);
   }
+  if (size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    fclose(file);
+    return false;
+  }
+
+  std::string result(size, 0);
+  const size_t readed = size ? fread(&result[0], 1, size, file) : 0;
+  fclose(file);
+  result.resize(readed);  // file was truncated while reading
+  data->swap(result);
+  return true;
 }
 }  // namespace
 
 namespace fastocloud {
 namespace utils {
 
-M3u8Reader::M3u8Reader() : version_(-1), allow_cache_(false), media_sequence_(-1), target_duration_(-1), chunks_() {}
+M3u8Reader::M3u8Reader()
+    : version_(-1), allow_cache_(false), media_sequence_(-1), target_duration_(-1), chunks_(), variants_() {}
 
 bool M3u8Reader::Parse(const std::string& path) {
-  FILE* file = fopen(path.c_str(), "r");
-  return ParseFile(file);
+  Clear();
+
+  std::string data;
+  if (!ReadWholeFile(path, &data)) {
+    return false;
+  }
+  return ParseData(data.data(), data.size());
 }
 
 bool M3u8Reader::Parse(const common::file_system::ascii_file_string_path& path) {
-  const std::string filepath = path.GetPath();
-  FILE* file = fopen(filepath.c_str(), "r");
-  return ParseFile(file);
+  return Parse(path.GetPath());
 }
 
-bool M3u8Reader::ParseFile(FILE* file) {
-  static const std::regex m3u8_version("^#EXT-X-VERSION:([0-9]+)$");
-  static const std::regex m3u8_allow_cache("^#EXT-X-ALLOW-CACHE:([A-Z]+)$");
-  static const std::regex m3u8_media_sequence("^#EXT-X-MEDIA-SEQUENCE:([0-9]+)$");
-  static const std::regex m3u8_target_duration("^#EXT-X-TARGETDURATION:([0-9]+)$");
-
+bool M3u8Reader::ParseData(const char* data, size_t size) {
   Clear();
 
-  if (!file) {
+  if (!data) {
     return false;
   }
 
-  std::string line;
-  std::smatch match;
-  while (GetNonEmptyLine(file, &line)) {
-    RemoveTrailingSpaces(&line);
-    if (line == M3U8_HEADER) {
-      continue;
-    } else if (std::regex_match(line, match, m3u8_version)) {
-      int version;
-      if (!common::ConvertFromString(match.str(1), &version)) {
+  const char* pos = data;
+  const char* end = data + size;
+  bool has_duration = false;
+  bool has_variant = false;
+  double duration = 0;
+  Line line;
+  Line value;
+  while (GetNonEmptyLine(&pos, end, &line)) {
+    if (line.data[0] != '#' && has_variant) {  // variant playlist uri
+      variants_.push_back(std::string(line.data, line.size));
+      has_variant = false;
+    } else if (line.data[0] != '#') {  // chunk uri
+      uint64_t index;
+      if (!has_duration || !ParseChunkIndex(line, &index)) {
         return false;
       }
-      version_ = version;
-    } else if (std::regex_match(line, match, m3u8_allow_cache)) {
-      const std::string allow_cache = match.str(1);
-      if (allow_cache == "YES") {
-        allow_cache_ = true;
-      } else if (allow_cache == "NO") {
-        allow_cache_ = false;
-      } else {
+      const uint64_t duration_ns = static_cast<uint64_t>(duration * ChunkInfo::SECOND);
+      chunks_.push_back(ChunkInfo(std::string(line.data, line.size), duration_ns, index));
+      has_duration = false;
+    } else if (LINE_TAG_VALUE(line, M3U8_CHUNK_HEADER, &value)) {
+      if (!ParseDuration(value, &duration)) {
         return false;
       }
-      continue;
-    } else if (std::regex_match(line, match, m3u8_media_sequence)) {
-      int media_sequence;
-      if (!common::ConvertFromString(match.str(1), &media_sequence)) {
+      has_duration = true;
+    } else if (LINE_TAG_VALUE(line, M3U8_STREAM_INF, &value)) {
+      has_variant = true;
+    } else if (LINE_EQUALS(line, M3U8_FOOTER)) {
+      return true;
+    } else if (LINE_TAG_VALUE(line, M3U8_MEDIA_SEQUENCE, &value)) {
+      if (!ParseInt(value, &media_sequence_)) {
         return false;
       }
-      media_sequence_ = media_sequence;
-    } else if (std::regex_match(line, match, m3u8_target_duration)) {
-      int target_duration;
-      if (!common::ConvertFromString(match.str(1), &target_duration)) {
+    } else if (LINE_TAG_VALUE(line, M3U8_TARGET_DURATION, &value)) {
+      if (!ParseInt(value, &target_duration_)) {
+        return false;
+      }
+    } else if (LINE_TAG_VALUE(line, M3U8_VERSION, &value)) {
+      if (!ParseInt(value, &version_)) {
+        return false;
+      }
+    } else if (LINE_TAG_VALUE(line, M3U8_ALLOW_CACHE, &value)) {
+      if (LINE_EQUALS(value, "YES")) {
+        allow_cache_ = true;
+      } else if (LINE_EQUALS(value, "NO")) {
+        allow_cache_ = false;
+      } else {
         return false;
       }
-      target_duration_ = target_duration;
-    } else {
-      long off = ftell(file);
-      fseek(file, off - line.length() - 1, SEEK_SET);
-      return ParseChunks(file);
     }
+    // #EXTM3U, #EXT-X-PROGRAM-DATE-TIME, #EXT-X-PLAYLIST-TYPE and other tags or comments are skipped
   }
 
-  return false;
-}
-
-bool M3u8Reader::ParseChunks(FILE* file) {
-  if (!file) {
-    return false;
-  }
-
-  std::string header_line, chunk_line;
-  while (true) {
-    if (!GetNonEmptyLine(file, &header_line)) {
-      return !chunks_.empty();
-    }
-    RemoveTrailingSpaces(&header_line);
-
-    if (header_line == M3U8_FOOTER) {
-      return true;
-    }
-
-    if (!GetNonEmptyLine(file, &chunk_line)) {
-      return false;
-    }
-    RemoveTrailingSpaces(&chunk_line);
-
-    double duration = 0;
-    uint64_t index = 0;
-
-    static const std::regex m3u8_chunk_header_re("^#EXTINF:([0-9.]+),$");
-    static const std::regex m3u8_chunk_re("^[A-Za-z0-9_]*?([0-9]+)" CHUNK_EXT_RE "$");
-
-    std::smatch header_match;
-    if (!std::regex_match(header_line, header_match, m3u8_chunk_header_re)) {
-      return false;
-    }
-    if (!common::ConvertFromString(header_match.str(1), &duration)) {
-      return false;
-    }
-    std::smatch chunk_match;
-    if (!std::regex_match(chunk_line, chunk_match, m3u8_chunk_re)) {
-      return false;
-    }
-    if (!common::ConvertFromString(chunk_match.str(1), &index)) {
-      return false;
-    }
-
-    ChunkInfo chunk(chunk_line, static_cast<uint64_t>(duration * SECOND), index);
-    chunks_.push_back(chunk);
-  }
+  // playlist which is still growing, a not finished tail entry is ignored
+  return !chunks_.empty() || !variants_.empty();
 }
 
 int M3u8Reader::GetVersion() const {
@@ -202,6 +269,10 @@ std::vector<ChunkInfo> M3u8Reader::GetChunks() const {
   return chunks_;
 }
 
+std::vector<std::string> M3u8Reader::GetVariants() const {
+  return variants_;
+}
+
 void M3u8Reader::Clear() {
   version_ = -1;
   allow_cache_ = false;
@@ -209,6 +280,7 @@ void M3u8Reader::Clear() {
   target_duration_ = -1;
 
   chunks_.clear();
+  variants_.clear();
 }
 
 }  // namespace utils
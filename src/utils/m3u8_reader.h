@@ -30,25 +30,25 @@ class M3u8Reader {
 
   bool Parse(const std::string& path);
   bool Parse(const common::file_system::ascii_file_string_path& path);
+  bool ParseData(const char* data, size_t size);
 
   int GetVersion() const;
   bool IsAllowCache() const;
   int GetMediaSequence() const;
   int GetTargetDuration() const;
   std::vector<ChunkInfo> GetChunks() const;
+  std::vector<std::string> GetVariants() const;  // playlists listed by master playlist
 
  private:
   void Clear();
 
-  bool ParseFile(FILE* file);
-  bool ParseChunks(FILE* file);
-
   int version_;
   bool allow_cache_;
   int media_sequence_;
   int target_duration_;
 
   std::vector<ChunkInfo> chunks_;
+  std::vector<std::string> variants_;
 };
 
 }  // namespace utils
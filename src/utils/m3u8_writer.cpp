@@ -14,23 +14,108 @@
 
 #include "utils/m3u8_writer.h"
 
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <common/file_system/file_system.h>
+
 #include "utils/chunk_info.h"
 
+#define M3U8_FOOTER "#EXT-X-ENDLIST"
+#define M3U8_HEADER_FMT \
+  "#EXTM3U\n#EXT-X-MEDIA-SEQUENCE:%llu\n#EXT-X-ALLOW-CACHE:YES\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:%llu\n"
+#define M3U8_EVENT_TYPE "#EXT-X-PLAYLIST-TYPE:EVENT\n"
+#define M3U8_FOOTER_TAIL_SIZE 64
+#define M3U8_MASTER_HEADER "#EXTM3U\n#EXT-X-VERSION:3\n"
+#define M3U8_STREAM_INF_FMT "#EXT-X-STREAM-INF:BANDWIDTH=%llu,RESOLUTION=%dx%d\n%s\n"
+
 namespace fastocloud {
 namespace utils {
+namespace {
+// the playlist is reopened after stop, strip footer so new chunks follow the old ones
+common::ErrnoError RemoveFooter(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return common::make_errno_error(errno);
+  }
+
+  char tail[M3U8_FOOTER_TAIL_SIZE + 1] = {0};
+  long size = 0;
+  long tail_size = 0;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0) {
+    tail_size = size < M3U8_FOOTER_TAIL_SIZE ? size : M3U8_FOOTER_TAIL_SIZE;
+    if (fseek(file, size - tail_size, SEEK_SET) != 0 || fread(tail, 1, tail_size, file) != size_t(tail_size)) {
+      tail_size = 0;
+    }
+  }
+  fclose(file);
+
+  long end = tail_size;
+  while (end > 0 && isspace(static_cast<unsigned char>(tail[end - 1]))) {
+    end--;
+  }
+  const long footer_size = sizeof(M3U8_FOOTER) - 1;
+  if (end < footer_size || strncmp(tail + end - footer_size, M3U8_FOOTER, footer_size) != 0) {
+    return common::ErrnoError();
+  }
+
+  if (truncate(path.c_str(), size - tail_size + end - footer_size) != 0) {
+    return common::make_errno_error(errno);
+  }
+  return common::ErrnoError();
+}
+}  // namespace
 
 M3u8Writer::M3u8Writer() : file_() {}
 
+common::ErrnoError M3u8Writer::OpenAppend(const common::file_system::ascii_file_string_path& file_path,
+                                          uint64_t first_index,
+                                          size_t target_duration) {
+  const std::string path = file_path.GetPath();
+  if (common::file_system::is_file_exist(path)) {
+    common::ErrnoError err = RemoveFooter(path);
+    if (err) {
+      return err;
+    }
+    return file_.Open(file_path, common::file_system::File::FLAG_OPEN | common::file_system::File::FLAG_APPEND);
+  }
+
+  // players never see a playlist without header
+  const common::file_system::ascii_file_string_path tmp_path(path + ".tmp");
+  common::ErrnoError err =
+      file_.Open(tmp_path, common::file_system::File::FLAG_CREATE_ALWAYS | common::file_system::File::FLAG_WRITE);
+  if (err) {
+    return err;
+  }
+
+  err = WriteEventHeader(first_index, target_duration);
+  ignore_result(file_.Close());
+  if (err) {
+    return err;
+  }
+
+  if (rename(tmp_path.GetPath().c_str(), path.c_str()) != 0) {
+    return common::make_errno_error(errno);
+  }
+  return file_.Open(file_path, common::file_system::File::FLAG_OPEN | common::file_system::File::FLAG_APPEND);
+}
+
 common::ErrnoError M3u8Writer::Open(const common::file_system::ascii_file_string_path& file_path, uint32_t flags) {
   return file_.Open(file_path, flags);
 }
 
 common::ErrnoError M3u8Writer::WriteHeader(uint64_t first_index, size_t target_duration) {
   size_t writed;
-  return file_.WriteBuffer(common::MemSPrintf("#EXTM3U\n#EXT-X-MEDIA-SEQUENCE:%llu\n#EXT-X-ALLOW-"
-                                              "CACHE:YES\n#EXT-X-VERSION:3\n#EXT-X-"
-                                              "TARGETDURATION:%llu\n",
-                                              first_index, target_duration),
+  return file_.WriteBuffer(common::MemSPrintf(M3U8_HEADER_FMT, first_index, target_duration), &writed);
+}
+
+common::ErrnoError M3u8Writer::WriteEventHeader(uint64_t first_index, size_t target_duration) {
+  size_t writed;
+  return file_.WriteBuffer(common::MemSPrintf(M3U8_HEADER_FMT M3U8_EVENT_TYPE, first_index, target_duration),
                            &writed);
 }
 
@@ -40,9 +125,19 @@ common::ErrnoError M3u8Writer::WriteLine(const ChunkInfo& chunk) {
   return file_.WriteBuffer(common::MemSPrintf("#EXTINF:%.2f,\n%s\n", ftime, chunk.path), &writed);
 }
 
+common::ErrnoError M3u8Writer::WriteMasterHeader() {
+  size_t writed;
+  return file_.WriteBuffer(M3U8_MASTER_HEADER, &writed);
+}
+
+common::ErrnoError M3u8Writer::WriteVariant(uint64_t bandwidth, int width, int height, const std::string& uri) {
+  size_t writed;
+  return file_.WriteBuffer(common::MemSPrintf(M3U8_STREAM_INF_FMT, bandwidth, width, height, uri), &writed);
+}
+
 common::ErrnoError M3u8Writer::WriteFooter() {
   size_t writed;
-  return file_.WriteBuffer("#EXT-X-ENDLIST", &writed);
+  return file_.WriteBuffer(M3U8_FOOTER, &writed);
 }
 
 common::ErrnoError M3u8Writer::Close() {
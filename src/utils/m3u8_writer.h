@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/file_system/file.h>
 
 namespace fastocloud {
@@ -28,8 +30,19 @@ class M3u8Writer {
   common::ErrnoError Open(const common::file_system::ascii_file_string_path& file_path,
                           uint32_t flags) WARN_UNUSED_RESULT;
 
+  // event playlist which grows while recording: the header is created once and moved in place,
+  // an existing playlist is reopened without its footer, chunks are appended with WriteLine
+  common::ErrnoError OpenAppend(const common::file_system::ascii_file_string_path& file_path,
+                                uint64_t first_index,
+                                size_t target_duration) WARN_UNUSED_RESULT;
+
   common::ErrnoError WriteHeader(uint64_t first_index, size_t target_duration) WARN_UNUSED_RESULT;
+  common::ErrnoError WriteEventHeader(uint64_t first_index, size_t target_duration) WARN_UNUSED_RESULT;
   common::ErrnoError WriteLine(const ChunkInfo& chunks) WARN_UNUSED_RESULT;
+
+  // master playlist of adaptive stream, one variant per rendition, bandwidth in bits per second
+  common::ErrnoError WriteMasterHeader() WARN_UNUSED_RESULT;
+  common::ErrnoError WriteVariant(uint64_t bandwidth, int width, int height, const std::string& uri) WARN_UNUSED_RESULT;
   common::ErrnoError WriteFooter() WARN_UNUSED_RESULT;
   common::ErrnoError Close() WARN_UNUSED_RESULT;
 
@@ -0,0 +1,275 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Load generator for http/vods/cods servers:
+// http_load_bench <host> <port> <directory> [connections] [seconds]
+// Requests every .m3u8/.ts file of directory (relative to http root) over keep-alive connections,
+// prints requests/sec and latency percentiles.
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+struct BenchResult {
+  BenchResult() : latencies_usec(), bytes(0), errors(0) {}
+
+  std::vector<uint64_t> latencies_usec;
+  uint64_t bytes;
+  uint64_t errors;
+};
+
+bool HasExtension(const std::string& name, const char* ext) {
+  const size_t ext_len = strlen(ext);
+  return name.size() > ext_len && strcasecmp(name.c_str() + name.size() - ext_len, ext) == 0;
+}
+
+// paths of files relative to http root, directory is both local path and path of url
+std::vector<std::string> ScanFiles(const std::string& dir) {
+  std::vector<std::string> result;
+  std::string url_dir = dir;
+  while (url_dir.compare(0, 2, "./") == 0) {
+    url_dir.erase(0, 2);
+  }
+  while (!url_dir.empty() && (url_dir.back() == '/' || url_dir == ".")) {
+    url_dir.pop_back();
+  }
+  const std::string prefix = url_dir.empty() ? std::string() : url_dir + "/";
+  DIR* dirp = opendir(dir.c_str());
+  if (!dirp) {
+    return result;
+  }
+
+  struct dirent* dent;
+  while ((dent = readdir(dirp)) != nullptr) {
+    const std::string name = dent->d_name;
+    if (HasExtension(name, ".m3u8") || HasExtension(name, ".ts")) {
+      result.push_back(prefix + name);
+    }
+  }
+  closedir(dirp);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+int Connect(const std::string& host, const std::string& port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) {
+    return -1;
+  }
+
+  int fd = -1;
+  for (struct addrinfo* it = res; it; it = it->ai_next) {
+    fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+    if (fd == -1) {
+      continue;
+    }
+    if (connect(fd, it->ai_addr, it->ai_addrlen) == 0) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t res = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (res <= 0) {
+      return false;
+    }
+    sent += res;
+  }
+  return true;
+}
+
+// reads one response, returns body size or -1
+ssize_t ReadResponse(int fd, std::string* pending, bool* keep_alive) {
+  char buff[16 * 1024];
+  size_t header_end = std::string::npos;
+  while ((header_end = pending->find("\r\n\r\n")) == std::string::npos) {
+    ssize_t res = recv(fd, buff, sizeof(buff), 0);
+    if (res <= 0) {
+      return -1;
+    }
+    pending->append(buff, res);
+  }
+
+  const std::string headers = pending->substr(0, header_end);
+  if (headers.compare(0, 5, "HTTP/") != 0) {
+    return -1;
+  }
+
+  const int status = atoi(headers.c_str() + headers.find(' ') + 1);
+  size_t content_length = 0;
+  *keep_alive = false;
+  size_t pos = 0;
+  while ((pos = headers.find("\r\n", pos)) != std::string::npos) {
+    pos += 2;
+    const size_t eol = headers.find("\r\n", pos);
+    std::string line = headers.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
+    std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+    if (line.compare(0, 15, "content-length:") == 0) {
+      content_length = strtoull(line.c_str() + 15, nullptr, 10);
+    } else if (line.compare(0, 11, "connection:") == 0) {
+      *keep_alive = line.find("keep-alive") != std::string::npos;
+    }
+  }
+
+  pending->erase(0, header_end + 4);
+  while (pending->size() < content_length) {
+    ssize_t res = recv(fd, buff, sizeof(buff), 0);
+    if (res <= 0) {
+      return -1;
+    }
+    pending->append(buff, res);
+  }
+  pending->erase(0, content_length);
+  if (status != 200) {
+    return -1;
+  }
+  return content_length;
+}
+
+void RunConnection(const std::string& host,
+                   const std::string& port,
+                   const std::vector<std::string>& files,
+                   size_t offset,
+                   bench_clock_t::time_point deadline,
+                   BenchResult* result) {
+  int fd = -1;
+  std::string pending;
+  for (size_t i = offset; bench_clock_t::now() < deadline; ++i) {
+    if (fd == -1) {
+      fd = Connect(host, port);
+      if (fd == -1) {
+        result->errors++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        continue;
+      }
+      pending.clear();
+    }
+
+    const std::string& file = files[i % files.size()];
+    const std::string request = "GET /" + file + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: Keep-Alive\r\n\r\n";
+    const bench_clock_t::time_point start = bench_clock_t::now();
+    bool keep_alive = false;
+    ssize_t body = SendAll(fd, request) ? ReadResponse(fd, &pending, &keep_alive) : -1;
+    const bench_clock_t::time_point stop = bench_clock_t::now();
+    if (body < 0) {
+      result->errors++;
+      close(fd);
+      fd = -1;
+      continue;
+    }
+
+    result->latencies_usec.push_back(std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+    result->bytes += body;
+    if (!keep_alive) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, double pct) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(pct / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s <host> <port> <directory> [connections] [seconds]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::string host = argv[1];
+  const std::string port = argv[2];
+  const std::vector<std::string> files = ScanFiles(argv[3]);
+  const size_t connections = argc > 4 ? strtoul(argv[4], nullptr, 10) : 64;
+  const unsigned seconds = argc > 5 ? strtoul(argv[5], nullptr, 10) : 10;
+  if (files.empty() || connections == 0 || seconds == 0) {
+    fprintf(stderr, "Nothing to request, check directory, connections and seconds\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BenchResult> results(connections);
+  std::vector<std::thread> threads;
+  const bench_clock_t::time_point start = bench_clock_t::now();
+  const bench_clock_t::time_point deadline = start + std::chrono::seconds(seconds);
+  for (size_t i = 0; i < connections; ++i) {
+    threads.push_back(std::thread(RunConnection, host, port, std::cref(files), i, deadline, &results[i]));
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  const double elapsed = std::chrono::duration<double>(bench_clock_t::now() - start).count();
+
+  std::vector<uint64_t> latencies;
+  uint64_t bytes = 0;
+  uint64_t errors = 0;
+  for (const BenchResult& res : results) {
+    latencies.insert(latencies.end(), res.latencies_usec.begin(), res.latencies_usec.end());
+    bytes += res.bytes;
+    errors += res.errors;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  printf("files: %zu, connections: %zu, duration: %.2f s\n", files.size(), connections, elapsed);
+  printf("requests: %zu, errors: %llu\n", latencies.size(), static_cast<unsigned long long>(errors));
+  printf("requests/sec: %.1f, MB/sec: %.2f\n", latencies.size() / elapsed, bytes / elapsed / (1024 * 1024));
+  printf("latency usec p50: %llu, p90: %llu, p99: %llu, max: %llu\n",
+         static_cast<unsigned long long>(Percentile(latencies, 50)),
+         static_cast<unsigned long long>(Percentile(latencies, 90)),
+         static_cast<unsigned long long>(Percentile(latencies, 99)),
+         static_cast<unsigned long long>(latencies.empty() ? 0 : latencies.back()));
+  return errors && latencies.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Streams statistics broadcast simulation:
+// stats_broadcast_bench [streams] [seconds]
+// Every stream reports each report_delay_sec (staggered), bandwidth fluctuates, status rarely changes.
+// Prints payload bytes/sec and writes/sec per admin connection for
+// per stream notifications, batched full notifications and batched delta notifications.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "server/daemon/statistics_aggregator.h"
+
+namespace {
+
+enum { report_delay_sec = 10, status_change_period_sec = 300 };
+
+fastocloud::StatisticInfo MakeStatistic(size_t index, size_t second) {
+  fastocloud::StreamInfo sha;
+  sha.id = "stream_" + std::to_string(index);
+  sha.type = fastocloud::ENCODE;
+  sha.input = {0};
+  sha.output = {1};
+  fastocloud::StreamStruct stats(sha, 1000, 1000, second / status_change_period_sec);
+  stats.status = (second + index) % status_change_period_sec == 0 ? fastocloud::FROZEN : fastocloud::PLAYING;
+  const size_t bps = 500000 + (rand() % 1000) * 100;
+  stats.input[0].SetBps(bps);
+  stats.input[0].SetTotalBytes(bps * second);
+  stats.output[0].SetBps(bps);
+  stats.output[0].SetTotalBytes(bps * second);
+  return fastocloud::StatisticInfo(stats, 0.1 + (rand() % 10) / 100.0, 100 * 1024 * 1024,
+                                   static_cast<fastotv::timestamp_t>(second) * 1000);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t streams = argc > 1 ? strtoul(argv[1], nullptr, 10) : 500;
+  const size_t seconds = argc > 2 ? strtoul(argv[2], nullptr, 10) : 600;
+  if (!streams || !seconds) {
+    fprintf(stderr, "Usage: %s [streams] [seconds]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  srand(0);
+  size_t per_stream_bytes = 0;
+  size_t per_stream_writes = 0;
+  size_t batched_bytes = 0;
+  size_t batched_writes = 0;
+  size_t delta_bytes = 0;
+  size_t delta_writes = 0;
+
+  fastocloud::server::StatisticsAggregator aggregator;
+  for (size_t second = 0; second < seconds; ++second) {
+    size_t tick_bytes = 0;
+    for (size_t i = 0; i < streams; ++i) {
+      if ((second + i) % report_delay_sec != 0) {
+        continue;
+      }
+
+      const fastocloud::StatisticInfo statistic = MakeStatistic(i, second);
+      std::string json;
+      if (statistic.SerializeToString(&json)) {
+        continue;
+      }
+
+      per_stream_bytes += json.size();
+      per_stream_writes++;
+      tick_bytes += json.size() + 1;  // with separator
+      aggregator.Update(statistic);
+    }
+
+    if (tick_bytes) {
+      batched_bytes += tick_bytes + 1;
+      batched_writes++;
+    }
+
+    std::string params;
+    if (aggregator.MakeTickBroadcast(&params)) {
+      delta_bytes += params.size();
+      delta_writes++;
+    }
+  }
+
+  printf("%zu streams, %zu seconds, payload per admin connection:\n", streams, seconds);
+  printf("  per stream: %10.1f bytes/sec %8.1f writes/sec\n", static_cast<double>(per_stream_bytes) / seconds,
+         static_cast<double>(per_stream_writes) / seconds);
+  printf("  batched:    %10.1f bytes/sec %8.1f writes/sec\n", static_cast<double>(batched_bytes) / seconds,
+         static_cast<double>(batched_writes) / seconds);
+  printf("  delta:      %10.1f bytes/sec %8.1f writes/sec\n", static_cast<double>(delta_bytes) / seconds,
+         static_cast<double>(delta_writes) / seconds);
+  return EXIT_SUCCESS;
+}
@@ -12,13 +12,42 @@
     along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+#include <common/time.h>
+
 #include "base/config_fields.h"
 #include "base/constants.h"
 #include "base/stream_config_parse.h"
 
+#include "server/base/http_file_response.h"
+#include "server/base/http_output.h"
+#include "server/base/http_request_reader.h"
+#include "server/cpu_placement.h"
+#include "server/daemon/statistics_aggregator.h"
+#include "server/http/segments_cache.h"
+#include "server/http/timeshift_playlist.h"
 #include "server/options/options.h"
+#include "server/vods/vod_jit.h"
+#include "server/vods/vod_jit_segments.h"
+#include "server/vods/vod_split_job.h"
+#include "server/vods/vods_completeness.h"
+#include "server/zygote_protocol.h"
 
 namespace {
 const char kTimeshiftRecorderConfig[] = R"({
@@ -53,3 +82,696 @@ TEST(Options, cfgs) {
   ASSERT_FALSE(err);
   ASSERT_EQ(args->GetSize(), 4);
 }
+
+TEST(SegmentsCache, hits_and_playlist_eviction) {
+  char dir_template[] = "/tmp/segments_cache_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  const std::string first = std::string(dir) + "/1.ts";
+  const std::string second = std::string(dir) + "/2.ts";
+  const std::string playlist = std::string(dir) + "/master.m3u8";
+  std::ofstream(first) << "first";
+  std::ofstream(second) << "second";
+
+  fastocloud::server::SegmentsCache cache(1024, 16);
+  struct stat sb;
+  ASSERT_EQ(stat(first.c_str(), &sb), 0);
+  ASSERT_FALSE(cache.Get(first, sb));  // miss is loaded in background
+  cache.WaitLoaded();
+  auto data = cache.Get(first, sb);
+  ASSERT_TRUE(data);
+  ASSERT_EQ(*data, "first");
+  auto stats = cache.GetStats();
+  ASSERT_EQ(stats.hits, 1);
+  ASSERT_EQ(stats.misses, 1);
+  ASSERT_EQ(stats.bytes, 5);
+
+  ASSERT_EQ(stat(second.c_str(), &sb), 0);
+  ASSERT_FALSE(cache.Get(second, sb));
+  cache.WaitLoaded();
+  ASSERT_TRUE(cache.Get(second, sb));
+  std::ofstream(playlist) << "#EXTM3U\n#EXTINF:5,\n2.ts\n";
+  ASSERT_EQ(stat(playlist.c_str(), &sb), 0);
+  ASSERT_FALSE(cache.Get(playlist, sb));
+  cache.WaitLoaded();
+  ASSERT_TRUE(cache.Get(playlist, sb));
+  stats = cache.GetStats();
+  ASSERT_EQ(stats.entries, 2);  // 1.ts is out of playlist
+
+  // only last segment of channel kept
+  fastocloud::server::SegmentsCache small_cache(1024, 1);
+  ASSERT_EQ(stat(first.c_str(), &sb), 0);
+  ASSERT_FALSE(small_cache.Get(first, sb));
+  ASSERT_EQ(stat(second.c_str(), &sb), 0);
+  ASSERT_FALSE(small_cache.Get(second, sb));
+  small_cache.WaitLoaded();
+  ASSERT_TRUE(small_cache.Get(second, sb));
+  ASSERT_EQ(stat(first.c_str(), &sb), 0);
+  ASSERT_FALSE(small_cache.Get(first, sb));
+  small_cache.WaitLoaded();
+  ASSERT_EQ(small_cache.GetStats().entries, 1);
+
+  unlink(first.c_str());
+  unlink(second.c_str());
+  unlink(playlist.c_str());
+  rmdir(dir);
+}
+
+static void PushToReader(fastocloud::server::base::HttpRequestReader* reader, const std::string& data) {
+  size_t size = 0;
+  char* buff = reader->PrepareRead(&size);
+  ASSERT_GE(size, data.size());
+  memcpy(buff, data.data(), data.size());
+  reader->CommitRead(data.size());
+}
+
+TEST(HttpRequestReader, split_and_pipelined) {
+  const std::string first = "GET /1.ts HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  const std::string second = "POST /2 HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+  fastocloud::server::base::HttpRequestReader reader;
+  PushToReader(&reader, first.substr(0, 10));
+  ASSERT_FALSE(reader.NextRequest());
+  PushToReader(&reader, first.substr(10) + second.substr(0, second.size() - 2));
+  ASSERT_TRUE(reader.NextRequest());
+  ASSERT_EQ(reader.GetRequest(), first);
+  ASSERT_FALSE(reader.NextRequest());
+  PushToReader(&reader, second.substr(second.size() - 2));
+  ASSERT_TRUE(reader.NextRequest());
+  ASSERT_EQ(reader.GetRequest(), second);
+  ASSERT_FALSE(reader.NextRequest());
+  ASSERT_FALSE(reader.IsOverflow());
+}
+
+TEST(HttpRequestReader, huge_content_length) {
+  fastocloud::server::base::HttpRequestReader reader;
+  PushToReader(&reader, "POST /1 HTTP/1.1\r\nContent-Length: 18446744073709551615\r\n\r\nbody");
+  ASSERT_FALSE(reader.NextRequest());
+  ASSERT_TRUE(reader.IsOverflow());
+
+  fastocloud::server::base::HttpRequestReader reader2;
+  PushToReader(&reader2, "POST /1 HTTP/1.1\r\nContent-Length: -60\r\n\r\nbody");
+  ASSERT_FALSE(reader2.NextRequest());
+  ASSERT_TRUE(reader2.IsOverflow());
+}
+
+static std::string ServeFile(int sock, int peer, int file, const struct stat& sb, const std::string& request) {
+  common::http::HttpRequest hrequest;
+  auto result = common::http::parse_http_request(request, &hrequest);
+  EXPECT_FALSE(result.second);
+  const fastocloud::server::base::HttpFileResponse response(hrequest, sb);
+  fastocloud::server::base::HttpOutput output;
+  response.QueueHeaders(&output, hrequest.GetProtocol(), "video/mp2t", true, "test");
+  response.QueueBody(&output, dup(file));
+  EXPECT_FALSE(output.Flush(sock));
+  EXPECT_TRUE(output.IsEmpty());
+
+  std::string answer;
+  char buff[4096];
+  ssize_t nread = 0;
+  while ((nread = recv(peer, buff, sizeof(buff), MSG_DONTWAIT)) > 0) {
+    answer.append(buff, nread);
+  }
+  return answer;
+}
+
+static std::string GetBody(const std::string& answer) {
+  const size_t headers_end = answer.find("\r\n\r\n");
+  return headers_end == std::string::npos ? std::string() : answer.substr(headers_end + 4);
+}
+
+TEST(HttpFileResponse, ranges_and_conditional_get) {
+  char file_template[] = "/tmp/http_file_response_XXXXXX";
+  int file = mkstemp(file_template);
+  ASSERT_NE(file, -1);
+  std::string content;
+  for (size_t i = 0; i < 1000; ++i) {
+    content += static_cast<char>(i * 7 % 251);  // no repeats within 251 bytes
+  }
+  ASSERT_EQ(write(file, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+  struct stat sb;
+  ASSERT_EQ(fstat(file, &sb), 0);
+
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  std::string answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(answer.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+  ASSERT_NE(answer.find("Accept-Ranges: bytes\r\n"), std::string::npos);
+  ASSERT_EQ(GetBody(answer), content);
+
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nRange: bytes=10-19\r\n\r\n");
+  ASSERT_EQ(answer.compare(0, 12, "HTTP/1.1 206"), 0);
+  ASSERT_NE(answer.find("Content-Range: bytes 10-19/1000\r\n"), std::string::npos);
+  ASSERT_EQ(GetBody(answer), content.substr(10, 10));
+
+  // bytes come from the range offset, not from position of descriptor
+  ASSERT_EQ(lseek(file, 0, SEEK_SET), 0);
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nRange: bytes=500-699\r\n\r\n");
+  ASSERT_EQ(GetBody(answer), content.substr(500, 200));
+  ASSERT_EQ(lseek(file, 0, SEEK_CUR), 0);
+
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nRange: bytes=990-\r\n\r\n");
+  ASSERT_EQ(GetBody(answer), content.substr(990));
+
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nRange: bytes=-5\r\n\r\n");
+  ASSERT_NE(answer.find("Content-Range: bytes 995-999/1000\r\n"), std::string::npos);
+  ASSERT_EQ(GetBody(answer), content.substr(995));
+
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nRange: bytes=1000-\r\n\r\n");
+  ASSERT_EQ(answer.compare(0, 12, "HTTP/1.1 416"), 0);
+  ASSERT_NE(answer.find("Content-Range: bytes */1000\r\n"), std::string::npos);
+
+  fastocloud::server::base::HttpFileResponse response(common::http::HttpRequest(), sb);
+  const std::string etag = response.GetETag();
+  answer = ServeFile(fds[0], fds[1], file, sb, "GET /1.ts HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n");
+  ASSERT_EQ(answer.compare(0, 12, "HTTP/1.1 304"), 0);
+  ASSERT_TRUE(GetBody(answer).empty());
+
+  answer = ServeFile(fds[0], fds[1], file, sb,
+                     "GET /1.ts HTTP/1.1\r\nRange: bytes=10-19\r\nIf-Range: \"stale\"\r\n\r\n");
+  ASSERT_EQ(GetBody(answer), content);
+
+  close(fds[0]);
+  close(fds[1]);
+  close(file);
+  unlink(file_template);
+}
+
+TEST(HttpOutput, resumes_when_socket_is_full) {
+  char file_template[] = "/tmp/http_output_XXXXXX";
+  int file = mkstemp(file_template);
+  ASSERT_NE(file, -1);
+  std::string content;
+  for (size_t i = 0; i < 1024 * 1024; ++i) {
+    content += static_cast<char>(i * 7 % 251);
+  }
+  ASSERT_EQ(write(file, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  ASSERT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+  int sndbuf = 16 * 1024;
+  ASSERT_EQ(setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)), 0);
+
+  // reader which doesn't read, flush returns instead of waiting
+  fastocloud::server::base::HttpOutput output;
+  output.Push("headers\r\n\r\n");
+  output.PushFile(file, 100, content.size() - 100);
+  ASSERT_FALSE(output.Flush(fds[0]));
+  ASSERT_FALSE(output.IsEmpty());
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  ASSERT_FALSE(output.IsStalled(current_time));
+  ASSERT_TRUE(output.IsStalled(current_time + fastocloud::server::base::HttpOutput::stall_timeout_msec + 1000));
+
+  // rest goes from saved offset as peer reads
+  std::string answer;
+  char buff[4096];
+  while (!output.IsEmpty()) {
+    ssize_t nread = 0;
+    while ((nread = recv(fds[1], buff, sizeof(buff), MSG_DONTWAIT)) > 0) {
+      answer.append(buff, nread);
+    }
+    ASSERT_FALSE(output.Flush(fds[0]));
+  }
+  ssize_t nread = 0;
+  while ((nread = recv(fds[1], buff, sizeof(buff), MSG_DONTWAIT)) > 0) {
+    answer.append(buff, nread);
+  }
+  ASSERT_EQ(answer, "headers\r\n\r\n" + content.substr(100));
+
+  close(fds[0]);
+  close(fds[1]);
+  unlink(file_template);
+}
+
+namespace {
+// stands for stream forked by zygote, lives until killed
+pid_t ForkSleeper() {
+  pid_t pid = fork();
+  if (pid == 0) {
+    while (true) {
+      pause();
+    }
+  }
+  return pid;
+}
+
+bool IsKilled(pid_t pid) {
+  int status = 0;
+  return waitpid(pid, &status, 0) == pid && WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL;
+}
+}  // namespace
+
+TEST(ZygoteProtocol, reply_matching) {
+  int sv[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv), 0);
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+
+  ASSERT_FALSE(fastocloud::server::SendSpawnRequest(sv[0], 2, "sid", R"({"id": "sid"})", pipe_fds, 2));
+  std::vector<char> buffer;
+  fastocloud::server::SpawnRequest request;
+  ASSERT_TRUE(fastocloud::server::ReadSpawnRequest(sv[1], &buffer, &request));
+  ASSERT_EQ(request.seq, 2u);
+  ASSERT_EQ(request.sid, "sid");
+  ASSERT_EQ(request.config_json, R"({"id": "sid"})");
+  ASSERT_EQ(request.nfds, 2u);
+  ASSERT_EQ(request.fds[2], INVALID_DESCRIPTOR);
+  for (size_t i = 0; i < request.nfds; ++i) {
+    close(request.fds[i]);
+  }
+
+  // reply of previous request came first, its stream was forked by service already
+  const pid_t stale = ForkSleeper();
+  ASSERT_GT(stale, 0);
+  ASSERT_TRUE(fastocloud::server::SendSpawnReply(sv[1], {1, stale}));
+  ASSERT_TRUE(fastocloud::server::SendSpawnReply(sv[1], {2, 12345}));
+  pid_t pid = 0;
+  ASSERT_FALSE(fastocloud::server::WaitSpawnReply(sv[0], 2, 1000, &pid));
+  ASSERT_EQ(pid, 12345);
+  ASSERT_TRUE(IsKilled(stale));
+
+  // zygote couldn't fork
+  ASSERT_TRUE(fastocloud::server::SendSpawnReply(sv[1], {3, -1}));
+  common::ErrnoError err = fastocloud::server::WaitSpawnReply(sv[0], 3, 1000, &pid);
+  ASSERT_TRUE(err);
+  ASSERT_EQ(err->GetErrorCode(), ECHILD);
+
+  // request without descriptors is malformed, it is answered with seq 0
+  const std::string garbage = "garbage";
+  ASSERT_EQ(send(sv[0], garbage.data(), garbage.size(), 0), static_cast<ssize_t>(garbage.size()));
+  ASSERT_TRUE(fastocloud::server::ReadSpawnRequest(sv[1], &buffer, &request));
+  ASSERT_EQ(request.seq, 0u);
+  ASSERT_EQ(request.nfds, 0u);
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  close(sv[0]);
+  ASSERT_FALSE(fastocloud::server::ReadSpawnRequest(sv[1], &buffer, &request));
+  close(sv[1]);
+}
+
+TEST(ZygoteProtocol, reply_timeout) {
+  int sv[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv), 0);
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+
+  // zygote is stuck, wait is bounded
+  ASSERT_FALSE(fastocloud::server::SendSpawnRequest(sv[0], 1, "sid", "{}", pipe_fds, 2));
+  pid_t pid = 0;
+  const auto start = std::chrono::steady_clock::now();
+  common::ErrnoError err = fastocloud::server::WaitSpawnReply(sv[0], 1, 50, &pid);
+  const auto waited = std::chrono::steady_clock::now() - start;
+  ASSERT_TRUE(err);
+  ASSERT_EQ(err->GetErrorCode(), ETIMEDOUT);
+  ASSERT_LT(waited, std::chrono::milliseconds(1000));
+
+  // reply comes after service forked stream itself, zygote's copy is killed
+  const pid_t late = ForkSleeper();
+  ASSERT_GT(late, 0);
+  ASSERT_TRUE(fastocloud::server::SendSpawnReply(sv[1], {1, late}));
+  fastocloud::server::KillStaleSpawns(sv[0]);
+  ASSERT_TRUE(IsKilled(late));
+
+  // zygote exited
+  close(sv[1]);
+  err = fastocloud::server::WaitSpawnReply(sv[0], 2, 1000, &pid);
+  ASSERT_TRUE(err);
+  ASSERT_EQ(err->GetErrorCode(), EPIPE);
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  close(sv[0]);
+}
+
+TEST(ZygoteProtocol, backoff) {
+  typedef fastocloud::server::SpawnBackoff SpawnBackoff;
+  const std::chrono::milliseconds backoff(SpawnBackoff::backoff_msec);
+  const auto now = std::chrono::steady_clock::now();
+  SpawnBackoff policy;
+  ASSERT_TRUE(policy.CanSpawn(now));
+
+  // one timeout doesn't disable zygote, it is tried again after backoff
+  policy.OnFailure(now);
+  ASSERT_FALSE(policy.IsExhausted());
+  ASSERT_FALSE(policy.CanSpawn(now + backoff / 2));
+  ASSERT_TRUE(policy.CanSpawn(now + backoff));
+  policy.OnSuccess();
+  ASSERT_EQ(policy.GetFailures(), 0u);
+  ASSERT_TRUE(policy.CanSpawn(now));
+
+  // backoff doubles with failures in a row, zygote is disabled after max of them
+  for (size_t i = 1; i < SpawnBackoff::max_failures; ++i) {
+    policy.OnFailure(now);
+    ASSERT_FALSE(policy.CanSpawn(now + backoff * (1 << (i - 1)) - std::chrono::milliseconds(1)));
+    ASSERT_TRUE(policy.CanSpawn(now + backoff * (1 << (i - 1))));
+  }
+  policy.OnFailure(now);
+  ASSERT_TRUE(policy.IsExhausted());
+  ASSERT_FALSE(policy.CanSpawn(now + backoff * 1000));
+}
+
+TEST(StatisticsAggregator, delta_and_snapshot) {
+  fastocloud::StreamInfo sha;
+  sha.id = "test";
+  sha.type = fastocloud::RELAY;
+  sha.input = {0};
+  sha.output = {1};
+  fastocloud::StreamStruct stats(sha, 15, 33, 0);
+  stats.input[0].SetBps(100);
+
+  fastocloud::server::StatisticsAggregator aggregator;
+  std::string params;
+  ASSERT_FALSE(aggregator.MakeSnapshot(&params));
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_TRUE(aggregator.MakeTickBroadcast(&params));
+  ASSERT_NE(params.find("\"start_time\""), std::string::npos);
+
+  stats.input[0].SetBps(200);
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_TRUE(aggregator.MakeTickBroadcast(&params));
+  ASSERT_NE(params.find("\"bps\""), std::string::npos);
+  ASSERT_NE(params.find("\"id\""), std::string::npos);
+  ASSERT_EQ(params.find("\"start_time\""), std::string::npos);
+  ASSERT_EQ(params.find("\"output_streams\""), std::string::npos);
+
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_FALSE(aggregator.MakeTickBroadcast(&params));
+
+  ASSERT_TRUE(aggregator.MakeSnapshot(&params));
+  ASSERT_NE(params.find("\"start_time\""), std::string::npos);
+
+  aggregator.Remove(sha.id);
+  ASSERT_FALSE(aggregator.MakeSnapshot(&params));
+}
+
+TEST(StatisticsAggregator, channels_matched_by_id) {
+  fastocloud::StreamInfo sha;
+  sha.id = "test";
+  sha.type = fastocloud::RELAY;
+  sha.input = {0, 1};
+  sha.output = {2};
+  fastocloud::StreamStruct stats(sha, 15, 33, 0);
+  stats.input[1].SetBps(100);
+
+  fastocloud::server::StatisticsAggregator aggregator;
+  std::string params;
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_TRUE(aggregator.MakeTickBroadcast(&params));
+
+  std::swap(stats.input[0], stats.input[1]);  // reordered, nothing changed
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_FALSE(aggregator.MakeTickBroadcast(&params));
+
+  stats.input.erase(stats.input.begin());  // input 1 removed
+  aggregator.Update(fastocloud::StatisticInfo(stats, 0.5, 12, 10));
+  ASSERT_TRUE(aggregator.MakeTickBroadcast(&params));
+  ASSERT_NE(params.find("\"removed\""), std::string::npos);
+  ASSERT_EQ(params.find("\"bps\""), std::string::npos);
+}
+
+TEST(VodsCompleteness, states) {
+  typedef fastocloud::server::VodsCompleteness VodsCompleteness;
+  char dir_template[] = "/tmp/vods_completeness_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  const std::string chunk = std::string(dir) + "/1.ts";
+  const std::string playlist = std::string(dir) + "/master.m3u8";
+  std::ofstream(playlist) << "#EXTM3U\n#EXTINF:5,\n1.ts\n#EXT-X-ENDLIST\n";
+
+  VodsCompleteness states;
+  const VodsCompleteness::playlist_t playlist_path(playlist);
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::NOT_VOD);
+  const VodsCompleteness::http_root_t http_root(dir);
+  states.Add(http_root, "vod");
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::MISSING_CHUNKS);
+
+  states.OnStreamStarted("vod");
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::ENCODING);
+  std::ofstream(chunk) << "chunk";
+  states.OnStreamExited("vod");
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::COMPLETE);
+
+  unlink(chunk.c_str());
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::COMPLETE);  // cached until invalidation
+  states.OnChunksRemoved(http_root);
+  ASSERT_EQ(states.GetState(playlist_path), VodsCompleteness::MISSING_CHUNKS);
+
+  unlink(playlist.c_str());
+  rmdir(dir);
+}
+
+TEST(CpuPlacement, cpulist_and_balance) {
+  typedef fastocloud::server::CpuPlacement CpuPlacement;
+  CpuPlacement::cpus_t cpus;
+  ASSERT_TRUE(CpuPlacement::ParseCpuList("0-3,8,10-11\n", &cpus));
+  ASSERT_EQ(cpus.size(), 7u);
+  ASSERT_EQ(CpuPlacement::MakeCpuList(cpus), "0-3,8,10-11");
+  ASSERT_FALSE(CpuPlacement::ParseCpuList("", &cpus));
+  ASSERT_FALSE(CpuPlacement::ParseCpuList("3-1", &cpus));
+
+  CpuPlacement::topology_t topology;
+  topology.push_back({0, {0, 1, 2, 3}});
+  topology.push_back({1, {4, 5, 6, 7}});
+  CpuPlacement placement(topology);
+
+  int node = 0;
+  ASSERT_TRUE(placement.Place("encode_1", 0, fastocloud::ENCODE));
+  ASSERT_TRUE(placement.GetStreamCpus("encode_1", &cpus, &node));
+  ASSERT_EQ(node, 0);
+  ASSERT_EQ(CpuPlacement::MakeCpuList(cpus), "0-3");
+  ASSERT_TRUE(placement.Place("encode_2", 0, fastocloud::ENCODE));
+  ASSERT_TRUE(placement.GetStreamCpus("encode_2", &cpus, &node));
+  ASSERT_EQ(node, 1);
+
+  ASSERT_TRUE(placement.Place("relay", 0, fastocloud::RELAY));
+  ASSERT_TRUE(placement.GetStreamCpus("relay", &cpus, &node));
+  ASSERT_EQ(cpus.size(), 1u);
+
+  // relay measured above one core widens to its node
+  placement.UpdateLoad("relay", 1.5);
+  ASSERT_TRUE(placement.Rebalance());
+  ASSERT_TRUE(placement.GetStreamCpus("relay", &cpus, &node));
+  ASSERT_EQ(cpus.size(), 4u);
+
+  placement.Remove("relay");
+  ASSERT_FALSE(placement.GetStreamCpus("relay", &cpus, &node));
+  ASSERT_EQ(placement.MakePlacementInfo().GetStreams().size(), 2u);
+
+  CpuPlacement::topology_t single;
+  single.push_back({0, {0}});
+  CpuPlacement single_cpu(single);
+  ASSERT_FALSE(single_cpu.Place("relay", 0, fastocloud::RELAY));
+}
+
+TEST(TimeShiftPlaylist, delay_and_range) {
+  typedef fastocloud::server::TimeShiftPlaylist TimeShiftPlaylist;
+  ASSERT_EQ(TimeShiftPlaylist::GetRequestQuery("GET /timeshift/14/master.m3u8?delay=60 HTTP/1.1\r\n\r\n"), "delay=60");
+  ASSERT_TRUE(TimeShiftPlaylist::GetRequestQuery("GET /timeshift/14/master.m3u8 HTTP/1.1\r\n\r\n").empty());
+
+  fastocloud::server::TimeShiftPlaylistRequest delayed;
+  ASSERT_TRUE(TimeShiftPlaylist::ParseQuery("delay=100", &delayed));
+  ASSERT_FALSE(delayed.IsRange());
+  fastocloud::server::TimeShiftPlaylistRequest range;
+  ASSERT_TRUE(TimeShiftPlaylist::ParseQuery("start=1060&end=1150", &range));
+  ASSERT_TRUE(range.IsRange());
+  ASSERT_FALSE(TimeShiftPlaylist::ParseQuery("start=1060&end=1000", &range));
+  ASSERT_FALSE(TimeShiftPlaylist::ParseQuery("delay=-5", &range));
+
+  char dir_template[] = "/tmp/timeshift_playlist_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  fastocloud::stream::TimeShiftIndex index{common::file_system::ascii_directory_string_path(dir)};
+  for (fastocloud::stream::chunk_index_t i = 0; i < 20; ++i) {
+    const int64_t start = 1000000 + i * 10000 + (i >= 10 ? 30000 : 0);  // recording gap before 10
+    ASSERT_FALSE(index.Append({i, start, 10000, 100}));
+  }
+
+  const int64_t now = 1250000;
+  std::string playlist;
+  ASSERT_TRUE(TimeShiftPlaylist::Make(index, delayed, now, &playlist));
+  ASSERT_NE(playlist.find("#EXT-X-MEDIA-SEQUENCE:7\n"), std::string::npos);
+  ASSERT_NE(playlist.find("#EXT-X-DISCONTINUITY\n"), std::string::npos);
+  ASSERT_NE(playlist.find("\n11.ts\n"), std::string::npos);
+  ASSERT_EQ(playlist.find("12.ts"), std::string::npos);
+  ASSERT_EQ(playlist.find("#EXT-X-ENDLIST"), std::string::npos);
+
+  ASSERT_TRUE(TimeShiftPlaylist::ParseQuery("start=1060&end=1150", &range));
+  ASSERT_TRUE(TimeShiftPlaylist::Make(index, range, now, &playlist));
+  ASSERT_NE(playlist.find("#EXT-X-MEDIA-SEQUENCE:6\n"), std::string::npos);
+  ASSERT_NE(playlist.find("#EXT-X-PLAYLIST-TYPE:VOD\n"), std::string::npos);
+  ASSERT_NE(playlist.find("#EXT-X-ENDLIST\n"), std::string::npos);
+
+  ASSERT_TRUE(TimeShiftPlaylist::ParseQuery("start=1060", &range));
+  ASSERT_TRUE(TimeShiftPlaylist::Make(index, range, now, &playlist));
+  ASSERT_NE(playlist.find("#EXT-X-PLAYLIST-TYPE:EVENT\n"), std::string::npos);
+  ASSERT_NE(playlist.find("\n19.ts\n"), std::string::npos);
+  ASSERT_EQ(playlist.find("#EXT-X-ENDLIST"), std::string::npos);
+
+  ASSERT_TRUE(TimeShiftPlaylist::ParseQuery("delay=100000", &delayed));
+  ASSERT_FALSE(TimeShiftPlaylist::Make(index, delayed, now, &playlist));
+
+  unlink(index.GetPath().c_str());
+  rmdir(dir);
+}
+
+TEST(VodSplitJob, ranges_and_scheduling) {
+  typedef fastocloud::server::VodSplitJob VodSplitJob;
+  ASSERT_EQ(fastocloud::CalcVodRangesCount(600000, 1), 1u);
+  ASSERT_EQ(fastocloud::CalcVodRangesCount(600000, 8), 30u);  // 20 seconds at least
+  ASSERT_EQ(fastocloud::CalcVodRangesCount(30000, 8), 1u);
+
+  fastocloud::vod_ranges_t ranges = fastocloud::MakeVodRanges({0, 10000, 10000, 20000});
+  ASSERT_EQ(ranges.size(), 3u);
+  ASSERT_EQ(ranges[1].start_msec, 10000);
+  ASSERT_EQ(ranges[1].stop_msec, 20000);
+  ASSERT_EQ(ranges[2].stop_msec, fastocloud::VodRange::open_stop);
+  fastocloud::VodRange range;
+  ASSERT_TRUE(common::ConvertFromString(common::ConvertToString(ranges[2]), &range));
+  ASSERT_EQ(range, ranges[2]);
+
+  fastocloud::StreamConfig config = fastocloud::MakeConfigFromJson(R"({
+    "id" : "vod", "type" : 8, "feedback_directory" : "/tmp/vod", "vod_workers" : 2,
+    "output" : {"urls" : [ {"id" : 1, "uri" : "http://localhost/vod/master.m3u8", "http_root" : "/tmp/vod"} ]}
+  })");
+  ASSERT_TRUE(config);
+  ASSERT_EQ(VodSplitJob::GetWorkers(config), 2u);
+
+  VodSplitJob job("vod", config, 2);
+  job.SetRanges(ranges);
+  job.QueueAllRanges();
+  fastocloud::stream_id_t wid;
+  fastocloud::StreamConfig wconfig;
+  ASSERT_TRUE(job.TakeRange(&wid, &wconfig));
+  ASSERT_EQ(wid, "vod_r0");
+  ASSERT_EQ(VodSplitJob::GetWorkers(wconfig), 1u);  // worker encodes its range by single pipeline
+  ASSERT_TRUE(job.TakeRange(&wid, &wconfig));
+  ASSERT_FALSE(job.TakeRange(&wid, &wconfig));  // all workers are busy
+
+  ASSERT_TRUE(job.OnWorkerExited("vod_r1", false));  // failed range is queued again
+  ASSERT_TRUE(job.TakeRange(&wid, &wconfig));
+  ASSERT_EQ(wid, "vod_r2");
+  ASSERT_TRUE(job.OnWorkerExited("vod_r2", true));
+  ASSERT_TRUE(job.TakeRange(&wid, &wconfig));
+  ASSERT_EQ(wid, "vod_r1");
+  ASSERT_TRUE(job.OnWorkerExited("vod_r1", false));  // no attempts left
+  ASSERT_FALSE(job.OnWorkerExited("other", true));
+  ASSERT_TRUE(job.OnWorkerExited("vod_r0", true));
+  ASSERT_TRUE(job.IsFinished());
+  ASSERT_TRUE(job.IsFailed());
+}
+
+TEST(VodJitSegments, lru_eviction) {
+  fastocloud::server::VodJitSegments segments(300);
+  ASSERT_TRUE(segments.Add("/tmp/vod/jit00000.ts", 100).empty());
+  ASSERT_TRUE(segments.Add("/tmp/vod/jit00001.ts", 100).empty());
+  ASSERT_TRUE(segments.Add("/tmp/vod/jit00002.ts", 100).empty());
+  segments.Touch("/tmp/vod/jit00000.ts");
+  std::vector<std::string> evicted = segments.Add("/tmp/vod/jit00003.ts", 150);
+  ASSERT_EQ(evicted.size(), 2u);  // least recently requested first
+  ASSERT_EQ(evicted[0], "/tmp/vod/jit00001.ts");
+  ASSERT_EQ(evicted[1], "/tmp/vod/jit00002.ts");
+  ASSERT_EQ(segments.GetBytes(), 250u);
+  evicted = segments.Add("/tmp/vod/jit00004.ts", 500);  // bigger than budget, kept alone
+  ASSERT_EQ(evicted.size(), 2u);
+  ASSERT_EQ(segments.GetCount(), 1u);
+  segments.Remove("/tmp/vod/jit00004.ts");
+  ASSERT_EQ(segments.GetBytes(), 0u);
+}
+
+TEST(VodJit, index_and_prefetch) {
+  typedef fastocloud::server::VodJit VodJit;
+  size_t index;
+  ASSERT_EQ(fastocloud::MakeVodJitSegmentName(7), "jit00007.ts");
+  ASSERT_TRUE(fastocloud::ParseVodJitSegmentName("jit00007.ts", &index));
+  ASSERT_EQ(index, 7u);
+  ASSERT_FALSE(fastocloud::ParseVodJitSegmentName("jit7.ts", &index));
+  ASSERT_FALSE(fastocloud::ParseVodJitSegmentName("00007.ts", &index));
+  ASSERT_EQ(fastocloud::CalcVodSegmentsCount(45000), 4u);
+
+  const fastocloud::vod_ranges_t ranges = fastocloud::MakeVodRanges({0, 10000, 20000, 30000, 45000}, 45000);
+  ASSERT_EQ(ranges.size(), 4u);
+  ASSERT_EQ(ranges[3].start_msec, 30000);
+  ASSERT_EQ(ranges[3].stop_msec, 45000);  // indexed vod knows its duration
+
+  char dir_template[] = "/tmp/vod_jit_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  const common::file_system::ascii_directory_string_path http_root(dir);
+  fastocloud::StreamConfig config = fastocloud::MakeConfigFromJson(common::MemSPrintf(R"({
+    "id" : "vod", "type" : 8, "feedback_directory" : "%s", "vod_jit" : true,
+    "output" : {"urls" : [ {"id" : 1, "uri" : "http://localhost/vod/master.m3u8", "http_root" : "%s"} ]}
+  })", dir, dir));
+  ASSERT_TRUE(config);
+  ASSERT_TRUE(VodJit::IsJit(config));
+  ASSERT_EQ(fastocloud::server::VodSplitJob::GetWorkers(config), 1u);
+
+  VodJit jit("vod", config, 1);
+  ASSERT_TRUE(jit.HasHttpRoot(http_root));
+  ASSERT_FALSE(jit.LoadIndex());
+  ASSERT_FALSE(jit.Request(0));
+  ASSERT_FALSE(fastocloud::WriteVodRanges(fastocloud::MakeVodJitIndexPath(http_root), ranges));
+  ASSERT_TRUE(jit.LoadIndex());
+  ASSERT_FALSE(jit.WritePlaylists());
+  const auto playlist = http_root.MakeFileStringPath("master.m3u8");
+  ASSERT_TRUE(playlist);
+  std::ifstream playlist_file(playlist->GetPath());
+  const std::string playlist_data((std::istreambuf_iterator<char>(playlist_file)), std::istreambuf_iterator<char>());
+  ASSERT_NE(playlist_data.find("jit00003.ts"), std::string::npos);
+
+  fastocloud::stream_id_t wid;
+  fastocloud::StreamConfig wconfig;
+  ASSERT_TRUE(jit.Request(1));
+  ASSERT_TRUE(jit.TakeSegment(&wid, &wconfig));
+  ASSERT_EQ(wid, "vod_r1");
+  ASSERT_TRUE(jit.TakeSegment(&wid, &wconfig));  // prefetch of next one
+  ASSERT_EQ(wid, "vod_r2");
+  ASSERT_FALSE(jit.TakeSegment(&wid, &wconfig));
+
+  ASSERT_TRUE(jit.Request(3));  // seek, old prefetch is dropped, running workers are counted
+  ASSERT_FALSE(jit.TakeSegment(&wid, &wconfig));
+  ASSERT_TRUE(jit.OnWorkerExited("vod_r2", false, nullptr));
+  ASSERT_TRUE(jit.TakeSegment(&wid, &wconfig));
+  ASSERT_EQ(wid, "vod_r3");
+  ASSERT_FALSE(jit.OnWorkerExited("vod_r0", true, nullptr));
+  ASSERT_EQ(jit.GetRunningWorkers().size(), 2u);
+
+  unlink(playlist->GetPath().c_str());
+  unlink(fastocloud::MakeVodJitIndexPath(http_root).GetPath().c_str());
+  rmdir(dir);
+}
+
+TEST(VodJit, make_segment) {
+  typedef fastocloud::server::VodJit VodJit;
+  typedef fastocloud::server::VodSplitJob VodSplitJob;
+  char dir_template[] = "/tmp/vod_jit_segment_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  const common::file_system::ascii_directory_string_path http_root(dir);
+  const std::string root = http_root.GetPath();
+  const auto range_playlist = VodSplitJob::MakeRangePlaylistPath(http_root, "master.m3u8", 0);
+  const std::string segment_path = root + fastocloud::MakeVodJitSegmentName(0);
+  const uint64_t duration = 5 * fastocloud::utils::ChunkInfo::SECOND;
+
+  // chunk of split range is missing, nothing is left behind
+  std::ofstream(root + "a.ts") << "first";
+  const std::vector<fastocloud::utils::ChunkInfo> split = {fastocloud::utils::ChunkInfo("a.ts", duration, 0),
+                                                           fastocloud::utils::ChunkInfo("b.ts", duration, 1)};
+  ASSERT_FALSE(VodSplitJob::WriteVodPlaylist(range_playlist, split));
+  VodJit::Segment segment;
+  ASSERT_TRUE(VodJit::MakeSegment(http_root, "master.m3u8", 0, &segment));
+  ASSERT_FALSE(common::file_system::is_file_exist(segment_path + ".tmp"));
+  ASSERT_FALSE(common::file_system::is_file_exist(segment_path));
+
+  // worker wrote whole segment as one chunk
+  ASSERT_FALSE(VodSplitJob::WriteVodPlaylist(range_playlist, {fastocloud::utils::ChunkInfo("a.ts", duration, 0)}));
+  ASSERT_FALSE(VodJit::MakeSegment(http_root, "master.m3u8", 0, &segment));
+  ASSERT_EQ(segment.path, segment_path);
+  ASSERT_EQ(segment.size, 5u);
+  ASSERT_FALSE(common::file_system::is_file_exist(root + "a.ts"));
+  ASSERT_FALSE(common::file_system::is_file_exist(range_playlist.GetPath()));
+
+  unlink(segment_path.c_str());
+  rmdir(dir);
+}
@@ -0,0 +1,201 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Seek latency of just in time vods:
+// vods_jit_bench <host> <port> <playlist path> [seeks]
+// Requests playlist (indexing vod on first request), then seeks to random not yet generated segments,
+// prints time to first byte of cold segment and of next, prefetched, segment.
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+struct Timing {
+  Timing() : first_byte_usec(0), full_usec(0) {}
+
+  uint64_t first_byte_usec;
+  uint64_t full_usec;
+};
+
+int Connect(const std::string& host, const std::string& port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) {
+    return -1;
+  }
+
+  int fd = -1;
+  for (struct addrinfo* it = res; it; it = it->ai_next) {
+    fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+    if (fd == -1) {
+      continue;
+    }
+    if (connect(fd, it->ai_addr, it->ai_addrlen) == 0) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+// requests file by new connection, returns body or false on error/status other than 200
+bool Get(const std::string& host, const std::string& port, const std::string& path, std::string* body, Timing* timing) {
+  int fd = Connect(host, port);
+  if (fd == -1) {
+    return false;
+  }
+
+  const bench_clock_t::time_point start = bench_clock_t::now();
+  const std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+  if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) {
+    close(fd);
+    return false;
+  }
+
+  std::string response;
+  char buff[16 * 1024];
+  ssize_t res;
+  while ((res = recv(fd, buff, sizeof(buff), 0)) > 0) {
+    if (response.empty()) {
+      timing->first_byte_usec =
+          std::chrono::duration_cast<std::chrono::microseconds>(bench_clock_t::now() - start).count();
+    }
+    response.append(buff, res);
+  }
+  timing->full_usec = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock_t::now() - start).count();
+  close(fd);
+
+  const size_t header_end = response.find("\r\n\r\n");
+  if (header_end == std::string::npos || response.compare(0, 5, "HTTP/") != 0 ||
+      atoi(response.c_str() + response.find(' ') + 1) != 200) {
+    return false;
+  }
+
+  *body = response.substr(header_end + 4);
+  return true;
+}
+
+std::vector<std::string> ParseSegments(const std::string& playlist) {
+  std::vector<std::string> segments;
+  std::istringstream stream(playlist);
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+      line.erase(line.size() - 1);
+    }
+    if (!line.empty() && line[0] != '#') {
+      segments.push_back(line);
+    }
+  }
+  return segments;
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, double pct) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(pct / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+void PrintLatencies(const char* name, std::vector<uint64_t> latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  printf("%s msec p50: %.1f, p90: %.1f, max: %.1f\n", name, Percentile(latencies, 50) / 1000.0,
+         Percentile(latencies, 90) / 1000.0, latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s <host> <port> <playlist path> [seeks]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::string host = argv[1];
+  const std::string port = argv[2];
+  const std::string playlist_path = argv[3];
+  const size_t seeks = argc > 4 ? strtoul(argv[4], nullptr, 10) : 10;
+
+  std::string playlist;
+  Timing playlist_timing;
+  if (!Get(host, port, playlist_path, &playlist, &playlist_timing)) {
+    fprintf(stderr, "Can't get playlist: %s\n", playlist_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<std::string> segments = ParseSegments(playlist);
+  if (segments.size() < 2) {
+    fprintf(stderr, "Playlist has not enough segments to seek\n");
+    return EXIT_FAILURE;
+  }
+
+  const std::string base = playlist_path.substr(0, playlist_path.rfind('/') + 1);
+  std::vector<size_t> positions;
+  for (size_t i = 0; i + 1 < segments.size(); i += 2) {  // next segment of position is never position itself
+    positions.push_back(i);
+  }
+  std::shuffle(positions.begin(), positions.end(), std::mt19937(std::random_device()()));
+  positions.resize(std::min(seeks, positions.size()));
+
+  std::vector<uint64_t> cold_first_byte, cold_full, next_first_byte;
+  size_t errors = 0;
+  for (size_t position : positions) {
+    std::string body;
+    Timing cold, next;
+    if (!Get(host, port, base + segments[position], &body, &cold)) {
+      errors++;
+      continue;
+    }
+    cold_first_byte.push_back(cold.first_byte_usec);
+    cold_full.push_back(cold.full_usec);
+
+    // asked right away, prefetch started with cold segment is still running or already done
+    if (!Get(host, port, base + segments[position + 1], &body, &next)) {
+      errors++;
+      continue;
+    }
+    next_first_byte.push_back(next.first_byte_usec);
+  }
+
+  printf("segments: %zu, seeks: %zu, errors: %zu, playlist msec: %.1f\n", segments.size(), positions.size(), errors,
+         playlist_timing.full_usec / 1000.0);
+  PrintLatencies("cold segment first byte", cold_first_byte);
+  PrintLatencies("cold segment full", cold_full);
+  PrintLatencies("next segment first byte", next_first_byte);
+  return cold_first_byte.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Vods playlist request cost on main loop:
+// vods_playlist_bench [chunks] [requests]
+// Creates vod folder with chunks and playlist, then serves playlist requests with full check
+// (parse playlist and stat every chunk) and with cached completeness state, prints requests/sec.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "server/vods/vods_completeness.h"
+
+namespace {
+
+bool CreateVod(const std::string& dir, size_t chunks) {
+  FILE* playlist = fopen((dir + "/master.m3u8").c_str(), "w");
+  if (!playlist) {
+    return false;
+  }
+
+  fprintf(playlist, "#EXTM3U\n#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:10\n");
+  for (size_t i = 0; i < chunks; ++i) {
+    const std::string chunk_path = dir + "/" + std::to_string(i) + ".ts";
+    FILE* chunk = fopen(chunk_path.c_str(), "w");
+    if (!chunk) {
+      fclose(playlist);
+      return false;
+    }
+    fclose(chunk);
+    fprintf(playlist, "#EXTINF:10.00,\n%zu.ts\n", i);
+  }
+  fprintf(playlist, "#EXT-X-ENDLIST\n");
+  fclose(playlist);
+  return true;
+}
+
+void RemoveVod(const std::string& dir, size_t chunks) {
+  for (size_t i = 0; i < chunks; ++i) {
+    unlink((dir + "/" + std::to_string(i) + ".ts").c_str());
+  }
+  unlink((dir + "/master.m3u8").c_str());
+  rmdir(dir.c_str());
+}
+
+template <typename F>
+double MeasureRps(size_t requests, F func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < requests; ++i) {
+    if (!func()) {
+      return 0;
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return requests / elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t chunks = argc > 1 ? strtoul(argv[1], nullptr, 10) : 720;
+  const size_t requests = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+  if (!chunks || !requests) {
+    fprintf(stderr, "Usage: %s [chunks] [requests]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char tmpl[] = "/tmp/vods_playlist_bench_XXXXXX";
+  if (!mkdtemp(tmpl)) {
+    fprintf(stderr, "Can't create temp folder\n");
+    return EXIT_FAILURE;
+  }
+
+  const std::string dir = tmpl;
+  if (!CreateVod(dir, chunks)) {
+    fprintf(stderr, "Can't create vod in %s\n", tmpl);
+    RemoveVod(dir, chunks);
+    return EXIT_FAILURE;
+  }
+
+  typedef fastocloud::server::VodsCompleteness VodsCompleteness;
+  const VodsCompleteness::http_root_t http_root(dir);
+  const VodsCompleteness::playlist_t playlist(dir + "/master.m3u8");
+  const double full_rps = MeasureRps(requests, [&playlist]() { return VodsCompleteness::IsFullVod(playlist); });
+
+  VodsCompleteness states;
+  states.Add(http_root, "vod");
+  const double cached_rps = MeasureRps(requests, [&states, &playlist]() {
+    return states.GetState(playlist) == VodsCompleteness::COMPLETE;
+  });
+  RemoveVod(dir, chunks);
+
+  if (full_rps == 0 || cached_rps == 0) {
+    fprintf(stderr, "Vod wasn't detected as complete\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%zu chunks, %zu playlist requests:\n", chunks, requests);
+  printf("  full check:   %12.1f requests/sec\n", full_rps);
+  printf("  cached state: %12.1f requests/sec\n", cached_rps);
+  return EXIT_SUCCESS;
+}
@@ -33,6 +33,9 @@ class FakeObserver : public fastocloud::stream::IBaseStream::IStreamClient {
   MOCK_METHOD2(OnSyncMessageReceived, void(fastocloud::stream::IBaseStream*, GstMessage*));
   MOCK_METHOD2(OnASyncMessageReceived, void(fastocloud::stream::IBaseStream*, GstMessage*));
   void OnInputChanged(const fastocloud::InputUri& uri) override { UNUSED(uri); }
+  MOCK_METHOD4(OnInputStalled,
+               void(fastocloud::stream::IBaseStream*, const fastocloud::InputUri&, fastocloud::StallReason, gint64));
+  MOCK_METHOD2(OnInputRecovered, void(fastocloud::stream::IBaseStream*, const fastocloud::InputUri&));
   GstPadProbeInfo* OnCheckReveivedOutputData(fastocloud::stream::IBaseStream* job,
                                              fastocloud::stream::OutputProbe* probe,
                                              GstPadProbeInfo* info) override {
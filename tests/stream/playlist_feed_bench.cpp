@@ -0,0 +1,173 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Playlist feeding benchmark:
+// playlist_feed_bench [seconds] [rounds]
+// Encodes a local TS file, then produces appsrc buffers for it the way PlaylistRelayStream::HandleNeedData
+// did before (calloc + fread + gst_buffer_new_wrapped per 4 KiB) and the way it does now (pread of ~64 KiB
+// into buffers reused from a pool). Every buffer is mapped and summed so both variants touch all bytes.
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <gst/gst.h>
+
+#include <common/sprintf.h>
+
+#include "stream/gstreamer_utils.h"
+
+#define OLD_BUFFER_SIZE 4096
+#define NEW_BUFFER_SIZE (188 * 348)
+#define TEST_FRAMERATE 25
+#define TEST_SOURCE_PATH "/tmp/playlist_feed_bench.ts"
+
+namespace {
+
+double GetCpuTimeMsec() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+bool RunPipeline(const std::string& description) {
+  GError* err = nullptr;
+  GstElement* pipeline = gst_parse_launch(description.c_str(), &err);
+  if (!pipeline) {
+    fprintf(stderr, "Can't create pipeline: %s\n", err ? err->message : "unknown");
+    if (err) {
+      g_error_free(err);
+    }
+    return false;
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  GstBus* bus = gst_element_get_bus(pipeline);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                               static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  const bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+  if (msg) {
+    gst_message_unref(msg);
+  }
+  gst_object_unref(bus);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+  return ok;
+}
+
+guint64 ConsumeBuffer(GstBuffer* buffer) {
+  guint64 sum = 0;
+  GstMapInfo info;
+  if (gst_buffer_map(buffer, &info, GST_MAP_READ)) {
+    for (gsize i = 0; i < info.size; i += 188) {
+      sum += info.data[i];
+    }
+    gst_buffer_unmap(buffer, &info);
+  }
+  gst_buffer_unref(buffer);
+  return sum;
+}
+
+guint64 FeedWithFread(size_t* buffers) {
+  guint64 sum = 0;
+  FILE* file = fopen(TEST_SOURCE_PATH, "rb");
+  if (!file) {
+    return sum;
+  }
+
+  while (true) {
+    char* ptr = static_cast<char*>(calloc(OLD_BUFFER_SIZE, sizeof(char)));
+    size_t size = fread(ptr, sizeof(char), OLD_BUFFER_SIZE, file);
+    if (size == 0) {
+      free(ptr);
+      break;
+    }
+    sum += ConsumeBuffer(gst_buffer_new_wrapped(ptr, size));
+    (*buffers)++;
+  }
+  fclose(file);
+  return sum;
+}
+
+guint64 FeedWithPool(size_t* buffers) {
+  guint64 sum = 0;
+  off_t total = 0;
+  int fd = fastocloud::stream::open_feed_file(TEST_SOURCE_PATH, &total);
+  if (fd < 0) {
+    return sum;
+  }
+
+  GstBufferPool* pool = fastocloud::stream::make_buffer_pool(NEW_BUFFER_SIZE);
+  off_t offset = 0;
+  while (pool && offset < total) {
+    GstBuffer* buffer = fastocloud::stream::read_file_buffer(pool, fd, offset);
+    if (!buffer) {
+      break;
+    }
+    offset += gst_buffer_get_size(buffer);
+    sum += ConsumeBuffer(buffer);
+    (*buffers)++;
+  }
+  if (pool) {
+    gst_buffer_pool_set_active(pool, FALSE);
+    gst_object_unref(pool);
+  }
+  close(fd);
+  return sum;
+}
+
+void Measure(const char* name, guint64 (*feed)(size_t*), int rounds) {
+  double cpu_total = 0;
+  double wall_total = 0;
+  size_t buffers = 0;
+  guint64 sum = 0;
+  for (int i = 0; i < rounds; ++i) {
+    const double cpu_start = GetCpuTimeMsec();
+    const auto wall_start = std::chrono::steady_clock::now();
+    sum += feed(&buffers);
+    cpu_total += GetCpuTimeMsec() - cpu_start;
+    wall_total +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+  }
+  printf("%-8s cpu: %8.2f ms  wall: %8.2f ms  buffers: %zu  (avg of %d, checksum %llu)\n", name,
+         cpu_total / rounds, wall_total / rounds, buffers / rounds, rounds, static_cast<unsigned long long>(sum));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  const int seconds = argc > 1 ? atoi(argv[1]) : 60;
+  const int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+  const std::string encode = common::MemSPrintf(
+      "videotestsrc num-buffers=%d ! video/x-raw,width=1280,height=720,framerate=%d/1 ! x264enc speed-preset=1 "
+      "bitrate=4096 ! h264parse ! mpegtsmux ! filesink location=" TEST_SOURCE_PATH,
+      seconds * TEST_FRAMERATE, TEST_FRAMERATE);
+  if (!RunPipeline(encode)) {
+    fprintf(stderr, "Can't prepare test source " TEST_SOURCE_PATH "\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("feeding of %d sec 720p TS file\n", seconds);
+  Measure("fread", FeedWithFread, rounds);
+  Measure("pool", FeedWithPool, rounds);
+  remove(TEST_SOURCE_PATH);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Muxer sharing benchmark:
+// shared_muxer_bench [seconds] [rounds]
+// Encodes a local test stream once, then relays it to 4 MPEG-TS outputs twice: with a muxer per output
+// (previous SrcDecodeStreamBuilder::BuildOutput layout) and with one muxer teed into every sink, prints
+// process CPU time and wall time of each run. Sinks are fakesinks so disk io does not hide mux cost.
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <gst/gst.h>
+
+#include <common/sprintf.h>
+
+#define OUTPUTS_COUNT 4
+#define TEST_FRAMERATE 25
+#define TEST_SOURCE_PATH "/tmp/shared_muxer_bench.ts"
+
+namespace {
+
+double GetCpuTimeMsec() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+bool RunPipeline(const std::string& description) {
+  GError* err = nullptr;
+  GstElement* pipeline = gst_parse_launch(description.c_str(), &err);
+  if (!pipeline) {
+    fprintf(stderr, "Can't create pipeline: %s\n", err ? err->message : "unknown");
+    if (err) {
+      g_error_free(err);
+    }
+    return false;
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  GstBus* bus = gst_element_get_bus(pipeline);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                               static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  const bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+  if (msg) {
+    gst_message_unref(msg);
+  }
+  gst_object_unref(bus);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+  return ok;
+}
+
+std::string MakeRelaySource() {
+  return "filesrc location=" TEST_SOURCE_PATH
+         " ! tsdemux name=demux demux. ! queue ! h264parse ! tee name=vt demux. ! queue ! aacparse ! tee name=at ";
+}
+
+std::string MakeMuxerPerOutput() {
+  std::string result = MakeRelaySource();
+  for (size_t i = 0; i < OUTPUTS_COUNT; ++i) {
+    result += common::MemSPrintf(
+        "vt. ! queue ! mux%lu. at. ! queue ! mux%lu. mpegtsmux name=mux%lu ! fakesink sync=false ", i, i, i);
+  }
+  return result;
+}
+
+std::string MakeSharedMuxer() {
+  std::string result = MakeRelaySource();
+  result += "vt. ! queue ! mux. at. ! queue ! mux. mpegtsmux name=mux ! tee name=mt ";
+  for (size_t i = 0; i < OUTPUTS_COUNT; ++i) {
+    result += "mt. ! queue ! fakesink sync=false ";
+  }
+  return result;
+}
+
+void Measure(const char* name, const std::string& description, int rounds) {
+  double cpu_total = 0;
+  double wall_total = 0;
+  for (int i = 0; i < rounds; ++i) {
+    const double cpu_start = GetCpuTimeMsec();
+    const auto wall_start = std::chrono::steady_clock::now();
+    if (!RunPipeline(description)) {
+      fprintf(stderr, "%s: pipeline failed\n", name);
+      return;
+    }
+    cpu_total += GetCpuTimeMsec() - cpu_start;
+    wall_total +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+  }
+  printf("%-18s cpu: %8.1f ms  wall: %8.1f ms  (avg of %d)\n", name, cpu_total / rounds, wall_total / rounds,
+         rounds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  const int seconds = argc > 1 ? atoi(argv[1]) : 60;
+  const int rounds = argc > 2 ? atoi(argv[2]) : 5;
+
+  const std::string encode = common::MemSPrintf(
+      "videotestsrc num-buffers=%d ! video/x-raw,width=1280,height=720,framerate=%d/1 ! x264enc speed-preset=1 "
+      "key-int-max=%d ! h264parse ! mpegtsmux name=mux ! filesink location=" TEST_SOURCE_PATH
+      " audiotestsrc num-buffers=%d samplesperbuffer=1024 ! audio/x-raw,rate=48000 ! faac ! aacparse ! mux.",
+      seconds * TEST_FRAMERATE, TEST_FRAMERATE, TEST_FRAMERATE * 2, seconds * 48000 / 1024);
+  if (!RunPipeline(encode)) {
+    fprintf(stderr, "Can't prepare test source " TEST_SOURCE_PATH "\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("relay of %d sec 720p test stream to %d MPEG-TS outputs\n", seconds, OUTPUTS_COUNT);
+  Measure("muxer per output", MakeMuxerPerOutput(), rounds);
+  Measure("shared muxer", MakeSharedMuxer(), rounds);
+  remove(TEST_SOURCE_PATH);
+  return EXIT_SUCCESS;
+}
@@ -12,13 +12,17 @@
     along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <string>
+
 #include "gtest/gtest.h"
 
 #include "base/config_fields.h"
 #include "base/constants.h"
 #include "base/inputs_outputs.h"
+#include "base/stream_config_parse.h"
 
 #include "stream/configs_factory.h"
+#include "stream/streams/configs/encode_config.h"
 #include "stream/stypes.h"
 
 TEST(Api, init) {
@@ -42,3 +46,45 @@ TEST(Api, logo) {
   uri2.SetOutput(common::uri::Url("screen"));
   ouri.push_back(uri2);
 }
+
+TEST(Api, hot_swap) {
+  const std::string input_str = R"({"urls": [{"id": 1, "uri": "udp://localhost:1234"}]})";
+  const std::string output_str = R"({"urls": [{"id": 2, "uri": "tcp://localhost:1935"}]})";
+  for (bool hot_swap : {false, true}) {
+    fastocloud::StreamConfig config_args(new common::HashValue);
+    config_args->Insert(ID_FIELD, common::Value::CreateStringValueFromBasicString("encoding"));
+    config_args->Insert(TYPE_FIELD, common::Value::CreateIntegerValue(fastocloud::ENCODE));
+    config_args->Insert(INPUT_FIELD, fastocloud::MakeConfigFromJson(input_str).release());
+    config_args->Insert(OUTPUT_FIELD, fastocloud::MakeConfigFromJson(output_str).release());
+    if (hot_swap) {
+      config_args->Insert(HOT_SWAP_FIELD, common::Value::CreateBooleanValue(true));
+    }
+
+    fastocloud::stream::Config* config = nullptr;
+    common::Error err = fastocloud::stream::make_config(config_args, &config);
+    ASSERT_FALSE(err);
+    ASSERT_EQ(hot_swap, static_cast<fastocloud::stream::streams::EncodeConfig*>(config)->GetHotSwap());
+    delete config;
+  }
+}
+
+TEST(Api, input_redundancy) {
+  const std::string input_str =
+      R"({"urls": [{"id": 1, "uri": "udp://localhost:1234"}, {"id": 2, "uri": "udp://localhost:1235"}]})";
+  const std::string output_str = R"({"urls": [{"id": 3, "uri": "tcp://localhost:1935"}]})";
+  for (bool redundancy : {false, true}) {
+    fastocloud::StreamConfig config_args(new common::HashValue);
+    config_args->Insert(ID_FIELD, common::Value::CreateStringValueFromBasicString("redundant"));
+    config_args->Insert(TYPE_FIELD, common::Value::CreateIntegerValue(fastocloud::ENCODE));
+    config_args->Insert(INPUT_FIELD, fastocloud::MakeConfigFromJson(input_str).release());
+    config_args->Insert(OUTPUT_FIELD, fastocloud::MakeConfigFromJson(output_str).release());
+    config_args->Insert(INPUT_REDUNDANCY_FIELD, common::Value::CreateBooleanValue(redundancy));
+
+    fastocloud::stream::Config* config = nullptr;
+    common::Error err = fastocloud::stream::make_config(config_args, &config);
+    ASSERT_FALSE(err);
+    ASSERT_EQ(2u, config->GetInput().size());
+    ASSERT_EQ(redundancy, static_cast<fastocloud::stream::streams::EncodeConfig*>(config)->GetInputRedundancy());
+    delete config;
+  }
+}
@@ -12,9 +12,18 @@
     along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <limits>
+#include <string>
+
 #include <gtest/gtest.h>
 
+#include "stream/element_tracer.h"
 #include "stream/stypes.h"
+#include "stream/timeshift_index.h"
 
 TEST(element_id_t, GetElementId) {
   fastocloud::stream::element_id_t id;
@@ -60,3 +69,125 @@ TEST(m3u8, GetIndexFromHttpTsTemplate) {
   uint64_t ind3;
   ASSERT_FALSE(fastocloud::stream::GetIndexFromHttpTsTemplate("123_g.ts", &ind3));
 }
+
+TEST(TimeShiftIndex, FindAppendTrim) {
+  char tmpl[] = "/tmp/timeshift_index_XXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpl));
+  const common::file_system::ascii_directory_string_path dir(tmpl);
+  fastocloud::stream::TimeShiftIndex index(dir);
+  fastocloud::stream::TimeShiftChunk chunk;
+  ASSERT_FALSE(index.FindChunk(0, &chunk));
+
+  for (fastocloud::stream::chunk_index_t i = 0; i < 100; ++i) {
+    const int64_t start = 1000000 + i * 10000;
+    ASSERT_FALSE(index.Append({i, start, i == 50 ? 5000 : 10000, 100}));  // gap after 50
+  }
+
+  ASSERT_FALSE(index.FindChunk(999999, &chunk));
+  ASSERT_TRUE(index.FindChunk(1000000, &chunk));
+  ASSERT_EQ(chunk.index, 0);
+  ASSERT_TRUE(index.FindChunk(1000000 + 42 * 10000 + 9999, &chunk));
+  ASSERT_EQ(chunk.index, 42);
+  ASSERT_TRUE(index.FindChunk(1000000 + 50 * 10000 + 7000, &chunk));
+  ASSERT_EQ(chunk.index, 51);
+  ASSERT_FALSE(index.FindChunk(1000000 + 100 * 10000, &chunk));
+  ASSERT_TRUE(index.GetLastChunk(&chunk));
+  ASSERT_EQ(chunk.index, 99);
+
+  std::vector<fastocloud::stream::TimeShiftChunk> chunks;
+  ASSERT_TRUE(index.GetChunks(1000000 + 20 * 10000 + 5000, 1000000 + 23 * 10000, 100, &chunks));
+  ASSERT_EQ(chunks.size(), 3);
+  ASSERT_EQ(chunks[0].index, 20);
+  ASSERT_TRUE(index.GetChunks(1000000 + 20 * 10000 + 5000, 1000000 + 23 * 10000, 2, &chunks));
+  ASSERT_EQ(chunks.size(), 2);
+  ASSERT_EQ(chunks[1].index, 21);
+  ASSERT_TRUE(index.GetChunks(1000000 + 90 * 10000, std::numeric_limits<int64_t>::max(), 100, &chunks));
+  ASSERT_EQ(chunks.size(), 10);
+  ASSERT_EQ(chunks[9].index, 99);
+  ASSERT_TRUE(index.GetChunksBefore(1000000 + 30 * 10000 + 5000, 4, &chunks));
+  ASSERT_EQ(chunks.size(), 4);
+  ASSERT_EQ(chunks[0].index, 26);
+  ASSERT_EQ(chunks[3].index, 29);
+
+  ASSERT_FALSE(index.RemoveOlder(1000000 + 10 * 10000));
+  ASSERT_TRUE(index.GetFirstChunk(&chunk));
+  ASSERT_EQ(chunk.index, 10);
+  ASSERT_TRUE(index.GetLastChunk(&chunk));
+  ASSERT_EQ(chunk.index, 99);
+
+  ASSERT_EQ(unlink(index.GetPath().c_str()), 0);
+  ASSERT_EQ(rmdir(tmpl), 0);
+}
+
+TEST(TimeShiftIndex, NextIndexWithMissingChunk) {
+  char tmpl[] = "/tmp/timeshift_index_XXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpl));
+  const common::file_system::ascii_directory_string_path dir(tmpl);
+  const auto chunk_path = [&dir](fastocloud::stream::chunk_index_t index) {
+    return dir.GetPath() + std::to_string(index) + ".ts";
+  };
+  const auto make_chunk = [&chunk_path](fastocloud::stream::chunk_index_t index) {
+    FILE* file = fopen(chunk_path(index).c_str(), "w");
+    ASSERT_TRUE(file);
+    ASSERT_EQ(fputs("chunk", file), 5);
+    ASSERT_EQ(fclose(file), 0);
+  };
+
+  // nothing recorded yet, files decide
+  fastocloud::stream::TimeShiftIndex index(dir);
+  ASSERT_EQ(index.GetNextIndex(fastocloud::stream::invalid_chunk_index), 0);
+  make_chunk(0);
+  ASSERT_EQ(index.GetNextIndex(fastocloud::stream::invalid_chunk_index), 1);
+  ASSERT_EQ(index.GetNextIndex(0), 1);
+
+  // chunk 2 was never written, chunk 3 is lost after it was recorded
+  make_chunk(1);
+  make_chunk(3);
+  ASSERT_FALSE(index.Rebuild(10000));
+  ASSERT_EQ(unlink(chunk_path(3).c_str()), 0);
+  fastocloud::stream::TimeShiftChunk chunk;
+  ASSERT_TRUE(index.GetLastChunk(&chunk));
+  ASSERT_EQ(chunk.index, 3);
+
+  // stale base of missing file must not make recorded index again
+  ASSERT_EQ(index.GetNextIndex(2), 4);
+  ASSERT_EQ(index.GetNextIndex(3), 4);
+  ASSERT_EQ(index.GetNextIndex(fastocloud::stream::invalid_chunk_index), 4);
+  ASSERT_EQ(index.GetNextIndex(7), 7);  // skipped ahead by time
+  ASSERT_FALSE(index.Append({4, chunk.GetEndTime(), 10000, 5}));
+  ASSERT_EQ(index.GetNextIndex(4), 5);
+
+  ASSERT_EQ(unlink(chunk_path(0).c_str()), 0);
+  ASSERT_EQ(unlink(chunk_path(1).c_str()), 0);
+  ASSERT_EQ(unlink(index.GetPath().c_str()), 0);
+  ASSERT_EQ(rmdir(tmpl), 0);
+}
+
+TEST(ProcTimeHistogram, CollectPercentiles) {
+  typedef fastocloud::stream::ProcTimeHistogram histogram_t;
+  for (histogram_t::proctime_t usec = 1; usec < 10000000; usec = usec * 3 + 1) {
+    const histogram_t::proctime_t value = histogram_t::GetBucketValue(histogram_t::GetBucket(usec));
+    ASSERT_LE(value, usec + usec / 8);
+    ASSERT_GE(value, usec - usec / 8);
+  }
+
+  histogram_t histogram;
+  histogram_t::proctime_t p50, p95, p99;
+  ASSERT_FALSE(histogram.CollectPercentiles(&p50, &p95, &p99));
+  for (histogram_t::proctime_t usec = 1; usec <= 1000; ++usec) {
+    histogram.Add(usec * 10);
+  }
+  ASSERT_TRUE(histogram.CollectPercentiles(&p50, &p95, &p99));
+  ASSERT_NEAR(p50, 5000, 5000 / 8);
+  ASSERT_NEAR(p95, 9500, 9500 / 8);
+  ASSERT_NEAR(p99, 9900, 9900 / 8);
+  ASSERT_LE(p50, p95);
+  ASSERT_LE(p95, p99);
+
+  // only values since previous collect
+  ASSERT_FALSE(histogram.CollectPercentiles(&p50, &p95, &p99));
+  histogram.Add(42);
+  ASSERT_TRUE(histogram.CollectPercentiles(&p50, &p95, &p99));
+  ASSERT_EQ(p50, histogram_t::GetBucketValue(histogram_t::GetBucket(42)));
+  ASSERT_EQ(p99, p50);
+}
@@ -23,6 +23,7 @@
 
 #include "stream/configs_factory.h"
 #include "stream/link_generator/streamlink.h"
+#include "stream/streams/encoding/redundant_encoding_stream.h"
 #include "stream/streams/screen_stream.h"
 #include "stream/streams_factory.h"
 
@@ -45,6 +46,15 @@
 #define TEST_SLEEP_SEC 10
 #define CATCHUP_SLEEP_SEC 20
 #define M3U8LOG_SLEEP_SEC 10
+#define HOT_SWAP_SLEEP_SEC 8
+#define HOT_SWAP_INPUT_PATH "/tmp/workflow_hot_swap.ts"
+#define HOT_SWAP_OUTPUT_PORT 6004  // nobody listens, udp output doesn't need peer unlike tcp one
+#define REDUNDANT_PRIMARY_PORT 6001
+#define REDUNDANT_BACKUP_PORT 6002
+#define REDUNDANT_OUTPUT_PORT 6003
+#define REDUNDANT_WARMUP_SEC 4
+#define REDUNDANT_SWITCH_SEC 3
+#define REDUNDANT_FAILBACK_WAIT_SEC 20  // rebuild interval, first key frame and primary_failback_sec
 #define DIFF_SEC 1
 
 #define MODEL_GRAPH_PATH PROJECT_TEST_SOURCES_DIR "/data/graph_tinyyolov2_tensorflow.pb"
@@ -121,8 +131,150 @@ void check_encoders() {
   }
 }
 
+void make_hot_swap_input() {
+  GError* error = nullptr;
+  GstElement* pipeline = gst_parse_launch(
+      "videotestsrc num-buffers=50 ! video/x-raw,width=320,height=240,framerate=25/1 ! x264enc ! h264parse ! "
+      "mpegtsmux ! filesink location=" HOT_SWAP_INPUT_PATH,
+      &error);
+  CHECK(pipeline && !error) << "can't make hot swap input pipeline: " << (error ? error->message : "unknown");
+
+  CHECK(gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE)
+      << "can't start hot swap input pipeline";
+  GstBus* bus = gst_element_get_bus(pipeline);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                               static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  CHECK(msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) << "hot swap input wasn't written";
+  gst_message_unref(msg);
+  gst_object_unref(bus);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+}
+
+// two seconds file ends several times while stream runs, every eos must rebuild input instead of stopping stream
+void check_hot_swap() {
+  make_hot_swap_input();
+
+  const std::string iuri_str = R"({"urls": [{"id": 116, "uri": "file://)" HOT_SWAP_INPUT_PATH R"("}]})";
+  const std::string enc_uri_str =
+      common::MemSPrintf(R"({"urls": [{"id": 116, "uri": "udp://127.0.0.1:%d"}]})", HOT_SWAP_OUTPUT_PORT);
+  fastocloud::StreamConfig config_args(new common::HashValue);
+  config_args->Insert(ID_FIELD, common::Value::CreateStringValueFromBasicString("hot_swap"));
+  config_args->Insert(TYPE_FIELD, common::Value::CreateIntegerValue(fastocloud::ENCODE));
+  config_args->Insert(HAVE_AUDIO_FIELD, common::Value::CreateBooleanValue(false));
+  config_args->Insert(HOT_SWAP_FIELD, common::Value::CreateBooleanValue(true));
+  config_args->Insert(FEEDBACK_DIR_FIELD, common::Value::CreateStringValueFromBasicString("~"));
+  config_args->Insert(VIDEO_CODEC_FIELD, common::Value::CreateStringValueFromBasicString("x264enc"));
+  config_args->Insert(INPUT_FIELD, fastocloud::MakeConfigFromJson(iuri_str).release());
+  config_args->Insert(OUTPUT_FIELD, fastocloud::MakeConfigFromJson(enc_uri_str).release());
+
+  fastocloud::StreamStruct encoding(
+      fastocloud::StreamInfo{"hot_swap", fastocloud::StreamType::ENCODE, {0}, {0}});
+  fastocloud::stream::TimeShiftInfo tinf;
+  fastocloud::stream::Config* config = nullptr;
+  common::Error err = fastocloud::stream::make_config(config_args, &config);
+  CHECK(!err) << "can't make hot swap config";
+  fastocloud::stream::IBaseStream* job = fastocloud::stream::StreamsFactory::GetInstance().CreateStream(
+      config, nullptr, &encoding, tinf, fastocloud::stream::invalid_chunk_index);
+  CHECK(job) << "can't create hot swap stream";
+  CHECK(job->IsInputRestartable());
+  std::thread th([job]() {
+    sleep(HOT_SWAP_SLEEP_SEC);
+    job->Quit(fastocloud::stream::EXIT_SELF);
+  });
+  const fastocloud::stream::ExitStatus status = job->Exec();
+  th.join();
+  CHECK(status == fastocloud::stream::EXIT_SELF) << "stream stopped on input eos";
+  CHECK(encoding.restarts >= 2) << "input rebuilt " << encoding.restarts << " times";
+  delete job;
+  delete config;
+  remove(HOT_SWAP_INPUT_PATH);
+}
+
+GstElement* start_udp_feeder(int port) {
+  const std::string line = common::MemSPrintf(
+      "videotestsrc is-live=true ! video/x-raw,width=320,height=240,framerate=25/1 ! "
+      "x264enc tune=zerolatency key-int-max=25 ! h264parse ! mpegtsmux ! udpsink host=127.0.0.1 port=%d",
+      port);
+  GstElement* pipeline = gst_parse_launch(line.c_str(), nullptr);
+  if (!pipeline) {
+    return nullptr;
+  }
+
+  if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    gst_object_unref(pipeline);
+    return nullptr;
+  }
+  return pipeline;
+}
+
+void stop_udp_feeder(GstElement* pipeline) {
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+}
+
+// primary feeder dies while stream runs, backup must take over, rebuilt primary must be taken back
+// once it delivers again
+void check_redundant_failover() {
+  GstElement* primary = start_udp_feeder(REDUNDANT_PRIMARY_PORT);
+  GstElement* backup = start_udp_feeder(REDUNDANT_BACKUP_PORT);
+  CHECK(primary && backup) << "can't start input feeders";
+
+  const std::string iuri_str = common::MemSPrintf(
+      R"({"urls": [{"id": 117, "uri": "udp://127.0.0.1:%d"}, {"id": 118, "uri": "udp://127.0.0.1:%d"}]})",
+      REDUNDANT_PRIMARY_PORT, REDUNDANT_BACKUP_PORT);
+  const std::string enc_uri_str =
+      common::MemSPrintf(R"({"urls": [{"id": 117, "uri": "udp://127.0.0.1:%d"}]})", REDUNDANT_OUTPUT_PORT);
+  fastocloud::StreamConfig config_args(new common::HashValue);
+  config_args->Insert(ID_FIELD, common::Value::CreateStringValueFromBasicString("redundant"));
+  config_args->Insert(TYPE_FIELD, common::Value::CreateIntegerValue(fastocloud::ENCODE));
+  config_args->Insert(HAVE_AUDIO_FIELD, common::Value::CreateBooleanValue(false));
+  config_args->Insert(INPUT_REDUNDANCY_FIELD, common::Value::CreateBooleanValue(true));
+  config_args->Insert(FEEDBACK_DIR_FIELD, common::Value::CreateStringValueFromBasicString("~"));
+  config_args->Insert(VIDEO_CODEC_FIELD, common::Value::CreateStringValueFromBasicString("x264enc"));
+  config_args->Insert(INPUT_FIELD, fastocloud::MakeConfigFromJson(iuri_str).release());
+  config_args->Insert(OUTPUT_FIELD, fastocloud::MakeConfigFromJson(enc_uri_str).release());
+
+  fastocloud::StreamStruct encoding(fastocloud::StreamInfo{"redundant", fastocloud::StreamType::ENCODE, {0}, {0}});
+  fastocloud::stream::TimeShiftInfo tinf;
+  fastocloud::stream::Config* config = nullptr;
+  common::Error err = fastocloud::stream::make_config(config_args, &config);
+  CHECK(!err);
+  fastocloud::stream::IBaseStream* job = fastocloud::stream::StreamsFactory::GetInstance().CreateStream(
+      config, nullptr, &encoding, tinf, fastocloud::stream::invalid_chunk_index);
+  fastocloud::stream::streams::RedundantEncodingStream* redundant =
+      dynamic_cast<fastocloud::stream::streams::RedundantEncodingStream*>(job);
+  CHECK(redundant) << "inputs with redundancy must make redundant stream";
+
+  fastocloud::stream::element_id_t before_kill = 1, after_kill = 0, after_revive = 1;
+  std::thread th([&]() {
+    sleep(REDUNDANT_WARMUP_SEC);
+    before_kill = redundant->GetActiveInput();
+    stop_udp_feeder(primary);
+    sleep(REDUNDANT_SWITCH_SEC);
+    after_kill = redundant->GetActiveInput();
+    primary = start_udp_feeder(REDUNDANT_PRIMARY_PORT);
+    sleep(REDUNDANT_FAILBACK_WAIT_SEC);
+    after_revive = redundant->GetActiveInput();
+    job->Quit(fastocloud::stream::EXIT_SELF);
+  });
+  const fastocloud::stream::ExitStatus status = job->Exec();
+  th.join();
+  CHECK(status == fastocloud::stream::EXIT_SELF) << "stream stopped while one input was alive";
+  CHECK_EQ(before_kill, 0u) << "primary must be active while it is healthy";
+  CHECK_EQ(after_kill, 1u) << "backup must take over dead primary";
+  CHECK_EQ(after_revive, 0u) << "rebuilt primary must be taken back";
+  CHECK(primary) << "can't restart primary feeder";
+  delete job;
+  delete config;
+  stop_udp_feeder(primary);
+  stop_udp_feeder(backup);
+}
+
 int main(int argc, char** argv) {
   fastocloud::stream::streams_init(argc, argv);
+  check_hot_swap();
+  check_redundant_failover();
   check_encoders();
   return 0;
 }
@@ -12,8 +12,14 @@
     along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
+#include "base/shared_stream_stats.h"
+#include "stream_commands/commands_info/input_stall_info.h"
+#include "stream_commands/commands_info/startup_info.h"
 #include "stream_commands/commands_info/statistic_info.h"
 
 TEST(StreamStructInfo, SerializeDeSerialize) {
@@ -45,3 +51,174 @@ TEST(StreamStructInfo, SerializeDeSerialize) {
 
   json_object_put(serialized);
 }
+
+TEST(StatisticInfo, SerializeDeSerializeElements) {
+  fastocloud::StreamStruct stats("test", fastocloud::ENCODE, fastocloud::PLAYING, fastocloud::input_channels_info_t(),
+                                 fastocloud::output_channels_info_t(), 1571234567890, 1571234567890, 0);
+  fastocloud::ElementStats encoder("x264enc_0");
+  encoder.SetInputRate(25);
+  encoder.SetOutputRate(24.5);
+  encoder.SetProcTime(9000, 21000, 40000);
+  stats.elements.push_back(encoder);
+  fastocloud::ElementStats queue("queue_1");
+  queue.SetQueueFill(75);
+  stats.elements.push_back(queue);
+
+  fastocloud::StatisticInfo info(stats, 1.5, 1024, 1571234567890);
+  json_object* serialized = NULL;
+  common::Error err = info.Serialize(&serialized);
+  ASSERT_FALSE(err);
+
+  fastocloud::StatisticInfo info2;
+  err = info2.DeSerialize(serialized);
+  ASSERT_FALSE(err);
+  json_object_put(serialized);
+
+  const fastocloud::elements_stats_t elements = info2.GetStreamStruct().elements;
+  ASSERT_EQ(elements.size(), 2);
+  ASSERT_EQ(elements[0].GetName(), "x264enc_0");
+  ASSERT_EQ(elements[0].GetInputRate(), 25);
+  ASSERT_EQ(elements[0].GetOutputRate(), 24.5);
+  ASSERT_EQ(elements[0].GetProcTimeP50(), 9000);
+  ASSERT_EQ(elements[0].GetProcTimeP95(), 21000);
+  ASSERT_EQ(elements[0].GetProcTimeP99(), 40000);
+  ASSERT_EQ(elements[0].GetQueueFill(), fastocloud::ElementStats::no_queue);
+  ASSERT_EQ(elements[1].GetName(), "queue_1");
+  ASSERT_EQ(elements[1].GetQueueFill(), 75);
+}
+
+TEST(InputStallInfo, SerializeDeSerialize) {
+  fastocloud::InputStallInfo stall("test", 7, fastocloud::STALL_NO_PROGRESS, true, 1571234567890, 1750);
+  json_object* serialized = NULL;
+  common::Error err = stall.Serialize(&serialized);
+  ASSERT_FALSE(err);
+
+  fastocloud::InputStallInfo stall2;
+  err = stall2.DeSerialize(serialized);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(stall.GetStreamID(), stall2.GetStreamID());
+  ASSERT_EQ(stall.GetInputID(), stall2.GetInputID());
+  ASSERT_EQ(stall.GetReason(), stall2.GetReason());
+  ASSERT_EQ(stall.IsRecovered(), stall2.IsRecovered());
+  ASSERT_EQ(stall.GetTimestamp(), stall2.GetTimestamp());
+  ASSERT_EQ(stall.GetDuration(), stall2.GetDuration());
+
+  json_object_put(serialized);
+}
+
+TEST(StartupInfo, SerializeDeSerialize) {
+  fastocloud::StartupTiming timing;
+  timing.Set(fastocloud::STARTUP_FORKED, 1000);
+  timing.Set(fastocloud::STARTUP_INITED, 5000);
+  timing.Set(fastocloud::STARTUP_PLAYING, 120000);
+  timing.Set(fastocloud::STARTUP_FIRST_SEGMENT, 2120000);
+  ASSERT_EQ(timing.GetDuration(), 2119000);
+  fastocloud::StartupInfo startup("test", 2, timing);
+  json_object* serialized = NULL;
+  common::Error err = startup.Serialize(&serialized);
+  ASSERT_FALSE(err);
+
+  fastocloud::StartupInfo startup2;
+  err = startup2.DeSerialize(serialized);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(startup.GetStreamID(), startup2.GetStreamID());
+  ASSERT_EQ(startup.GetRestarts(), startup2.GetRestarts());
+  ASSERT_EQ(startup.GetTiming(), startup2.GetTiming());
+  ASSERT_FALSE(startup2.GetTiming().IsMarked(fastocloud::STARTUP_PAUSED));
+  json_object_put(serialized);
+
+  std::string trace;
+  err = startup2.SerializeTrace(&trace);
+  ASSERT_FALSE(err);
+  ASSERT_NE(trace.find("traceEvents"), std::string::npos);
+  ASSERT_NE(trace.find("first_segment"), std::string::npos);
+}
+
+TEST(SharedStreamStats, PublishReadAcrossFork) {
+  fastocloud::SharedStreamStats* mem = fastocloud::SharedStreamStats::Create();
+  ASSERT_TRUE(mem);
+
+  fastocloud::StreamStruct stats;
+  double cpu_load = 0;
+  size_t rss = 0;
+  fastotv::timestamp_t timestamp = 0;
+  fastocloud::SharedStreamStats::sequence_t sequence = 0;
+  ASSERT_FALSE(mem->Read(&stats, &cpu_load, &rss, &timestamp, &sequence));
+
+  pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    fastocloud::StreamInfo sha;
+    sha.id = "test";
+    sha.type = fastocloud::RELAY;
+    sha.input = {0, 1};
+    sha.output = {2};
+    fastocloud::StreamStruct str(sha, 15, 33, 2);
+    str.status = fastocloud::PLAYING;
+    str.input[1].SetBps(1024);
+    fastocloud::ElementStats element("videoscale_0");
+    element.SetProcTime(300, 900, 1200);
+    str.elements.push_back(element);
+    mem->Publish(str, 0.5, 12, 10);
+    _exit(EXIT_SUCCESS);
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(mem->Read(&stats, &cpu_load, &rss, &timestamp, &sequence));
+  ASSERT_NE(sequence, 0u);
+  ASSERT_EQ(stats.type, fastocloud::RELAY);
+  ASSERT_EQ(stats.status, fastocloud::PLAYING);
+  ASSERT_EQ(stats.restarts, 2u);
+  ASSERT_EQ(stats.input.size(), 2u);
+  ASSERT_EQ(stats.input[1].GetID(), 1u);
+  ASSERT_EQ(stats.input[1].GetBps(), 1024u);
+  ASSERT_EQ(stats.output.size(), 1u);
+  ASSERT_EQ(stats.elements.size(), 1u);
+  ASSERT_EQ(stats.elements[0].GetName(), "videoscale_0");
+  ASSERT_EQ(stats.elements[0].GetProcTimeP95(), 900u);
+  ASSERT_EQ(cpu_load, 0.5);
+  ASSERT_EQ(rss, 12u);
+  ASSERT_EQ(timestamp, 10);
+
+  fastocloud::SharedStreamStats::Destroy(&mem);
+  ASSERT_FALSE(mem);
+}
+
+#if defined(OS_LINUX)
+TEST(SharedStreamStats, AttachByDescriptor) {
+  int fd = -1;
+  fastocloud::SharedStreamStats* mem = fastocloud::SharedStreamStats::CreateShared(&fd);
+  ASSERT_TRUE(mem);
+  ASSERT_NE(fd, -1);
+
+  fastocloud::SharedStreamStats* attached = fastocloud::SharedStreamStats::Attach(fd);
+  close(fd);
+  ASSERT_TRUE(attached);
+  ASSERT_NE(attached, mem);
+
+  fastocloud::StreamInfo sha;
+  sha.id = "test";
+  sha.type = fastocloud::ENCODE;
+  sha.input = {0};
+  sha.output = {1, 2};
+  fastocloud::StreamStruct str(sha, 15, 33, 1);
+  str.status = fastocloud::PLAYING;
+  attached->Publish(str, 0.25, 64, 20);
+
+  fastocloud::StreamStruct stats;
+  double cpu_load = 0;
+  size_t rss = 0;
+  fastotv::timestamp_t timestamp = 0;
+  fastocloud::SharedStreamStats::sequence_t sequence = 0;
+  ASSERT_TRUE(mem->Read(&stats, &cpu_load, &rss, &timestamp, &sequence));
+  ASSERT_EQ(stats.type, fastocloud::ENCODE);
+  ASSERT_EQ(stats.status, fastocloud::PLAYING);
+  ASSERT_EQ(stats.output.size(), 2u);
+  ASSERT_EQ(cpu_load, 0.25);
+  ASSERT_EQ(rss, 64u);
+
+  fastocloud::SharedStreamStats::Destroy(&attached);
+  fastocloud::SharedStreamStats::Destroy(&mem);
+}
+#endif
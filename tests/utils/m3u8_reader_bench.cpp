@@ -0,0 +1,177 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// M3U8 parsing benchmark:
+// m3u8_reader_bench [chunks] [iterations]
+// Writes a catchup like playlist and parses it with utils::M3u8Reader and with the previous
+// regex based parser, prints average time per parse.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+
+#include <common/convert2string.h>
+
+#include "utils/m3u8_reader.h"
+
+namespace {
+
+#define MAX_LINE 255
+
+bool LegacyGetNonEmptyLine(FILE* file, std::string* line) {
+  char t[MAX_LINE] = {0};
+  while (true) {
+    if (!fgets(t, MAX_LINE, file)) {
+      return false;
+    }
+
+    auto it = std::find_if(std::begin(t), std::end(t), [](char c) { return !std::isspace(c); });
+    if (it != std::end(t) && *it != 0) {
+      *line = t;
+      while (!line->empty() && std::isspace(line->back())) {
+        line->pop_back();
+      }
+      return true;
+    }
+  }
+}
+
+size_t LegacyParseChunks(FILE* file) {
+  static const std::regex m3u8_chunk_header_re("^#EXTINF:([0-9.]+),$");
+  static const std::regex m3u8_chunk_re("^[A-Za-z0-9_]*?([0-9]+)\\.ts$");
+
+  size_t chunks = 0;
+  std::string header_line, chunk_line;
+  while (LegacyGetNonEmptyLine(file, &header_line)) {
+    if (header_line == "#EXT-X-ENDLIST") {
+      break;
+    }
+    if (!LegacyGetNonEmptyLine(file, &chunk_line)) {
+      return 0;
+    }
+
+    std::smatch header_match;
+    double duration;
+    if (!std::regex_match(header_line, header_match, m3u8_chunk_header_re) ||
+        !common::ConvertFromString(header_match.str(1), &duration)) {
+      return 0;
+    }
+    std::smatch chunk_match;
+    uint64_t index;
+    if (!std::regex_match(chunk_line, chunk_match, m3u8_chunk_re) ||
+        !common::ConvertFromString(chunk_match.str(1), &index)) {
+      return 0;
+    }
+    chunks++;
+  }
+  return chunks;
+}
+
+// regex parser which M3u8Reader had before, returns count of chunks
+size_t LegacyParse(const std::string& path) {
+  static const std::regex m3u8_version("^#EXT-X-VERSION:([0-9]+)$");
+  static const std::regex m3u8_allow_cache("^#EXT-X-ALLOW-CACHE:([A-Z]+)$");
+  static const std::regex m3u8_media_sequence("^#EXT-X-MEDIA-SEQUENCE:([0-9]+)$");
+  static const std::regex m3u8_target_duration("^#EXT-X-TARGETDURATION:([0-9]+)$");
+
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) {
+    return 0;
+  }
+
+  size_t chunks = 0;
+  std::string line;
+  std::smatch match;
+  while (LegacyGetNonEmptyLine(file, &line)) {
+    if (line == "#EXTM3U" || std::regex_match(line, match, m3u8_version) ||
+        std::regex_match(line, match, m3u8_allow_cache) || std::regex_match(line, match, m3u8_media_sequence) ||
+        std::regex_match(line, match, m3u8_target_duration)) {
+      continue;
+    }
+
+    long off = ftell(file);
+    fseek(file, off - line.length() - 1, SEEK_SET);
+    chunks = LegacyParseChunks(file);
+    break;
+  }
+  fclose(file);
+  return chunks;
+}
+
+bool WritePlaylist(const std::string& path, size_t chunks) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  fprintf(file, "#EXTM3U\n#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-ALLOW-CACHE:YES\n#EXT-X-VERSION:3\n");
+  fprintf(file, "#EXT-X-TARGETDURATION:10\n");
+  for (size_t i = 0; i < chunks; ++i) {
+    fprintf(file, "#EXTINF:%.2f,\n%zu.ts\n", 9.5 + (i % 10) / 20.0, i);
+  }
+  fprintf(file, "#EXT-X-ENDLIST\n");
+  fclose(file);
+  return true;
+}
+
+template <typename F>
+double MeasureMsec(size_t iterations, F func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t chunks = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+  const size_t iterations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20;
+  if (!chunks || !iterations) {
+    fprintf(stderr, "Usage: %s [chunks] [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::string path = "m3u8_reader_bench.m3u8";
+  if (!WritePlaylist(path, chunks)) {
+    fprintf(stderr, "Can't write %s\n", path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  size_t parsed = 0;
+  const double reader_msec = MeasureMsec(iterations, [&path, &parsed]() {
+    fastocloud::utils::M3u8Reader reader;
+    reader.Parse(path);
+    parsed = reader.GetChunks().size();
+  });
+  size_t legacy_parsed = 0;
+  const double legacy_msec = MeasureMsec(iterations, [&path, &legacy_parsed]() { legacy_parsed = LegacyParse(path); });
+  remove(path.c_str());
+
+  if (parsed != chunks || legacy_parsed != chunks) {
+    fprintf(stderr, "Parsed %zu and %zu chunks of %zu\n", parsed, legacy_parsed, chunks);
+    return EXIT_FAILURE;
+  }
+
+  printf("%zu chunks, %zu iterations, per parse:\n", chunks, iterations);
+  printf("  M3u8Reader: %10.3f msec\n", reader_msec);
+  printf("  regex:      %10.3f msec (x%.1f)\n", legacy_msec, legacy_msec / reader_msec);
+  return EXIT_SUCCESS;
+}
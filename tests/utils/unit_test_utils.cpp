@@ -14,9 +14,56 @@
 
 #include <gtest/gtest.h>
 
+#include <common/convert2string.h>
+#include <common/file_system/file_system.h>
+
 #include "utils/chunk_info.h"
+#include "utils/m3u8_reader.h"
+#include "utils/m3u8_writer.h"
 
 TEST(ChunkInfo, double) {
   fastocloud::utils::ChunkInfo ch("1497615343667_segment10012.ts", 11.43 * fastocloud::utils::ChunkInfo::SECOND, 10012);
   ASSERT_EQ(ch.GetDurationInSecconds(), 11.43);
 }
+
+TEST(M3u8Writer, master_playlist) {
+  const common::file_system::ascii_file_string_path path("/tmp/unit_test_master.m3u8");
+  const uint32_t flags = common::file_system::File::FLAG_CREATE_ALWAYS | common::file_system::File::FLAG_WRITE;
+  fastocloud::utils::M3u8Writer writer;
+  ASSERT_FALSE(writer.Open(path, flags));
+  ASSERT_FALSE(writer.WriteMasterHeader());
+  ASSERT_FALSE(writer.WriteVariant(5000 * 1000, 1920, 1080, "0_master.m3u8"));
+  ASSERT_FALSE(writer.WriteVariant(1200 * 1000, 640, 360, "1_master.m3u8"));
+  ASSERT_FALSE(writer.Close());
+
+  fastocloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.Parse(path));
+  ASSERT_TRUE(reader.GetChunks().empty());
+  const auto variants = reader.GetVariants();
+  ASSERT_EQ(variants.size(), 2);
+  ASSERT_EQ(variants[1], "1_master.m3u8");
+  ASSERT_FALSE(common::file_system::remove_file(path.GetPath()));
+}
+
+TEST(M3u8Writer, append_event_playlist) {
+  const common::file_system::ascii_file_string_path path("/tmp/unit_test_event.m3u8");
+  ignore_result(common::file_system::remove_file(path.GetPath()));
+  for (uint64_t run = 0; run < 2; ++run) {  // second run reopens stopped playlist
+    fastocloud::utils::M3u8Writer writer;
+    ASSERT_FALSE(writer.OpenAppend(path, 0, 10));
+    for (uint64_t i = run * 2; i < run * 2 + 2; ++i) {
+      fastocloud::utils::ChunkInfo ch(common::ConvertToString(i) + ".ts", 2 * fastocloud::utils::ChunkInfo::SECOND, i);
+      ASSERT_FALSE(writer.WriteLine(ch));
+    }
+    ASSERT_FALSE(writer.WriteFooter());
+    ASSERT_FALSE(writer.Close());
+  }
+
+  fastocloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.Parse(path));
+  ASSERT_EQ(reader.GetTargetDuration(), 10);
+  const auto chunks = reader.GetChunks();
+  ASSERT_EQ(chunks.size(), 4);
+  ASSERT_EQ(chunks[3].index, 3);
+  ASSERT_FALSE(common::file_system::remove_file(path.GetPath()));
+}